@@ -0,0 +1,140 @@
+// Frame arena benchmark: time per frame of an allocation heavy pipeline (per group of objects: temporary arrays of
+// world transforms, matrices and transformed points, as built by typical per-frame code) with std::allocator and
+// with the FrameArena of vmath_arena.h (reset per frame only, or also rewound after each group with ArenaScope), on
+// 100k and 1M objects per frame. The temporaries are allocated with and without reserve (vector growth). Timings
+// are ns per object (bench::Suite, see benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_arena                  # 100k and 1M objects per frame
+//     bazel run -c opt //benchmark:benchmark_arena -- 500000 64     # 500k objects, groups of 64
+//
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_arena.h"
+#include "vmath_stream.h"
+
+namespace {
+
+// one group: the world transforms of its objects along a chain, their matrices, and a few points of each object
+// in world space, all in temporary arrays of the given allocator
+template <typename Alloc>
+double process_group(const math::Transff *locals, const std::vector<math::Vector3f> &points, size_t group,
+                     bool reserve, const Alloc &alloc) {
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<math::Transff> TransformAlloc;
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<math::Matrix4f> MatrixAlloc;
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<math::Vector3f> PointAlloc;
+    const size_t points_per_object = points.size() / group;
+    std::vector<math::Transff, TransformAlloc> world{TransformAlloc(alloc)};
+    std::vector<math::Matrix4f, MatrixAlloc> matrices{MatrixAlloc(alloc)};
+    std::vector<math::Vector3f, PointAlloc> out{PointAlloc(alloc)};
+    if (reserve) {
+        world.reserve(group);
+        matrices.reserve(group);
+        out.reserve(points.size());
+    }
+    math::Transff parent;
+    for (size_t i = 0; i < group; i++) {
+        parent = parent * locals[i];
+        world.push_back(parent);
+        matrices.push_back(math::create_transformation(parent.p, parent.q));
+    }
+    for (size_t i = 0; i < group; i++) {
+        const size_t first = out.size();
+        out.resize(first + points_per_object);
+        math::transform_points(world[i], &points[i * points_per_object], &out[first], points_per_object, 1);
+    }
+    return double(out.back().x + matrices.back().data[12]);
+}
+
+// one frame: all the groups; with a scoped arena, the temporaries of each group are released at its end
+template <typename Alloc>
+double frame(const std::vector<math::Transff> &locals, const std::vector<math::Vector3f> &points, size_t group,
+             bool reserve, const Alloc &alloc, math::FrameArena *scoped = nullptr) {
+    double sum = 0.0;
+    for (size_t g = 0; g + group <= locals.size(); g += group) {
+        if (scoped) {
+            math::ArenaScope scope(*scoped);
+            sum += process_group(&locals[g], points, group, reserve, alloc);
+        } else {
+            sum += process_group(&locals[g], points, group, reserve, alloc);
+        }
+    }
+    return sum;
+}
+
+struct State {
+    std::vector<math::Transff> locals;
+    std::vector<math::Vector3f> points;
+    math::FrameArena arena, scoped_arena;
+};
+
+void register_size(bench::Suite &suite, size_t n, size_t group, uint32_t seed) {
+    auto s = std::make_shared<State>();
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> d(-1.f, 1.f);
+    s->locals.resize(n);
+    for (auto &t : s->locals)
+        t = math::Transff(math::Vector3f(d(gen), d(gen), d(gen)),
+                          math::normalized(math::Quatf(1.f, d(gen) * 0.1f, d(gen) * 0.1f, d(gen) * 0.1f)));
+    s->points.resize(group * 4);
+    for (auto &p : s->points)
+        p = math::Vector3f(d(gen), d(gen), d(gen));
+
+    // first frame: the arenas grow to the size of a frame (without reserve, the larger one), then they stay in a
+    // single block
+    math::ArenaAllocator<math::Transff> alloc(s->arena), scoped_alloc(s->scoped_arena);
+    frame(s->locals, s->points, group, false, alloc);
+    s->arena.reset();
+    frame(s->locals, s->points, group, false, scoped_alloc, &s->scoped_arena);
+    s->scoped_arena.reset();
+    printf("%zu objects per frame, groups of %zu (%zu groups): arena %.2f MB in %zu block, %.2f MB in %zu block "
+           "with ArenaScope\n",
+           n, group, n / group, double(s->arena.capacity()) * 1e-6, s->arena.block_count(),
+           double(s->scoped_arena.capacity()) * 1e-6, s->scoped_arena.block_count());
+
+    const std::string sfx = "/" + bench::size_label(n);
+    for (bool reserve : {true, false}) {
+        const std::string kind = reserve ? "_reserved" : "_growing";
+        suite.add("heap" + kind + sfx, n, [s, group, reserve] {
+            return frame(s->locals, s->points, group, reserve, std::allocator<math::Transff>());
+        });
+        suite.add("arena" + kind + sfx, n, [s, group, reserve] {
+            const double sum =
+                frame(s->locals, s->points, group, reserve, math::ArenaAllocator<math::Transff>(s->arena));
+            s->arena.reset();
+            return sum;
+        });
+        suite.add("arena_scoped" + kind + sfx, n, [s, group, reserve] {
+            const double sum = frame(s->locals, s->points, group, reserve,
+                                     math::ArenaAllocator<math::Transff>(s->scoped_arena), &s->scoped_arena);
+            s->scoped_arena.reset();
+            return sum;
+        });
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [GROUP [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const size_t group = opt.args.size() > 1 ? std::max<size_t>(1, size_t(std::atoll(opt.args[1].c_str()))) : 16;
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{100000, 1000000})
+        groups.push_back([=](bench::Suite &suite) { register_size(suite, size, group, seed); });
+    return bench::run_suite(groups, opt);
+}
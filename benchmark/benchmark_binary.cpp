@@ -0,0 +1,168 @@
+// Binary file benchmark: startup time of loading 1M and 10M Matrix4f and Transff from the memory mapped binary
+// format of vmath_binary.h (no copy, with and without checksum verification) against parsing the same data from a
+// text file. The files are written to a temporary directory and read back while they are in the page cache, so
+// the numbers do not include the disk. Timings are ns per Matrix4f + Transff pair (bench::Suite, see
+// benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_binary                        # 1M and 10M elements, files in /tmp
+//     bazel run -c opt //benchmark:benchmark_binary -- 2000000 /scratch    # 2M elements, files in /scratch
+//
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_binary.h"
+
+namespace {
+
+// sum of all the scalars, to make sure that the data is read
+template <typename V> double touch(const V *v, size_t n) {
+    const float *p = reinterpret_cast<const float *>(v);
+    double sum = 0.0;
+    for (size_t i = 0; i < n * sizeof(V) / sizeof(float); i++)
+        sum += p[i];
+    return sum;
+}
+
+bool write_text(const std::string &path, const std::vector<math::Matrix4f> &m, const std::vector<math::Transff> &t) {
+    std::FILE *f = std::fopen(path.c_str(), "w");
+    if (!f)
+        return false;
+    fprintf(f, "%zu %zu\n", m.size(), t.size());
+    for (const auto &e : m) {
+        for (int k = 0; k < 16; k++)
+            fprintf(f, k < 15 ? "%.9g " : "%.9g\n", e.data[k]);
+    }
+    for (const auto &e : t)
+        fprintf(f, "%.9g %.9g %.9g %.9g %.9g %.9g %.9g\n", e.p.x, e.p.y, e.p.z, e.q.w, e.q.x, e.q.y, e.q.z);
+    return std::fclose(f) == 0;
+}
+
+// read the whole file, then parse it
+bool read_text(const std::string &path, std::vector<math::Matrix4f> &m, std::vector<math::Transff> &t) {
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    std::fseek(f, 0, SEEK_END);
+    std::string text(size_t(std::ftell(f)), '\0');
+    std::fseek(f, 0, SEEK_SET);
+    const bool ok = std::fread(&text[0], 1, text.size(), f) == text.size();
+    std::fclose(f);
+    if (!ok)
+        return false;
+    char *p = &text[0];
+    m.resize(size_t(std::strtoull(p, &p, 10)));
+    t.resize(size_t(std::strtoull(p, &p, 10)));
+    for (auto &e : m)
+        for (int k = 0; k < 16; k++)
+            e.data[k] = std::strtof(p, &p);
+    for (auto &e : t) {
+        e.p.x = std::strtof(p, &p);
+        e.p.y = std::strtof(p, &p);
+        e.p.z = std::strtof(p, &p);
+        e.q.w = std::strtof(p, &p);
+        e.q.x = std::strtof(p, &p);
+        e.q.y = std::strtof(p, &p);
+        e.q.z = std::strtof(p, &p);
+    }
+    return true;
+}
+
+// the data, the files and the reader of one size; the files are removed when the benchmarks of the size are done
+struct State {
+    ~State() {
+        reader.close();
+        std::remove(text_path.c_str());
+        std::remove(binary_path.c_str());
+    }
+    std::vector<math::Matrix4f> m, tm;
+    std::vector<math::Transff> t, tt;
+    std::string text_path, binary_path;
+    math::BinaryFileWriter writer;
+    math::BinaryFileReader reader;
+};
+
+void register_size(bench::Suite &suite, size_t n, const std::string &dir, uint32_t seed) {
+    auto s = std::make_shared<State>();
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> d(-10.f, 10.f);
+    s->m.resize(n);
+    s->t.resize(n);
+    for (auto &e : s->m)
+        for (auto &v : e.data)
+            v = d(gen);
+    for (auto &e : s->t)
+        e = math::Transff(math::Vector3f(d(gen), d(gen), d(gen)),
+                          math::normalized(math::Quatf(d(gen), d(gen), d(gen), d(gen))));
+    const double bytes = double(n) * double(sizeof(math::Matrix4f) + sizeof(math::Transff));
+    printf("%zu Matrix4f + %zu Transff (%.1f MB)\n", n, n, bytes * 1e-6);
+
+    s->text_path = dir + "/vmath_benchmark_binary.txt";
+    s->binary_path = dir + "/vmath_benchmark_binary.bin";
+    s->writer.add("matrices", s->m.data(), n);
+    s->writer.add("transforms", s->t.data(), n);
+    if (!s->writer.write(s->binary_path) || !write_text(s->text_path, s->m, s->t))
+        printf("cannot write the files in %s\n", dir.c_str());
+    if (!read_text(s->text_path, s->tm, s->tt) || s->tm.size() != n || s->tt.size() != n ||
+        s->tm[n / 2].data[3] != s->m[n / 2].data[3] || s->tt[n / 3].q.z != s->t[n / 3].q.z)
+        printf("  text round trip mismatch\n");
+    if (!s->reader.open(s->binary_path) || s->reader.aos<math::Matrix4f>("matrices").size() != n ||
+        s->reader.aos<math::Matrix4f>("matrices")[n / 2].data[3] != s->m[n / 2].data[3])
+        printf("  binary round trip mismatch\n");
+
+    const std::string sfx = "/" + bench::size_label(n);
+    suite.add("binary_write" + sfx, n, [s] { return double(s->writer.write(s->binary_path)); });
+    suite.add("text_parse" + sfx, n, [s] {
+        if (!read_text(s->text_path, s->tm, s->tt))
+            printf("cannot read %s\n", s->text_path.c_str());
+        return double(s->tm.back().data[15]);
+    });
+    auto open = [s](bool verify) {
+        if (!s->reader.open(s->binary_path, verify))
+            printf("cannot open %s: %s\n", s->binary_path.c_str(), s->reader.error().c_str());
+    };
+    suite.add("binary_open_first_access" + sfx, n, [s, open] {
+        open(false);
+        const auto m = s->reader.aos<math::Matrix4f>("matrices");
+        return double(m[m.size() - 1].data[15]);
+    });
+    suite.add("binary_open_read_all" + sfx, n, [s, open] {
+        open(false);
+        const auto m = s->reader.aos<math::Matrix4f>("matrices");
+        const auto t = s->reader.aos<math::Transff>("transforms");
+        return touch(m.data(), m.size()) + touch(t.data(), t.size());
+    });
+    suite.add("binary_open_verified" + sfx, n, [s, open] {
+        open(true);
+        const auto t = s->reader.aos<math::Transff>("transforms");
+        return double(t[t.size() - 1].q.z);
+    });
+    // reference: the same data in memory
+    suite.add("read_all_in_memory" + sfx, n,
+              [s] { return touch(s->m.data(), s->m.size()) + touch(s->t.data(), s->t.size()); });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 3; // the text parse of 10M elements takes tens of seconds
+    const int rc = bench::parse_options(argc, argv, opt, "[N [DIR [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const std::string dir = opt.args.size() > 1 ? opt.args[1] : "/tmp";
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{1000000, 10000000})
+        groups.push_back([=](bench::Suite &suite) { register_size(suite, size, dir, seed); });
+    return bench::run_suite(groups, opt);
+}
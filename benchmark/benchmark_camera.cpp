@@ -0,0 +1,153 @@
+// Primary ray generation benchmark: origins and unit directions of 1M and 10M jittered camera rays (a 1920 pixels
+// wide image) into SoA arrays, with the batch kernel of vmath_camera.h over 32x32 pixel tiles and the whole image
+// (1 thread and all threads), against the per pixel route (two inverse view projection Matrix4 * Vector4 products,
+// perspective divides and a normalize). Timings are ns per ray (bench::Suite, see benchmark_util.h for the
+// options).
+//
+//     bazel run -c opt //benchmark:benchmark_camera                  # 1M and 10M rays
+//     bazel run -c opt //benchmark:benchmark_camera -- 2000000 4     # 2M rays, 4 threads
+//
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_camera.h"
+
+namespace {
+
+math::Matrix4f perspective(float fovy, float aspect, float znear, float zfar) {
+    const float f = 1.f / std::tan(0.5f * fovy);
+    math::Matrix4f m = math::matrix4_identity<float>();
+    m(0, 0) = f / aspect;
+    m(1, 1) = f;
+    m(2, 2) = (zfar + znear) / (znear - zfar);
+    m(2, 3) = 2.f * zfar * znear / (znear - zfar);
+    m(3, 2) = -1.f;
+    m(3, 3) = 0.f;
+    return m;
+}
+
+struct State {
+    uint32_t width, height;
+    math::Matrix4f inverse_vp;
+    math::CameraRays camera;
+    std::vector<math::Vector2f> jitter;
+    std::vector<float> ox, oy, oz, dx, dy, dz, tile;
+    math::RayArrays out, t;
+};
+
+void per_pixel(State &s) {
+    for (uint32_t y = 0; y < s.height; y++) {
+        for (uint32_t x = 0; x < s.width; x++) {
+            const size_t i = size_t(y) * s.width + x;
+            const math::Vector2f &j = s.jitter[i % s.jitter.size()];
+            const float ndc_x = 2.f * (float(x) + j.x) / float(s.width) - 1.f;
+            const float ndc_y = 1.f - 2.f * (float(y) + j.y) / float(s.height);
+            const math::Vector4f near = s.inverse_vp * math::Vector4f(ndc_x, ndc_y, -1.f, 1.f);
+            const math::Vector4f far = s.inverse_vp * math::Vector4f(ndc_x, ndc_y, 1.f, 1.f);
+            const math::Vector3f origin(near.x / near.w, near.y / near.w, near.z / near.w);
+            const math::Vector3f dir =
+                math::normalized(math::Vector3f(far.x / far.w, far.y / far.w, far.z / far.w) - origin);
+            s.ox[i] = origin.x;
+            s.oy[i] = origin.y;
+            s.oz[i] = origin.z;
+            s.dx[i] = dir.x;
+            s.dy[i] = dir.y;
+            s.dz[i] = dir.z;
+        }
+    }
+}
+
+void register_size(bench::Suite &suite, size_t n, unsigned threads, uint32_t seed) {
+    auto s = std::make_shared<State>();
+    s->width = 1920;
+    s->height = uint32_t(std::max<size_t>(1, n / s->width));
+    n = size_t(s->width) * s->height;
+    const math::Matrix4f vp =
+        perspective(1.f, float(s->width) / float(s->height), 0.1f, 100.f) *
+        math::inverse(math::create_lookat(math::Vector3f(0.f, -30.f, 5.f), math::Vector3f(0.f, 0.f, 0.f)));
+    s->inverse_vp = math::inverse(vp);
+    s->camera = math::camera_rays(vp, s->width, s->height);
+    // subpixel offsets, as a sampler would supply them
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> d(0.f, 1.f);
+    s->jitter.resize(1024);
+    for (auto &j : s->jitter)
+        j = math::Vector2f(d(gen), d(gen));
+    for (auto *v : {&s->ox, &s->oy, &s->oz, &s->dx, &s->dy, &s->dz})
+        v->resize(n);
+    s->out.ox = s->ox.data();
+    s->out.oy = s->oy.data();
+    s->out.oz = s->oz.data();
+    s->out.dx = s->dx.data();
+    s->out.dy = s->dy.data();
+    s->out.dz = s->dz.data();
+    // tiles generated in a small buffer, as a tiled renderer would consume them
+    s->tile.resize(6 * 32 * 32);
+    s->t.ox = s->tile.data();
+    s->t.oy = s->t.ox + 1024;
+    s->t.oz = s->t.oy + 1024;
+    s->t.dx = s->t.oz + 1024;
+    s->t.dy = s->t.dx + 1024;
+    s->t.dz = s->t.dy + 1024;
+
+    per_pixel(*s);
+    const size_t check = n / 2 + 7;
+    const float check_dx = s->dx[check], check_dy = s->dy[check], check_dz = s->dz[check];
+    math::generate_rays(s->camera, 0, 0, s->width, s->height, s->jitter.data(), s->jitter.size(), s->out, threads);
+    printf("%zu rays (%ux%u)\n", n, s->width, s->height);
+    if (std::abs(s->dx[check] - check_dx) > 1e-4f || std::abs(s->dy[check] - check_dy) > 1e-4f ||
+        std::abs(s->dz[check] - check_dz) > 1e-4f)
+        printf("  mismatch with the per pixel route\n");
+
+    const std::string sfx = "/" + bench::size_label(n);
+    suite.add("per_pixel_inverse" + sfx, n, [s] {
+        per_pixel(*s);
+        return double(s->dx.back());
+    });
+    suite.add("batch_tiles32_serial" + sfx, n, [s] {
+        for (uint32_t y0 = 0; y0 < s->height; y0 += 32) {
+            for (uint32_t x0 = 0; x0 < s->width; x0 += 32) {
+                const uint32_t tw = std::min(32u, s->width - x0), th = std::min(32u, s->height - y0);
+                math::generate_rays(s->camera, x0, y0, tw, th, s->jitter.data(), s->jitter.size(), s->t, 1);
+            }
+        }
+        return double(s->tile[0]);
+    });
+    suite.add("batch_image_serial" + sfx, n, [s] {
+        math::generate_rays(s->camera, 0, 0, s->width, s->height, s->jitter.data(), s->jitter.size(), s->out, 1);
+        return double(s->dx.back());
+    });
+    suite.add("batch_image_parallel" + sfx, n, [s, threads] {
+        math::generate_rays(s->camera, 0, 0, s->width, s->height, s->jitter.data(), s->jitter.size(), s->out,
+                            threads);
+        return double(s->dx.back());
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel kernel (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{1000000, 10000000})
+        groups.push_back([=](bench::Suite &suite) { register_size(suite, size, threads, seed); });
+    return bench::run_suite(groups, opt);
+}
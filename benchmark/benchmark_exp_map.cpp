@@ -0,0 +1,150 @@
+// Quaternion exponential map benchmark: 100k and 1M random rotations, converted from rotation vectors to
+// quaternions, back to rotation vectors and raised to a power, with the axis() / angle() / quat_from_axis_angle()
+// route of vmath.h against quat_from_rotation_vector(), rotation_vector() and quat_pow() of vmath_exp_map.h, one at
+// a time and batch (1 thread and all threads, polynomial kernels). The worst error of each route against the double
+// precision functions is printed as a measure of the accuracy. Timings are ns per rotation (bench::Suite, see
+// benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_exp_map                  # 100k and 1M rotations
+//     bazel run -c opt //benchmark:benchmark_exp_map -- 2000000 4     # 2M rotations, 4 threads
+//     bazel run -c opt --copt=-mavx //benchmark:benchmark_exp_map     # 8 rotations per iteration
+//
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_exp_map.h"
+#include "vmath_random.h"
+
+namespace {
+
+// q and -q are the same rotation
+double quat_error(const math::Quatf &a, const math::Quatd &b) {
+    const double sign = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z < 0 ? -1 : 1;
+    const double dw = sign * a.w - b.w, dx = sign * a.x - b.x, dy = sign * a.y - b.y, dz = sign * a.z - b.z;
+    return std::sqrt(dw * dw + dx * dx + dy * dy + dz * dz);
+}
+
+double max_error(const std::vector<math::Quatf> &q, const std::vector<math::Quatd> &expected) {
+    double worst = 0;
+    for (size_t i = 0; i < q.size(); i++)
+        worst = std::max(worst, quat_error(q[i], expected[i]));
+    return worst;
+}
+
+double max_error(const std::vector<math::Vector3f> &r, const std::vector<math::Vector3d> &expected) {
+    double worst = 0;
+    for (size_t i = 0; i < r.size(); i++)
+        worst = std::max(worst, math::length(math::Vector3d(r[i]) - expected[i]));
+    return worst;
+}
+
+struct State {
+    float t;
+    std::vector<math::Vector3f> r, rb;
+    std::vector<math::Quatf> q, qb;
+    std::vector<math::Quatd> exp_ref, pow_ref;
+    std::vector<math::Vector3d> log_ref;
+};
+
+void register_size(bench::Suite &suite, size_t n, unsigned threads, uint64_t seed) {
+    auto s = std::make_shared<State>();
+    math::Random rng(seed);
+    s->t = 0.3f;
+    s->r.resize(n);
+    s->rb.resize(n);
+    s->q.resize(n);
+    s->qb.resize(n);
+    s->exp_ref.resize(n);
+    s->pow_ref.resize(n);
+    s->log_ref.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        s->r[i] = math::random_unit_vector<float>(rng) * rng.uniform(0.f, 3.14159265f);
+        s->q[i] = math::random_quat<float>(rng);
+        s->exp_ref[i] = math::quat_from_rotation_vector(math::Vector3d(s->r[i]));
+        s->log_ref[i] = math::rotation_vector(math::Quatd(s->q[i]));
+        s->pow_ref[i] = math::quat_pow(math::Quatd(s->q[i]), double(s->t));
+    }
+    printf("%zu rotations, worst error against the double precision functions:\n", n);
+    const std::string sfx = "/" + bench::size_label(n);
+
+    // each route runs once here for its error, then in the suite; exp and pow write qb, log writes rb
+    const auto add = [&](const char *name, const std::vector<math::Quatd> *quat_ref,
+                         std::function<void(State &)> route) {
+        route(*s);
+        printf("  %-32s %.2g\n", name, quat_ref ? max_error(s->qb, *quat_ref) : max_error(s->rb, s->log_ref));
+        const bool quat = quat_ref != nullptr;
+        suite.add(name + sfx, n, [s, route, quat] {
+            route(*s);
+            return quat ? double(s->qb.back().w) : double(s->rb.back().x);
+        });
+    };
+
+    add("exp_axis_angle", &s->exp_ref, [](State &b) {
+        for (size_t i = 0; i < b.r.size(); i++) {
+            const float a = math::length(b.r[i]);
+            b.qb[i] = a > 0.f ? math::quat_from_axis_angle(b.r[i] / a, a) : math::Quatf();
+        }
+    });
+    add("exp_scalar", &s->exp_ref, [](State &b) {
+        for (size_t i = 0; i < b.r.size(); i++)
+            b.qb[i] = math::quat_from_rotation_vector(b.r[i]);
+    });
+    add("exp_batch", &s->exp_ref,
+        [](State &b) { math::quat_from_rotation_vector(b.r.data(), b.qb.data(), b.r.size(), 1); });
+    add("exp_parallel", &s->exp_ref,
+        [threads](State &b) { math::quat_from_rotation_vector(b.r.data(), b.qb.data(), b.r.size(), threads); });
+
+    add("log_axis_angle", nullptr, [](State &b) {
+        for (size_t i = 0; i < b.q.size(); i++) {
+            const math::Quatf p = b.q[i].w < 0.f ? -b.q[i] : b.q[i];
+            b.rb[i] = math::axis(p) * math::angle(p);
+        }
+    });
+    add("log_scalar", nullptr, [](State &b) {
+        for (size_t i = 0; i < b.q.size(); i++)
+            b.rb[i] = math::rotation_vector(b.q[i]);
+    });
+    add("log_batch", nullptr, [](State &b) { math::rotation_vector(b.q.data(), b.rb.data(), b.q.size(), 1); });
+    add("log_parallel", nullptr,
+        [threads](State &b) { math::rotation_vector(b.q.data(), b.rb.data(), b.q.size(), threads); });
+
+    add("pow_axis_angle", &s->pow_ref, [](State &b) {
+        for (size_t i = 0; i < b.q.size(); i++)
+            b.qb[i] = math::quat_from_axis_angle(math::axis(b.q[i]), b.t * math::angle(b.q[i]));
+    });
+    add("pow_scalar", &s->pow_ref, [](State &b) {
+        for (size_t i = 0; i < b.q.size(); i++)
+            b.qb[i] = math::quat_pow(b.q[i], b.t);
+    });
+    add("pow_batch", &s->pow_ref, [](State &b) { math::quat_pow(b.q.data(), b.t, b.qb.data(), b.q.size(), 1); });
+    add("pow_parallel", &s->pow_ref,
+        [threads](State &b) { math::quat_pow(b.q.data(), b.t, b.qb.data(), b.q.size(), threads); });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint64_t seed = opt.args.size() > 2 ? uint64_t(std::atoll(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel kernels (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{100000, 1000000})
+        groups.push_back([=](bench::Suite &suite) { register_size(suite, size, threads, seed); });
+    return bench::run_suite(groups, opt);
+}
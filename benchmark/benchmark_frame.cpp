@@ -0,0 +1,159 @@
+// Tangent frame benchmark: orthonormal bases of 1M and 10M random unit normals, with the usual cross/normalize
+// construction (helper axis chosen with a branch) against the branchless orthonormal_basis() of vmath_frame.h, one
+// at a time and batch (1 thread and all threads); then the tangents of a grid mesh with as many vertices and the
+// QTangent encoding and decoding of its frames. Timings are ns per frame (bench::Suite, see benchmark_util.h for
+// the options).
+//
+//     bazel run -c opt //benchmark:benchmark_frame                  # 1M and 10M normals
+//     bazel run -c opt //benchmark:benchmark_frame -- 2000000 4     # 2M normals, 4 threads
+//
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_frame.h"
+
+namespace {
+
+struct Bases {
+    std::vector<math::Vector3f> normals, b1, b2;
+};
+
+struct Mesh {
+    std::vector<math::Vector3f> positions, normals, bitangents, decoded_normals;
+    std::vector<math::Vector2f> uvs;
+    std::vector<uint32_t> indices;
+    std::vector<math::Vector4f> tangents, decoded;
+    std::vector<math::Quatf> q;
+};
+
+void register_size(bench::Suite &suite, size_t n, unsigned threads, uint32_t seed) {
+    auto b = std::make_shared<Bases>();
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> d;
+    b->normals.resize(n);
+    b->b1.resize(n);
+    b->b2.resize(n);
+    for (auto &v : b->normals)
+        v = math::normalized(math::Vector3f(d(gen), d(gen), d(gen)));
+    printf("%zu normals\n", n);
+    const std::string sfx = "/" + bench::size_label(n);
+
+    for (size_t i = 0; i < n; i++)
+        math::orthonormal_basis(b->normals[i], b->b1[i], b->b2[i]);
+    const math::Vector3f check = b->b1[n / 2];
+    math::orthonormal_basis(b->normals.data(), b->b1.data(), b->b2.data(), n, threads);
+    if (math::length(b->b1[n / 2] - check) > 1e-5f)
+        printf("  mismatch with the scalar version\n");
+
+    suite.add("cross_normalize" + sfx, n, [b] {
+        for (size_t i = 0; i < b->normals.size(); i++) {
+            const math::Vector3f &v = b->normals[i];
+            const math::Vector3f up =
+                std::abs(v.z) < 0.999f ? math::Vector3f(0.f, 0.f, 1.f) : math::Vector3f(1.f, 0.f, 0.f);
+            b->b1[i] = math::normalized(up.cross(v));
+            b->b2[i] = v.cross(b->b1[i]);
+        }
+        return double(b->b2.back().x);
+    });
+    suite.add("orthonormal_basis_scalar" + sfx, n, [b] {
+        for (size_t i = 0; i < b->normals.size(); i++)
+            math::orthonormal_basis(b->normals[i], b->b1[i], b->b2[i]);
+        return double(b->b2.back().x);
+    });
+    suite.add("orthonormal_basis_batch" + sfx, n, [b] {
+        math::orthonormal_basis(b->normals.data(), b->b1.data(), b->b2.data(), b->normals.size(), 1);
+        return double(b->b2.back().x);
+    });
+    suite.add("orthonormal_basis_parallel" + sfx, n, [b, threads] {
+        math::orthonormal_basis(b->normals.data(), b->b1.data(), b->b2.data(), b->normals.size(), threads);
+        return double(b->b2.back().x);
+    });
+
+    // grid mesh of about n vertices on a wave, texture coordinates following the grid
+    auto m = std::make_shared<Mesh>();
+    const size_t side = size_t(std::sqrt(double(n)));
+    const size_t vertex_count = side * side;
+    m->positions.resize(vertex_count);
+    m->normals.resize(vertex_count);
+    m->uvs.resize(vertex_count);
+    for (size_t j = 0; j < side; j++) {
+        for (size_t i = 0; i < side; i++) {
+            const float x = float(i) * 0.01f, y = float(j) * 0.01f;
+            m->positions[j * side + i] = math::Vector3f(x, y, std::sin(x * 3.f) * 0.2f);
+            m->normals[j * side + i] = math::normalized(math::Vector3f(-0.6f * std::cos(x * 3.f), 0.f, 1.f));
+            m->uvs[j * side + i] = math::Vector2f(x, y);
+        }
+    }
+    m->indices.reserve((side - 1) * (side - 1) * 6);
+    for (uint32_t j = 0; j + 1 < side; j++) {
+        for (uint32_t i = 0; i + 1 < side; i++) {
+            const uint32_t v = j * uint32_t(side) + i, s = uint32_t(side);
+            for (uint32_t k : {v, v + 1, v + s + 1, v, v + s + 1, v + s})
+                m->indices.push_back(k);
+        }
+    }
+    m->bitangents.resize(vertex_count);
+    m->tangents.resize(vertex_count);
+    m->q.resize(vertex_count);
+    m->decoded_normals.resize(vertex_count);
+    m->decoded.resize(vertex_count);
+
+    math::compute_tangents(m->positions.data(), m->normals.data(), m->uvs.data(), vertex_count, m->indices.data(),
+                           m->indices.size() / 3, m->tangents.data(), m->bitangents.data(), threads);
+    math::qtangent_encode(m->normals.data(), m->tangents.data(), m->q.data(), vertex_count, threads);
+    math::qtangent_decode(m->q.data(), m->decoded_normals.data(), m->decoded.data(), vertex_count, threads);
+    float max_error = 0.f;
+    for (size_t i = 0; i < vertex_count; i++)
+        max_error = std::max(max_error, math::length(m->decoded_normals[i] - m->normals[i]));
+    printf("%zu vertices mesh, QTangent round trip: max normal error %.2g\n", vertex_count, double(max_error));
+
+    const std::string msfx = "/" + bench::size_label(vertex_count);
+    suite.add("compute_tangents" + msfx, vertex_count, [m] {
+        math::compute_tangents(m->positions.data(), m->normals.data(), m->uvs.data(), m->positions.size(),
+                               m->indices.data(), m->indices.size() / 3, m->tangents.data(), m->bitangents.data(),
+                               1);
+        return double(m->tangents.back().x);
+    });
+    suite.add("compute_tangents_parallel" + msfx, vertex_count, [m, threads] {
+        math::compute_tangents(m->positions.data(), m->normals.data(), m->uvs.data(), m->positions.size(),
+                               m->indices.data(), m->indices.size() / 3, m->tangents.data(), m->bitangents.data(),
+                               threads);
+        return double(m->tangents.back().x);
+    });
+    suite.add("qtangent_encode" + msfx, vertex_count, [m] {
+        math::qtangent_encode(m->normals.data(), m->tangents.data(), m->q.data(), m->q.size(), 1);
+        return double(m->q.back().w);
+    });
+    suite.add("qtangent_decode" + msfx, vertex_count, [m] {
+        math::qtangent_decode(m->q.data(), m->decoded_normals.data(), m->decoded.data(), m->q.size(), 1);
+        return double(m->decoded.back().x);
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel kernels (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{1000000, 10000000})
+        groups.push_back([=](bench::Suite &suite) { register_size(suite, size, threads, seed); });
+    return bench::run_suite(groups, opt);
+}
@@ -0,0 +1,141 @@
+// Fixed size generic matrix benchmark: 6x6 matrix-vector and matrix-matrix products (the sizes of spatial
+// velocities and inertias) over 10k and 100k matrices, with vmath_generic.h Matrix<6, 6, T> against a dynamically
+// sized matrix (heap storage, run time dimensions, naive loops) like the ones of a general linear algebra library,
+// and Matrix<4, 4, T> against the hand-written Matrix4. Timings are ns per product (bench::Suite, see
+// benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_generic               # 10k and 100k matrices
+//     bazel run -c opt //benchmark:benchmark_generic -- 50000      # 50k matrices
+//
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_generic.h"
+
+namespace {
+
+// column-major matrix with run time dimensions
+template <typename T> struct DynamicMatrix {
+    int rows = 0, cols = 0;
+    std::vector<T> data;
+    DynamicMatrix(int r, int c) : rows(r), cols(c), data(size_t(r * c), T(0)) {}
+};
+
+template <typename T> DynamicMatrix<T> dynamic_mul(const DynamicMatrix<T> &a, const DynamicMatrix<T> &b) {
+    DynamicMatrix<T> ret(a.rows, b.cols);
+    for (int j = 0; j < b.cols; j++)
+        for (int k = 0; k < a.cols; k++)
+            for (int i = 0; i < a.rows; i++)
+                ret.data[size_t(j * a.rows + i)] += a.data[size_t(k * a.rows + i)] * b.data[size_t(j * b.rows + k)];
+    return ret;
+}
+
+template <typename T> struct State {
+    std::vector<math::Matrix<6, 6, T>> m, out_m;
+    std::vector<math::Vector<6, T>> v, out_v;
+    std::vector<DynamicMatrix<T>> dm, dv;
+    std::vector<math::Matrix4<T>> m4, out4;
+    std::vector<math::Matrix<4, 4, T>> g4, gout4;
+};
+
+template <typename T> void register_type(bench::Suite &suite, const char *type, size_t n, uint32_t seed) {
+    auto s = std::make_shared<State<T>>();
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<T> dist(T(-1), T(1));
+    s->m.resize(n);
+    s->out_m.resize(n);
+    s->v.resize(n);
+    s->out_v.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        s->dm.emplace_back(6, 6);
+        s->dv.emplace_back(6, 1);
+        for (int k = 0; k < 36; k++)
+            s->dm[i].data[size_t(k)] = s->m[i].data[k] = dist(gen);
+        for (int k = 0; k < 6; k++)
+            s->dv[i].data[size_t(k)] = s->v[i].data[k] = dist(gen);
+    }
+    // 4x4: the generic type against the hand-written one
+    s->m4.resize(n);
+    s->out4.resize(n);
+    s->g4.resize(n);
+    s->gout4.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        for (int k = 0; k < 16; k++)
+            s->m4[i].data[k] = dist(gen);
+        s->g4[i] = s->m4[i];
+    }
+    const std::string sfx = std::string("/") + type + "/" + bench::size_label(n);
+
+    suite.add("mat6_vec6_dynamic" + sfx, n, [s] {
+        T sink = 0;
+        for (size_t i = 0; i < s->dm.size(); i++)
+            sink += dynamic_mul(s->dm[i], s->dv[i]).data[0];
+        return double(sink);
+    });
+    suite.add("mat6_vec6_generic" + sfx, n, [s] {
+        for (size_t i = 0; i < s->m.size(); i++)
+            s->out_v[i] = s->m[i] * s->v[i];
+        return double(s->out_v.back()[0]);
+    });
+    suite.add("mat6_mat6_dynamic" + sfx, n, [s] {
+        const size_t count = s->dm.size();
+        T sink = 0;
+        for (size_t i = 0; i < count; i++)
+            sink += dynamic_mul(s->dm[i], s->dm[count - 1 - i]).data[0];
+        return double(sink);
+    });
+    suite.add("mat6_mat6_generic" + sfx, n, [s] {
+        const size_t count = s->m.size();
+        for (size_t i = 0; i < count; i++)
+            s->out_m[i] = s->m[i] * s->m[count - 1 - i];
+        return double(s->out_m.back().data[0]);
+    });
+    // congruence transpose(a) * i * a
+    suite.add("mat6_congruence_generic" + sfx, n, [s] {
+        const size_t count = s->m.size();
+        for (size_t i = 0; i < count; i++)
+            s->out_m[i] = math::transposed(s->m[i]) * s->m[count - 1 - i] * s->m[i];
+        return double(s->out_m.back().data[0]);
+    });
+    suite.add("mat4_mat4_matrix4" + sfx, n, [s] {
+        const size_t count = s->m4.size();
+        for (size_t i = 0; i < count; i++)
+            s->out4[i] = s->m4[i] * s->m4[count - 1 - i];
+        return double(s->out4.back().data[0]);
+    });
+    suite.add("mat4_mat4_generic" + sfx, n, [s] {
+        const size_t count = s->g4.size();
+        for (size_t i = 0; i < count; i++)
+            s->gout4[i] = s->g4[i] * s->g4[count - 1 - i];
+        return double(s->gout4.back().data[0]);
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [SEED]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const uint32_t seed = opt.args.size() > 1 ? uint32_t(std::atoi(opt.args[1].c_str())) : 12345678;
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{10000, 100000}) {
+        groups.push_back([=](bench::Suite &suite) {
+            register_type<float>(suite, "f", size, seed);
+            register_type<double>(suite, "d", size, seed);
+        });
+    }
+    return bench::run_suite(groups, opt);
+}
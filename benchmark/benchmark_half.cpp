@@ -0,0 +1,121 @@
+// Half precision storage benchmark: bulk conversion throughput of Vector3f <-> Vector3h (IEEE half) and
+// Vector3f <-> Vector3bf (bfloat16) on 1M and 10M vectors, 1 thread and all threads, against the one value at a
+// time conversion and a plain memcpy of the float data. Timings are ns per vector (bench::Suite, see
+// benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_half                    # 1M and 10M vectors
+//     bazel run -c opt //benchmark:benchmark_half -- 2000000 4       # 2M vectors, 4 threads
+//     bazel run -c opt --copt=-march=native //benchmark:benchmark_half   # F16C/AVX-512 kernels
+//
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_half.h"
+
+namespace {
+
+template <typename H> struct Buffers {
+    std::vector<math::Vector3f> v;
+    std::vector<math::Vector3<H>> h;
+    std::vector<math::Vector3f> back;
+};
+
+template <typename H>
+void register_format(bench::Suite &suite, const char *label, const std::vector<math::Vector3f> &v, unsigned threads) {
+    const size_t n = v.size();
+    auto b = std::make_shared<Buffers<H>>();
+    b->v = v;
+    b->h.resize(n);
+    b->back.resize(n);
+    const std::string sfx = "/" + bench::size_label(n);
+    const std::string name = label;
+
+    suite.add(name + "_encode_batch" + sfx, n, [b] {
+        math::convert(b->v.data(), b->h.data(), b->v.size(), 1);
+        return double(float(b->h.back().x));
+    });
+    suite.add(name + "_encode_parallel" + sfx, n, [b, threads] {
+        math::convert(b->v.data(), b->h.data(), b->v.size(), threads);
+        return double(float(b->h.back().x));
+    });
+    suite.add(name + "_encode_scalar" + sfx, n, [b] {
+        for (size_t i = 0; i < b->v.size(); i++)
+            b->h[i] = math::Vector3<H>(b->v[i]);
+        return double(float(b->h.back().x));
+    });
+    suite.add(name + "_decode_batch" + sfx, n, [b] {
+        math::convert(b->h.data(), b->back.data(), b->h.size(), 1);
+        return double(b->back.back().x);
+    });
+    suite.add(name + "_decode_parallel" + sfx, n, [b, threads] {
+        math::convert(b->h.data(), b->back.data(), b->h.size(), threads);
+        return double(b->back.back().x);
+    });
+    suite.add(name + "_decode_scalar" + sfx, n, [b] {
+        for (size_t i = 0; i < b->h.size(); i++)
+            b->back[i] = math::Vector3f(b->h[i]);
+        return double(b->back.back().x);
+    });
+
+    math::convert(v.data(), b->h.data(), n, threads);
+    math::convert(b->h.data(), b->back.data(), n, threads);
+    double max_err = 0;
+    for (size_t i = 0; i < n; i++)
+        max_err = std::max(max_err, double(math::length(b->back[i] - v[i])));
+    printf("%zu %s normals: round trip max error %.2e, %.1f MB instead of %.1f MB\n", n, label, max_err,
+           double(n * sizeof(math::Vector3<H>)) * 1e-6, double(n * sizeof(math::Vector3f)) * 1e-6);
+}
+
+void register_size(bench::Suite &suite, size_t n, unsigned threads, uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> d(-1.f, 1.f);
+    std::vector<math::Vector3f> v(n);
+    for (auto &e : v)
+        e = math::normalized(math::Vector3f(d(gen), d(gen), d(gen)) + math::Vector3f(0.f, 0.f, 1e-3f));
+
+    auto copy = std::make_shared<std::pair<std::vector<math::Vector3f>, std::vector<math::Vector3f>>>(
+        v, std::vector<math::Vector3f>(n));
+    suite.add("memcpy_vec3f/" + bench::size_label(n), n, [copy] {
+        std::memcpy(copy->second.data(), copy->first.data(), copy->first.size() * sizeof(math::Vector3f));
+        return double(copy->second.back().x);
+    });
+    register_format<math::Half>(suite, "half", v, threads);
+    register_format<math::BFloat16>(suite, "bfloat16", v, threads);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+#if defined(VMATH_AVX512F)
+    printf("conversion kernels: AVX-512F\n");
+#elif defined(VMATH_F16C)
+    printf("conversion kernels: F16C\n");
+#elif defined(VMATH_SSE2)
+    printf("conversion kernels: SSE2\n");
+#else
+    printf("conversion kernels: scalar\n");
+#endif
+    printf("%u threads for the parallel conversions (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{1000000, 10000000})
+        groups.push_back([=](bench::Suite &suite) { register_size(suite, size, threads, seed); });
+    return bench::run_suite(groups, opt);
+}
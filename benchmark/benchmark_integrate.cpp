@@ -0,0 +1,217 @@
+// Rigid body integration benchmark: one semi-implicit Euler step (v += a dt, w += alpha dt, p += v dt, then the
+// orientation) of 100k and 1M bodies with random angular velocities, written with the quaternion operators of
+// vmath.h (q + dt / 2 * (0, w) * q and quat_from_axis_angle(w / |w|, |w| dt) * q, then normalized) against the batch
+// integrators of vmath_integrate.h over arrays of Transform (1 thread and all threads) and over structure of
+// arrays. The worst deviation 1 - |dot(q, exact)| of the orientations after one step, against the exact rotation
+// about the constant angular velocity, is printed as a measure of the accuracy. Timings are ns per body
+// (bench::Suite, see benchmark_util.h for the options); every repetition advances the bodies by one more step, as a
+// simulation would.
+//
+//     bazel run -c opt //benchmark:benchmark_integrate                  # 100k and 1M bodies
+//     bazel run -c opt //benchmark:benchmark_integrate -- 2000000 4     # 2M bodies, 4 threads
+//     bazel run -c opt --copt=-mavx //benchmark:benchmark_integrate     # 8 bodies per iteration
+//
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_integrate.h"
+#include "vmath_random.h"
+
+namespace {
+
+struct Bodies {
+    std::vector<math::Transff> x;
+    std::vector<math::Vector3f> v, w, a, alpha;
+};
+
+// worst 1 - |dot(q, exact)| after one step from the initial state s0
+double max_error(const Bodies &s0, const std::vector<math::Quatf> &q, float dt) {
+    double worst = 0;
+    for (size_t i = 0; i < q.size(); i++) {
+        const math::Vector3d w = math::Vector3d(s0.w[i]) + math::Vector3d(s0.alpha[i]) * double(dt);
+        const math::Quatd exact =
+            math::quat_from_axis_angle(math::normalized(w), math::length(w) * double(dt)) * math::Quatd(s0.x[i].q);
+        const double d = exact.w * q[i].w + exact.x * q[i].x + exact.y * q[i].y + exact.z * q[i].z;
+        worst = std::max(worst, 1.0 - std::abs(d));
+    }
+    return worst;
+}
+
+double max_error(const Bodies &s0, const Bodies &s, float dt) {
+    std::vector<math::Quatf> q(s.x.size());
+    for (size_t i = 0; i < q.size(); i++)
+        q[i] = s.x[i].q;
+    return max_error(s0, q, dt);
+}
+
+void step_operators(Bodies &s, float dt) {
+    for (size_t i = 0; i < s.x.size(); i++) {
+        s.v[i] += s.a[i] * dt;
+        s.w[i] += s.alpha[i] * dt;
+        s.x[i].p += s.v[i] * dt;
+        const math::Quatf &q = s.x[i].q;
+        s.x[i].q = math::normalized(q + math::Quatf(0, s.w[i].x, s.w[i].y, s.w[i].z) * q * (0.5f * dt));
+    }
+}
+
+void step_axis_angle(Bodies &s, float dt) {
+    for (size_t i = 0; i < s.x.size(); i++) {
+        s.v[i] += s.a[i] * dt;
+        s.w[i] += s.alpha[i] * dt;
+        s.x[i].p += s.v[i] * dt;
+        const float speed = math::length(s.w[i]);
+        if (speed > 0.f)
+            s.x[i].q = math::normalized(math::quat_from_axis_angle(s.w[i] / speed, speed * dt) * s.x[i].q);
+    }
+}
+
+struct State {
+    Bodies s;
+    std::vector<float> soa;
+    math::RigidBodyArrays<float> arrays;
+};
+
+void register_size(bench::Suite &suite, size_t n, unsigned threads, uint64_t seed) {
+    math::Random rng(seed);
+    const float dt = 1.f / 60.f;
+    Bodies s0;
+    s0.x.resize(n);
+    s0.v.resize(n);
+    s0.w.resize(n);
+    s0.a.assign(n, math::Vector3f(0, -9.81f, 0));
+    s0.alpha.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        s0.x[i] = math::random_transform<float>(rng, 100.f);
+        s0.v[i] = math::random_unit_vector<float>(rng) * rng.uniform(0.f, 10.f);
+        s0.w[i] = math::random_unit_vector<float>(rng) * rng.uniform(0.f, 20.f);
+        s0.alpha[i] = math::random_unit_vector<float>(rng) * rng.uniform(0.f, 1.f);
+    }
+
+    // structure of arrays: columns p (3), q (4), v (3), w (3), then a (3) and alpha (3)
+    std::vector<float> soa0(19 * n);
+    for (size_t i = 0; i < n; i++) {
+        const math::Transff &t = s0.x[i];
+        const float values[19] = {t.p.x,         t.p.y,         t.p.z,        t.q.w,     t.q.x,
+                                  t.q.y,         t.q.z,         s0.v[i].x,    s0.v[i].y, s0.v[i].z,
+                                  s0.w[i].x,     s0.w[i].y,     s0.w[i].z,    s0.a[i].x, s0.a[i].y,
+                                  s0.a[i].z,     s0.alpha[i].x, s0.alpha[i].y, s0.alpha[i].z};
+        for (int c = 0; c < 19; c++)
+            soa0[size_t(c) * n + i] = values[c];
+    }
+    auto st = std::make_shared<State>();
+    st->s = s0;
+    st->soa = soa0;
+    float *column[19];
+    for (int c = 0; c < 19; c++)
+        column[c] = st->soa.data() + size_t(c) * n;
+    math::RigidBodyArrays<float> &arrays = st->arrays;
+    arrays.px = column[0], arrays.py = column[1], arrays.pz = column[2];
+    arrays.qw = column[3], arrays.qx = column[4], arrays.qy = column[5], arrays.qz = column[6];
+    arrays.vx = column[7], arrays.vy = column[8], arrays.vz = column[9];
+    arrays.wx = column[10], arrays.wy = column[11], arrays.wz = column[12];
+    arrays.ax = column[13], arrays.ay = column[14], arrays.az = column[15];
+    arrays.alphax = column[16], arrays.alphay = column[17], arrays.alphaz = column[18];
+
+    // accuracy of one step from the initial state, the 1 thread and parallel kernels give the same results
+    Bodies &s = st->s;
+    printf("%zu bodies, orientation error:", n);
+    step_operators(s, dt);
+    printf(" euler operators %.2g,", max_error(s0, s, dt));
+    s = s0;
+    math::integrate_euler(s.x.data(), s.v.data(), s.w.data(), s.a.data(), s.alpha.data(), dt, n, threads);
+    printf(" euler batch %.2g,", max_error(s0, s, dt));
+    s = s0;
+    step_axis_angle(s, dt);
+    printf(" quat_from_axis_angle %.2g,", max_error(s0, s, dt));
+    s = s0;
+    math::integrate_exp(s.x.data(), s.v.data(), s.w.data(), s.a.data(), s.alpha.data(), dt, n, threads);
+    printf(" exp batch %.2g,", max_error(s0, s, dt));
+    s = s0;
+    const auto soa_error = [&] {
+        std::vector<math::Quatf> q(n);
+        for (size_t i = 0; i < n; i++)
+            q[i] = math::Quatf(arrays.qw[i], arrays.qx[i], arrays.qy[i], arrays.qz[i]);
+        return max_error(s0, q, dt);
+    };
+    math::integrate_euler(arrays, dt, n, threads);
+    printf(" euler soa %.2g,", soa_error());
+    std::copy(soa0.begin(), soa0.end(), st->soa.begin());
+    math::integrate_exp(arrays, dt, n, threads);
+    printf(" exp soa %.2g\n", soa_error());
+    std::copy(soa0.begin(), soa0.end(), st->soa.begin());
+
+    const std::string sfx = "/" + bench::size_label(n);
+    suite.add("euler_operators" + sfx, n, [st, dt] {
+        step_operators(st->s, dt);
+        return double(st->s.x.back().q.w);
+    });
+    suite.add("euler_batch" + sfx, n, [st, dt] {
+        Bodies &b = st->s;
+        math::integrate_euler(b.x.data(), b.v.data(), b.w.data(), b.a.data(), b.alpha.data(), dt, b.x.size(), 1);
+        return double(b.x.back().q.w);
+    });
+    suite.add("euler_parallel" + sfx, n, [st, dt, threads] {
+        Bodies &b = st->s;
+        math::integrate_euler(b.x.data(), b.v.data(), b.w.data(), b.a.data(), b.alpha.data(), dt, b.x.size(),
+                              threads);
+        return double(b.x.back().q.w);
+    });
+    suite.add("exp_axis_angle" + sfx, n, [st, dt] {
+        step_axis_angle(st->s, dt);
+        return double(st->s.x.back().q.w);
+    });
+    suite.add("exp_batch" + sfx, n, [st, dt] {
+        Bodies &b = st->s;
+        math::integrate_exp(b.x.data(), b.v.data(), b.w.data(), b.a.data(), b.alpha.data(), dt, b.x.size(), 1);
+        return double(b.x.back().q.w);
+    });
+    suite.add("exp_parallel" + sfx, n, [st, dt, threads] {
+        Bodies &b = st->s;
+        math::integrate_exp(b.x.data(), b.v.data(), b.w.data(), b.a.data(), b.alpha.data(), dt, b.x.size(),
+                            threads);
+        return double(b.x.back().q.w);
+    });
+    suite.add("euler_soa" + sfx, n, [st, dt, n] {
+        math::integrate_euler(st->arrays, dt, n, 1);
+        return double(st->arrays.qw[n - 1]);
+    });
+    suite.add("euler_soa_parallel" + sfx, n, [st, dt, n, threads] {
+        math::integrate_euler(st->arrays, dt, n, threads);
+        return double(st->arrays.qw[n - 1]);
+    });
+    suite.add("exp_soa" + sfx, n, [st, dt, n] {
+        math::integrate_exp(st->arrays, dt, n, 1);
+        return double(st->arrays.qw[n - 1]);
+    });
+    suite.add("exp_soa_parallel" + sfx, n, [st, dt, n, threads] {
+        math::integrate_exp(st->arrays, dt, n, threads);
+        return double(st->arrays.qw[n - 1]);
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint64_t seed = opt.args.size() > 2 ? uint64_t(std::atoll(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel integrators (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{100000, 1000000})
+        groups.push_back([=](bench::Suite &suite) { register_size(suite, size, threads, seed); });
+    return bench::run_suite(groups, opt);
+}
@@ -0,0 +1,130 @@
+// k-d tree benchmark: build (1 thread and all threads), exact and approximate kNN, radius queries over a uniform
+// point cloud, with the spatial hash grid on the same queries as a reference. Timings are ns per point (build) or
+// per query (bench::Suite, see benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_kdtree                  # 1M and 10M points
+//     bazel run -c opt //benchmark:benchmark_kdtree -- 2000000 4     # 2M points, 4 threads
+//
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath_kdtree.h"
+#include "vmath_spatial_hash.h"
+
+namespace {
+
+template <typename T> double mean_kth_distance(const std::vector<T> &d2, size_t nq, size_t k) {
+    double mean = 0;
+    for (size_t i = 0; i < nq; i++)
+        mean += std::sqrt(double(d2[i * k + k - 1]));
+    return mean / double(nq);
+}
+
+template <typename T> struct State {
+    explicit State(T cell) : grid(cell), grid_build(cell) {}
+    std::vector<math::Vector3<T>> pts, queries;
+    math::KdTree<math::Vector3<T>> tree, tree_build;
+    math::SpatialHashGrid<T> grid, grid_build;
+    std::vector<uint32_t> knn, offsets, found;
+    std::vector<T> d2;
+};
+
+template <typename T> void register_size(bench::Suite &suite, const std::string &sfx, size_t n, unsigned threads,
+                                         uint32_t seed) {
+    const T side = T(100);
+    // radius with about 8 points per query ball
+    const T radius = side * T(std::cbrt(8.0 / double(n) * 3.0 / (4.0 * 3.14159265358979)));
+    auto s = std::make_shared<State<T>>(radius);
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<T> u(T(0), side);
+    s->pts.resize(n);
+    for (auto &p : s->pts)
+        p = math::Vector3<T>(u(gen), u(gen), u(gen));
+    const size_t nq = 100000, k = 8;
+    s->queries.resize(nq);
+    for (auto &q : s->queries)
+        q = math::Vector3<T>(u(gen), u(gen), u(gen));
+    s->knn.resize(nq * k);
+    s->d2.resize(nq * k);
+    s->tree.build(s->pts.data(), n, threads);
+    s->grid.build(s->pts.data(), n, threads);
+
+    // quality of the approximate searches
+    math::KdTreeSearchParams<T> exact, eps, leaves;
+    eps.eps = T(0.5);
+    leaves.max_leaves = 4;
+    printf("%zu points (%s): mean k-th distance", n, sfx.c_str());
+    for (const auto &params : {exact, eps, leaves}) {
+        s->tree.knn_search(s->queries.data(), nq, k, s->knn.data(), s->d2.data(), params, threads);
+        printf(" %.4f", mean_kth_distance(s->d2, nq, k));
+    }
+    s->tree.radius_search(s->queries.data(), nq, radius, s->offsets, s->found, threads);
+    printf(" (exact, eps=0.5, max_leaves=4), %.1f neighbors per radius query\n",
+           double(s->found.size()) / double(nq));
+
+    const std::string name = "/" + sfx + "/" + bench::size_label(n);
+    suite.add("kdtree_build_serial" + name, n, [s] {
+        s->tree_build.build(s->pts.data(), s->pts.size(), 1);
+        return double(s->tree_build.size());
+    });
+    suite.add("kdtree_build_parallel" + name, n, [s, threads] {
+        s->tree_build.build(s->pts.data(), s->pts.size(), threads);
+        return double(s->tree_build.size());
+    });
+    auto knn = [s, k, threads](const math::KdTreeSearchParams<T> &params) {
+        return [s, k, threads, params] {
+            s->tree.knn_search(s->queries.data(), s->queries.size(), k, s->knn.data(), s->d2.data(), params,
+                               threads);
+            return double(s->d2.back());
+        };
+    };
+    suite.add("kdtree_knn8" + name, nq, knn(exact));
+    suite.add("kdtree_knn8_eps" + name, nq, knn(eps));
+    suite.add("kdtree_knn8_leaves4" + name, nq, knn(leaves));
+    suite.add("kdtree_radius" + name, nq, [s, radius, threads] {
+        s->tree.radius_search(s->queries.data(), s->queries.size(), radius, s->offsets, s->found, threads);
+        return double(s->found.size());
+    });
+
+    // spatial hash grid on the same data, for reference
+    suite.add("grid_build" + name, n, [s, threads] {
+        s->grid_build.build(s->pts.data(), s->pts.size(), threads);
+        return double(s->grid_build.overflow_size());
+    });
+    suite.add("grid_knn8" + name, nq, [s, k, threads] {
+        s->grid.knn_search(s->queries.data(), s->queries.size(), k, s->knn.data(), s->d2.data(), threads);
+        return double(s->d2.back());
+    });
+    suite.add("grid_radius" + name, nq, [s, radius, threads] {
+        s->grid.radius_search(s->queries.data(), s->queries.size(), radius, s->offsets, s->found, threads);
+        return double(s->found.size());
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel passes (0 = all), 100k queries\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{1000000, 10000000}) {
+        groups.push_back([=](bench::Suite &suite) { register_size<float>(suite, "f", size, threads, seed); });
+        groups.push_back([=](bench::Suite &suite) { register_size<double>(suite, "d", size, threads, seed); });
+    }
+    return bench::run_suite(groups, opt);
+}
@@ -0,0 +1,131 @@
+// Compressed quaternion and normal benchmark: decode throughput of the smallest three (32/48 bit) quaternion and
+// octahedral (16/24/32 bit) normal encodings on 1M and 10M values, batch (1 thread and all threads) against one
+// value at a time, with a memcpy of the float data as a reference. Encoding time and the max error of each format
+// are reported as well. Timings are ns per value (bench::Suite, see benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_packing                  # 1M and 10M values
+//     bazel run -c opt //benchmark:benchmark_packing -- 2000000 4     # 2M values, 4 threads
+//
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_packing.h"
+
+namespace {
+
+double angle_deg(const math::Quatf &a, const math::Quatf &b) {
+    const math::Quatd d = ~math::Quatd(a) * math::normalized(math::Quatd(b));
+    return 2.0 * std::atan2(std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z), std::abs(d.w)) * 180.0 / M_PI;
+}
+
+double angle_deg(const math::Vector3f &a, const math::Vector3f &b) {
+    const math::Vector3d x(a), y(b);
+    return std::atan2(math::length(x.cross(y)), x.dot(y)) * 180.0 / M_PI;
+}
+
+template <typename P, typename V> struct Buffers {
+    std::vector<V> values, out;
+    std::vector<P> packed;
+};
+
+template <typename P> double first_byte(const std::vector<P> &p) {
+    return double(*reinterpret_cast<const unsigned char *>(p.data()));
+}
+
+// encode, then decode in batch (1 thread, all threads) and one value at a time
+template <typename P, typename V, typename Scalar>
+void register_format(bench::Suite &suite, const char *label, const std::vector<V> &values, unsigned threads,
+                     Scalar decode_one) {
+    const size_t n = values.size();
+    auto b = std::make_shared<Buffers<P, V>>();
+    b->values = values;
+    b->packed.resize(n);
+    b->out.resize(n);
+    math::pack(values.data(), b->packed.data(), n, threads);
+    math::unpack(b->packed.data(), b->out.data(), n, threads);
+    double max_err = 0;
+    for (size_t i = 0; i < n; i++)
+        max_err = std::max(max_err, angle_deg(values[i], b->out[i]));
+    printf("%zu %s: %zu bytes instead of %zu, max error %.4f deg\n", n, label, sizeof(P), sizeof(V), max_err);
+
+    const std::string name = label, sfx = "/" + bench::size_label(n);
+    suite.add(name + "_encode_parallel" + sfx, n, [b, threads] {
+        math::pack(b->values.data(), b->packed.data(), b->values.size(), threads);
+        return first_byte(b->packed);
+    });
+    suite.add(name + "_decode_batch" + sfx, n, [b] {
+        math::unpack(b->packed.data(), b->out.data(), b->packed.size(), 1);
+        return double(b->out.back().x);
+    });
+    suite.add(name + "_decode_parallel" + sfx, n, [b, threads] {
+        math::unpack(b->packed.data(), b->out.data(), b->packed.size(), threads);
+        return double(b->out.back().x);
+    });
+    suite.add(name + "_decode_scalar" + sfx, n, [b, decode_one] {
+        for (size_t i = 0; i < b->packed.size(); i++)
+            b->out[i] = decode_one(b->packed[i]);
+        return double(b->out.back().x);
+    });
+}
+
+template <typename V> void register_memcpy(bench::Suite &suite, const std::string &name, const std::vector<V> &v) {
+    auto copy = std::make_shared<std::pair<std::vector<V>, std::vector<V>>>(v, std::vector<V>(v.size()));
+    suite.add(name + "/" + bench::size_label(v.size()), v.size(), [copy] {
+        std::memcpy(copy->second.data(), copy->first.data(), copy->first.size() * sizeof(V));
+        return double(copy->second.back().x);
+    });
+}
+
+void register_size(bench::Suite &suite, size_t n, unsigned threads, uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> d;
+    std::vector<math::Quatf> q(n);
+    std::vector<math::Vector3f> v(n);
+    for (size_t i = 0; i < n; i++) {
+        q[i] = math::normalized(math::Quatf(d(gen), d(gen), d(gen), d(gen)));
+        v[i] = math::normalized(math::Vector3f(d(gen), d(gen), d(gen)));
+    }
+
+    register_memcpy(suite, "memcpy_quatf", q);
+    register_memcpy(suite, "memcpy_vec3f", v);
+    register_format<math::PackedQuat32>(suite, "quat32", q, threads,
+                                        [](math::PackedQuat32 p) { return math::unpack_quat<float>(p); });
+    register_format<math::PackedQuat48>(suite, "quat48", q, threads,
+                                        [](math::PackedQuat48 p) { return math::unpack_quat<float>(p); });
+    register_format<math::PackedNormal16>(suite, "normal16", v, threads,
+                                          [](math::PackedNormal16 p) { return math::unpack_normal<float>(p); });
+    register_format<math::PackedNormal24>(suite, "normal24", v, threads,
+                                          [](math::PackedNormal24 p) { return math::unpack_normal<float>(p); });
+    register_format<math::PackedNormal32>(suite, "normal32", v, threads,
+                                          [](math::PackedNormal32 p) { return math::unpack_normal<float>(p); });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel passes (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{1000000, 10000000})
+        groups.push_back([=](bench::Suite &suite) { register_size(suite, size, threads, seed); });
+    return bench::run_suite(groups, opt);
+}
@@ -0,0 +1,138 @@
+// Vertex processing benchmark: model-view-projection, clip outcodes, perspective divide and viewport transform of
+// 1M and 10M vertices into screen space SoA arrays, with the fused kernel of vmath_projection.h (1 thread and all
+// threads) against three separate passes (Matrix4 * Vector4 into a temporary array, outcodes and divide into a
+// second one, viewport into the output arrays). Timings are ns per vertex (bench::Suite, see benchmark_util.h for
+// the options).
+//
+//     bazel run -c opt //benchmark:benchmark_projection                  # 1M and 10M vertices
+//     bazel run -c opt //benchmark:benchmark_projection -- 2000000 4     # 2M vertices, 4 threads
+//
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_projection.h"
+
+namespace {
+
+math::Matrix4f perspective(float fovy, float aspect, float znear, float zfar) {
+    const float f = 1.f / std::tan(0.5f * fovy);
+    math::Matrix4f m = math::matrix4_identity<float>();
+    m(0, 0) = f / aspect;
+    m(1, 1) = f;
+    m(2, 2) = (zfar + znear) / (znear - zfar);
+    m(2, 3) = 2.f * zfar * znear / (znear - zfar);
+    m(3, 2) = -1.f;
+    m(3, 3) = 0.f;
+    return m;
+}
+
+struct State {
+    std::vector<math::Vector3f> vertices;
+    math::Matrix4f mvp;
+    math::Viewport viewport{0.f, 1080.f, 1920.f, -1080.f};
+    std::vector<float> x, y, depth, inv_w;
+    std::vector<uint8_t> outcode;
+    math::ScreenVertices out;
+    // temporaries of the three passes
+    std::vector<math::Vector4f> clip;
+    std::vector<math::Vector3f> ndc;
+};
+
+void three_passes(State &s) {
+    const size_t n = s.vertices.size();
+    for (size_t i = 0; i < n; i++)
+        s.clip[i] = s.mvp * math::Vector4f(s.vertices[i].x, s.vertices[i].y, s.vertices[i].z, 1.f);
+    for (size_t i = 0; i < n; i++) {
+        const math::Vector4f &c = s.clip[i];
+        s.outcode[i] = uint8_t((c.x < -c.w ? math::clip_left : 0) | (c.x > c.w ? math::clip_right : 0) |
+                               (c.y < -c.w ? math::clip_bottom : 0) | (c.y > c.w ? math::clip_top : 0) |
+                               (c.z < -c.w ? math::clip_near : 0) | (c.z > c.w ? math::clip_far : 0));
+        s.inv_w[i] = 1.f / c.w;
+        s.ndc[i] = math::Vector3f(c.x * s.inv_w[i], c.y * s.inv_w[i], c.z * s.inv_w[i]);
+    }
+    for (size_t i = 0; i < n; i++) {
+        s.x[i] = (s.ndc[i].x * 0.5f + 0.5f) * s.viewport.width + s.viewport.x;
+        s.y[i] = (s.ndc[i].y * 0.5f + 0.5f) * s.viewport.height + s.viewport.y;
+        s.depth[i] = s.ndc[i].z * 0.5f + 0.5f;
+    }
+}
+
+void register_size(bench::Suite &suite, size_t n, unsigned threads, uint32_t seed) {
+    auto s = std::make_shared<State>();
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> d(-40.f, 40.f);
+    s->vertices.resize(n);
+    for (auto &v : s->vertices)
+        v = math::Vector3f(d(gen), d(gen), d(gen));
+    s->mvp = perspective(1.f, 16.f / 9.f, 0.5f, 100.f) *
+             math::inverse(math::create_lookat(math::Vector3f(0.f, -30.f, 5.f), math::Vector3f(0.f, 0.f, 0.f)));
+    s->x.resize(n);
+    s->y.resize(n);
+    s->depth.resize(n);
+    s->inv_w.resize(n);
+    s->outcode.resize(n);
+    s->clip.resize(n);
+    s->ndc.resize(n);
+    s->out.x = s->x.data();
+    s->out.y = s->y.data();
+    s->out.depth = s->depth.data();
+    s->out.inv_w = s->inv_w.data();
+    s->out.outcode = s->outcode.data();
+
+    three_passes(*s);
+    const float check_x = s->x[n / 2], check_y = s->y[n / 2];
+    const uint8_t check_code = s->outcode[n / 2];
+    const math::ClipSummary summary = math::project_vertices(s->mvp, s->vertices.data(), n, s->viewport, s->out, 1);
+    size_t visible = 0;
+    for (uint8_t c : s->outcode)
+        visible += c == 0;
+    printf("%zu vertices: %zu visible (%.1f%%), outcodes or %02x and %02x\n", n, visible,
+           100.0 * double(visible) / double(n), summary.any, summary.all);
+    if (s->outcode[n / 2] != check_code ||
+        (check_code == 0 && (std::abs(s->x[n / 2] - check_x) > 1e-2f || std::abs(s->y[n / 2] - check_y) > 1e-2f)))
+        printf("  mismatch with the three passes\n");
+
+    const std::string sfx = "/" + bench::size_label(n);
+    suite.add("three_passes" + sfx, n, [s] {
+        three_passes(*s);
+        return double(s->x.back());
+    });
+    suite.add("fused_serial" + sfx, n, [s] {
+        const math::ClipSummary c =
+            math::project_vertices(s->mvp, s->vertices.data(), s->vertices.size(), s->viewport, s->out, 1);
+        return double(c.any) + double(s->x.back());
+    });
+    suite.add("fused_parallel" + sfx, n, [s, threads] {
+        const math::ClipSummary c =
+            math::project_vertices(s->mvp, s->vertices.data(), s->vertices.size(), s->viewport, s->out, threads);
+        return double(c.any) + double(s->x.back());
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel kernel (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{1000000, 10000000})
+        groups.push_back([=](bench::Suite &suite) { register_size(suite, size, threads, seed); });
+    return bench::run_suite(groups, opt);
+}
@@ -0,0 +1,111 @@
+// Random generation benchmark: 1M and 10M random rotations, unit vectors and rigid transforms. The quaternions of
+// the Euler angle route (std::mt19937, quat_from_euler_321 and a normalization, not uniformly distributed) are
+// compared with the uniformly distributed random_quat() of vmath_random.h, one at a time and batch (1 thread and
+// all threads); the unit vectors of normalized gaussian vectors with random_unit_vector(). Timings are ns per
+// value (bench::Suite, see benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_random                  # 1M and 10M values
+//     bazel run -c opt //benchmark:benchmark_random -- 2000000 4     # 2M values, 4 threads
+//
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_random.h"
+
+namespace {
+
+struct State {
+    std::vector<math::Quatf> q;
+    std::vector<math::Vector3f> v;
+    std::vector<math::Transff> t;
+};
+
+void register_size(bench::Suite &suite, size_t n, unsigned threads, uint32_t seed) {
+    auto s = std::make_shared<State>();
+    s->q.resize(n);
+    s->v.resize(n);
+    s->t.resize(n);
+    const std::string sfx = "/" + bench::size_label(n);
+
+    // uniformity: E[w^2] is 1/4 for uniformly distributed rotations
+    math::random_quats(seed, s->q.data(), n, threads);
+    double w2 = 0;
+    for (const math::Quatf &r : s->q)
+        w2 += double(r.w) * r.w;
+    printf("%zu values: E[w^2] = %.4f (uniform: 0.25)\n", n, w2 / double(n));
+
+    suite.add("euler_mt19937" + sfx, n, [s, seed] {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> angle(-3.1f, 3.1f);
+        for (auto &r : s->q)
+            r = math::normalized(math::quat_from_euler_321(angle(gen), angle(gen), angle(gen)));
+        return double(s->q.back().w);
+    });
+    suite.add("random_quat_scalar" + sfx, n, [s, seed] {
+        math::Random rng(seed);
+        for (auto &r : s->q)
+            r = math::random_quat<float>(rng);
+        return double(s->q.back().w);
+    });
+    suite.add("random_quats_batch" + sfx, n, [s, seed] {
+        math::random_quats(seed, s->q.data(), s->q.size(), 1);
+        return double(s->q.back().w);
+    });
+    suite.add("random_quats_parallel" + sfx, n, [s, seed, threads] {
+        math::random_quats(seed, s->q.data(), s->q.size(), threads);
+        return double(s->q.back().w);
+    });
+
+    suite.add("gaussian_mt19937" + sfx, n, [s, seed] {
+        std::mt19937 gen(seed);
+        std::normal_distribution<float> d;
+        for (auto &r : s->v)
+            r = math::normalized(math::Vector3f(d(gen), d(gen), d(gen)));
+        return double(s->v.back().x);
+    });
+    suite.add("unit_vectors_batch" + sfx, n, [s, seed] {
+        math::random_unit_vectors(seed, s->v.data(), s->v.size(), 1);
+        return double(s->v.back().x);
+    });
+    suite.add("unit_vectors_parallel" + sfx, n, [s, seed, threads] {
+        math::random_unit_vectors(seed, s->v.data(), s->v.size(), threads);
+        return double(s->v.back().x);
+    });
+
+    suite.add("random_transforms_batch" + sfx, n, [s, seed] {
+        math::random_transforms(seed, s->t.data(), s->t.size(), 10.f, 1);
+        return double(s->t.back().q.w);
+    });
+    suite.add("random_transforms_parallel" + sfx, n, [s, seed, threads] {
+        math::random_transforms(seed, s->t.data(), s->t.size(), 10.f, threads);
+        return double(s->t.back().q.w);
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel kernels (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{1000000, 10000000})
+        groups.push_back([=](bench::Suite &suite) { register_size(suite, size, threads, seed); });
+    return bench::run_suite(groups, opt);
+}
@@ -0,0 +1,133 @@
+// Point-set registration benchmark: kabsch() and umeyama() on 1M (and 10M) noisy correspondences, unweighted and
+// weighted, 1 thread and all threads. For reference it also times the scalar accumulation pass and the classic
+// route (two passes for centroids and covariance matrix, then a 3x3 SVD). Timings are ns per correspondence
+// (bench::Suite, see benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_registration                  # 1M and 10M points
+//     bazel run -c opt //benchmark:benchmark_registration -- 2000000 4     # 2M points, 4 threads
+//
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath_registration.h"
+
+namespace {
+
+// rotation error in degrees
+template <typename T> double angle_error(const math::Quaternion<T> &a, const math::Quaternion<T> &b) {
+    const double d = std::abs(double(a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z));
+    return 2.0 * std::acos(std::min(1.0, d)) * 180.0 / 3.14159265358979;
+}
+
+// classic route: centroids, covariance matrix, SVD, R = V * U^T (u and v are proper rotations, the reflection
+// case is handled by the sign of the smallest singular value)
+template <typename T>
+math::Transform<T> kabsch_svd(const math::Vector3<T> *src, const math::Vector3<T> *dst, size_t count) {
+    math::Vector3<T> ms(T(0), T(0), T(0)), md(T(0), T(0), T(0));
+    for (size_t i = 0; i < count; i++) {
+        ms += src[i];
+        md += dst[i];
+    }
+    ms = ms * (T(1) / T(count));
+    md = md * (T(1) / T(count));
+    math::Matrix3<T> h;
+    for (size_t i = 0; i < count; i++) {
+        const math::Vector3<T> s = src[i] - ms, d = dst[i] - md;
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 3; c++)
+                h(r, c) += s[r] * d[c];
+    }
+    math::Matrix3<T> u, v;
+    math::Vector3<T> sigma;
+    math::svd_decompose(h, u, sigma, v);
+    math::transpose(u);
+    const math::Matrix3<T> r = v * u;
+    const math::Quaternion<T> q = math::quat_from_matrix(r);
+    return math::Transform<T>(md - q.rotate(ms), q);
+}
+
+template <typename T> struct State {
+    std::vector<math::Vector3<T>> src, dst;
+    std::vector<T> weights;
+};
+
+template <typename T> void register_size(bench::Suite &suite, const std::string &sfx, size_t n, unsigned threads,
+                                         uint32_t seed) {
+    auto s = std::make_shared<State<T>>();
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<T> u(T(-50), T(50));
+    std::normal_distribution<T> noise(T(0), T(0.01));
+    const math::Quaternion<T> q = math::normalized(math::Quaternion<T>(T(0.3), T(-0.5), T(0.7), T(0.2)));
+    const math::Transform<T> pose(math::Vector3<T>(T(10), T(-3), T(7)), q);
+    s->src.resize(n);
+    s->dst.resize(n);
+    s->weights.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        s->src[i] = math::Vector3<T>(u(gen), u(gen), u(gen));
+        s->dst[i] = pose.transform(s->src[i]) + math::Vector3<T>(noise(gen), noise(gen), noise(gen));
+        s->weights[i] = T(0.5) + (u(gen) + T(50)) * T(0.01);
+    }
+
+    const std::string name = "/" + sfx + "/" + bench::size_label(n);
+    std::vector<std::pair<std::string, std::function<math::Transform<T>()>>> routes = {
+        {"kabsch_serial", [s] { return math::kabsch(s->src.data(), s->dst.data(), s->src.size(),
+                                                    static_cast<const T *>(nullptr), 1); }},
+        {"kabsch_parallel", [s, threads] { return math::kabsch(s->src.data(), s->dst.data(), s->src.size(),
+                                                               static_cast<const T *>(nullptr), threads); }},
+        {"kabsch_weighted", [s, threads] { return math::kabsch(s->src.data(), s->dst.data(), s->src.size(),
+                                                               s->weights.data(), threads); }},
+        {"umeyama", [s, threads] {
+             T scale = 0;
+             return math::umeyama(s->src.data(), s->dst.data(), s->src.size(), scale,
+                                  static_cast<const T *>(nullptr), threads);
+         }},
+        // reference: the generic (scalar) accumulation pass, and the classic SVD route
+        {"scalar_pass", [s] {
+             math::detail::RegistrationSums sums;
+             math::detail::accumulate_registration<T>(s->src.data(), s->dst.data(), nullptr, 0, s->src.size(),
+                                                      s->src[0], s->dst[0], sums);
+             return math::detail::solve_registration(sums, s->src[0], s->dst[0], static_cast<T *>(nullptr));
+         }},
+        {"covariance_svd", [s] { return kabsch_svd(s->src.data(), s->dst.data(), s->src.size()); }},
+    };
+    printf("%zu correspondences (%s), rotation error in degrees:", n, sfx.c_str());
+    for (const auto &r : routes) {
+        printf(" %s %.2e", r.first.c_str(), angle_error(r.second().q, pose.q));
+        suite.add(r.first + name, n, [r] {
+            const math::Transform<T> t = r.second();
+            return double(t.p.x + t.q.w);
+        });
+    }
+    printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel passes (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{1000000, 10000000}) {
+        groups.push_back([=](bench::Suite &suite) { register_size<float>(suite, "f", size, threads, seed); });
+        groups.push_back([=](bench::Suite &suite) { register_size<double>(suite, "d", size, threads, seed); });
+    }
+    return bench::run_suite(groups, opt);
+}
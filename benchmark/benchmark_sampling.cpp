@@ -0,0 +1,117 @@
+// Sampling benchmark: 1M and 10M 2D samples of the Sobol (plain and Owen scrambled), Halton and R2 sequences of
+// vmath_sampling.h, one at a time with sample_2d() against the batch generate_samples() (1 thread and all
+// threads), with std::mt19937 as the pseudo random baseline, then the batch warps of the samples. Timings are
+// ns per sample (bench::Suite, see benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_sampling                  # 1M and 10M samples
+//     bazel run -c opt //benchmark:benchmark_sampling -- 2000000 4     # 2M samples, 4 threads
+//
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_sampling.h"
+
+namespace {
+
+struct State {
+    std::mt19937 gen;
+    std::vector<math::Vector2f> samples, disk;
+    std::vector<math::Vector3f> directions;
+};
+
+void register_size(bench::Suite &suite, size_t n, unsigned threads, uint32_t seed) {
+    auto s = std::make_shared<State>();
+    s->gen.seed(seed);
+    s->samples.resize(n);
+    printf("%zu samples\n", n);
+    const std::string sfx = "/" + bench::size_label(n);
+
+    suite.add("mt19937" + sfx, n, [s] {
+        std::uniform_real_distribution<float> d(0.f, 1.f);
+        for (auto &e : s->samples)
+            e = math::Vector2f(d(s->gen), d(s->gen));
+        return double(s->samples.back().x);
+    });
+
+    const struct {
+        math::SampleSequence sequence;
+        const char *name;
+    } sequences[] = {{math::SampleSequence::sobol, "sobol"},
+                     {math::SampleSequence::owen_sobol, "owen_sobol"},
+                     {math::SampleSequence::halton, "halton"},
+                     {math::SampleSequence::r2, "r2"}};
+    for (const auto &q : sequences) {
+        const math::SampleSequence sequence = q.sequence;
+        const std::string name = q.name;
+        for (size_t i = 0; i < n; i++)
+            s->samples[i] = math::sample_2d<float>(sequence, uint32_t(i), seed);
+        const math::Vector2f check = s->samples[n / 2];
+        math::generate_samples(sequence, 0, seed, s->samples.data(), n, threads);
+        if (s->samples[n / 2] != check)
+            printf("  %s: mismatch with sample_2d\n", q.name);
+
+        suite.add(name + "_sample_2d" + sfx, n, [s, sequence, seed] {
+            for (size_t i = 0; i < s->samples.size(); i++)
+                s->samples[i] = math::sample_2d<float>(sequence, uint32_t(i), seed);
+            return double(s->samples.back().x);
+        });
+        suite.add(name + "_batch" + sfx, n, [s, sequence, seed] {
+            math::generate_samples(sequence, 0, seed, s->samples.data(), s->samples.size(), 1);
+            return double(s->samples.back().x);
+        });
+        suite.add(name + "_batch_parallel" + sfx, n, [s, sequence, seed, threads] {
+            math::generate_samples(sequence, 0, seed, s->samples.data(), s->samples.size(), threads);
+            return double(s->samples.back().x);
+        });
+    }
+
+    // the warps read their own copy of the samples, the generators above keep writing theirs
+    auto w = std::make_shared<State>();
+    w->samples.resize(n);
+    w->disk.resize(n);
+    w->directions.resize(n);
+    math::generate_samples(math::SampleSequence::owen_sobol, 0, seed, w->samples.data(), n, threads);
+    suite.add("warp_disk" + sfx, n, [w] {
+        math::warp_disk(w->samples.data(), w->disk.data(), w->samples.size(), 1);
+        return double(w->disk.back().x);
+    });
+    suite.add("warp_cosine_hemisphere" + sfx, n, [w] {
+        math::warp_cosine_hemisphere(w->samples.data(), w->directions.data(), w->samples.size(), 1);
+        return double(w->directions.back().x);
+    });
+    suite.add("warp_uniform_sphere" + sfx, n, [w] {
+        math::warp_uniform_sphere(w->samples.data(), w->directions.data(), w->samples.size(), 1);
+        return double(w->directions.back().x);
+    });
+    suite.add("warp_triangle" + sfx, n, [w] {
+        math::warp_triangle(w->samples.data(), w->directions.data(), w->samples.size(), 1);
+        return double(w->directions.back().x);
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel kernels (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{1000000, 10000000})
+        groups.push_back([=](bench::Suite &suite) { register_size(suite, size, threads, seed); });
+    return bench::run_suite(groups, opt);
+}
@@ -0,0 +1,165 @@
+// Small linear system benchmark: 100k and 1M independent 3x3 and 4x4 float systems, solved with inverse(m) * b
+// (general matrices a + 2 * identity and symmetric positive definite matrices a * transpose(a) + 0.1 * identity)
+// against the LU (partial pivoting) and Cholesky solvers of vmath_solve.h, one at a time and batch over arrays of
+// matrices (1 thread and all threads) and over structure of arrays. The worst residual |m x - b| / (1 + |x|) of each
+// route is printed as a measure of the accuracy. Timings are ns per system (bench::Suite, see benchmark_util.h for
+// the options).
+//
+//     bazel run -c opt //benchmark:benchmark_solve                  # 100k and 1M systems
+//     bazel run -c opt //benchmark:benchmark_solve -- 2000000 4     # 2M systems, 4 threads
+//     bazel run -c opt --copt=-mavx //benchmark:benchmark_solve     # 8 systems per iteration
+//
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_random.h"
+#include "vmath_solve.h"
+
+namespace {
+
+// worst |m x - b| / (1 + |x|), in double
+template <int N, typename M, typename V>
+double max_residual(const std::vector<M> &m, const std::vector<V> &b, const std::vector<V> &x) {
+    double worst = 0;
+    for (size_t i = 0; i < m.size(); i++) {
+        double r2 = 0, x2 = 0;
+        for (int row = 0; row < N; row++) {
+            double s = -double(b[i][row]);
+            for (int col = 0; col < N; col++)
+                s += double(m[i](row, col)) * double(x[i][col]);
+            r2 += s * s;
+            x2 += double(x[i][row]) * double(x[i][row]);
+        }
+        worst = std::max(worst, std::sqrt(r2) / (1.0 + std::sqrt(x2)));
+    }
+    return worst;
+}
+
+template <typename M, typename V> struct State {
+    std::vector<M> m, spd;
+    std::vector<V> b, x;
+    std::vector<float> soa_a, soa_b, soa_x;
+};
+
+template <int N, typename M, typename V>
+void register_size(bench::Suite &suite, const char *label, size_t n, unsigned threads, uint64_t seed) {
+    auto s = std::make_shared<State<M, V>>();
+    math::Random rng(seed);
+    s->m.resize(n);
+    s->spd.resize(n);
+    s->b.resize(n);
+    s->x.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        M a, at, id;
+        for (float &v : a.data)
+            v = rng.uniform(-1.f, 1.f);
+        math::set_identity(id);
+        s->m[i] = a + id * 2.f; // general, moderately conditioned
+        at = a;
+        math::transpose(at);
+        s->spd[i] = a * at + id * 0.1f;
+        for (int k = 0; k < N; k++)
+            s->b[i][k] = rng.uniform(-1.f, 1.f);
+    }
+    s->soa_a.resize(N * N * n);
+    s->soa_b.resize(N * n);
+    s->soa_x.resize(N * n);
+    for (size_t i = 0; i < n; i++) {
+        for (int c = 0; c < N * N; c++)
+            s->soa_a[size_t(c) * n + i] = s->m[i].data[c];
+        for (int c = 0; c < N; c++)
+            s->soa_b[size_t(c) * n + i] = s->b[i][c];
+    }
+
+    // accuracy of each route, the batch and one at a time solvers give the same results
+    std::vector<V> &x = s->x;
+    printf("%s, %zu systems, residual:", label, n);
+    for (size_t i = 0; i < n; i++)
+        x[i] = math::inverse(s->m[i]) * s->b[i];
+    printf(" inverse(m) * b %.2g,", max_residual<N>(s->m, s->b, x));
+    math::solve(s->m.data(), s->b.data(), x.data(), n, threads);
+    printf(" solve %.2g,", max_residual<N>(s->m, s->b, x));
+    for (size_t i = 0; i < n; i++)
+        x[i] = math::inverse(s->spd[i]) * s->b[i];
+    printf(" spd inverse(m) * b %.2g,", max_residual<N>(s->spd, s->b, x));
+    math::solve_cholesky(s->spd.data(), s->b.data(), x.data(), n, threads);
+    printf(" solve_cholesky %.2g\n", max_residual<N>(s->spd, s->b, x));
+
+    const std::string sfx = std::string("/") + label + "/" + bench::size_label(n);
+    suite.add("inverse_mul" + sfx, n, [s] {
+        for (size_t i = 0; i < s->m.size(); i++)
+            s->x[i] = math::inverse(s->m[i]) * s->b[i];
+        return double(s->x.back()[0]);
+    });
+    suite.add("solve_scalar" + sfx, n, [s] {
+        for (size_t i = 0; i < s->m.size(); i++)
+            s->x[i] = math::solve(s->m[i], s->b[i]);
+        return double(s->x.back()[0]);
+    });
+    suite.add("solve_batch" + sfx, n, [s] {
+        math::solve(s->m.data(), s->b.data(), s->x.data(), s->m.size(), 1);
+        return double(s->x.back()[0]);
+    });
+    suite.add("solve_parallel" + sfx, n, [s, threads] {
+        math::solve(s->m.data(), s->b.data(), s->x.data(), s->m.size(), threads);
+        return double(s->x.back()[0]);
+    });
+    suite.add("solve_soa" + sfx, n, [s] {
+        math::solve_soa<N>(s->soa_a.data(), s->soa_b.data(), s->soa_x.data(), s->m.size(), 1);
+        return double(s->soa_x.back());
+    });
+    suite.add("solve_soa_parallel" + sfx, n, [s, threads] {
+        math::solve_soa<N>(s->soa_a.data(), s->soa_b.data(), s->soa_x.data(), s->m.size(), threads);
+        return double(s->soa_x.back());
+    });
+
+    suite.add("spd_inverse_mul" + sfx, n, [s] {
+        for (size_t i = 0; i < s->spd.size(); i++)
+            s->x[i] = math::inverse(s->spd[i]) * s->b[i];
+        return double(s->x.back()[0]);
+    });
+    suite.add("spd_cholesky_scalar" + sfx, n, [s] {
+        for (size_t i = 0; i < s->spd.size(); i++)
+            s->x[i] = math::solve_cholesky(s->spd[i], s->b[i]);
+        return double(s->x.back()[0]);
+    });
+    suite.add("spd_cholesky_batch" + sfx, n, [s] {
+        math::solve_cholesky(s->spd.data(), s->b.data(), s->x.data(), s->spd.size(), 1);
+        return double(s->x.back()[0]);
+    });
+    suite.add("spd_cholesky_parallel" + sfx, n, [s, threads] {
+        math::solve_cholesky(s->spd.data(), s->b.data(), s->x.data(), s->spd.size(), threads);
+        return double(s->x.back()[0]);
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint64_t seed = opt.args.size() > 2 ? uint64_t(std::atoll(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel solvers (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{100000, 1000000}) {
+        groups.push_back([=](bench::Suite &suite) {
+            register_size<3, math::Matrix3f, math::Vector3f>(suite, "3x3", size, threads, seed);
+            register_size<4, math::Matrix4f, math::Vector4f>(suite, "4x4", size, threads, seed);
+        });
+    }
+    return bench::run_suite(groups, opt);
+}
@@ -0,0 +1,101 @@
+// Spatial hash grid benchmark: bulk build (1 thread and all threads), incremental update after a small motion,
+// radius and kNN queries over a uniform point cloud. Timings are ns per point (build, update) or per query
+// (bench::Suite, see benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_spatial_hash                  # 1M and 10M points
+//     bazel run -c opt //benchmark:benchmark_spatial_hash -- 2000000 4     # 2M points, 4 threads
+//
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath_spatial_hash.h"
+
+namespace {
+
+template <typename T> struct State {
+    explicit State(T cell) : grid(cell) {}
+    math::SpatialHashGrid<T> grid;
+    std::vector<math::Vector3<T>> pts, moved, queries;
+    std::vector<uint32_t> offsets, found, knn;
+    std::vector<T> d2;
+    bool at_moved = false;
+};
+
+template <typename T> void register_size(bench::Suite &suite, const std::string &sfx, size_t n, unsigned threads,
+                                         uint32_t seed) {
+    const T side = T(100);
+    // about 8 points per cell
+    const T cell = side * T(std::cbrt(8.0 / double(n)));
+    auto s = std::make_shared<State<T>>(cell);
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<T> u(T(0), side);
+    s->pts.resize(n);
+    for (auto &p : s->pts)
+        p = math::Vector3<T>(u(gen), u(gen), u(gen));
+    const size_t nq = 100000;
+    s->queries.resize(nq);
+    for (auto &q : s->queries)
+        q = math::Vector3<T>(u(gen), u(gen), u(gen));
+    // small motion: a few percent of the points leave their bucket
+    std::uniform_real_distribution<T> step(-cell * T(0.02), cell * T(0.02));
+    s->moved = s->pts;
+    for (auto &p : s->moved)
+        p += math::Vector3<T>(step(gen), step(gen), step(gen));
+    const size_t k = 8;
+    s->knn.resize(nq * k);
+    s->d2.resize(nq * k);
+    const std::string name = "/" + sfx + "/" + bench::size_label(n);
+
+    suite.add("hash_build_serial" + name, n, [s] {
+        s->grid.build(s->pts.data(), s->pts.size(), 1);
+        s->at_moved = false;
+        return double(s->grid.overflow_size());
+    });
+    suite.add("hash_build_parallel" + name, n, [s, threads] {
+        s->grid.build(s->pts.data(), s->pts.size(), threads);
+        s->at_moved = false;
+        return double(s->grid.overflow_size());
+    });
+    // every run moves the points back and forth between the two positions
+    suite.add("hash_update" + name, n, [s, threads] {
+        s->at_moved = !s->at_moved;
+        s->grid.update(s->at_moved ? s->moved.data() : s->pts.data(), threads);
+        return double(s->grid.overflow_size());
+    });
+    suite.add("hash_radius_query" + name, nq, [s, cell, threads] {
+        s->grid.radius_search(s->queries.data(), s->queries.size(), cell, s->offsets, s->found, threads);
+        return double(s->found.size());
+    });
+    suite.add("hash_knn8_query" + name, nq, [s, k, threads] {
+        s->grid.knn_search(s->queries.data(), s->queries.size(), k, s->knn.data(), s->d2.data(), threads);
+        return double(s->d2.back());
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel passes (0 = all), about 8 points per cell, 100k queries\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{1000000, 10000000}) {
+        groups.push_back([=](bench::Suite &suite) { register_size<float>(suite, "f", size, threads, seed); });
+        groups.push_back([=](bench::Suite &suite) { register_size<double>(suite, "d", size, threads, seed); });
+    }
+    return bench::run_suite(groups, opt);
+}
@@ -0,0 +1,121 @@
+// Spatial sort benchmark: Morton and Hilbert key generation, parallel radix sort against std::sort, and the
+// effect of a spatially sorted layout on a memory-bound gather (a neighbor lookup in a point cloud). Timings are
+// ns per point (bench::Suite, see benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_spatial_sort                  # 1M and 10M points
+//     bazel run -c opt //benchmark:benchmark_spatial_sort -- 2000000 4     # 2M points, 4 threads
+//
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath_spatial_sort.h"
+
+namespace {
+
+// sum of the distances between each point and the points that follow it in a fixed pattern of offsets of
+// the original indices: with a spatially sorted layout the same neighbors are close in memory
+double gather_pass(const std::vector<math::Vector3f> &pts, const std::vector<uint32_t> &neighbor) {
+    double s = 0;
+    for (size_t i = 0; i < pts.size(); i++)
+        s += length(pts[i] - pts[neighbor[i]]);
+    return s;
+}
+
+struct State {
+    std::vector<math::Vector3f> pts, sorted;
+    math::AABBf bounds;
+    std::vector<uint64_t> keys, hilbert;
+    std::vector<uint32_t> perm, ref, neighbor, sorted_neighbor;
+};
+
+void register_size(bench::Suite &suite, size_t n, unsigned threads, uint32_t seed) {
+    auto s = std::make_shared<State>();
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> u(0.0f, 100.0f);
+    s->pts.resize(n);
+    for (auto &p : s->pts)
+        p = math::Vector3f(u(gen), u(gen), u(gen));
+    s->bounds = math::fit_aabb(s->pts.data(), n);
+    s->keys.resize(n);
+    s->hilbert.resize(n);
+    s->perm.resize(n);
+    s->ref.resize(n);
+    math::spatial_keys(s->pts.data(), n, s->bounds, math::SpaceFillingCurve::hilbert, s->hilbert.data(), threads);
+    math::radix_sort(s->hilbert.data(), n, s->perm.data(), nullptr, threads);
+
+    // neighbor of each point: the closest of a few random candidates is not needed, any spatially close point
+    // does; use the next point along the curve, expressed in the original indices
+    s->neighbor.resize(n);
+    for (size_t i = 0; i < n; i++)
+        s->neighbor[s->perm[i]] = s->perm[(i + 1) % n];
+    s->sorted.resize(n);
+    math::apply_permutation(s->pts.data(), s->perm.data(), n, s->sorted.data(), threads);
+    s->sorted_neighbor.resize(n);
+    for (size_t i = 0; i < n; i++)
+        s->sorted_neighbor[i] = uint32_t((i + 1) % n);
+
+    std::iota(s->ref.begin(), s->ref.end(), 0u);
+    const std::vector<uint64_t> &keys = s->hilbert;
+    std::stable_sort(s->ref.begin(), s->ref.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    const double s0 = gather_pass(s->pts, s->neighbor), s1 = gather_pass(s->sorted, s->sorted_neighbor);
+    printf("%zu points: radix sort and std::stable_sort %s, neighbor gather checksum %s\n", n,
+           s->ref == s->perm ? "give the same permutation" : "MISMATCH",
+           std::abs(s0 - s1) < 1e-3 * s0 ? "ok" : "MISMATCH");
+
+    const std::string sfx = "/" + bench::size_label(n);
+    suite.add("hilbert_keys" + sfx, n, [s, threads] {
+        math::spatial_keys(s->pts.data(), s->pts.size(), s->bounds, math::SpaceFillingCurve::hilbert,
+                           s->keys.data(), threads);
+        return double(s->keys.back());
+    });
+    suite.add("morton_keys" + sfx, n, [s, threads] {
+        math::spatial_keys(s->pts.data(), s->pts.size(), s->bounds, math::SpaceFillingCurve::morton,
+                           s->keys.data(), threads);
+        return double(s->keys.back());
+    });
+    suite.add("radix_sort_serial" + sfx, n, [s] {
+        math::radix_sort(s->hilbert.data(), s->hilbert.size(), s->perm.data(), nullptr, 1);
+        return double(s->perm.back());
+    });
+    suite.add("radix_sort_parallel" + sfx, n, [s, threads] {
+        math::radix_sort(s->hilbert.data(), s->hilbert.size(), s->perm.data(), nullptr, threads);
+        return double(s->perm.back());
+    });
+    // includes the reset of the index array, which is small against the sort
+    suite.add("std_stable_sort" + sfx, n, [s] {
+        const std::vector<uint64_t> &keys = s->hilbert;
+        std::iota(s->ref.begin(), s->ref.end(), 0u);
+        std::stable_sort(s->ref.begin(), s->ref.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+        return double(s->ref.back());
+    });
+    suite.add("gather_unsorted" + sfx, n, [s] { return gather_pass(s->pts, s->neighbor); });
+    suite.add("gather_sorted" + sfx, n, [s] { return gather_pass(s->sorted, s->sorted_neighbor); });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 5;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [SEED]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const uint32_t seed = opt.args.size() > 2 ? uint32_t(std::atoi(opt.args[2].c_str())) : 12345678;
+    printf("%u threads for the parallel passes (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{1000000, 10000000})
+        groups.push_back([=](bench::Suite &suite) { register_size(suite, size, threads, seed); });
+    return bench::run_suite(groups, opt);
+}
@@ -0,0 +1,153 @@
+// Streaming transform benchmark: throughput (GB/s of input) of transforming 10M and 100M Vector3f stored in a file
+// with the chunked pipeline of vmath_stream.h, without overlap (1 buffer), double buffered and with 3 buffers,
+// against the same transform in memory and the pipeline with an empty kernel (I/O only). The file is written to
+// a temporary directory first, so the reads are usually served by the page cache. Timings are ns per point
+// (bench::Suite, see benchmark_util.h for the options).
+//
+//     bazel run -c opt //benchmark:benchmark_stream                          # 10M and 100M points, in /tmp
+//     bazel run -c opt //benchmark:benchmark_stream -- 50000000 4 /scratch   # 50M points, 4 threads, in /scratch
+//
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "vmath.h"
+#include "vmath_stream.h"
+
+namespace {
+
+// the files of one size, removed at the end of the program
+struct Files {
+    ~Files() {
+        std::remove(input.c_str());
+        std::remove(output.c_str());
+    }
+    std::string input, output;
+};
+
+// a few points of the output of the last run
+bool check_output(const Files &files, const math::Transff &t, size_t n) {
+    std::FILE *f = std::fopen(files.input.c_str(), "rb");
+    std::FILE *g = std::fopen(files.output.c_str(), "rb");
+    bool ok = f && g;
+    if (ok) {
+        for (size_t i : {size_t(0), n / 2, n - 1}) {
+            math::Vector3f a, b;
+            std::fseek(f, long(i * sizeof(a)), SEEK_SET);
+            std::fseek(g, long(i * sizeof(b)), SEEK_SET);
+            if (std::fread(&a, sizeof(a), 1, f) != 1 || std::fread(&b, sizeof(b), 1, g) != 1 ||
+                math::length(t.transform(a) - b) > 1e-3f)
+                ok = false;
+        }
+    }
+    if (f)
+        std::fclose(f);
+    if (g)
+        std::fclose(g);
+    return ok;
+}
+
+const math::Transff transform(math::Vector3f(1.f, -2.f, 3.f),
+                              math::quat_from_axis_angle(math::normalized(math::Vector3f(1, 2, 3)), 0.5f));
+
+void register_stream(bench::Suite &suite, const std::shared_ptr<Files> &files, size_t n, unsigned threads,
+                     uint32_t seed) {
+    printf("%zu points (%.1f MB)\n", n, double(n) * sizeof(math::Vector3f) * 1e-6);
+    // written in chunks, so that the file can be larger than the memory used here
+    {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> d(-100.f, 100.f);
+        std::vector<math::Vector3f> block(size_t(1) << 20);
+        std::FILE *f = std::fopen(files->input.c_str(), "wb");
+        if (!f) {
+            printf("cannot create %s\n", files->input.c_str());
+            return;
+        }
+        for (size_t i = 0; i < n; i += block.size()) {
+            const size_t m = std::min(block.size(), n - i);
+            for (size_t j = 0; j < m; j++)
+                block[j] = math::Vector3f(d(gen), d(gen), d(gen));
+            std::fwrite(block.data(), sizeof(block[0]), m, f);
+        }
+        std::fclose(f);
+    }
+    math::StreamOptions options;
+    options.threads = threads;
+    math::StreamStats stats;
+    if (!math::transform_points_file(files->input, files->output, transform, options, &stats) ||
+        !check_output(*files, transform, n))
+        printf("  stream failed: %s\n", stats.error.empty() ? "mismatch" : stats.error.c_str());
+    const std::string sfx = "/" + bench::size_label(n);
+
+    auto stream = [files](const math::StreamOptions &options) {
+        return [files, options] {
+            math::StreamStats stats;
+            if (!math::transform_points_file(files->input, files->output, transform, options, &stats))
+                printf("stream failed: %s\n", stats.error.c_str());
+            return double(stats.points);
+        };
+    };
+    options.buffers = 3;
+    suite.add("stream_io_only" + sfx, n, [files, options] {
+        math::StreamStats stats;
+        if (!math::stream_points<float>(files->input, files->output, [](math::Vector3f *, size_t) {}, options,
+                                        &stats))
+            printf("stream failed: %s\n", stats.error.c_str());
+        return double(stats.points);
+    });
+    for (unsigned buffers : {1u, 2u, 3u}) {
+        options.buffers = buffers;
+        suite.add("stream_transform_" + std::to_string(buffers) + "buf" + sfx, n, stream(options));
+    }
+    options.chunk_points = size_t(1) << 16;
+    suite.add("stream_transform_3buf_64k" + sfx, n, stream(options));
+}
+
+// compute only, on the data of the file in memory (in a group of its own, so that the stream does not run with
+// the points in memory)
+void register_in_memory(bench::Suite &suite, const std::shared_ptr<Files> &files, size_t n, unsigned threads) {
+    auto in = std::make_shared<std::vector<math::Vector3f>>(n);
+    auto out = std::make_shared<std::vector<math::Vector3f>>(n);
+    std::FILE *f = std::fopen(files->input.c_str(), "rb");
+    if (f && std::fread(in->data(), sizeof(math::Vector3f), n, f) == n) {
+        suite.add("transform_in_memory/" + bench::size_label(n), n, [in, out, threads] {
+            math::transform_points(transform, in->data(), out->data(), in->size(), threads);
+            return double(out->back().x);
+        });
+    }
+    if (f)
+        std::fclose(f);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bench::Options opt;
+    opt.reps = 3;
+    const int rc = bench::parse_options(argc, argv, opt, "[N [THREADS [DIR [SEED]]]]");
+    if (rc >= 0)
+        return rc;
+    const size_t n = opt.args.size() > 0 ? size_t(std::atoll(opt.args[0].c_str())) : 0;
+    const unsigned threads = opt.args.size() > 1 ? unsigned(std::atoi(opt.args[1].c_str())) : 0;
+    const std::string dir = opt.args.size() > 2 ? opt.args[2] : "/tmp";
+    const uint32_t seed = opt.args.size() > 3 ? uint32_t(std::atoi(opt.args[3].c_str())) : 12345678;
+    printf("chunks of 1M points (64k for the last one), %u threads (0 = all)\n", threads);
+
+    std::vector<bench::Group> groups;
+    for (size_t size : n > 0 ? std::vector<size_t>{n} : std::vector<size_t>{10000000, 100000000}) {
+        auto files = std::make_shared<Files>();
+        files->input = dir + "/vmath_benchmark_stream_in_" + bench::size_label(size) + ".bin";
+        files->output = dir + "/vmath_benchmark_stream_out_" + bench::size_label(size) + ".bin";
+        groups.push_back([=](bench::Suite &suite) { register_stream(suite, files, size, threads, seed); });
+        // when it fits
+        if (size <= 200000000)
+            groups.push_back([=](bench::Suite &suite) { register_in_memory(suite, files, size, threads); });
+    }
+    return bench::run_suite(groups, opt);
+}
@@ -1,26 +1,21 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstdio>
-#include <random>
 #include <vector>
 #include <chrono>
 
 #include "vmath.h"
+#include "vmath_random.h"
 
-template <typename T> T rand_range(T v1, T v2) {
-    return v1 + T(double(rand()) / RAND_MAX * (v2 - v1));
+// translation in [0,1) (as with the former rand() based generator), uniformly distributed rotation
+template <typename T> math::Transform<T> create_random_transf(math::Random &rng) {
+    const math::Vector3<T> p(rng.uniform<T>(), rng.uniform<T>(), rng.uniform<T>());
+    return math::Transform<T>(p, math::random_quat<T>(rng));
 }
 
-template <typename T> math::Matrix4<T> create_random_mat4() {
-    return math::create_transformation(
-        math::Vector3<T>(rand_range(T(0), T(1)), rand_range(T(0), T(1)), rand_range(T(0), T(1))),
-        math::quat_from_euler_321(rand_range(T(0), T(1)), rand_range(T(0), T(1)), rand_range(T(0), T(1))));
-}
-
-template <typename T> math::Transform<T> create_random_transf() {
-    return math::Transform<T>(
-        math::Vector3<T>(rand_range(T(0), T(1)), rand_range(T(0), T(1)), rand_range(T(0), T(1))),
-        math::quat_from_euler_321(rand_range(T(0), T(1)), rand_range(T(0), T(1)), rand_range(T(0), T(1))));
+template <typename T> math::Matrix4<T> create_random_mat4(math::Random &rng) {
+    const math::Transform<T> t = create_random_transf<T>(rng);
+    return math::create_transformation(t.p, t.q);
 }
 
 template <typename T> void profile_mat4(std::vector<math::Matrix4<T>> &chain) {
@@ -40,14 +35,15 @@ template <typename T> void profile_transform(std::vector<math::Transform<T>> &ch
 int main(int argc, char *argv[]) {
     int32_t len = argc > 1 ? std::atoi(argv[1]) : 100;
     uint32_t seed = argc > 2 ? std::atoi(argv[2]) : 12345678;
+    math::Random rng(seed);
     {
         printf("\n[FLOAT] start benchmark\n");
         // profile mat4 (float)
         std::vector<math::Matrix4f> chain_mat4_f;
         std::vector<math::Transff> chain_transf_f;
-        srand(seed);
+        rng = math::Random(seed);
         for (int i = 0; i < len; i++) {
-            chain_mat4_f.push_back(create_random_mat4<float>());
+            chain_mat4_f.push_back(create_random_mat4<float>(rng));
         }
         auto start = std::chrono::high_resolution_clock::now();
         profile_mat4(chain_mat4_f);
@@ -56,9 +52,9 @@ int main(int argc, char *argv[]) {
         printf("mat4 elapsed time:   %lld ns\n", (long long)dur.count());
 
         // profile transf (float)
-        srand(seed);
+        rng = math::Random(seed);
         for (int i = 0; i < len; i++) {
-            chain_transf_f.push_back(create_random_transf<float>());
+            chain_transf_f.push_back(create_random_transf<float>(rng));
         }
         start = std::chrono::high_resolution_clock::now();
         profile_transform(chain_transf_f);
@@ -76,9 +72,9 @@ int main(int argc, char *argv[]) {
         // profile mat4 (double)
         std::vector<math::Matrix4d> chain_mat4_d;
         std::vector<math::Transfd> chain_transf_d;
-        srand(seed);
+        rng = math::Random(seed);
         for (int i = 0; i < len; i++) {
-            chain_mat4_d.push_back(create_random_mat4<double>());
+            chain_mat4_d.push_back(create_random_mat4<double>(rng));
         }
         auto start = std::chrono::high_resolution_clock::now();
         profile_mat4(chain_mat4_d);
@@ -87,9 +83,9 @@ int main(int argc, char *argv[]) {
         printf("mat4 elapsed time:   %lld ns\n", (long long)dur.count());
 
         // profile transf (double)
-        srand(seed);
+        rng = math::Random(seed);
         for (int i = 0; i < len; i++) {
-            chain_transf_d.push_back(create_random_transf<double>());
+            chain_transf_d.push_back(create_random_transf<double>(rng));
         }
         start = std::chrono::high_resolution_clock::now();
         profile_transform(chain_transf_d);
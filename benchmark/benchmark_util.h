@@ -4,6 +4,8 @@
 //   - Suite: register named benchmarks and run them with warmup + repetitions
 //   - baseline save / load / compare: persist a performance baseline and detect
 //     regressions on later runs
+//   - parse_options() / run_suite(): the command line shared by the benchmark
+//     programs (--reps, --filter, --save, --baseline, --check, ...)
 //
 // Each benchmark returns a `double` checksum derived from its results; the
 // harness feeds it into a volatile sink so the optimizer cannot discard the
@@ -17,6 +19,7 @@
 #include <chrono>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <functional>
 #include <map>
@@ -118,4 +121,179 @@ inline std::map<std::string, double> load_baseline(const std::string &path) {
     return m;
 }
 
+/// Short label of a problem size for the benchmark names: 100k, 1M, 10M, ...
+inline std::string size_label(uint64_t n) {
+    if (n >= 1000000 && n % 1000000 == 0)
+        return std::to_string(n / 1000000) + "M";
+    if (n >= 1000 && n % 1000 == 0)
+        return std::to_string(n / 1000) + "k";
+    return std::to_string(n);
+}
+
+// ------------------------------------------------------------------ //
+// Reporting & comparison                                             //
+// ------------------------------------------------------------------ //
+
+inline void print_results(const std::vector<Result> &results) {
+    printf("\n%-32s %10s %14s %14s\n", "benchmark", "ops", "ns/op(best)", "ns/op(median)");
+    printf("%-32s %10s %14s %14s\n", "--------------------------------", "----------", "--------------",
+           "--------------");
+    for (const auto &r : results)
+        printf("%-32s %10llu %14.3f %14.3f\n", r.name.c_str(), (unsigned long long)r.ops, r.ns_per_op_best,
+               r.ns_per_op_median);
+    printf("\n");
+}
+
+// Returns number of regressions worse than `threshold` percent.
+inline int compare_to_baseline(const std::vector<Result> &results, const std::map<std::string, double> &base,
+                               double threshold) {
+    printf("comparison vs baseline (threshold %.1f%%):\n", threshold);
+    printf("%-32s %14s %14s %10s\n", "benchmark", "baseline", "current", "delta");
+    printf("%-32s %14s %14s %10s\n", "--------------------------------", "--------------", "--------------",
+           "----------");
+    int regressions = 0;
+    int missing = 0;
+    for (const auto &r : results) {
+        auto it = base.find(r.name);
+        if (it == base.end()) {
+            printf("%-32s %14s %14.3f %10s\n", r.name.c_str(), "-", r.ns_per_op_best, "(new)");
+            ++missing;
+            continue;
+        }
+        double old = it->second;
+        double cur = r.ns_per_op_best;
+        double delta = old > 0 ? (cur - old) / old * 100.0 : 0.0;
+        const char *tag = "";
+        if (delta > threshold) {
+            tag = "  SLOWER";
+            ++regressions;
+        } else if (delta < -threshold) {
+            tag = "  faster";
+        }
+        printf("%-32s %14.3f %14.3f %+9.1f%%%s\n", r.name.c_str(), old, cur, delta, tag);
+    }
+    printf("\n%d regression(s) above %.1f%%, %d new benchmark(s) not in baseline.\n", regressions, threshold, missing);
+    return regressions;
+}
+
+// ------------------------------------------------------------------ //
+// Command line                                                       //
+// ------------------------------------------------------------------ //
+
+/// Options of the benchmark programs. The values on entry of parse_options()
+/// are the defaults; the arguments that are not options (e.g. the problem
+/// sizes of the large data set benchmarks) are left in `args`.
+struct Options {
+    int reps = 100;
+    double threshold = 10.0;
+    bool check = false;
+    std::string save_path, baseline_path, filter;
+    std::vector<std::string> args;
+};
+
+inline void print_usage(const char *prog, const Options &defaults, const char *args_usage) {
+    std::string name = prog;
+    name = name.substr(name.find_last_of('/') + 1);
+    printf("usage: %s [options]%s%s\n", prog, args_usage[0] ? " " : "", args_usage);
+    printf("  --reps N            repetitions per benchmark (default %d)\n", defaults.reps);
+    printf("  --filter SUBSTR     only run benchmarks whose name contains SUBSTR\n");
+    printf("  --save PATH         write current results as a baseline file\n");
+    printf("  --baseline PATH     compare current results against a baseline file\n");
+    printf("  --threshold PCT     regression threshold percent for --check (default %g)\n", defaults.threshold);
+    printf("  --check             exit non-zero if any regression exceeds threshold\n");
+    printf("  -h, --help          show this help\n");
+    printf("\nBuild/run optimized:  bazel run -c opt //benchmark:%s\n", name.c_str());
+}
+
+/// Parse the command line into `opt`. Returns -1 when the program should go
+/// on, otherwise the exit code (after --help or a bad argument).
+inline int parse_options(int argc, char **argv, Options &opt, const char *args_usage = "") {
+    const Options defaults = opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto need_val = [&](const char *name) -> std::string {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "error: missing value for %s\n", name);
+                exit(2);
+            }
+            return argv[++i];
+        };
+        if (a == "--reps")
+            opt.reps = std::atoi(need_val("--reps").c_str());
+        else if (a == "--threshold")
+            opt.threshold = std::atof(need_val("--threshold").c_str());
+        else if (a == "--filter")
+            opt.filter = need_val("--filter");
+        else if (a == "--save")
+            opt.save_path = need_val("--save");
+        else if (a == "--baseline")
+            opt.baseline_path = need_val("--baseline");
+        else if (a == "--check")
+            opt.check = true;
+        else if (a == "-h" || a == "--help") {
+            print_usage(argv[0], defaults, args_usage);
+            return 0;
+        } else if (a[0] != '-' && args_usage[0]) {
+            opt.args.push_back(a);
+        } else {
+            fprintf(stderr, "error: unknown argument '%s'\n", a.c_str());
+            print_usage(argv[0], defaults, args_usage);
+            return 2;
+        }
+    }
+    if (opt.reps < 1)
+        opt.reps = 1;
+    return -1;
+}
+
+/// A group of benchmarks, registered on a suite of its own just before it
+/// runs: the data of a group only lives while its benchmarks run, so the
+/// large data set programs do not hold every problem size at once.
+using Group = std::function<void(Suite &)>;
+
+/// Run the benchmark groups, print the results table, then save and/or
+/// compare the baseline as requested. Returns the exit code of the program.
+inline int run_suite(const std::vector<Group> &groups, const Options &opt) {
+    // Process-level warmup: spin doing real work for ~200 ms so the CPU reaches
+    // a steady (boosted) frequency before any measurement. Without this the
+    // first (cheapest) benchmarks are biased by the frequency ramp-up.
+    {
+        volatile double sink = 0.0;
+        double acc = 1.0;
+        auto t0 = clock_type::now();
+        while (std::chrono::duration<double, std::milli>(clock_type::now() - t0).count() < 200.0) {
+            for (int k = 0; k < 10000; ++k)
+                acc = acc * 1.0000001 + 1e-9;
+            sink += acc;
+        }
+        do_not_optimize(sink);
+    }
+
+    printf("running vmath benchmarks (reps=%d)...\n", opt.reps);
+    std::vector<Result> results;
+    for (const auto &g : groups) {
+        Suite suite;
+        g(suite);
+        auto r = suite.run(opt.reps, opt.filter);
+        results.insert(results.end(), r.begin(), r.end());
+    }
+    print_results(results);
+
+    if (!opt.save_path.empty()) {
+        save_baseline(opt.save_path, results);
+        printf("saved baseline to %s\n", opt.save_path.c_str());
+    }
+
+    int rc = 0;
+    if (!opt.baseline_path.empty()) {
+        auto base = load_baseline(opt.baseline_path);
+        if (base.empty())
+            fprintf(stderr, "warning: baseline '%s' is empty or missing\n", opt.baseline_path.c_str());
+        int regressions = compare_to_baseline(results, base, opt.threshold);
+        if (opt.check && regressions > 0)
+            rc = 1;
+    }
+    return rc;
+}
+
 } // namespace bench
@@ -2,7 +2,8 @@
 //
 // Measures execution time of challenging sequences of vmath operations
 // (dependent multiply chains, matrix inversions, quaternion slerp, type
-// conversions, and a realistic scene-graph pipeline) for both float and double.
+// conversions, and a realistic scene-graph pipeline) for both float and double,
+// plus the double -> float conversions of a large world (scalar and batch).
 //
 // IMPORTANT: always build/run in optimized mode, otherwise the numbers are
 // meaningless (bazel defaults to -O0 "fastbuild"):
@@ -15,12 +16,18 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
-#include <random>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "benchmark_util.h"
 #include "vmath.h"
+#include "vmath_convert.h"
+#include "vmath_fixed.h"
+#include "vmath_geometry.h"
+#include "vmath_random.h"
+#include "vmath_registration.h"
+#include "vmath_spatial_sort.h"
 
 namespace {
 
@@ -35,9 +42,8 @@ constexpr size_t CHAIN = 1024;
 // ------------------------------------------------------------------ //
 
 struct Rng {
-    std::mt19937 gen{0xC0FFEEu};
-    std::uniform_real_distribution<double> dist{-1.0, 1.0};
-    template <typename T> T next() { return static_cast<T>(dist(gen)); }
+    math::Random gen{0xC0FFEEu};
+    template <typename T> T next() { return gen.uniform(T(-1), T(1)); }
 };
 
 template <typename T> math::Vector3<T> rand_vec3(Rng &r) {
@@ -50,8 +56,8 @@ template <typename T> math::Vector4<T> rand_vec4(Rng &r) {
 }
 
 template <typename T> math::Quaternion<T> rand_quat(Rng &r) {
-    // random rotation quaternion (normalized)
-    return math::normalized(math::quat_from_euler_321<T>(r.next<T>() * T(3.1), r.next<T>() * T(3.1), r.next<T>() * T(3.1)));
+    // uniformly distributed rotation (normalized)
+    return math::random_quat<T>(r.gen);
 }
 
 template <typename T> math::Matrix4<T> rand_transform_mat4(Rng &r) {
@@ -63,6 +69,16 @@ template <typename T> math::Matrix3<T> rand_rot_mat3(Rng &r) {
     return math::rot_matrix<T>(rand_quat<T>(r));
 }
 
+template <typename T> math::Matrix3<T> rand_spd_mat3(Rng &r) {
+    // symmetric positive definite: A^T * A + I
+    math::Matrix3<T> a;
+    for (int i = 0; i < 9; ++i)
+        a.data[i] = r.next<T>();
+    math::Matrix3<T> at = a;
+    math::transpose(at);
+    return at * a + math::matrix3_identity<T>();
+}
+
 template <typename T> math::Transform<T> rand_transform(Rng &r) {
     return math::Transform<T>(rand_vec3<T>(r), rand_quat<T>(r));
 }
@@ -79,6 +95,52 @@ template <typename Gen> auto make_vec(size_t n, Gen g) -> std::vector<decltype(g
 // Benchmark registration (templated over the scalar type).           //
 // ------------------------------------------------------------------ //
 
+// double -> float conversions of a large world, registered with the double
+// conversions (their own generator keeps the data of the other benchmarks)
+void register_d2f_conversions(bench::Suite &, float) {}
+void register_d2f_conversions(bench::Suite &suite, double) {
+    Rng r;
+    // points and models a few km around a camera placed 6400 km from the origin
+    const math::Vector3d eye(6.4e6, -1.3e6, 2.1e5);
+    auto p = make_vec(BATCH, [&] { return eye + rand_vec3<double>(r) * 1000.0; });
+    auto m = make_vec(BATCH, [&] {
+        return math::create_transformation<double>(eye + rand_vec3<double>(r) * 1000.0, rand_quat<double>(r));
+    });
+    auto pf = std::make_shared<std::vector<math::Vector3f>>(BATCH);
+    auto mf = std::make_shared<std::vector<math::Matrix4f>>(BATCH);
+
+    suite.add("vec3_convert_scalar/d2f", BATCH, [p, pf] {
+        auto &out = *pf;
+        for (size_t i = 0; i < p.size(); ++i)
+            out[i] = math::Vector3f(p[i]);
+        return double(out[0].x + out.back().z);
+    });
+    suite.add("vec3_convert_batch/d2f", BATCH, [p, pf] {
+        math::convert(p.data(), pf->data(), p.size(), 1);
+        return double((*pf)[0].x + pf->back().z);
+    });
+    suite.add("vec3_convert_relative_scalar/d2f", BATCH, [p, pf, eye] {
+        auto &out = *pf;
+        for (size_t i = 0; i < p.size(); ++i)
+            out[i] = math::Vector3f(p[i] - eye);
+        return double(out[0].x + out.back().z);
+    });
+    suite.add("vec3_convert_relative_batch/d2f", BATCH, [p, pf, eye] {
+        math::convert_relative(p.data(), eye, pf->data(), p.size(), 1);
+        return double((*pf)[0].x + pf->back().z);
+    });
+    suite.add("mat4_convert_scalar/d2f", BATCH, [m, mf] {
+        auto &out = *mf;
+        for (size_t i = 0; i < m.size(); ++i)
+            out[i] = math::Matrix4f(m[i]);
+        return double(out[0].data[12] + out.back().data[0]);
+    });
+    suite.add("mat4_relative_to_eye_batch/d2f", BATCH, [m, mf, eye] {
+        math::relative_to_eye(m.data(), eye, mf->data(), m.size(), 1);
+        return double((*mf)[0].data[12] + mf->back().data[0]);
+    });
+}
+
 template <typename T> void register_benchmarks(bench::Suite &suite, const std::string &sfx) {
     Rng r;
 
@@ -125,6 +187,8 @@ template <typename T> void register_benchmarks(bench::Suite &suite, const std::s
     // ---- Matrix3 ----
     {
         auto m = make_vec(BATCH, [&] { return rand_rot_mat3<T>(r); });
+        auto chain = make_vec(CHAIN, [&] { return rand_rot_mat3<T>(r); });
+        auto v3 = make_vec(BATCH, [&] { return rand_vec3<T>(r); });
         suite.add("mat3_mul_batch/" + sfx, BATCH - 1, [m] {
             double s = 0;
             for (size_t i = 1; i < m.size(); ++i) {
@@ -133,6 +197,20 @@ template <typename T> void register_benchmarks(bench::Suite &suite, const std::s
             }
             return s;
         });
+        suite.add("mat3_mul_chain/" + sfx, CHAIN - 1, [chain] {
+            auto acc = chain[0];
+            for (size_t i = 1; i < chain.size(); ++i)
+                acc = acc * chain[i]; // dependent: latency-bound
+            return double(acc.data[0] + acc.data[4]);
+        });
+        suite.add("mat3_mul_vec3/" + sfx, BATCH, [m, v3] {
+            double s = 0;
+            for (size_t i = 0; i < m.size(); ++i) {
+                auto out = m[i] * v3[i];
+                s += out.x + out.y + out.z;
+            }
+            return s;
+        });
         suite.add("mat3_inverse/" + sfx, BATCH, [m] {
             double s = 0;
             for (const auto &e : m) {
@@ -141,6 +219,50 @@ template <typename T> void register_benchmarks(bench::Suite &suite, const std::s
             }
             return s;
         });
+
+        // rotation * symmetric stretch (polar/QR input) and symmetric matrices (eigen input)
+        auto deformed = make_vec(BATCH, [&] { return rand_rot_mat3<T>(r) * rand_spd_mat3<T>(r); });
+        auto sym = make_vec(BATCH, [&] { return rand_spd_mat3<T>(r); });
+        suite.add("mat3_polar_decompose/" + sfx, BATCH, [deformed] {
+            double s = 0;
+            math::Matrix3<T> rot, stretch;
+            for (const auto &e : deformed) {
+                math::polar_decompose(e, rot, stretch);
+                s += rot.data[0] + stretch.data[4];
+            }
+            return s;
+        });
+        suite.add("mat3_qr_decompose/" + sfx, BATCH, [deformed] {
+            double s = 0;
+            math::Matrix3<T> q, rr;
+            for (const auto &e : deformed) {
+                math::qr_decompose(e, q, rr);
+                s += q.data[0] + rr.data[4];
+            }
+            return s;
+        });
+        auto svd_u = std::make_shared<std::vector<math::Matrix3<T>>>(BATCH);
+        auto svd_v = std::make_shared<std::vector<math::Matrix3<T>>>(BATCH);
+        auto svd_sigma = std::make_shared<std::vector<math::Vector3<T>>>(BATCH);
+        suite.add("mat3_svd_decompose/" + sfx, BATCH, [deformed, svd_u, svd_v, svd_sigma] {
+            auto &u = *svd_u, &v = *svd_v;
+            auto &sigma = *svd_sigma;
+            math::svd_decompose(deformed.data(), u.data(), sigma.data(), v.data(), deformed.size());
+            double s = 0;
+            for (size_t i = 0; i < sigma.size(); ++i)
+                s += sigma[i].x + u[i].data[0] + v[i].data[0];
+            return s;
+        });
+        suite.add("mat3_eigen_decompose/" + sfx, BATCH, [sym] {
+            double s = 0;
+            math::Matrix3<T> v;
+            math::Vector3<T> ev;
+            for (const auto &e : sym) {
+                math::eigen_decompose(e, v, ev);
+                s += v.data[0] + ev.x;
+            }
+            return s;
+        });
     }
 
     // ---- Matrix4 ----
@@ -283,6 +405,7 @@ template <typename T> void register_benchmarks(bench::Suite &suite, const std::s
             }
             return s;
         });
+        register_d2f_conversions(suite, T());
     }
 
     // ---- Transform (rigid) ----
@@ -315,6 +438,122 @@ template <typename T> void register_benchmarks(bench::Suite &suite, const std::s
         });
     }
 
+    // ---- Geometry queries ----
+    {
+        auto p = make_vec(BATCH, [&] { return rand_vec3<T>(r) * T(2); });
+        auto q = make_vec(BATCH, [&] { return rand_vec3<T>(r) * T(2); });
+        auto tri = make_vec(3, [&] { return rand_vec3<T>(r); });
+        auto boxes = make_vec(BATCH, [&] {
+            return math::create_obb(rand_transform<T>(r), math::Vector3<T>(T(0.5), T(0.75), T(1)));
+        });
+        auto caps = make_vec(BATCH, [&] {
+            return math::Capsule<T>{rand_vec3<T>(r) * T(2), rand_vec3<T>(r) * T(2), T(0.25)};
+        });
+        auto closest = std::make_shared<std::vector<math::Vector3<T>>>(BATCH);
+        suite.add("geom_closest_point_triangle/" + sfx, BATCH, [p, tri, closest] {
+            auto &out = *closest;
+            math::closest_point_on_triangle(p.data(), p.size(), tri[0], tri[1], tri[2], out.data());
+            double s = 0;
+            for (const auto &e : out)
+                s += e.x + e.y + e.z;
+            return s;
+        });
+        suite.add("geom_closest_point_obb/" + sfx, BATCH, [p, boxes] {
+            double s = 0;
+            for (size_t i = 0; i < p.size(); ++i) {
+                auto c = math::closest_point_on_obb(p[i], boxes[i]);
+                s += c.x + c.y + c.z;
+            }
+            return s;
+        });
+        suite.add("geom_segment_segment/" + sfx, BATCH - 1, [p, q] {
+            double s = 0;
+            for (size_t i = 0; i + 1 < p.size(); ++i)
+                s += math::distance2_segment_segment(p[i], q[i], p[i + 1], q[i + 1]);
+            return s;
+        });
+        suite.add("geom_overlap_capsule/" + sfx, BATCH - 1, [caps] {
+            size_t n = 0;
+            for (size_t i = 0; i + 1 < caps.size(); ++i)
+                n += math::overlap(caps[i], caps[i + 1]);
+            return double(n);
+        });
+        suite.add("geom_overlap_obb/" + sfx, BATCH - 1, [boxes] {
+            std::unique_ptr<bool[]> res(new bool[boxes.size() - 1]);
+            math::overlap(boxes.data(), boxes.data() + 1, boxes.size() - 1, res.get());
+            size_t n = 0;
+            for (size_t i = 0; i + 1 < boxes.size(); ++i)
+                n += res[i];
+            return double(n);
+        });
+        suite.add("geom_fit_obb/" + sfx, BATCH, [p] {
+            auto box = math::fit_obb(p.data(), p.size());
+            return double(box.center.x + box.half_extents.x);
+        });
+    }
+
+    // ---- OBB broadphase ----
+    // Narrow-phase filter of a broadphase: 100k candidate pairs of boxes scattered in a volume sized so that
+    // roughly half of the bounding spheres touch. Each pair runs a bounding sphere rejection and then the
+    // SAT test, which exits early on the first separating face axis for most separated pairs.
+    {
+        const size_t pairs = 100000;
+        auto boxes = make_vec(pairs + 1, [&] {
+            auto pose = rand_transform<T>(r);
+            pose.p = pose.p * T(0.5);
+            const math::Vector3<T> ext(T(0.15) + r.next<T>() * T(0.1), T(0.15) + r.next<T>() * T(0.1),
+                                       T(0.15) + r.next<T>() * T(0.1));
+            return math::create_obb(pose, ext);
+        });
+        suite.add("geom_obb_broadphase_100k/" + sfx, pairs, [boxes] {
+            size_t n = 0;
+            for (size_t i = 0; i + 1 < boxes.size(); ++i) {
+                const auto &a = boxes[i];
+                const auto &b = boxes[i + 1];
+                const T rad = length(a.half_extents) + length(b.half_extents);
+                if (length2(a.center - b.center) <= rad * rad)
+                    n += math::overlap(a, b);
+            }
+            return double(n);
+        });
+    }
+
+    // ---- Spatial keys ----
+    {
+        auto p = make_vec(BATCH, [&] { return rand_vec3<T>(r); });
+        const auto bounds = math::fit_aabb(p.data(), p.size());
+        auto out = std::make_shared<std::vector<uint64_t>>(BATCH);
+        suite.add("spatial_keys_morton/" + sfx, BATCH, [p, bounds, out] {
+            auto &keys = *out;
+            math::spatial_keys(p.data(), p.size(), bounds, math::SpaceFillingCurve::morton, keys.data(), 1);
+            return double(keys[0] ^ keys.back());
+        });
+        suite.add("spatial_keys_hilbert/" + sfx, BATCH, [p, bounds, out] {
+            auto &keys = *out;
+            math::spatial_keys(p.data(), p.size(), bounds, math::SpaceFillingCurve::hilbert, keys.data(), 1);
+            return double(keys[0] ^ keys.back());
+        });
+    }
+
+    // ---- Point-set registration ----
+    // Best-fit transform between BATCH noisy correspondences (single threaded).
+    {
+        const auto pose = rand_transform<T>(r);
+        auto src = make_vec(BATCH, [&] { return rand_vec3<T>(r); });
+        std::vector<math::Vector3<T>> dst(src.size());
+        for (size_t i = 0; i < src.size(); ++i)
+            dst[i] = pose.transform(src[i]) + math::Vector3<T>(r.next<T>(), r.next<T>(), r.next<T>()) * T(0.01);
+        suite.add("registration_kabsch/" + sfx, BATCH, [src, dst] {
+            auto t = math::kabsch(src.data(), dst.data(), src.size(), static_cast<const T *>(nullptr), 1);
+            return double(t.q.w + t.p.x);
+        });
+        suite.add("registration_umeyama/" + sfx, BATCH, [src, dst] {
+            T scale;
+            auto t = math::umeyama(src.data(), dst.data(), src.size(), scale, static_cast<const T *>(nullptr), 1);
+            return double(t.q.w + scale);
+        });
+    }
+
     // ---- Realistic pipeline: a small "scene graph" frame ----
     // For each node: compose a local transform onto a running parent transform,
     // convert the world transform to a Matrix4, and transform a point with it.
@@ -338,140 +577,74 @@ template <typename T> void register_benchmarks(bench::Suite &suite, const std::s
 }
 
 // ------------------------------------------------------------------ //
-// Reporting & comparison                                             //
+// Fixed-point vs floating-point scalar (registered for f, x16, x32).  //
 // ------------------------------------------------------------------ //
 
-void print_results(const std::vector<bench::Result> &results) {
-    printf("\n%-32s %10s %14s %14s\n", "benchmark", "ops", "ns/op(best)", "ns/op(median)");
-    printf("%-32s %10s %14s %14s\n", "--------------------------------", "----------", "--------------",
-           "--------------");
-    for (const auto &r : results)
-        printf("%-32s %10llu %14.3f %14.3f\n", r.name.c_str(), (unsigned long long)r.ops, r.ns_per_op_best,
-               r.ns_per_op_median);
-    printf("\n");
-}
-
-// Returns number of regressions worse than `threshold` percent.
-int compare_to_baseline(const std::vector<bench::Result> &results, const std::map<std::string, double> &base,
-                        double threshold) {
-    printf("comparison vs baseline (threshold %.1f%%):\n", threshold);
-    printf("%-32s %14s %14s %10s\n", "benchmark", "baseline", "current", "delta");
-    printf("%-32s %14s %14s %10s\n", "--------------------------------", "--------------", "--------------",
-           "----------");
-    int regressions = 0;
-    int missing = 0;
-    for (const auto &r : results) {
-        auto it = base.find(r.name);
-        if (it == base.end()) {
-            printf("%-32s %14s %14.3f %10s\n", r.name.c_str(), "-", r.ns_per_op_best, "(new)");
-            ++missing;
-            continue;
-        }
-        double old = it->second;
-        double cur = r.ns_per_op_best;
-        double delta = old > 0 ? (cur - old) / old * 100.0 : 0.0;
-        const char *tag = "";
-        if (delta > threshold) {
-            tag = "  SLOWER";
-            ++regressions;
-        } else if (delta < -threshold) {
-            tag = "  faster";
+template <typename T> void register_scalar_benchmarks(bench::Suite &suite, const std::string &sfx) {
+    Rng r;
+    auto v = make_vec(BATCH, [&] { return rand_vec3<T>(r); });
+    auto m = make_vec(BATCH, [&] { return rand_transform_mat4<T>(r); });
+    auto q = make_vec(BATCH, [&] { return rand_quat<T>(r); });
+    auto chain = make_vec(CHAIN, [&] { return rand_transform<T>(r); });
+    auto angles = make_vec(BATCH, [&] { return r.next<T>() * T(3); });
+
+    suite.add("scalar_vec3_normalize/" + sfx, BATCH, [v] {
+        double s = 0;
+        for (const auto &e : v)
+            s += double(math::normalized(e).x);
+        return s;
+    });
+    suite.add("scalar_mat4_mul_batch/" + sfx, BATCH - 1, [m] {
+        double s = 0;
+        for (size_t i = 0; i + 1 < m.size(); ++i)
+            s += double((m[i] * m[i + 1]).data[0]);
+        return s;
+    });
+    suite.add("scalar_quat_rotate_vec3/" + sfx, BATCH, [q, v] {
+        double s = 0;
+        for (size_t i = 0; i < q.size(); ++i) {
+            auto out = q[i].rotate(v[i]);
+            s += double(out.x + out.y + out.z);
         }
-        printf("%-32s %14.3f %14.3f %+9.1f%%%s\n", r.name.c_str(), old, cur, delta, tag);
-    }
-    printf("\n%d regression(s) above %.1f%%, %d new benchmark(s) not in baseline.\n", regressions, threshold, missing);
-    return regressions;
-}
-
-void print_usage(const char *prog) {
-    printf("usage: %s [options]\n", prog);
-    printf("  --reps N            repetitions per benchmark (default 100)\n");
-    printf("  --filter SUBSTR     only run benchmarks whose name contains SUBSTR\n");
-    printf("  --save PATH         write current results as a baseline file\n");
-    printf("  --baseline PATH     compare current results against a baseline file\n");
-    printf("  --threshold PCT     regression threshold percent for --check (default 10)\n");
-    printf("  --check             exit non-zero if any regression exceeds threshold\n");
-    printf("  -h, --help          show this help\n");
-    printf("\nBuild/run optimized:  bazel run -c opt //benchmark:vmath_benchmark\n");
+        return s;
+    });
+    suite.add("scalar_transform_compose_chain/" + sfx, CHAIN - 1, [chain] {
+        auto acc = chain[0];
+        for (size_t i = 1; i < chain.size(); ++i)
+            acc = acc * chain[i]; // dependent
+        return double(acc.p.x + acc.q.w);
+    });
+    suite.add("scalar_sincos/" + sfx, BATCH, [angles] {
+        using std::cos;
+        using std::sin;
+        double s = 0;
+        for (const auto &a : angles)
+            s += double(sin(a) + cos(a));
+        return s;
+    });
+    suite.add("scalar_sqrt/" + sfx, BATCH, [v] {
+        using std::sqrt;
+        double s = 0;
+        for (const auto &e : v)
+            s += double(sqrt(e.x));
+        return s;
+    });
 }
 
 } // namespace
 
 int main(int argc, char **argv) {
-    int reps = 100;
-    double threshold = 10.0;
-    bool check = false;
-    std::string save_path, baseline_path, filter;
-
-    for (int i = 1; i < argc; ++i) {
-        std::string a = argv[i];
-        auto need_val = [&](const char *name) -> std::string {
-            if (i + 1 >= argc) {
-                fprintf(stderr, "error: missing value for %s\n", name);
-                exit(2);
-            }
-            return argv[++i];
-        };
-        if (a == "--reps")
-            reps = std::atoi(need_val("--reps").c_str());
-        else if (a == "--threshold")
-            threshold = std::atof(need_val("--threshold").c_str());
-        else if (a == "--filter")
-            filter = need_val("--filter");
-        else if (a == "--save")
-            save_path = need_val("--save");
-        else if (a == "--baseline")
-            baseline_path = need_val("--baseline");
-        else if (a == "--check")
-            check = true;
-        else if (a == "-h" || a == "--help") {
-            print_usage(argv[0]);
-            return 0;
-        } else {
-            fprintf(stderr, "error: unknown argument '%s'\n", a.c_str());
-            print_usage(argv[0]);
-            return 2;
-        }
-    }
-    if (reps < 1)
-        reps = 1;
-
-    bench::Suite suite;
-    register_benchmarks<float>(suite, "f");
-    register_benchmarks<double>(suite, "d");
-
-    // Process-level warmup: spin doing real work for ~200 ms so the CPU reaches
-    // a steady (boosted) frequency before any measurement. Without this the
-    // first (cheapest) benchmarks are biased by the frequency ramp-up.
-    {
-        volatile double sink = 0.0;
-        double acc = 1.0;
-        auto t0 = bench::clock_type::now();
-        while (std::chrono::duration<double, std::milli>(bench::clock_type::now() - t0).count() < 200.0) {
-            for (int k = 0; k < 10000; ++k)
-                acc = acc * 1.0000001 + 1e-9;
-            sink += acc;
-        }
-        bench::do_not_optimize(sink);
-    }
-
-    printf("running vmath benchmarks (reps=%d)...\n", reps);
-    auto results = suite.run(reps, filter);
-    print_results(results);
-
-    if (!save_path.empty()) {
-        bench::save_baseline(save_path, results);
-        printf("saved baseline to %s\n", save_path.c_str());
-    }
-
-    int rc = 0;
-    if (!baseline_path.empty()) {
-        auto base = bench::load_baseline(baseline_path);
-        if (base.empty())
-            fprintf(stderr, "warning: baseline '%s' is empty or missing\n", baseline_path.c_str());
-        int regressions = compare_to_baseline(results, base, threshold);
-        if (check && regressions > 0)
-            rc = 1;
-    }
-    return rc;
+    bench::Options opt;
+    const int rc = bench::parse_options(argc, argv, opt);
+    if (rc >= 0)
+        return rc;
+
+    return bench::run_suite({[](bench::Suite &suite) {
+                                register_benchmarks<float>(suite, "f");
+                                register_benchmarks<double>(suite, "d");
+                                register_scalar_benchmarks<float>(suite, "f");
+                                register_scalar_benchmarks<math::Fixed16>(suite, "x16");
+                                register_scalar_benchmarks<math::Fixed32>(suite, "x32");
+                            }},
+                            opt);
 }
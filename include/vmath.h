@@ -26,6 +26,8 @@
 
 #include "vmath_types.h"
 
+#include <cstddef>
+
 namespace math {
 
 // /////// //
@@ -89,6 +91,37 @@ template <typename T> T det(const Matrix3<T> &mat);
 template <typename T> Matrix3<T> inverse(const Matrix3<T> &mat);
 /// linear interpolation of two matrices
 template <typename T> Matrix3<T> lerp(const Matrix3<T> &m1, const Matrix3<T> &m2, T fact);
+/// polar decomposition m = r * s, where r is orthonormal and s is symmetric positive semi-definite.
+/// r is a rotation when det(m) > 0. The input matrix must be non-singular.
+/// @param iterations number of (scaled) Newton iterations; there is no convergence test, so the cost is fixed
+template <typename T> void polar_decompose(const Matrix3<T> &m, Matrix3<T> &r, Matrix3<T> &s, int iterations = 8);
+/// QR decomposition m = q * r, where q is orthonormal and r is upper triangular with a positive diagonal.
+/// The columns of the input matrix must be linearly independent.
+template <typename T> void qr_decompose(const Matrix3<T> &m, Matrix3<T> &q, Matrix3<T> &r);
+/// eigen decomposition of a symmetric matrix, m = v * diag(eigenvalues) * transpose(v).
+/// The eigenvalues are sorted in decreasing order and the columns of v are the corresponding (unit) eigenvectors;
+/// v is always a proper rotation (det(v) = +1). Only the symmetric part of the input matrix is considered.
+/// @param sweeps number of cyclic Jacobi sweeps; there is no convergence test, so the cost is fixed
+template <typename T> void eigen_decompose(const Matrix3<T> &m, Matrix3<T> &v, Vector3<T> &eigenvalues, int sweeps = 5);
+/// singular value decomposition m = u * diag(sigma) * transpose(v), where u and v are proper rotations.
+/// The singular values are sorted by decreasing magnitude; if det(m) < 0 the last one is negative (signed SVD,
+/// as used with deformation gradients). Implements the method of McAdams et al., "Computing the Singular Value
+/// Decomposition of 3x3 matrices with minimal branching and elementary floating point operations" (2011).
+/// @param sweeps number of Jacobi sweeps on transpose(m)*m; there is no convergence test, so the cost is fixed
+template <typename T>
+void svd_decompose(const Matrix3<T> &m, Matrix3<T> &u, Vector3<T> &sigma, Matrix3<T> &v, int sweeps = 6);
+/// polar decomposition of an array of matrices (see the single matrix version)
+template <typename T>
+void polar_decompose(const Matrix3<T> *m, Matrix3<T> *r, Matrix3<T> *s, size_t count, int iterations = 8);
+/// QR decomposition of an array of matrices (see the single matrix version)
+template <typename T> void qr_decompose(const Matrix3<T> *m, Matrix3<T> *q, Matrix3<T> *r, size_t count);
+/// eigen decomposition of an array of symmetric matrices (see the single matrix version)
+template <typename T>
+void eigen_decompose(const Matrix3<T> *m, Matrix3<T> *v, Vector3<T> *eigenvalues, size_t count, int sweeps = 5);
+/// singular value decomposition of an array of matrices (see the single matrix version)
+template <typename T>
+void svd_decompose(const Matrix3<T> *m, Matrix3<T> *u, Vector3<T> *sigma, Matrix3<T> *v, size_t count,
+                   int sweeps = 6);
 
 // /////// //
 // Matrix4 //
@@ -0,0 +1,216 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace math {
+
+/// linear allocator for the temporary arrays of a frame: allocations bump a pointer in a memory block, nothing is
+/// freed individually, and reset() releases everything at once. When a block is full a new one is added; reset()
+/// then merges them into a single block of the total size, so after the first frames the allocations of a frame
+/// touch the same memory and never reach the system allocator.
+/// Not thread safe: use one arena per thread.
+class FrameArena {
+  public:
+    /// alignment of the allocations when none is given (a cache line)
+    static const size_t default_alignment = 64;
+
+    explicit FrameArena(size_t block_size = size_t(1) << 20)
+    : block_size_(block_size) {}
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    /// allocate bytes with the given alignment (a power of 2). Never returns nullptr (throws std::bad_alloc as
+    /// operator new when the system is out of memory).
+    void *allocate(size_t bytes, size_t alignment = default_alignment);
+    /// position of the arena, to release the allocations made after it with rewind()
+    struct Marker {
+        size_t block;
+        size_t offset;
+    };
+    Marker mark() const { return Marker{blocks_.size(), offset_}; }
+    /// release the allocations made after the marker, so that their memory (still in cache) is reused by the next
+    /// ones, e.g. for the temporaries of each iteration of a loop. The memory of the blocks added since the marker
+    /// is only reused after reset().
+    void rewind(const Marker &marker);
+    /// release all the allocations; the memory of the arena is kept for the next frame
+    void reset();
+    /// release all the allocations and the memory
+    void release();
+
+    /// bytes allocated since the last reset, including the alignment padding
+    size_t used() const { return used_ + offset_; }
+    /// largest used() since the construction
+    size_t peak() const { return peak_ > used() ? peak_ : used(); }
+    /// total size of the memory blocks
+    size_t capacity() const;
+    /// number of memory blocks
+    size_t block_count() const { return blocks_.size(); }
+
+  private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> memory;
+        unsigned char *begin; // first byte aligned to default_alignment
+        size_t size;
+    };
+    void add_block(size_t min_size);
+
+    std::vector<Block> blocks_;
+    size_t block_size_;
+    size_t offset_ = 0; // used bytes in the last block, where the allocations come from
+    size_t used_ = 0;   // used bytes of the blocks before the last one
+    size_t peak_ = 0;
+};
+
+/// rewinds the arena to its position at construction when going out of scope
+class ArenaScope {
+  public:
+    explicit ArenaScope(FrameArena &arena)
+    : arena_(arena)
+    , marker_(arena.mark()) {}
+    ~ArenaScope() { arena_.rewind(marker_); }
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+  private:
+    FrameArena &arena_;
+    FrameArena::Marker marker_;
+};
+
+/// standard allocator on a FrameArena, for containers of temporaries (e.g. ArenaVector<Matrix4f>) and as storage of
+/// the arrays given to the batch functions. Deallocation does nothing: the memory is released by the reset() of the
+/// arena, so the containers must not be used after it. Allocations are aligned to Alignment bytes (at least the
+/// alignment of T).
+template <typename T, size_t Alignment = FrameArena::default_alignment> class ArenaAllocator {
+  public:
+    typedef T value_type;
+    template <typename U> struct rebind {
+        typedef ArenaAllocator<U, Alignment> other;
+    };
+
+    explicit ArenaAllocator(FrameArena &arena)
+    : arena_(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U, Alignment> &other)
+    : arena_(&other.arena()) {}
+
+    T *allocate(size_t n) {
+        if (n > size_t(-1) / sizeof(T))
+            throw std::bad_alloc();
+        return static_cast<T *>(
+            arena_->allocate(n * sizeof(T), Alignment > alignof(T) ? Alignment : alignof(T)));
+    }
+    void deallocate(T *, size_t) {}
+
+    FrameArena &arena() const { return *arena_; }
+
+  private:
+    FrameArena *arena_;
+};
+
+template <typename T, typename U, size_t A>
+bool operator==(const ArenaAllocator<T, A> &a, const ArenaAllocator<U, A> &b) {
+    return &a.arena() == &b.arena();
+}
+template <typename T, typename U, size_t A>
+bool operator!=(const ArenaAllocator<T, A> &a, const ArenaAllocator<U, A> &b) {
+    return !(a == b);
+}
+
+/// vector allocated from a FrameArena: ArenaVector<Transff> v(n, ArenaAllocator<Transff>(arena)). As the memory
+/// of the previous buffer is not reused when a vector grows, reserve the size up front where possible.
+template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+inline void *FrameArena::allocate(size_t bytes, size_t alignment) {
+    if (bytes > size_t(-1) / 2)
+        throw std::bad_alloc();
+    for (;;) {
+        if (!blocks_.empty()) {
+            const Block &b = blocks_.back();
+            const uintptr_t start = reinterpret_cast<uintptr_t>(b.begin) + offset_;
+            const size_t padding = size_t((alignment - start % alignment) % alignment);
+            if (padding <= b.size - offset_ && bytes <= b.size - offset_ - padding) {
+                offset_ += padding + bytes;
+                return b.begin + (offset_ - bytes);
+            }
+            // the rest of the full block stays unused until the reset, and is not counted in used()
+            used_ += offset_;
+            offset_ = 0;
+        }
+        add_block(bytes + alignment);
+    }
+}
+
+inline void FrameArena::add_block(size_t min_size) {
+    Block b;
+    b.size = min_size > block_size_ ? min_size : block_size_;
+    b.memory.reset(new unsigned char[b.size + default_alignment]);
+    const uintptr_t p = reinterpret_cast<uintptr_t>(b.memory.get());
+    b.begin = b.memory.get() + (default_alignment - p % default_alignment) % default_alignment;
+    blocks_.push_back(std::move(b));
+}
+
+inline void FrameArena::rewind(const Marker &marker) {
+    if (marker.block == blocks_.size() && marker.offset <= offset_) {
+        peak_ = peak();
+        offset_ = marker.offset;
+    }
+}
+
+inline void FrameArena::reset() {
+    peak_ = peak();
+    if (blocks_.size() > 1) {
+        // a single block of the total size, for the next frames
+        const size_t total = capacity();
+        blocks_.clear();
+        add_block(total);
+    }
+    offset_ = 0;
+    used_ = 0;
+}
+
+inline void FrameArena::release() {
+    peak_ = peak();
+    blocks_.clear();
+    offset_ = 0;
+    used_ = 0;
+}
+
+inline size_t FrameArena::capacity() const {
+    size_t total = 0;
+    for (const auto &b : blocks_)
+        total += b.size;
+    return total;
+}
+
+} // namespace math
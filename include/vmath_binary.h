@@ -0,0 +1,609 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+#pragma once
+
+#include "vmath_types.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define VMATH_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace math {
+
+// Binary file format for arrays of vmath types, meant to be memory mapped and used in place:
+//
+//     header (64 bytes)      magic "VMATHBIN", byte order tag, version, section count, table offset and
+//                            checksum, file size
+//     section table          one 64 byte entry per section: name, element type, scalar size, layout, count,
+//                            data offset and checksum
+//     section data           each section starts at a multiple of 64 bytes. AoS sections are the plain array of
+//                            elements; SoA sections store each scalar component of the elements as a separate
+//                            array, each starting at a multiple of 64 bytes
+//
+// All the values are in the byte order of the writer. The checksums are XXH64 (seed 0) of the section table and of
+// each section data.
+
+/// version of the file format written by BinaryFileWriter; BinaryFileReader reads this version only
+const uint16_t binary_file_version = 1;
+
+/// element types of the sections
+enum class BinaryElementType : uint32_t {
+    scalar = 1,
+    vector2 = 2,
+    vector3 = 3,
+    vector4 = 4,
+    quaternion = 5,
+    matrix3 = 6,
+    matrix4 = 7,
+    transform = 8,
+};
+
+/// memory layout of a section
+enum class BinaryLayout : uint8_t {
+    aos = 0, ///< array of elements
+    soa = 1, ///< one array per scalar component
+};
+
+/// element type traits: the supported element types are float and double scalars, Vector2/3/4, Quaternion, Matrix3,
+/// Matrix4 and Transform of float and double
+template <typename V> struct BinaryElement;
+
+/// read only view of an array (e.g. a section of a mapped file)
+template <typename V> struct ConstSpan {
+    const V *ptr = nullptr;
+    size_t count = 0;
+
+    const V *data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const V *begin() const { return ptr; }
+    const V *end() const { return ptr + count; }
+    const V &operator[](size_t i) const { return ptr[i]; }
+};
+
+/// read only view of a SoA section: component k (in the memory order of the element, e.g. p.x p.y p.z q.w q.x q.y
+/// q.z for a Transform, column major for the matrices) of element i is component(k)[i]
+template <typename T> struct ConstSoaSpan {
+    const T *ptr = nullptr;
+    size_t count = 0;
+    size_t stride = 0; ///< distance in scalars between two components
+    uint32_t components = 0;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T *component(uint32_t k) const { return ptr + k * stride; }
+};
+
+/// description of a section, as stored in the section table
+struct BinarySection {
+    char name[32];           ///< nul terminated
+    BinaryElementType type;  ///< element type
+    uint8_t scalar_size;     ///< 4 (float) or 8 (double)
+    BinaryLayout layout;     ///< AoS or SoA
+    uint16_t components;     ///< scalars per element
+    uint64_t count;          ///< number of elements
+    uint64_t offset;         ///< offset of the data from the start of the file (multiple of 64)
+    uint64_t checksum;       ///< XXH64 of the data
+};
+
+/// collects arrays and writes them to a file. The arrays are not copied: they must stay valid until write().
+class BinaryFileWriter {
+  public:
+    /// add a section with count elements; the name (at most 31 characters) should be unique in the file
+    /// @return false if the name is too long or already used
+    template <typename V>
+    bool add(const std::string &name, const V *data, size_t count, BinaryLayout layout = BinaryLayout::aos);
+
+    /// write the file
+    /// @return false on I/O errors
+    bool write(const std::string &path) const;
+
+  private:
+    struct Pending {
+        BinarySection section;
+        const void *data;
+    };
+    std::vector<Pending> sections_;
+};
+
+/// maps a file written by BinaryFileWriter and gives direct access to its sections, without copies. The file
+/// stays mapped (and the spans valid) until close() or the destruction of the reader.
+class BinaryFileReader {
+  public:
+    BinaryFileReader() = default;
+    ~BinaryFileReader() { close(); }
+    BinaryFileReader(const BinaryFileReader &) = delete;
+    BinaryFileReader &operator=(const BinaryFileReader &) = delete;
+
+    /// map the file and validate its header and section table. With verify_data the checksums of all the sections
+    /// are checked as well (this reads the whole file, while the mapping alone only reads the pages that are used).
+    /// @return false if the file cannot be read, is not a valid file of this version, was written with a different
+    /// byte order or is corrupted; error() gives the reason
+    bool open(const std::string &path, bool verify_data = true);
+    void close();
+    const std::string &error() const { return error_; }
+
+    size_t section_count() const { return sections_.size(); }
+    const BinarySection &section(size_t i) const { return sections_[i]; }
+    /// index of the section with the given name, or -1
+    int find(const std::string &name) const;
+    /// check the checksum of a section (e.g. before using it, when the file was opened without verify_data)
+    bool verify(size_t i) const;
+
+    /// AoS section with the given name and element type V; empty if there is no such section
+    template <typename V> ConstSpan<V> aos(const std::string &name) const;
+    /// SoA section with the given name and element type V; empty if there is no such section
+    template <typename V> ConstSoaSpan<typename BinaryElement<V>::scalar_type> soa(const std::string &name) const;
+
+  private:
+    bool fail(const std::string &message);
+    const BinarySection *find_section(const std::string &name, BinaryElementType type, size_t scalar_size,
+                                      BinaryLayout layout) const;
+
+    const unsigned char *data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<uint64_t> buffer_; // file contents when memory mapping is not available
+    std::vector<BinarySection> sections_;
+    std::string error_;
+};
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+template <typename T, BinaryElementType element_type, uint16_t count> struct BinaryElementTraits {
+    typedef T scalar_type;
+    static const uint16_t n = count;
+    static BinaryElementType type() { return element_type; }
+    static uint16_t components() { return n; }
+};
+} // namespace detail
+
+template <> struct BinaryElement<float> : detail::BinaryElementTraits<float, BinaryElementType::scalar, 1> {};
+template <> struct BinaryElement<double> : detail::BinaryElementTraits<double, BinaryElementType::scalar, 1> {};
+template <typename T>
+struct BinaryElement<Vector2<T>> : detail::BinaryElementTraits<T, BinaryElementType::vector2, 2> {};
+template <typename T>
+struct BinaryElement<Vector3<T>> : detail::BinaryElementTraits<T, BinaryElementType::vector3, 3> {};
+template <typename T>
+struct BinaryElement<Vector4<T>> : detail::BinaryElementTraits<T, BinaryElementType::vector4, 4> {};
+template <typename T>
+struct BinaryElement<Quaternion<T>> : detail::BinaryElementTraits<T, BinaryElementType::quaternion, 4> {};
+template <typename T>
+struct BinaryElement<Matrix3<T>> : detail::BinaryElementTraits<T, BinaryElementType::matrix3, 9> {};
+template <typename T>
+struct BinaryElement<Matrix4<T>> : detail::BinaryElementTraits<T, BinaryElementType::matrix4, 16> {};
+template <typename T>
+struct BinaryElement<Transform<T>> : detail::BinaryElementTraits<T, BinaryElementType::transform, 7> {};
+
+namespace detail {
+
+struct BinaryFileHeader {
+    char magic[8];
+    uint32_t byte_order;      // binary_byte_order in the byte order of the writer
+    uint16_t version;
+    uint16_t header_size;
+    uint64_t section_count;
+    uint64_t table_offset;
+    uint64_t table_checksum;
+    uint64_t file_size;
+    uint8_t reserved[16];
+};
+
+const char binary_magic[8] = {'V', 'M', 'A', 'T', 'H', 'B', 'I', 'N'};
+const uint32_t binary_byte_order = 0x01020304u;
+const size_t binary_alignment = 64;
+
+static_assert(sizeof(BinaryFileHeader) == 64, "unexpected padding in the file header");
+static_assert(sizeof(BinarySection) == 64, "unexpected padding in the section table");
+
+inline uint64_t align_up(uint64_t v, uint64_t a) { return (v + a - 1) / a * a; }
+
+// scalars per element of each element type (0 for the unknown types)
+inline uint32_t binary_components(BinaryElementType type) {
+    switch (type) {
+    case BinaryElementType::scalar:
+        return 1;
+    case BinaryElementType::vector2:
+        return 2;
+    case BinaryElementType::vector3:
+        return 3;
+    case BinaryElementType::vector4:
+    case BinaryElementType::quaternion:
+        return 4;
+    case BinaryElementType::matrix3:
+        return 9;
+    case BinaryElementType::matrix4:
+        return 16;
+    case BinaryElementType::transform:
+        return 7;
+    }
+    return 0;
+}
+
+inline uint64_t section_bytes(const BinarySection &s) {
+    const uint64_t array = s.count * s.scalar_size;
+    return s.layout == BinaryLayout::aos ? array * s.components
+                                         : align_up(array, binary_alignment) * (s.components - 1) + array;
+}
+
+// XXH64 (Y. Collet), streaming version
+class Hash64 {
+  public:
+    void update(const void *data, size_t len) {
+        if (len == 0)
+            return; // data can be null (empty arrays)
+        const unsigned char *p = static_cast<const unsigned char *>(data);
+        total_ += len;
+        if (buffered_ > 0) {
+            const size_t n = std::min(len, sizeof(buffer_) - buffered_);
+            std::memcpy(buffer_ + buffered_, p, n);
+            buffered_ += n;
+            p += n;
+            len -= n;
+            if (buffered_ < sizeof(buffer_))
+                return;
+            stripe(buffer_);
+            buffered_ = 0;
+        }
+        for (; len >= 32; p += 32, len -= 32)
+            stripe(p);
+        std::memcpy(buffer_, p, len);
+        buffered_ = len;
+    }
+
+    uint64_t digest() const {
+        uint64_t h;
+        if (total_ >= 32) {
+            h = rotl(v_[0], 1) + rotl(v_[1], 7) + rotl(v_[2], 12) + rotl(v_[3], 18);
+            for (int i = 0; i < 4; i++)
+                h = (h ^ round(0, v_[i])) * p1 + p4;
+        } else {
+            h = p5;
+        }
+        h += total_;
+        const unsigned char *p = buffer_;
+        size_t len = buffered_;
+        for (; len >= 8; p += 8, len -= 8)
+            h = rotl(h ^ round(0, read64(p)), 27) * p1 + p4;
+        if (len >= 4) {
+            h = rotl(h ^ (uint64_t(read32(p)) * p1), 23) * p2 + p3;
+            p += 4;
+            len -= 4;
+        }
+        for (; len > 0; p++, len--)
+            h = rotl(h ^ (*p * p5), 11) * p1;
+        h ^= h >> 33;
+        h *= p2;
+        h ^= h >> 29;
+        h *= p3;
+        h ^= h >> 32;
+        return h;
+    }
+
+  private:
+    static const uint64_t p1 = 11400714785074694791ull, p2 = 14029467366897019727ull, p3 = 1609587929392839161ull,
+                          p4 = 9650029242287828579ull, p5 = 2870177450012600261ull;
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+    static uint64_t round(uint64_t acc, uint64_t input) { return rotl(acc + input * p2, 31) * p1; }
+    // the checksums are defined on little endian values, whatever the byte order of the file
+    static uint64_t read64(const unsigned char *p) {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; i--)
+            v = v << 8 | p[i];
+        return v;
+    }
+    static uint32_t read32(const unsigned char *p) {
+        return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+    }
+    void stripe(const unsigned char *p) {
+        for (int i = 0; i < 4; i++)
+            v_[i] = round(v_[i], read64(p + 8 * i));
+    }
+
+    uint64_t v_[4] = {p1 + p2, p2, 0, 0 - p1};
+    uint64_t total_ = 0;
+    unsigned char buffer_[32];
+    size_t buffered_ = 0;
+};
+
+inline uint64_t hash64(const void *data, size_t len) {
+    Hash64 h;
+    h.update(data, len);
+    return h.digest();
+}
+
+// writes to a file, hashing the data of the current section
+class BinaryOutput {
+  public:
+    explicit BinaryOutput(std::FILE *f)
+    : f_(f) {}
+    void write(const void *data, size_t len) {
+        ok_ = ok_ && (len == 0 || std::fwrite(data, 1, len, f_) == len);
+        hash_.update(data, len);
+        pos_ += len;
+    }
+    void pad_to(uint64_t offset) {
+        static const unsigned char zeros[binary_alignment] = {};
+        while (pos_ < offset)
+            write(zeros, size_t(std::min<uint64_t>(offset - pos_, sizeof(zeros))));
+    }
+    void start_section() { hash_ = Hash64(); }
+    uint64_t checksum() const { return hash_.digest(); }
+    bool ok() const { return ok_; }
+
+  private:
+    std::FILE *f_;
+    Hash64 hash_;
+    uint64_t pos_ = 0;
+    bool ok_ = true;
+};
+
+} // namespace detail
+
+template <typename V>
+bool BinaryFileWriter::add(const std::string &name, const V *data, size_t count, BinaryLayout layout) {
+    typedef typename BinaryElement<V>::scalar_type T;
+    static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value, "float or double elements only");
+    static_assert(sizeof(V) == sizeof(T) * BinaryElement<V>::n, "unexpected padding in the element type");
+    if (name.size() >= sizeof(BinarySection::name))
+        return false;
+    for (const auto &s : sections_)
+        if (name == s.section.name)
+            return false;
+    Pending p;
+    std::memset(&p.section, 0, sizeof(p.section));
+    std::memcpy(p.section.name, name.c_str(), name.size());
+    p.section.type = BinaryElement<V>::type();
+    p.section.scalar_size = uint8_t(sizeof(T));
+    p.section.layout = layout;
+    p.section.components = BinaryElement<V>::components();
+    p.section.count = count;
+    p.data = data;
+    sections_.push_back(p);
+    return true;
+}
+
+inline bool BinaryFileWriter::write(const std::string &path) const {
+    using namespace detail;
+    // layout of the file
+    std::vector<BinarySection> table(sections_.size());
+    uint64_t offset = align_up(sizeof(BinaryFileHeader) + table.size() * sizeof(BinarySection), binary_alignment);
+    for (size_t i = 0; i < table.size(); i++) {
+        table[i] = sections_[i].section;
+        table[i].offset = offset;
+        offset = align_up(offset + section_bytes(table[i]), binary_alignment);
+    }
+    const uint64_t file_size = table.empty() ? sizeof(BinaryFileHeader)
+                                             : table.back().offset + section_bytes(table.back());
+
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+    BinaryOutput out(f);
+    // header and table go first with placeholder checksums, and are rewritten at the end
+    BinaryFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    out.write(&header, sizeof(header));
+    out.write(table.data(), table.size() * sizeof(BinarySection));
+    std::vector<unsigned char> buffer;
+    for (size_t i = 0; i < table.size(); i++) {
+        const BinarySection &s = table[i];
+        const unsigned char *src = static_cast<const unsigned char *>(sections_[i].data);
+        const size_t element = size_t(s.scalar_size) * s.components;
+        out.pad_to(s.offset);
+        out.start_section();
+        if (s.layout == BinaryLayout::aos) {
+            out.write(src, size_t(s.count) * element);
+        } else {
+            // gather each component in blocks
+            const size_t block = 4096;
+            buffer.resize(block * s.scalar_size);
+            for (uint32_t k = 0; k < s.components; k++) {
+                if (k > 0)
+                    out.pad_to(s.offset + k * align_up(s.count * s.scalar_size, binary_alignment));
+                for (size_t b = 0; b < s.count; b += block) {
+                    const size_t n = std::min<size_t>(block, size_t(s.count) - b);
+                    for (size_t j = 0; j < n; j++)
+                        std::memcpy(&buffer[j * s.scalar_size], src + (b + j) * element + k * s.scalar_size,
+                                    s.scalar_size);
+                    out.write(buffer.data(), n * s.scalar_size);
+                }
+            }
+        }
+        table[i].checksum = out.checksum();
+    }
+    out.pad_to(file_size);
+
+    std::memcpy(header.magic, binary_magic, sizeof(header.magic));
+    header.byte_order = binary_byte_order;
+    header.version = binary_file_version;
+    header.header_size = uint16_t(sizeof(BinaryFileHeader));
+    header.section_count = table.size();
+    header.table_offset = sizeof(BinaryFileHeader);
+    header.table_checksum = hash64(table.data(), table.size() * sizeof(BinarySection));
+    header.file_size = file_size;
+    bool ok = out.ok() && std::fseek(f, 0, SEEK_SET) == 0 &&
+              std::fwrite(&header, sizeof(header), 1, f) == 1 &&
+              (table.empty() || std::fwrite(table.data(), table.size() * sizeof(BinarySection), 1, f) == 1);
+    ok = std::fclose(f) == 0 && ok;
+    return ok;
+}
+
+inline bool BinaryFileReader::fail(const std::string &message) {
+    close();
+    error_ = message;
+    return false;
+}
+
+inline bool BinaryFileReader::open(const std::string &path, bool verify_data) {
+    using namespace detail;
+    close();
+    error_.clear();
+#if defined(VMATH_MMAP)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return fail("cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return fail("cannot read " + path);
+    }
+    void *p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        return fail("cannot map " + path);
+    data_ = static_cast<const unsigned char *>(p);
+    size_ = size_t(st.st_size);
+    mapped_ = true;
+#else
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return fail("cannot open " + path);
+    std::fseek(f, 0, SEEK_END);
+    const long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (size <= 0) {
+        std::fclose(f);
+        return fail("cannot read " + path);
+    }
+    // start of the file at a multiple of 64 bytes in memory, as with mmap
+    buffer_.resize((size_t(size) + 2 * binary_alignment - 1) / 8);
+    unsigned char *aligned = reinterpret_cast<unsigned char *>(
+        align_up(reinterpret_cast<uintptr_t>(buffer_.data()), binary_alignment));
+    const bool read = std::fread(aligned, 1, size_t(size), f) == size_t(size);
+    std::fclose(f);
+    if (!read)
+        return fail("cannot read " + path);
+    data_ = aligned;
+    size_ = size_t(size);
+#endif
+
+    BinaryFileHeader header;
+    if (size_ < sizeof(header))
+        return fail("file too small");
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, binary_magic, sizeof(binary_magic)) != 0)
+        return fail("not a vmath binary file");
+    if (header.byte_order != binary_byte_order)
+        return fail("file written with a different byte order");
+    if (header.version != binary_file_version)
+        return fail("unsupported file version " + std::to_string(header.version));
+    if (header.header_size != sizeof(header) || header.file_size > size_ ||
+        header.table_offset < sizeof(header) || header.table_offset > header.file_size ||
+        header.section_count > (header.file_size - header.table_offset) / sizeof(BinarySection))
+        return fail("invalid file header");
+    if (hash64(data_ + header.table_offset, size_t(header.section_count) * sizeof(BinarySection)) !=
+        header.table_checksum)
+        return fail("corrupted section table");
+    sections_.resize(size_t(header.section_count));
+    std::memcpy(sections_.data(), data_ + header.table_offset, sections_.size() * sizeof(BinarySection));
+    for (size_t i = 0; i < sections_.size(); i++) {
+        const BinarySection &s = sections_[i];
+        // the components must match the type tag: aos() and soa() trust them to size the elements
+        if ((s.scalar_size != 4 && s.scalar_size != 8) || s.components != binary_components(s.type) ||
+            s.offset % binary_alignment != 0 || s.name[sizeof(s.name) - 1] != 0 ||
+            (s.layout != BinaryLayout::aos && s.layout != BinaryLayout::soa) || s.count > header.file_size ||
+            s.offset > header.file_size || section_bytes(s) > header.file_size - s.offset)
+            return fail("invalid section " + std::to_string(i));
+        if (verify_data && !verify(i))
+            return fail("corrupted section " + std::string(s.name));
+    }
+    return true;
+}
+
+inline void BinaryFileReader::close() {
+#if defined(VMATH_MMAP)
+    if (mapped_)
+        munmap(const_cast<unsigned char *>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    buffer_.clear();
+    sections_.clear();
+}
+
+inline int BinaryFileReader::find(const std::string &name) const {
+    for (size_t i = 0; i < sections_.size(); i++)
+        if (name == sections_[i].name)
+            return int(i);
+    return -1;
+}
+
+inline bool BinaryFileReader::verify(size_t i) const {
+    // for SoA sections the padding between the components is part of the checksum
+    const BinarySection &s = sections_[i];
+    return detail::hash64(data_ + s.offset, size_t(detail::section_bytes(s))) == s.checksum;
+}
+
+inline const BinarySection *BinaryFileReader::find_section(const std::string &name, BinaryElementType type,
+                                                           size_t scalar_size, BinaryLayout layout) const {
+    const int i = find(name);
+    if (i < 0)
+        return nullptr;
+    const BinarySection &s = sections_[size_t(i)];
+    return s.type == type && s.scalar_size == scalar_size && s.layout == layout ? &s : nullptr;
+}
+
+template <typename V> ConstSpan<V> BinaryFileReader::aos(const std::string &name) const {
+    typedef BinaryElement<V> E;
+    ConstSpan<V> span;
+    if (const BinarySection *s = find_section(name, E::type(), sizeof(typename E::scalar_type), BinaryLayout::aos)) {
+        span.ptr = reinterpret_cast<const V *>(data_ + s->offset);
+        span.count = size_t(s->count);
+    }
+    return span;
+}
+
+template <typename V>
+ConstSoaSpan<typename BinaryElement<V>::scalar_type> BinaryFileReader::soa(const std::string &name) const {
+    typedef BinaryElement<V> E;
+    typedef typename E::scalar_type T;
+    ConstSoaSpan<T> span;
+    if (const BinarySection *s = find_section(name, E::type(), sizeof(T), BinaryLayout::soa)) {
+        span.ptr = reinterpret_cast<const T *>(data_ + s->offset);
+        span.count = size_t(s->count);
+        span.stride = size_t(detail::align_up(s->count * sizeof(T), detail::binary_alignment) / sizeof(T));
+        span.components = s->components;
+    }
+    return span;
+}
+
+} // namespace math
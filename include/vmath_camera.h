@@ -0,0 +1,191 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+#pragma once
+
+#include "vmath.h"
+#include "vmath_parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace math {
+
+/// primary ray generation set up of a camera, for a width x height image. The pixel (px, py) (continuous
+/// coordinates: the pixel (i, j) covers [i, i + 1) x [j, j + 1), row 0 at the top) is unprojected to the near and
+/// far planes in homogeneous coordinates as near_plane + px * step_x + py * step_y (and likewise for far_plane),
+/// which replaces the inverse view projection matrix product of each pixel with two multiply-adds per component.
+struct CameraRays {
+    Vector4f step_x;     ///< change of the homogeneous near and far points per pixel along x
+    Vector4f step_y;     ///< change of the homogeneous near and far points per pixel along y
+    Vector4f near_plane; ///< homogeneous point on the near plane of the pixel (0, 0)
+    Vector4f far_plane;  ///< homogeneous point on the far plane of the pixel (0, 0)
+};
+
+/// set up the rays of a camera from its view projection matrix (projection * view, OpenGL clip space conventions).
+/// The matrix is inverted in double.
+CameraRays camera_rays(const Matrix4f &view_projection, uint32_t width, uint32_t height);
+/// set up the rays of a camera from the inverse of its view projection matrix
+CameraRays camera_rays_from_inverse(const Matrix4f &inverse_view_projection, uint32_t width, uint32_t height);
+
+/// output rays, one array per component (structure of arrays). The origin pointers can be null (e.g. for a
+/// pinhole camera, whose rays all start at the eye).
+struct RayArrays {
+    float *ox = nullptr, *oy = nullptr, *oz = nullptr; ///< origins, on the near plane
+    float *dx = nullptr, *dy = nullptr, *dz = nullptr; ///< unit directions
+};
+
+/// generate the primary rays of the tile of tile_width x tile_height pixels starting at the pixel (x0, y0). The ray
+/// of the pixel (x0 + i, y0 + j) is written at the index j * tile_width + i of the arrays and goes through the point
+/// (x0 + i + jitter.x, y0 + j + jitter.y), where jitter = jitter[(j * tile_width + i) % jitter_count] (offsets in
+/// [0, 1) from a sampling sequence), or the pixel center if jitter is null. 4 pixels are processed at a time with
+/// SSE2; the rows of large tiles are split over threads (0 = hardware threads).
+void generate_rays(const CameraRays &camera, uint32_t x0, uint32_t y0, uint32_t tile_width, uint32_t tile_height,
+                   const Vector2f *jitter, size_t jitter_count, const RayArrays &out, unsigned threads = 0);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+inline CameraRays camera_rays_from_inverse(const Matrix4f &inverse_view_projection, uint32_t width,
+                                           uint32_t height) {
+    // ndc x = 2 px / width - 1, ndc y = 1 - 2 py / height, ndc z = -1 (near) or 1 (far)
+    const float *m = inverse_view_projection.data;
+    const float sx = 2.f / float(width), sy = -2.f / float(height);
+    CameraRays c;
+    c.step_x = Vector4f(m[0] * sx, m[1] * sx, m[2] * sx, m[3] * sx);
+    c.step_y = Vector4f(m[4] * sy, m[5] * sy, m[6] * sy, m[7] * sy);
+    const Vector4f base(m[12] - m[0] + m[4], m[13] - m[1] + m[5], m[14] - m[2] + m[6], m[15] - m[3] + m[7]);
+    const Vector4f z(m[8], m[9], m[10], m[11]);
+    c.near_plane = base - z;
+    c.far_plane = base + z;
+    return c;
+}
+
+inline CameraRays camera_rays(const Matrix4f &view_projection, uint32_t width, uint32_t height) {
+    return camera_rays_from_inverse(Matrix4f(inverse(Matrix4d(view_projection))), width, height);
+}
+
+namespace detail {
+
+inline void generate_ray(const CameraRays &c, float px, float py, const RayArrays &out, size_t i) {
+    const float nx = c.near_plane.x + px * c.step_x.x + py * c.step_y.x;
+    const float ny = c.near_plane.y + px * c.step_x.y + py * c.step_y.y;
+    const float nz = c.near_plane.z + px * c.step_x.z + py * c.step_y.z;
+    const float nw = c.near_plane.w + px * c.step_x.w + py * c.step_y.w;
+    const float fx = c.far_plane.x + px * c.step_x.x + py * c.step_y.x;
+    const float fy = c.far_plane.y + px * c.step_x.y + py * c.step_y.y;
+    const float fz = c.far_plane.z + px * c.step_x.z + py * c.step_y.z;
+    const float fw = c.far_plane.w + px * c.step_x.w + py * c.step_y.w;
+    const float inw = 1.f / nw, ifw = 1.f / fw;
+    const float ox = nx * inw, oy = ny * inw, oz = nz * inw;
+    const float dx = fx * ifw - ox, dy = fy * ifw - oy, dz = fz * ifw - oz;
+    const float il = 1.f / std::sqrt(dx * dx + dy * dy + dz * dz);
+    if (out.ox) {
+        out.ox[i] = ox;
+        out.oy[i] = oy;
+        out.oz[i] = oz;
+    }
+    out.dx[i] = dx * il;
+    out.dy[i] = dy * il;
+    out.dz[i] = dz * il;
+}
+
+inline void generate_row(const CameraRays &c, float x0, float py, uint32_t width, const Vector2f *jitter,
+                         size_t jitter_count, size_t first, const RayArrays &out) {
+    uint32_t i = 0;
+#if defined(VMATH_SSE2)
+    // the camera is broadcast once per row (the output stores could alias it otherwise), with the row folded in
+    const Vector4f near_row = c.near_plane + c.step_y * py, far_row = c.far_plane + c.step_y * py;
+    const __m128 sx[4] = {_mm_set1_ps(c.step_x.x), _mm_set1_ps(c.step_x.y), _mm_set1_ps(c.step_x.z),
+                          _mm_set1_ps(c.step_x.w)};
+    const __m128 sy[4] = {_mm_set1_ps(c.step_y.x), _mm_set1_ps(c.step_y.y), _mm_set1_ps(c.step_y.z),
+                          _mm_set1_ps(c.step_y.w)};
+    const __m128 n0[4] = {_mm_set1_ps(near_row.x), _mm_set1_ps(near_row.y), _mm_set1_ps(near_row.z),
+                          _mm_set1_ps(near_row.w)};
+    const __m128 f0[4] = {_mm_set1_ps(far_row.x), _mm_set1_ps(far_row.y), _mm_set1_ps(far_row.z),
+                          _mm_set1_ps(far_row.w)};
+    const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f), half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.f);
+    for (; i + 4 <= width; i += 4) {
+        __m128 px, jy;
+        if (jitter) {
+            float jx4[4], jy4[4];
+            for (int k = 0; k < 4; k++) {
+                const Vector2f &j = jitter[(first + i + size_t(k)) % jitter_count];
+                jx4[k] = j.x;
+                jy4[k] = j.y;
+            }
+            px = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(x0 + float(i)), half), _mm_add_ps(offsets, _mm_loadu_ps(jx4)));
+            jy = _mm_loadu_ps(jy4);
+        } else {
+            px = _mm_add_ps(_mm_set1_ps(x0 + float(i)), offsets);
+            jy = half;
+        }
+        auto point = [&](const __m128 *base, int k) {
+            return _mm_add_ps(_mm_add_ps(base[k], _mm_mul_ps(px, sx[k])), _mm_mul_ps(jy, sy[k]));
+        };
+        const __m128 inw = _mm_div_ps(one, point(n0, 3)), ifw = _mm_div_ps(one, point(f0, 3));
+        const __m128 ox = _mm_mul_ps(point(n0, 0), inw);
+        const __m128 oy = _mm_mul_ps(point(n0, 1), inw);
+        const __m128 oz = _mm_mul_ps(point(n0, 2), inw);
+        const __m128 dx = _mm_sub_ps(_mm_mul_ps(point(f0, 0), ifw), ox);
+        const __m128 dy = _mm_sub_ps(_mm_mul_ps(point(f0, 1), ifw), oy);
+        const __m128 dz = _mm_sub_ps(_mm_mul_ps(point(f0, 2), ifw), oz);
+        const __m128 il = _mm_div_ps(
+            one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz))));
+        const size_t k = first + i;
+        if (out.ox) {
+            _mm_storeu_ps(out.ox + k, ox);
+            _mm_storeu_ps(out.oy + k, oy);
+            _mm_storeu_ps(out.oz + k, oz);
+        }
+        _mm_storeu_ps(out.dx + k, _mm_mul_ps(dx, il));
+        _mm_storeu_ps(out.dy + k, _mm_mul_ps(dy, il));
+        _mm_storeu_ps(out.dz + k, _mm_mul_ps(dz, il));
+    }
+#endif
+    for (; i < width; i++) {
+        const size_t k = first + i;
+        const Vector2f j = jitter ? jitter[k % jitter_count] : Vector2f(0.5f, 0.5f);
+        generate_ray(c, x0 + float(i) + j.x, py + j.y, out, k);
+    }
+}
+
+} // namespace detail
+
+inline void generate_rays(const CameraRays &camera, uint32_t x0, uint32_t y0, uint32_t tile_width,
+                          uint32_t tile_height, const Vector2f *jitter, size_t jitter_count, const RayArrays &out,
+                          unsigned threads) {
+    if (jitter_count == 0)
+        jitter = nullptr;
+    const size_t min_rows = std::max<size_t>(1, 16384 / std::max<uint32_t>(1, tile_width));
+    parallel_for(tile_height, threads, min_rows, [&](size_t, size_t begin, size_t end) {
+        for (size_t j = begin; j < end; j++)
+            detail::generate_row(camera, float(x0), float(y0 + j), tile_width, jitter, jitter_count,
+                                 j * tile_width, out);
+    });
+}
+
+} // namespace math
@@ -0,0 +1,244 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+#pragma once
+
+#include "vmath_parallel.h"
+#include "vmath_simd_detail.h"
+#include "vmath_types.h"
+
+#include <cstddef>
+
+// AVX (4 doubles per conversion) and AVX-512F (8 per conversion) are used when the compiler targets them (e.g.
+// -mavx, -mavx512f or -march=native, detected in vmath_simd_detail.h); the SSE2 kernels are the fallback. All the
+// paths give the same results as the converting constructors of the types.
+
+namespace math {
+
+/// bulk conversion of count doubles to float (round to nearest). Large arrays are split over threads (0 = hardware
+/// threads).
+void convert(const double *src, float *dst, size_t count, unsigned threads = 0);
+
+/// bulk conversion of count vectors, quaternions or matrices from double to float (e.g. Vector3d -> Vector3f,
+/// Matrix4d -> Matrix4f)
+template <template <typename> class V>
+void convert(const V<double> *src, V<float> *dst, size_t count, unsigned threads = 0);
+
+/// bulk conversion of count points from double to float, relative to an origin: dst[i] = Vector3f(src[i] - origin).
+/// The subtraction is done in double, so the points near the origin (e.g. the camera of a large world) keep
+/// their precision in float.
+void convert_relative(const Vector3d *src, const Vector3d &origin, Vector3f *dst, size_t count,
+                      unsigned threads = 0);
+
+/// bulk conversion of count rigid transforms from double to float, with the translations relative to origin
+void convert_relative(const Transfd *src, const Vector3d &origin, Transff *dst, size_t count, unsigned threads = 0);
+
+/// relative to eye model matrix: translate(-eye) * m, computed in double and converted to float. The translation
+/// that remains is small for the objects near the eye, so the float matrix keeps their precision; use it with the
+/// matrix returned by view_relative_to_eye() for the same eye.
+Matrix4f relative_to_eye(const Matrix4d &m, const Vector3d &eye);
+
+/// bulk version of relative_to_eye() for count matrices
+void relative_to_eye(const Matrix4d *src, const Vector3d &eye, Matrix4f *dst, size_t count, unsigned threads = 0);
+
+/// relative to eye view matrix: view * translate(eye), computed in double and converted to float. For a view
+/// matrix looking from eye its translation is (about) zero, and
+/// view_relative_to_eye(view, eye) * relative_to_eye(model, eye) == view * model up to the float rounding of the
+/// two factors, without the cancellation of the large translations in float.
+Matrix4f view_relative_to_eye(const Matrix4d &view, const Vector3d &eye);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+#if defined(VMATH_AVX512F)
+// zero-masked form with all the lanes enabled: same instruction, without the spurious maybe-uninitialized warning
+// of the unmasked intrinsic in some gcc versions
+inline __m256 cvtpd_ps_avx512(__m512d v) { return _mm512_maskz_cvtpd_ps(__mmask8(0xff), v); }
+#endif
+
+inline void convert_range(const double *src, float *dst, size_t count) {
+    size_t i = 0;
+#if defined(VMATH_AVX512F)
+    for (; i + 16 <= count; i += 16) {
+        _mm256_storeu_ps(dst + i, cvtpd_ps_avx512(_mm512_loadu_pd(src + i)));
+        _mm256_storeu_ps(dst + i + 8, cvtpd_ps_avx512(_mm512_loadu_pd(src + i + 8)));
+    }
+#endif
+#if defined(VMATH_AVX)
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_loadu_pd(src + i)));
+        _mm_storeu_ps(dst + i + 4, _mm256_cvtpd_ps(_mm256_loadu_pd(src + i + 4)));
+    }
+#endif
+#if defined(VMATH_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+        const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+        _mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = float(src[i]);
+}
+
+// count points (3 scalars each), minus origin. The origin is repeated with a period of 3 lanes over the vectors
+inline void convert_relative_range(const double *src, const double origin[3], float *dst, size_t count) {
+    const double ox = origin[0], oy = origin[1], oz = origin[2];
+    size_t i = 0;
+#if defined(VMATH_AVX512F)
+    {
+        const __m512d o0 = _mm512_setr_pd(ox, oy, oz, ox, oy, oz, ox, oy);
+        const __m512d o1 = _mm512_setr_pd(oz, ox, oy, oz, ox, oy, oz, ox);
+        const __m512d o2 = _mm512_setr_pd(oy, oz, ox, oy, oz, ox, oy, oz);
+        for (; i + 8 <= count; i += 8) {
+            const double *s = src + 3 * i;
+            float *d = dst + 3 * i;
+            _mm256_storeu_ps(d, cvtpd_ps_avx512(_mm512_sub_pd(_mm512_loadu_pd(s), o0)));
+            _mm256_storeu_ps(d + 8, cvtpd_ps_avx512(_mm512_sub_pd(_mm512_loadu_pd(s + 8), o1)));
+            _mm256_storeu_ps(d + 16, cvtpd_ps_avx512(_mm512_sub_pd(_mm512_loadu_pd(s + 16), o2)));
+        }
+    }
+#endif
+#if defined(VMATH_AVX)
+    {
+        const __m256d o0 = _mm256_setr_pd(ox, oy, oz, ox);
+        const __m256d o1 = _mm256_setr_pd(oy, oz, ox, oy);
+        const __m256d o2 = _mm256_setr_pd(oz, ox, oy, oz);
+        for (; i + 4 <= count; i += 4) {
+            const double *s = src + 3 * i;
+            float *d = dst + 3 * i;
+            _mm_storeu_ps(d, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(s), o0)));
+            _mm_storeu_ps(d + 4, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(s + 4), o1)));
+            _mm_storeu_ps(d + 8, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(s + 8), o2)));
+        }
+    }
+#endif
+#if defined(VMATH_SSE2)
+    {
+        const __m128d o0 = _mm_setr_pd(ox, oy);
+        const __m128d o1 = _mm_setr_pd(oz, ox);
+        const __m128d o2 = _mm_setr_pd(oy, oz);
+        for (; i + 2 <= count; i += 2) {
+            const double *s = src + 3 * i;
+            float *d = dst + 3 * i;
+            const __m128 a = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s), o0));
+            const __m128 b = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 2), o1));
+            const __m128 c = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 4), o2));
+            _mm_storeu_ps(d, _mm_movelh_ps(a, b));
+            _mm_storel_pi(reinterpret_cast<__m64 *>(d + 4), c);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        dst[3 * i + 0] = float(src[3 * i + 0] - ox);
+        dst[3 * i + 1] = float(src[3 * i + 1] - oy);
+        dst[3 * i + 2] = float(src[3 * i + 2] - oz);
+    }
+}
+
+// rows 0-2 minus eye times row 3 (which is 0 0 0 1 for affine matrices), converted to float
+inline void relative_to_eye(const Matrix4d &m, const Vector3d &eye, float *out) {
+#if defined(VMATH_SSE2)
+    const __m128d exy = _mm_setr_pd(eye.x, eye.y);
+    const __m128d ez0 = _mm_setr_pd(eye.z, 0.0);
+    for (int c = 0; c < 4; c++) {
+        const __m128d lo = _mm_loadu_pd(m.data + c * 4);
+        const __m128d hi = _mm_loadu_pd(m.data + c * 4 + 2);
+        const __m128d w = _mm_unpackhi_pd(hi, hi);
+        const __m128 xy = _mm_cvtpd_ps(_mm_sub_pd(lo, _mm_mul_pd(exy, w)));
+        const __m128 zw = _mm_cvtpd_ps(_mm_sub_pd(hi, _mm_mul_pd(ez0, w)));
+        _mm_storeu_ps(out + c * 4, _mm_movelh_ps(xy, zw));
+    }
+#else
+    for (int c = 0; c < 4; c++) {
+        const double w = m.data[c * 4 + 3];
+        out[c * 4 + 0] = float(m.data[c * 4 + 0] - eye.x * w);
+        out[c * 4 + 1] = float(m.data[c * 4 + 1] - eye.y * w);
+        out[c * 4 + 2] = float(m.data[c * 4 + 2] - eye.z * w);
+        out[c * 4 + 3] = float(w);
+    }
+#endif
+}
+
+} // namespace detail
+
+inline void convert(const double *src, float *dst, size_t count, unsigned threads) {
+    parallel_for(count, threads, size_t(1) << 18, [&](size_t, size_t begin, size_t end) {
+        detail::convert_range(src + begin, dst + begin, end - begin);
+    });
+}
+
+template <template <typename> class V>
+void convert(const V<double> *src, V<float> *dst, size_t count, unsigned threads) {
+    const size_t n = sizeof(V<float>) / sizeof(float);
+    static_assert(sizeof(V<float>) == n * sizeof(float) && sizeof(V<double>) == n * sizeof(double),
+                  "convert() needs types made of float/double components only");
+    convert(reinterpret_cast<const double *>(src), reinterpret_cast<float *>(dst), count * n, threads);
+}
+
+inline void convert_relative(const Vector3d *src, const Vector3d &origin, Vector3f *dst, size_t count,
+                             unsigned threads) {
+    static_assert(sizeof(Vector3d) == 3 * sizeof(double) && sizeof(Vector3f) == 3 * sizeof(float),
+                  "packed vectors expected");
+    const double o[3] = {origin.x, origin.y, origin.z};
+    parallel_for(count, threads, size_t(1) << 16, [&](size_t, size_t begin, size_t end) {
+        detail::convert_relative_range(&src[begin].x, o, &dst[begin].x, end - begin);
+    });
+}
+
+inline void convert_relative(const Transfd *src, const Vector3d &origin, Transff *dst, size_t count,
+                             unsigned threads) {
+    parallel_for(count, threads, size_t(1) << 16, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            dst[i].p = Vector3f(src[i].p - origin);
+            dst[i].q = Quatf(src[i].q);
+        }
+    });
+}
+
+inline Matrix4f relative_to_eye(const Matrix4d &m, const Vector3d &eye) {
+    Matrix4f out;
+    detail::relative_to_eye(m, eye, out.data);
+    return out;
+}
+
+inline void relative_to_eye(const Matrix4d *src, const Vector3d &eye, Matrix4f *dst, size_t count,
+                            unsigned threads) {
+    parallel_for(count, threads, size_t(1) << 14, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            detail::relative_to_eye(src[i], eye, dst[i].data);
+    });
+}
+
+inline Matrix4f view_relative_to_eye(const Matrix4d &view, const Vector3d &eye) {
+    Matrix4d v = view;
+    // last column: view * (eye, 1)
+    for (int r = 0; r < 4; r++)
+        v.data[12 + r] = view.data[r] * eye.x + view.data[4 + r] * eye.y + view.data[8 + r] * eye.z + view.data[12 + r];
+    return Matrix4f(v);
+}
+
+} // namespace math
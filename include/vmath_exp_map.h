@@ -0,0 +1,339 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+#pragma once
+
+#include "vmath.h"
+#include "vmath_parallel.h"
+#include "vmath_simd_detail.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace math {
+
+// ///////////////////////////// //
+// quaternion exponential map    //
+// ///////////////////////////// //
+
+// A unit quaternion is the exponential of a pure quaternion: q = exp((0, theta / 2 n)) for the rotation of angle
+// theta about the unit axis n, and the rotation vector theta n = 2 log(q). The functions below compute them
+// directly, with small angle Taylor expansions instead of the divisions by |v| of the axis() / angle() route. The
+// float versions use the polynomial approximations of the batch kernels (about 1 ulp) instead of sin, cos and atan2.
+
+/// exponential of a quaternion, exp(q) = e^w (cos|v|, sin|v| / |v| v)
+template <typename T> Quaternion<T> quat_exp(const Quaternion<T> &q);
+/// logarithm of a non zero quaternion, log(q) = (log|q|, atan2(|v|, w) / |v| v). For a unit quaternion the
+/// vector part is half the rotation vector (the axis is arbitrary, returned as zero, for q = -1)
+template <typename T> Quaternion<T> quat_log(const Quaternion<T> &q);
+/// power of a non zero quaternion, exp(t log(q)): for a unit quaternion the rotation with the same axis and t times
+/// the angle (q is not flipped to the shortest path; slerp(identity, q, t) is the shortest path version)
+template <typename T> Quaternion<T> quat_pow(const Quaternion<T> &q, T t);
+/// unit quaternion of the rotation vector r (axis * angle), exp((0, r / 2))
+template <typename T> Quaternion<T> quat_from_rotation_vector(const Vector3<T> &r);
+/// rotation vector (axis * angle, angle in [0, pi]) of a unit quaternion, 2 log(q) of q or -q
+template <typename T> Vector3<T> rotation_vector(const Quaternion<T> &q);
+
+/// batch versions over arrays of count values, for unit quaternions. The float kernels use polynomial
+/// approximations (sin / cos, atan) on 8 (AVX) or 4 (SSE2) values per iteration, the double ones the scalar
+/// functions; large arrays are split over threads (0 = hardware threads)
+template <typename T>
+void quat_from_rotation_vector(const Vector3<T> *r, Quaternion<T> *q, size_t count, unsigned threads = 0);
+template <typename T> void rotation_vector(const Quaternion<T> *q, Vector3<T> *r, size_t count, unsigned threads = 0);
+template <typename T>
+void quat_pow(const Quaternion<T> *q, T t, Quaternion<T> *out, size_t count, unsigned threads = 0);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+// cos(h) and sin(h) / h from h^2
+template <typename T> inline void half_angle_libm(T h2, T &c, T &sinc) {
+    using std::cos;
+    using std::sin;
+    using std::sqrt;
+    const T h = sqrt(h2);
+    c = cos(h);
+    sinc = h > T(1e-4) ? sin(h) / h : T(1) - h2 / T(6);
+}
+
+template <typename T> inline void lanes_half_angle(T h2, T &c, T &sinc) { half_angle_libm(h2, c, sinc); }
+
+// atan2(s, w) / s for s >= 0, the scale from the vector part of a quaternion to its logarithm
+template <typename T> inline T lanes_log_scale(T s, T w) {
+    using std::atan2;
+    if (w > T(0) && s < T(1e-4) * w) {
+        const T t = s / w;
+        return (T(1) - t * t / T(3)) / w;
+    }
+    return s > T(0) ? atan2(s, w) / s : T(0);
+}
+
+inline bool lanes_any(bool mask) { return mask; }
+#if defined(VMATH_SSE2)
+inline bool lanes_any(Float4 mask) { return _mm_movemask_ps(mask.v) != 0; }
+#endif
+#if defined(VMATH_AVX)
+inline bool lanes_any(Float8 mask) { return _mm256_movemask_ps(mask.v) != 0; }
+#endif
+
+// float and float packs: Taylor polynomials in h^2, accurate to float precision for h <= pi / 2 (rotations of up
+// to half a turn); the lanes beyond that use the scalar functions
+template <typename P> inline void lanes_half_angle_poly(P h2, P &c, P &sinc) {
+    sinc = P(1.f / 6227020800.f);
+    sinc = sinc * h2 - P(1.f / 39916800.f);
+    sinc = sinc * h2 + P(1.f / 362880.f);
+    sinc = sinc * h2 - P(1.f / 5040.f);
+    sinc = sinc * h2 + P(1.f / 120.f);
+    sinc = sinc * h2 - P(1.f / 6.f);
+    sinc = sinc * h2 + P(1.f);
+    c = P(-1.f / 87178291200.f);
+    c = c * h2 + P(1.f / 479001600.f);
+    c = c * h2 - P(1.f / 3628800.f);
+    c = c * h2 + P(1.f / 40320.f);
+    c = c * h2 - P(1.f / 720.f);
+    c = c * h2 + P(1.f / 24.f);
+    c = c * h2 - P(1.f / 2.f);
+    c = c * h2 + P(1.f);
+    if (lanes_any(lanes_greater(h2, P(2.4674011f)))) {
+        const size_t width = sizeof(P) / sizeof(float);
+        float x[8], cs[8], ss[8];
+        lanes_store(x, h2);
+        lanes_store(cs, c);
+        lanes_store(ss, sinc);
+        for (size_t i = 0; i < width; i++)
+            if (x[i] > 2.4674011f)
+                half_angle_libm(x[i], cs[i], ss[i]);
+        lanes_load(c, cs);
+        lanes_load(sinc, ss);
+    }
+}
+
+// float and float packs: atan2(s, w) for s >= 0 with the reductions of the Cephes atanf to |t| <= tan(pi / 8) and its
+// polynomial (about 1 ulp), divided by s. The ratio t = s / |w| keeps the relative accuracy for small angles, so
+// there is no separate Taylor branch.
+template <typename P> inline P lanes_log_scale_poly(P s, P w) {
+    const P aw = lanes_abs(w);
+    const auto swap = lanes_greater(s, aw);
+    const P num = lanes_select(swap, aw, s), den = lanes_select(swap, s, aw); // t = num / den in [0, 1]
+    // (t - 1) / (t + 1) = (num - den) / (num + den): a single division for both reductions
+    const auto reduce = lanes_greater(num, den * P(0.41421356f));
+    const P x = lanes_select(reduce, num - den, num) /
+                lanes_select(reduce, num + den, lanes_select(lanes_greater(den, P(0.f)), den, P(1.f)));
+    const P z = x * x;
+    P a = P(8.05374449538e-2f);
+    a = a * z - P(1.38776856032e-1f);
+    a = a * z + P(1.99777106478e-1f);
+    a = a * z - P(3.33329491539e-1f);
+    a = a * z * x + x + lanes_select(reduce, P(0.78539816f), P(0.f));
+    a = lanes_select(swap, P(1.57079633f) - a, a);
+    a = lanes_select(lanes_greater(P(0.f), w), P(3.14159265f) - a, a);
+    return a / lanes_select(lanes_greater(s, P(0.f)), s, P(1.f));
+}
+
+inline void lanes_half_angle(float h2, float &c, float &sinc) { lanes_half_angle_poly(h2, c, sinc); }
+inline float lanes_log_scale(float s, float w) { return lanes_log_scale_poly(s, w); }
+#if defined(VMATH_SSE2)
+inline void lanes_half_angle(Float4 h2, Float4 &c, Float4 &sinc) { lanes_half_angle_poly(h2, c, sinc); }
+inline Float4 lanes_log_scale(Float4 s, Float4 w) { return lanes_log_scale_poly(s, w); }
+#endif
+#if defined(VMATH_AVX)
+inline void lanes_half_angle(Float8 h2, Float8 &c, Float8 &sinc) { lanes_half_angle_poly(h2, c, sinc); }
+inline Float8 lanes_log_scale(Float8 s, Float8 w) { return lanes_log_scale_poly(s, w); }
+#endif
+
+// the pack of the batch kernels: there are no double polynomials, the double kernels are scalar
+template <typename T> struct ExpMapPack { typedef typename WidePack<T>::type type; };
+template <> struct ExpMapPack<double> { typedef double type; };
+
+// the kernels, on components: q = exp((0, h)) and h = log(q) for unit quaternions
+template <typename P> inline void exp_lanes(P hx, P hy, P hz, P &qw, P &qx, P &qy, P &qz) {
+    P c, sinc;
+    lanes_half_angle(hx * hx + hy * hy + hz * hz, c, sinc);
+    qw = c;
+    qx = sinc * hx;
+    qy = sinc * hy;
+    qz = sinc * hz;
+}
+template <typename P> inline void log_lanes(P qw, P qx, P qy, P qz, P &hx, P &hy, P &hz) {
+    const P scale = lanes_log_scale(lanes_sqrt(qx * qx + qy * qy + qz * qz), qw);
+    hx = scale * qx;
+    hy = scale * qy;
+    hz = scale * qz;
+}
+
+// batch kernels, on (const P *in, P *out)
+struct FromRotationVectorKernel {
+    template <typename P> void operator()(const P *r, P *q) const {
+        const P half(0.5f);
+        exp_lanes(r[0] * half, r[1] * half, r[2] * half, q[0], q[1], q[2], q[3]);
+    }
+};
+struct RotationVectorKernel {
+    template <typename P> void operator()(const P *q, P *r) const {
+        P hx, hy, hz;
+        log_lanes(q[0], q[1], q[2], q[3], hx, hy, hz);
+        const P two(2.f);
+        r[0] = hx * two;
+        r[1] = hy * two;
+        r[2] = hz * two;
+    }
+};
+template <typename T> struct PowKernel {
+    T t;
+    template <typename P> void operator()(const P *q, P *out) const {
+        P hx, hy, hz;
+        log_lanes(q[0], q[1], q[2], q[3], hx, hy, hz);
+        const P pt(t);
+        exp_lanes(hx * pt, hy * pt, hz * pt, out[0], out[1], out[2], out[3]);
+    }
+};
+
+// arrays of In values to arrays of Out values with kernel(in, out) on packs, transposed to structure of
+// arrays in small blocks; load(i, T *in) and store(i, const T *out) read and write the components of value i
+template <int In, int Out, typename T, typename Load, typename Kernel, typename Store>
+inline void exp_map_batch(size_t count, unsigned threads, Load load, Kernel kernel, Store store) {
+    typedef typename ExpMapPack<T>::type P;
+    const size_t width = sizeof(P) / sizeof(T);
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        const size_t block = 64;
+        T in[In][block], out[Out][block];
+        for (size_t first = begin; first < end; first += block) {
+            const size_t n = std::min(block, end - first);
+            for (size_t k = 0; k < n; k++) {
+                T values[In];
+                load(first + k, values);
+                for (int c = 0; c < In; c++)
+                    in[c][k] = values[c];
+            }
+            size_t k = 0;
+            for (; k + width <= n; k += width) {
+                P x[In], y[Out];
+                for (int c = 0; c < In; c++)
+                    lanes_load(x[c], in[c] + k);
+                kernel(x, y);
+                for (int c = 0; c < Out; c++)
+                    lanes_store(out[c] + k, y[c]);
+            }
+            for (; k < n; k++) {
+                T x[In], y[Out];
+                for (int c = 0; c < In; c++)
+                    x[c] = in[c][k];
+                kernel(x, y);
+                for (int c = 0; c < Out; c++)
+                    out[c][k] = y[c];
+            }
+            for (k = 0; k < n; k++) {
+                T values[Out];
+                for (int c = 0; c < Out; c++)
+                    values[c] = out[c][k];
+                store(first + k, values);
+            }
+        }
+    });
+}
+
+} // namespace detail
+
+template <typename T> inline Quaternion<T> quat_exp(const Quaternion<T> &q) {
+    using std::exp;
+    T c, sinc;
+    detail::lanes_half_angle(q.x * q.x + q.y * q.y + q.z * q.z, c, sinc);
+    const T e = exp(q.w);
+    return Quaternion<T>(e * c, e * sinc * q.x, e * sinc * q.y, e * sinc * q.z);
+}
+
+template <typename T> inline Quaternion<T> quat_log(const Quaternion<T> &q) {
+    using std::log;
+    using std::sqrt;
+    const T v2 = q.x * q.x + q.y * q.y + q.z * q.z;
+    const T scale = detail::lanes_log_scale(sqrt(v2), q.w);
+    return Quaternion<T>(log(v2 + q.w * q.w) / T(2), scale * q.x, scale * q.y, scale * q.z);
+}
+
+template <typename T> inline Quaternion<T> quat_pow(const Quaternion<T> &q, T t) {
+    const Quaternion<T> l = quat_log(q);
+    return quat_exp(Quaternion<T>(t * l.w, t * l.x, t * l.y, t * l.z));
+}
+
+template <typename T> inline Quaternion<T> quat_from_rotation_vector(const Vector3<T> &r) {
+    Quaternion<T> q;
+    detail::exp_lanes(r.x / T(2), r.y / T(2), r.z / T(2), q.w, q.x, q.y, q.z);
+    return q;
+}
+
+template <typename T> inline Vector3<T> rotation_vector(const Quaternion<T> &q) {
+    // -q is the same rotation: w >= 0 gives the angle in [0, pi]
+    const T sign = q.w < T(0) ? T(-1) : T(1);
+    Vector3<T> h;
+    detail::log_lanes(sign * q.w, sign * q.x, sign * q.y, sign * q.z, h.x, h.y, h.z);
+    return Vector3<T>(h.x * T(2), h.y * T(2), h.z * T(2));
+}
+
+template <typename T>
+inline void quat_from_rotation_vector(const Vector3<T> *r, Quaternion<T> *q, size_t count, unsigned threads) {
+    detail::exp_map_batch<3, 4, T>(
+        count, threads,
+        [r](size_t i, T *in) {
+            in[0] = r[i].x;
+            in[1] = r[i].y;
+            in[2] = r[i].z;
+        },
+        detail::FromRotationVectorKernel(),
+        [q](size_t i, const T *out) { q[i] = Quaternion<T>(out[0], out[1], out[2], out[3]); });
+}
+
+template <typename T>
+inline void rotation_vector(const Quaternion<T> *q, Vector3<T> *r, size_t count, unsigned threads) {
+    detail::exp_map_batch<4, 3, T>(
+        count, threads,
+        [q](size_t i, T *in) {
+            // -q is the same rotation: w >= 0 gives the angle in [0, pi]
+            const T sign = q[i].w < T(0) ? T(-1) : T(1);
+            in[0] = sign * q[i].w;
+            in[1] = sign * q[i].x;
+            in[2] = sign * q[i].y;
+            in[3] = sign * q[i].z;
+        },
+        detail::RotationVectorKernel(), [r](size_t i, const T *out) { r[i] = Vector3<T>(out[0], out[1], out[2]); });
+}
+
+template <typename T>
+inline void quat_pow(const Quaternion<T> *q, T t, Quaternion<T> *out, size_t count, unsigned threads) {
+    detail::exp_map_batch<4, 4, T>(
+        count, threads,
+        [q](size_t i, T *in) {
+            in[0] = q[i].w;
+            in[1] = q[i].x;
+            in[2] = q[i].y;
+            in[3] = q[i].z;
+        },
+        detail::PowKernel<T>{t},
+        [out](size_t i, const T *values) { out[i] = Quaternion<T>(values[0], values[1], values[2], values[3]); });
+}
+
+} // namespace math
@@ -0,0 +1,494 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+#pragma once
+
+#include "vmath_types.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__SIZEOF_INT128__) && !defined(VMATH_FIXED_NO_INT128)
+#define VMATH_FIXED_INT128
+#endif
+
+namespace math {
+
+/// Signed fixed point scalar with Q fractional bits, for simulations that must give bit-identical results on
+/// every machine (lockstep networking, replays). Formats with Q <= 16 are stored in 32 bits (Fixed<16> is
+/// Q16.16), the others in 64 bits (Fixed<32> is Q32.32).
+///
+/// All the arithmetic is done on integers with a fixed rounding, so the results do not depend on the compiler,
+/// the instruction set or the floating point environment:
+/// - addition and subtraction are exact and wrap around on overflow (two's complement);
+/// - multiplication rounds to the nearest value (ties up); division truncates toward zero, and a division by
+///   zero gives the largest or smallest value with the sign of the dividend;
+/// - sqrt() is an integer square root, sin()/cos() interpolate a quarter wave table, atan2()/asin()/acos() use
+///   CORDIC. All of them are pure integer code, with absolute errors of a few units of the last place (at
+///   most about 5e-9 for the 64 bit formats).
+/// Conversions from float and double (including the implicit ones in mixed expressions such as `q * 0.5`)
+/// round to the nearest value; they are exact and deterministic for constants, but should be kept out of the
+/// simulation state. Comparisons with builtin arithmetic values are exact (the other operand is not rounded), so
+/// the VMATH_EPSILON comparisons of the vector and matrix types keep their meaning; with Q16.16, whose resolution
+/// is coarser than the epsilon, they are exact comparisons.
+///
+/// The math functions are found by argument dependent lookup, so the generic Vector, Matrix, Quaternion and
+/// Transform code (length, normalize, inverse, rotations, slerp, quaternion/matrix/euler conversions) works
+/// unchanged with Fixed. The decompositions in vmath.h still require floating point types.
+template <int Q> struct Fixed;
+
+typedef Fixed<16> Fixed16; ///< Q16.16, range +-32768 with a resolution of 1.5e-5
+typedef Fixed<32> Fixed32; ///< Q32.32, range +-2.1e9 with a resolution of 2.3e-10
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+template <int Q> struct FixedStorage {
+    static_assert(Q >= 1 && Q <= 60, "unsupported number of fractional bits");
+    typedef typename std::conditional<(Q <= 16), int32_t, int64_t>::type type;
+};
+
+/// number of significant bits of v (0 for v == 0)
+inline int fixed_bit_length(uint64_t v) {
+#if defined(__GNUC__)
+    return v ? 64 - __builtin_clzll(v) : 0;
+#else
+    int n = 0;
+    while (v) {
+        v >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/// floor(sqrt(v)), digit by digit
+inline uint64_t fixed_isqrt(uint64_t v) {
+    uint64_t res = 0;
+    // highest power of 4 <= v
+    uint64_t bit = v ? uint64_t(1) << ((fixed_bit_length(v) - 1) & ~1) : 0;
+    while (bit) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+/// three-way comparison of raw / 2^Q with x * 2^Q = scaled (exact for every double)
+inline int fixed_compare(int64_t raw, double scaled) {
+    if (scaled >= 9223372036854775808.0)
+        return -1;
+    if (scaled < -9223372036854775808.0)
+        return 1;
+    const double f = std::floor(scaled);
+    const int64_t fi = int64_t(f);
+    if (raw != fi)
+        return raw < fi ? -1 : 1;
+    return scaled > f ? -1 : 0;
+}
+
+// 32 bit formats: the intermediate values fit in 64 bits
+inline int32_t fixed_mul(int32_t a, int32_t b, int q) {
+    return int32_t((int64_t(a) * b + (int64_t(1) << (q - 1))) >> q);
+}
+inline int32_t fixed_div(int32_t a, int32_t b, int q) {
+    if (b == 0)
+        return a >= 0 ? std::numeric_limits<int32_t>::max() : std::numeric_limits<int32_t>::min();
+    return int32_t(int64_t(a) * (int64_t(1) << q) / b);
+}
+
+// 64 bit formats: 128 bit intermediate values. The portable version gives the same results as the one using the
+// compiler's 128 bit integers.
+#if defined(VMATH_FIXED_INT128)
+inline int64_t fixed_mul(int64_t a, int64_t b, int q) {
+    return int64_t(((__int128)a * b + ((__int128)1 << (q - 1))) >> q);
+}
+inline int64_t fixed_div(int64_t a, int64_t b, int q) {
+    if (b == 0)
+        return a >= 0 ? std::numeric_limits<int64_t>::max() : std::numeric_limits<int64_t>::min();
+    return int64_t((__int128)a * ((__int128)1 << q) / b);
+}
+#else
+/// unsigned 64x64 -> 128 bit product
+inline void fixed_umul128(uint64_t a, uint64_t b, uint64_t &hi, uint64_t &lo) {
+    const uint64_t a0 = a & 0xffffffffu, a1 = a >> 32, b0 = b & 0xffffffffu, b1 = b >> 32;
+    const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    const uint64_t mid = (p00 >> 32) + (p01 & 0xffffffffu) + (p10 & 0xffffffffu);
+    lo = (mid << 32) | (p00 & 0xffffffffu);
+    hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+inline int64_t fixed_mul(int64_t a, int64_t b, int q) {
+    // two's complement 128 bit product, plus the rounding term, arithmetic shift right by q
+    uint64_t hi, lo;
+    fixed_umul128(uint64_t(a), uint64_t(b), hi, lo);
+    // signed correction of the unsigned product
+    if (a < 0)
+        hi -= uint64_t(b);
+    if (b < 0)
+        hi -= uint64_t(a);
+    const uint64_t half = uint64_t(1) << (q - 1);
+    lo += half;
+    hi += lo < half ? 1 : 0;
+    return int64_t((lo >> q) | (hi << (64 - q)));
+}
+inline int64_t fixed_div(int64_t a, int64_t b, int q) {
+    if (b == 0)
+        return a >= 0 ? std::numeric_limits<int64_t>::max() : std::numeric_limits<int64_t>::min();
+    // restoring division of |a| * 2^q by |b|, quotient truncated to 64 bits
+    const uint64_t ua = a < 0 ? 0 - uint64_t(a) : uint64_t(a);
+    const uint64_t ub = b < 0 ? 0 - uint64_t(b) : uint64_t(b);
+    uint64_t n_hi = ua >> (64 - q), n_lo = ua << q;
+    uint64_t rem = 0, quot = 0;
+    for (int i = 127; i >= 0; i--) {
+        const uint64_t bit = i >= 64 ? (n_hi >> (i - 64)) & 1 : (n_lo >> i) & 1;
+        const bool carry = (rem >> 63) != 0;
+        rem = (rem << 1) | bit;
+        quot <<= 1;
+        if (carry || rem >= ub) {
+            rem -= ub;
+            quot |= 1;
+        }
+    }
+    return (a < 0) != (b < 0) ? int64_t(0 - quot) : int64_t(quot);
+}
+#endif
+
+/// quarter wave of sin, sin(i * pi / 512) in Q30 for i = 0..256
+inline const int32_t *fixed_sin_table() {
+    static const int32_t table[257] = {
+        0, 6588356, 13176464, 19764076, 26350943, 32936819, 39521455, 46104602,
+        52686014, 59265442, 65842639, 72417357, 78989349, 85558366, 92124163, 98686491,
+        105245103, 111799753, 118350194, 124896179, 131437462, 137973796, 144504935, 151030634,
+        157550647, 164064728, 170572633, 177074115, 183568930, 190056834, 196537583, 203010932,
+        209476638, 215934457, 222384147, 228825464, 235258165, 241682010, 248096755, 254502159,
+        260897982, 267283981, 273659918, 280025552, 286380643, 292724951, 299058239, 305380268,
+        311690799, 317989595, 324276419, 330551034, 336813204, 343062693, 349299266, 355522689,
+        361732726, 367929144, 374111709, 380280190, 386434353, 392573967, 398698801, 404808624,
+        410903207, 416982319, 423045732, 429093217, 435124548, 441139496, 447137835, 453119340,
+        459083786, 465030947, 470960600, 476872522, 482766489, 488642281, 494499676, 500338453,
+        506158392, 511959275, 517740883, 523502998, 529245404, 534967884, 540670223, 546352205,
+        552013618, 557654248, 563273883, 568872310, 574449320, 580004702, 585538248, 591049748,
+        596538995, 602005783, 607449906, 612871159, 618269338, 623644239, 628995660, 634323400,
+        639627258, 644907034, 650162530, 655393548, 660599890, 665781362, 670937767, 676068911,
+        681174602, 686254647, 691308855, 696337036, 701339000, 706314559, 711263525, 716185713,
+        721080937, 725949013, 730789757, 735602987, 740388522, 745146182, 749875788, 754577161,
+        759250125, 763894504, 768510122, 773096806, 777654384, 782182683, 786681534, 791150767,
+        795590213, 799999706, 804379079, 808728167, 813046808, 817334838, 821592095, 825818421,
+        830013654, 834177638, 838310216, 842411232, 846480531, 850517961, 854523370, 858496606,
+        862437520, 866345964, 870221790, 874064853, 877875009, 881652112, 885396022, 889106597,
+        892783698, 896427186, 900036924, 903612776, 907154608, 910662286, 914135678, 917574653,
+        920979082, 924348837, 927683790, 930983817, 934248793, 937478595, 940673101, 943832191,
+        946955747, 950043650, 953095785, 956112036, 959092290, 962036435, 964944360, 967815955,
+        970651112, 973449725, 976211688, 978936898, 981625251, 984276646, 986890984, 989468165,
+        992008094, 994510675, 996975812, 999403415, 1001793390, 1004145648, 1006460100, 1008736660,
+        1010975242, 1013175761, 1015338134, 1017462281, 1019548121, 1021595575, 1023604567, 1025575020,
+        1027506862, 1029400018, 1031254418, 1033069992, 1034846671, 1036584389, 1038283080, 1039942680,
+        1041563127, 1043144360, 1044686319, 1046188946, 1047652185, 1049075980, 1050460278, 1051805027,
+        1053110176, 1054375676, 1055601479, 1056787540, 1057933813, 1059040255, 1060106826, 1061133483,
+        1062120190, 1063066909, 1063973603, 1064840240, 1065666786, 1066453210, 1067199483, 1067905576,
+        1068571464, 1069197120, 1069782521, 1070327646, 1070832474, 1071296985, 1071721163, 1072104991,
+        1072448455, 1072751542, 1073014240, 1073236540, 1073418433, 1073559913, 1073660973, 1073721611,
+        1073741824,
+    };
+    return table;
+}
+
+/// atan(2^-i) in Q30 for i = 0..30, for CORDIC
+inline const int32_t *fixed_atan_table() {
+    static const int32_t table[31] = {
+        843314857, 497837829, 263043837, 133525159, 67021687, 33543516, 16775851, 8388437,
+        4194283, 2097149, 1048576, 524288, 262144, 131072, 65536, 32768,
+        16384, 8192, 4096, 2048, 1024, 512, 256, 128,
+        64, 32, 16, 8, 4, 2, 1,
+    };
+    return table;
+}
+
+/// sin(pi/2 * p / 2^30) in Q30 for p in [0, 2^30]: cubic Hermite interpolation of the table, using the table
+/// itself (mirrored) for the derivatives
+inline int64_t fixed_sin_quarter(uint32_t p) {
+    const int32_t *s = fixed_sin_table();
+    const uint32_t i = p >> 22;
+    if (i >= 256)
+        return s[256];
+    const int64_t t = p & 0x3fffff; // Q22
+    const int64_t t2 = (t * t) >> 22, t3 = (t2 * t) >> 22;
+    const int64_t h00 = 2 * t3 - 3 * t2 + (int64_t(1) << 22);
+    const int64_t h01 = 3 * t2 - 2 * t3;
+    const int64_t h10 = t3 - 2 * t2 + t;
+    const int64_t h11 = t3 - t2;
+    // derivative per segment: cos(x) * pi / 512, with cos(x) = s[256 - i]; pi / 512 in Q32
+    const int64_t step = 26353589;
+    const int64_t slope = (h10 * s[256 - i] + h11 * s[255 - i]) >> 22;
+    return ((h00 * s[i] + h01 * s[i + 1]) >> 22) + ((slope * step) >> 32);
+}
+
+/// sin of a phase in turns (2^32 = full turn), in Q30
+inline int64_t fixed_sin_phase(uint32_t phase) {
+    const uint32_t quadrant = phase >> 30;
+    const uint32_t p = phase & 0x3fffffffu;
+    const int64_t v = fixed_sin_quarter((quadrant & 1) ? (uint32_t(1) << 30) - p : p);
+    return quadrant >= 2 ? -v : v;
+}
+
+/// atan2(y, x) in Q30 radians with CORDIC (vectoring mode)
+inline int64_t fixed_atan2(int64_t y, int64_t x) {
+    if (x == 0 && y == 0)
+        return 0;
+    const int64_t pi_q30 = 3373259426;
+    const int64_t limit = int64_t(1) << 61;
+    if (x > limit || x < -limit || y > limit || y < -limit) {
+        x >>= 2; // keeps the negations below in range
+        y >>= 2;
+    }
+    // bring the vector to the right half plane
+    int64_t z = 0;
+    if (x < 0) {
+        x = -x;
+        y = -y;
+        z = y > 0 ? -pi_q30 : pi_q30; // note: y has been negated
+    }
+    // scale to about 2^40 (the CORDIC gain is 1.65, the result does not depend on the scale)
+    const uint64_t m = uint64_t(x) > uint64_t(y < 0 ? -y : y) ? uint64_t(x) : uint64_t(y < 0 ? -y : y);
+    const int shift = fixed_bit_length(m) - 41;
+    if (shift > 0) {
+        x >>= shift;
+        y >>= shift;
+    } else {
+        x *= int64_t(1) << -shift;
+        y *= int64_t(1) << -shift;
+    }
+    const int32_t *atan_table = fixed_atan_table();
+    for (int i = 0; i < 31; i++) {
+        const int64_t xs = x >> i, ys = y >> i;
+        if (y > 0) {
+            x += ys;
+            y -= xs;
+            z += atan_table[i];
+        } else {
+            x -= ys;
+            y += xs;
+            z -= atan_table[i];
+        }
+    }
+    return z;
+}
+
+/// v (Q30) to Q fractional bits, rounding to nearest
+template <typename S> inline S fixed_from_q30(int64_t v, int q) {
+    return q >= 30 ? S(v * (int64_t(1) << (q - 30))) : S((v + (int64_t(1) << (29 - q))) >> (30 - q));
+}
+
+} // namespace detail
+
+template <int Q> struct Fixed {
+    typedef typename detail::FixedStorage<Q>::type storage_type;
+    static constexpr int fractional_bits = Q;
+    static constexpr storage_type one_raw = storage_type(1) << Q;
+
+    storage_type raw; ///< value * 2^Q
+
+    Fixed() = default;
+    Fixed(const Fixed &) = default;
+    Fixed &operator=(const Fixed &) = default;
+
+    /// from integers (exact, wraps around if out of range)
+    template <typename A, typename std::enable_if<std::is_integral<A>::value, int>::type = 0>
+    constexpr Fixed(A v)
+    : raw(storage_type(unsigned_type(v) * unsigned_type(one_raw))) {}
+    /// from floating point values, rounded to the nearest representable value (saturates if out of range)
+    template <typename A, typename std::enable_if<std::is_floating_point<A>::value, int>::type = 0>
+    Fixed(A v)
+    : raw(from_scaled(std::ldexp(double(v), Q))) {}
+    /// from another fixed point format (rounded to nearest when precision is lost)
+    template <int Q2, typename std::enable_if<Q2 != Q, int>::type = 0>
+    explicit Fixed(const Fixed<Q2> &v)
+    : raw(Q2 > Q ? storage_type((int64_t(v.raw) + (int64_t(1) << (Q2 > Q ? Q2 - Q - 1 : 0))) >> (Q2 > Q ? Q2 - Q : 0))
+                 : storage_type(int64_t(v.raw) * (int64_t(1) << (Q > Q2 ? Q - Q2 : 0)))) {}
+
+    /// fixed point value with the given raw representation (value * 2^Q)
+    static constexpr Fixed from_raw(storage_type r) { return Fixed(r, raw_tag()); }
+    /// smallest positive value
+    static constexpr Fixed epsilon() { return from_raw(1); }
+    static constexpr Fixed max() { return from_raw(std::numeric_limits<storage_type>::max()); }
+    static constexpr Fixed lowest() { return from_raw(std::numeric_limits<storage_type>::min()); }
+    static constexpr Fixed pi() { return from_raw(storage_type(((pi_q61 >> (60 - Q)) + 1) >> 1)); }
+
+    /// to builtin arithmetic types; the integer conversions truncate toward zero
+    template <typename A, typename std::enable_if<std::is_floating_point<A>::value, int>::type = 0>
+    explicit operator A() const {
+        return A(std::ldexp(double(raw), -Q));
+    }
+    template <typename A, typename std::enable_if<std::is_integral<A>::value, int>::type = 0>
+    explicit operator A() const {
+        return A(raw / one_raw);
+    }
+
+    // arithmetic
+    friend Fixed operator+(Fixed a, Fixed b) {
+        return from_raw(storage_type(unsigned_type(a.raw) + unsigned_type(b.raw)));
+    }
+    friend Fixed operator-(Fixed a, Fixed b) {
+        return from_raw(storage_type(unsigned_type(a.raw) - unsigned_type(b.raw)));
+    }
+    friend Fixed operator*(Fixed a, Fixed b) { return from_raw(detail::fixed_mul(a.raw, b.raw, Q)); }
+    friend Fixed operator/(Fixed a, Fixed b) { return from_raw(detail::fixed_div(a.raw, b.raw, Q)); }
+    Fixed operator-() const { return from_raw(storage_type(unsigned_type(0) - unsigned_type(raw))); }
+    Fixed operator+() const { return *this; }
+    Fixed &operator+=(Fixed b) { return *this = *this + b; }
+    Fixed &operator-=(Fixed b) { return *this = *this - b; }
+    Fixed &operator*=(Fixed b) { return *this = *this * b; }
+    Fixed &operator/=(Fixed b) { return *this = *this / b; }
+
+    // comparisons
+    friend bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+    friend bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+    friend bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+    friend bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+    friend bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+    friend bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+    // exact comparisons with builtin arithmetic values (no rounding of the other operand)
+#define VMATH_FIXED_COMPARE(op)                                                                                        \
+    template <typename A,                                                                                              \
+              typename std::enable_if<std::is_arithmetic<A>::value, int>::type = 0>                                    \
+    friend bool operator op(Fixed a, A b) {                                                                            \
+        return detail::fixed_compare(a.raw, std::ldexp(double(b), Q)) op 0;                                            \
+    }                                                                                                                  \
+    template <typename A,                                                                                              \
+              typename std::enable_if<std::is_arithmetic<A>::value, int>::type = 0>                                    \
+    friend bool operator op(A b, Fixed a) {                                                                            \
+        return 0 op detail::fixed_compare(a.raw, std::ldexp(double(b), Q));                                            \
+    }
+    VMATH_FIXED_COMPARE(==)
+    VMATH_FIXED_COMPARE(!=)
+    VMATH_FIXED_COMPARE(<)
+    VMATH_FIXED_COMPARE(<=)
+    VMATH_FIXED_COMPARE(>)
+    VMATH_FIXED_COMPARE(>=)
+#undef VMATH_FIXED_COMPARE
+
+    // math functions, found by argument dependent lookup
+    friend Fixed abs(Fixed a) { return a.raw < 0 ? -a : a; }
+    friend Fixed copysign(Fixed a, Fixed b) { return (a.raw < 0) != (b.raw < 0) ? -a : a; }
+    /// 1 / a
+    friend Fixed reciprocal(Fixed a) { return from_raw(detail::fixed_div(one_raw, a.raw, Q)); }
+    /// integer square root, 0 for negative values. Exact (rounded down) for the 32 bit formats; the 64 bit ones
+    /// refine a 31 bit integer estimate with a Newton step (within 1 unit of the last place).
+    friend Fixed sqrt(Fixed a) {
+        if (a.raw <= 0)
+            return from_raw(0);
+        // sqrt(raw * 2^Q) = sqrt(raw * 2^s) * 2^((Q - s) / 2), with the largest s that fits in 64 bits and has
+        // the parity of Q
+        const uint64_t r = uint64_t(a.raw);
+        int s = 63 - detail::fixed_bit_length(r);
+        s = s >= Q ? Q : s - ((Q - s) & 1);
+        if (s >= Q)
+            return from_raw(storage_type(detail::fixed_isqrt(r << s)));
+        // the estimate has at least 31 significant bits: one Newton step gets the full precision
+        const storage_type x = storage_type(s < 0 ? detail::fixed_isqrt(r >> 1) << ((Q + 1) / 2) // raw >= 2^62, odd Q
+                                                  : detail::fixed_isqrt(r << s) << ((Q - s) / 2));
+        return from_raw(storage_type((uint64_t(x) + uint64_t(detail::fixed_div(a.raw, x, Q))) >> 1));
+    }
+    friend Fixed sin(Fixed a) {
+        return from_raw(detail::fixed_from_q30<storage_type>(detail::fixed_sin_phase(phase(a)), Q));
+    }
+    friend Fixed cos(Fixed a) {
+        const uint32_t quarter_turn = uint32_t(1) << 30;
+        return from_raw(detail::fixed_from_q30<storage_type>(detail::fixed_sin_phase(phase(a) + quarter_turn), Q));
+    }
+    friend Fixed atan2(Fixed y, Fixed x) {
+        return from_raw(detail::fixed_from_q30<storage_type>(detail::fixed_atan2(y.raw, x.raw), Q));
+    }
+    friend Fixed asin(Fixed a) {
+        const Fixed c = a > 1 ? Fixed(1) : a < -1 ? Fixed(-1) : a;
+        return atan2(c, sqrt(Fixed(1) - c * c));
+    }
+    friend Fixed acos(Fixed a) {
+        const Fixed c = a > 1 ? Fixed(1) : a < -1 ? Fixed(-1) : a;
+        return atan2(sqrt(Fixed(1) - c * c), c);
+    }
+
+  private:
+    typedef typename std::make_unsigned<storage_type>::type unsigned_type;
+    static constexpr int64_t pi_q61 = 7244019458077122842; // pi * 2^61
+    struct raw_tag {};
+    constexpr Fixed(storage_type r, raw_tag)
+    : raw(r) {}
+
+    static storage_type from_scaled(double v) {
+        const double r = std::floor(v + 0.5);
+        if (r >= double(std::numeric_limits<storage_type>::max()))
+            return std::numeric_limits<storage_type>::max();
+        if (r <= double(std::numeric_limits<storage_type>::min()))
+            return std::numeric_limits<storage_type>::min();
+        return storage_type(r);
+    }
+
+    /// angle in radians to a phase in turns (2^32 = full turn), modulo one turn: raw / 2^Q * 2^32 / (2 pi),
+    /// rounded to nearest
+    static uint32_t phase(Fixed a) {
+        // 2^64 / (2 pi)
+        const uint64_t inv_2pi_q64 = 2935890503282001226u;
+#if defined(VMATH_FIXED_INT128)
+        if (sizeof(storage_type) == 8)
+            return uint32_t(
+                uint64_t(((__int128)a.raw * (__int128)inv_2pi_q64 + ((__int128)1 << (Q + 31))) >> (Q + 32)));
+#else
+        if (sizeof(storage_type) == 8) {
+            uint64_t hi, lo;
+            detail::fixed_umul128(uint64_t(a.raw), inv_2pi_q64, hi, lo);
+            if (a.raw < 0)
+                hi -= inv_2pi_q64;
+            const int shift = Q + 32;
+            const int half = shift - 1; // rounding bit
+            if (half < 64) {
+                const uint64_t h = uint64_t(1) << (half & 63);
+                lo += h;
+                hi += lo < h ? 1 : 0;
+            } else {
+                hi += uint64_t(1) << (half & 63);
+            }
+            return uint32_t(shift >= 64 ? hi >> (shift & 63) : (lo >> shift) | (hi << ((64 - shift) & 63)));
+        }
+#endif
+        // 32 bit formats: 2^32 / (2 pi) with 30 significant bits, the product fits in 64 bits
+        return uint32_t(uint64_t(int64_t(a.raw) * int64_t(inv_2pi_q64 >> 32) + (int64_t(1) << (Q - 1))) >> Q);
+    }
+};
+
+template <int Q> constexpr int Fixed<Q>::fractional_bits;
+template <int Q> constexpr typename Fixed<Q>::storage_type Fixed<Q>::one_raw;
+template <int Q> constexpr int64_t Fixed<Q>::pi_q61;
+
+} // namespace math
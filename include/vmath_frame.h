@@ -0,0 +1,241 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+#pragma once
+
+#include "vmath.h"
+#include "vmath_parallel.h"
+#include "vmath_simd_detail.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace math {
+
+// ///////////////// //
+// orthonormal bases //
+// ///////////////// //
+
+/// complete the unit vector n to a right handed orthonormal basis (b1, b2, n), without branches and without
+/// normalization (Duff et al. 2017, "Building an Orthonormal Basis, Revisited"). The basis is continuous except
+/// across the plane z = 0.
+template <typename T> void orthonormal_basis(const Vector3<T> &n, Vector3<T> &b1, Vector3<T> &b2);
+/// the basis as the columns (b1, b2, n) of a rotation matrix
+template <typename T> Matrix3<T> orthonormal_basis(const Vector3<T> &n);
+/// batch version (b1 and b2 of count unit vectors), 4 at a time with SSE2; large arrays are split over threads
+/// (0 = hardware threads)
+void orthonormal_basis(const Vector3f *n, Vector3f *b1, Vector3f *b2, size_t count, unsigned threads = 0);
+
+// ////////////// //
+// tangent frames //
+// ////////////// //
+
+/// per vertex tangent frames of an indexed triangle mesh from the texture coordinates (Lengyel): the tangents
+/// (xyz, orthogonalized against the vertex normal) and the handedness of the frame in w (+1 or -1), with the
+/// bitangent = w * cross(normal, tangent) also written if bitangents is not null. The triangle contributions are
+/// summed in index order, so that the result does not depend on the number of threads; the vertices without a
+/// usable contribution (degenerate texture coordinates, unreferenced) get the tangent of orthonormal_basis().
+/// @param indices 3 * triangle_count vertex indices (< vertex_count)
+template <typename T>
+void compute_tangents(const Vector3<T> *positions, const Vector3<T> *normals, const Vector2<T> *uvs,
+                      size_t vertex_count, const uint32_t *indices, size_t triangle_count, Vector4<T> *tangents,
+                      Vector3<T> *bitangents = nullptr, unsigned threads = 0);
+
+/// encode a tangent frame (unit normal, unit tangent orthogonal to it with the handedness in w) as a QTangent (Frey
+/// 2011): the rotation of the frame (tangent, cross(normal, tangent), normal), with w < 0 for a negative handedness.
+/// |w| is kept >= 1 / 32767, so that the sign of w survives a 16 bit snorm quantization.
+template <typename T> Quaternion<T> qtangent_encode(const Vector3<T> &normal, const Vector4<T> &tangent);
+/// decode a QTangent into the normal and the tangent (with the handedness in w)
+template <typename T> void qtangent_decode(const Quaternion<T> &q, Vector3<T> &normal, Vector4<T> &tangent);
+/// batch versions; large arrays are split over threads (0 = hardware threads)
+template <typename T>
+void qtangent_encode(const Vector3<T> *normals, const Vector4<T> *tangents, Quaternion<T> *out, size_t count,
+                     unsigned threads = 0);
+template <typename T>
+void qtangent_decode(const Quaternion<T> *q, Vector3<T> *normals, Vector4<T> *tangents, size_t count,
+                     unsigned threads = 0);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+template <typename T> void orthonormal_basis(const Vector3<T> &n, Vector3<T> &b1, Vector3<T> &b2) {
+    const T sign = std::copysign(T(1), n.z);
+    const T a = T(-1) / (sign + n.z);
+    const T b = n.x * n.y * a;
+    b1 = Vector3<T>(T(1) + sign * n.x * n.x * a, sign * b, -sign * n.x);
+    b2 = Vector3<T>(b, sign + n.y * n.y * a, -n.y);
+}
+
+namespace detail {
+
+template <typename T> Matrix3<T> from_columns(const Vector3<T> &c0, const Vector3<T> &c1, const Vector3<T> &c2) {
+    Matrix3<T> m;
+    const Vector3<T> *columns[] = {&c0, &c1, &c2};
+    for (int j = 0; j < 3; j++) {
+        m(0, j) = columns[j]->x;
+        m(1, j) = columns[j]->y;
+        m(2, j) = columns[j]->z;
+    }
+    return m;
+}
+
+inline void orthonormal_basis_range(const Vector3f *n, Vector3f *b1, Vector3f *b2, size_t count) {
+    size_t i = 0;
+#if defined(VMATH_SSE2)
+    const __m128 sign_mask = _mm_set1_ps(-0.f), one = _mm_set1_ps(1.f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 x, y, z;
+        load_vector3_sse2(n + i, x, y, z);
+        const __m128 sign = _mm_or_ps(_mm_and_ps(z, sign_mask), one);
+        const __m128 a = _mm_div_ps(_mm_set1_ps(-1.f), _mm_add_ps(sign, z));
+        const __m128 b = _mm_mul_ps(_mm_mul_ps(x, y), a);
+        const __m128 sx = _mm_mul_ps(sign, x);
+        store_vector3_sse2(_mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(sx, x), a)), _mm_mul_ps(sign, b),
+                           _mm_xor_ps(sx, sign_mask), b1 + i);
+        store_vector3_sse2(b, _mm_add_ps(sign, _mm_mul_ps(_mm_mul_ps(y, y), a)), _mm_xor_ps(y, sign_mask), b2 + i);
+    }
+#endif
+    for (; i < count; i++)
+        orthonormal_basis(n[i], b1[i], b2[i]);
+}
+
+// tangent and bitangent of a triangle, scaled by the inverse of the signed area in texture space; false if the
+// texture coordinates are degenerate
+template <typename T>
+bool triangle_tangents(const Vector3<T> &p0, const Vector3<T> &p1, const Vector3<T> &p2, const Vector2<T> &uv0,
+                       const Vector2<T> &uv1, const Vector2<T> &uv2, Vector3<T> &t, Vector3<T> &b) {
+    const Vector3<T> e1 = p1 - p0, e2 = p2 - p0;
+    const T du1 = uv1.x - uv0.x, dv1 = uv1.y - uv0.y, du2 = uv2.x - uv0.x, dv2 = uv2.y - uv0.y;
+    const T det = du1 * dv2 - du2 * dv1;
+    if (!(std::abs(det) > std::numeric_limits<T>::min()))
+        return false;
+    const T r = T(1) / det;
+    t = (e1 * dv2 - e2 * dv1) * r;
+    b = (e2 * du1 - e1 * du2) * r;
+    return true;
+}
+
+} // namespace detail
+
+template <typename T> Matrix3<T> orthonormal_basis(const Vector3<T> &n) {
+    Vector3<T> b1, b2;
+    orthonormal_basis(n, b1, b2);
+    return detail::from_columns(b1, b2, n);
+}
+
+inline void orthonormal_basis(const Vector3f *n, Vector3f *b1, Vector3f *b2, size_t count, unsigned threads) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        detail::orthonormal_basis_range(n + begin, b1 + begin, b2 + begin, end - begin);
+    });
+}
+
+template <typename T>
+void compute_tangents(const Vector3<T> *positions, const Vector3<T> *normals, const Vector2<T> *uvs,
+                      size_t vertex_count, const uint32_t *indices, size_t triangle_count, Vector4<T> *tangents,
+                      Vector3<T> *bitangents, unsigned threads) {
+    // the triangle tangents are summed per vertex in index order (in the xyz of the output tangents and in a
+    // temporary array for the bitangents), then orthogonalized in parallel
+    std::vector<Vector3<T>> bitangent_sum(vertex_count, Vector3<T>(T(0), T(0), T(0)));
+    for (size_t v = 0; v < vertex_count; v++)
+        tangents[v] = Vector4<T>(T(0), T(0), T(0), T(0));
+    for (size_t f = 0; f < triangle_count; f++) {
+        const uint32_t *v = indices + 3 * f;
+        Vector3<T> t, b;
+        if (!detail::triangle_tangents(positions[v[0]], positions[v[1]], positions[v[2]], uvs[v[0]], uvs[v[1]],
+                                       uvs[v[2]], t, b))
+            continue;
+        for (int k = 0; k < 3; k++) {
+            Vector4<T> &sum = tangents[v[k]];
+            sum = Vector4<T>(sum.x + t.x, sum.y + t.y, sum.z + t.z, T(0));
+            bitangent_sum[v[k]] += b;
+        }
+    }
+    parallel_for(vertex_count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++) {
+            const Vector3<T> &n = normals[v];
+            // Gram-Schmidt
+            const Vector3<T> sum(tangents[v].x, tangents[v].y, tangents[v].z);
+            Vector3<T> t = sum - n * n.dot(sum);
+            const T len2 = length2(t);
+            if (len2 > std::numeric_limits<T>::min()) {
+                t = t * (T(1) / std::sqrt(len2));
+            } else {
+                Vector3<T> b2;
+                orthonormal_basis(n, t, b2);
+            }
+            const T w = n.cross(t).dot(bitangent_sum[v]) < T(0) ? T(-1) : T(1);
+            tangents[v] = Vector4<T>(t.x, t.y, t.z, w);
+            if (bitangents)
+                bitangents[v] = n.cross(t) * w;
+        }
+    });
+}
+
+template <typename T> Quaternion<T> qtangent_encode(const Vector3<T> &normal, const Vector4<T> &tangent) {
+    const Vector3<T> t(tangent.x, tangent.y, tangent.z);
+    Quaternion<T> q = normalized(quat_from_matrix(detail::from_columns(t, normal.cross(t), normal)));
+    if (q.w < T(0))
+        q = Quaternion<T>(-q.w, -q.x, -q.y, -q.z);
+    const T bias = T(1) / T(32767);
+    if (q.w < bias) {
+        const T s = std::sqrt(T(1) - bias * bias);
+        q = Quaternion<T>(bias, q.x * s, q.y * s, q.z * s);
+    }
+    if (tangent.w < T(0))
+        q = Quaternion<T>(-q.w, -q.x, -q.y, -q.z);
+    return q;
+}
+
+template <typename T> void qtangent_decode(const Quaternion<T> &q, Vector3<T> &normal, Vector4<T> &tangent) {
+    // first and third columns of the rotation matrix
+    const T x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+    const T xx = q.x * x2, yy = q.y * y2, zz = q.z * z2, xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+    const T wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+    tangent = Vector4<T>(T(1) - yy - zz, xy + wz, xz - wy, q.w < T(0) ? T(-1) : T(1));
+    normal = Vector3<T>(xz + wy, yz - wx, T(1) - xx - yy);
+}
+
+template <typename T>
+void qtangent_encode(const Vector3<T> *normals, const Vector4<T> *tangents, Quaternion<T> *out, size_t count,
+                     unsigned threads) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            out[i] = qtangent_encode(normals[i], tangents[i]);
+    });
+}
+
+template <typename T>
+void qtangent_decode(const Quaternion<T> *q, Vector3<T> *normals, Vector4<T> *tangents, size_t count,
+                     unsigned threads) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            qtangent_decode(q[i], normals[i], tangents[i]);
+    });
+}
+
+} // namespace math
@@ -0,0 +1,546 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+#pragma once
+
+#include "vmath.h"
+
+#include <cassert>
+#include <initializer_list>
+
+namespace math {
+
+namespace detail {
+// the hand-written type with the same size and layout (if any), used for the implicit conversions
+struct NoFixedType {};
+template <int N, typename T> struct FixedVector { typedef NoFixedType type; };
+template <typename T> struct FixedVector<2, T> { typedef Vector2<T> type; };
+template <typename T> struct FixedVector<3, T> { typedef Vector3<T> type; };
+template <typename T> struct FixedVector<4, T> { typedef Vector4<T> type; };
+template <int R, int C, typename T> struct FixedMatrix { typedef NoFixedType type; };
+template <typename T> struct FixedMatrix<3, 3, T> { typedef Matrix3<T> type; };
+template <typename T> struct FixedMatrix<4, 4, T> { typedef Matrix4<T> type; };
+} // namespace detail
+
+// //////////////// //
+// N-D fixed Vector //
+// //////////////// //
+
+/// vector with a compile time dimension, stored on the stack; all the loops have constant trip counts, so that the
+/// compiler can unroll them. Vector<2/3/4, T> have the same layout as Vector2/3/4<T> and convert implicitly.
+template <int N, typename T> struct Vector {
+    static_assert(N > 0, "the vector dimension must be positive");
+    typedef T value_type; // to access the inner type at compile time
+    T data[N];
+
+    // constructors
+    Vector() {
+        for (int i = 0; i < N; i++)
+            data[i] = T(0);
+    }
+    Vector(const Vector<N, T> &src) = default;
+    template <typename fromT> Vector(const Vector<N, fromT> &src) {
+        for (int i = 0; i < N; i++)
+            data[i] = static_cast<T>(src.data[i]);
+    }
+    explicit Vector(const T *dt) {
+        for (int i = 0; i < N; i++)
+            data[i] = dt[i];
+    }
+    Vector(std::initializer_list<T> values) {
+        assert(values.size() == size_t(N));
+        int i = 0;
+        for (auto it = values.begin(); it != values.end() && i < N; ++it)
+            data[i++] = *it;
+        for (; i < N; i++)
+            data[i] = T(0);
+    }
+    // conversion from/to the hand-written type of the same size
+    Vector(const typename detail::FixedVector<N, T>::type &src) {
+        for (int i = 0; i < N; i++)
+            data[i] = src[i];
+    }
+    operator typename detail::FixedVector<N, T>::type() const {
+        typename detail::FixedVector<N, T>::type ret;
+        for (int i = 0; i < N; i++)
+            ret[i] = data[i];
+        return ret;
+    }
+    // comparison
+    bool operator==(const Vector<N, T> &rhs) const {
+        using std::abs;
+        for (int i = 0; i < N; i++)
+            if (abs(data[i] - rhs.data[i]) >= VMATH_EPSILON)
+                return false;
+        return true;
+    }
+    bool operator!=(const Vector<N, T> &rhs) const { return !(*this == rhs); }
+    // access
+    T &operator[](int n) {
+        assert(n >= 0 && n < N);
+        return data[n];
+    }
+    const T &operator[](int n) const {
+        assert(n >= 0 && n < N);
+        return data[n];
+    }
+    // assignment operators
+    Vector<N, T> &operator=(const Vector<N, T> &rhs) = default;
+    void operator+=(const Vector<N, T> &rhs) {
+        for (int i = 0; i < N; i++)
+            data[i] += rhs.data[i];
+    }
+    void operator-=(const Vector<N, T> &rhs) {
+        for (int i = 0; i < N; i++)
+            data[i] -= rhs.data[i];
+    }
+    void operator*=(T rhs) {
+        for (int i = 0; i < N; i++)
+            data[i] *= rhs;
+    }
+    void operator/=(T rhs) {
+        for (int i = 0; i < N; i++)
+            data[i] /= rhs;
+    }
+    // pointer to the underlying data (for passing the instance as a T*)
+    T *ptr() { return data; }
+    const T *ptr() const { return data; }
+};
+
+// unary operators
+template <int N, typename T> Vector<N, T> operator-(const Vector<N, T> &v);
+// vector operations
+template <int N, typename T> Vector<N, T> operator+(const Vector<N, T> &v1, const Vector<N, T> &v2);
+template <int N, typename T> Vector<N, T> operator-(const Vector<N, T> &v1, const Vector<N, T> &v2);
+// scalar operations
+template <int N, typename T> Vector<N, T> operator*(const Vector<N, T> &v, T s);
+template <int N, typename T> Vector<N, T> operator*(T s, const Vector<N, T> &v);
+template <int N, typename T> Vector<N, T> operator/(const Vector<N, T> &v, T s);
+
+/// dot product
+template <int N, typename T> T dot(const Vector<N, T> &v1, const Vector<N, T> &v2);
+/// get length of vector.
+template <int N, typename T> T length(const Vector<N, T> &v);
+/// square of length.
+template <int N, typename T> T length2(const Vector<N, T> &v);
+/// get the normalized vector
+template <int N, typename T> Vector<N, T> normalized(const Vector<N, T> &v);
+/// normalize vector
+template <int N, typename T> void normalize(Vector<N, T> &v);
+/// the M elements starting at index i
+template <int M, int N, typename T> Vector<M, T> segment(const Vector<N, T> &v, int i);
+/// overwrite the M elements starting at index i
+template <int M, int N, typename T> void set_segment(Vector<N, T> &v, int i, const Vector<M, T> &s);
+
+// ////////////////// //
+// RxC fixed Matrix   //
+// ////////////////// //
+
+/// matrix with compile time dimensions (R rows, C columns), stored on the stack in column-major order like
+/// Matrix3/Matrix4. The products use SSE2 kernels for float and double (4 and 2 rows at a time). Matrix<3, 3, T>
+/// and Matrix<4, 4, T> have the same layout as Matrix3/4<T> and convert implicitly.
+template <int R, int C, typename T> struct Matrix {
+    static_assert(R > 0 && C > 0, "the matrix dimensions must be positive");
+    typedef T value_type; // to access the inner type at compile time
+    T data[R * C];        ///< values (stored in column-major order)
+
+    // constructors
+    Matrix() ///< default to null matrix
+    {
+        for (int i = 0; i < R * C; i++)
+            data[i] = T(0);
+    }
+    Matrix(const Matrix<R, C, T> &src) = default;
+    template <typename fromT> Matrix(const Matrix<R, C, fromT> &src) {
+        for (int i = 0; i < R * C; i++)
+            data[i] = static_cast<T>(src.data[i]);
+    }
+    // from arrays. Note: the input arrays are assumed in row-major, as for Matrix3/Matrix4
+    explicit Matrix(const T *dt) {
+        for (int i = 0; i < R; i++)
+            for (int j = 0; j < C; j++)
+                data[j * R + i] = dt[i * C + j];
+    }
+    Matrix(std::initializer_list<T> values) {
+        assert(values.size() == size_t(R * C));
+        for (int i = 0; i < R * C; i++)
+            data[i] = T(0);
+        int n = 0;
+        for (auto it = values.begin(); it != values.end() && n < R * C; ++it, n++)
+            data[(n % C) * R + n / C] = *it;
+    }
+    // conversion from/to the hand-written type of the same size
+    Matrix(const typename detail::FixedMatrix<R, C, T>::type &src) {
+        for (int i = 0; i < R * C; i++)
+            data[i] = src.data[i];
+    }
+    operator typename detail::FixedMatrix<R, C, T>::type() const {
+        typename detail::FixedMatrix<R, C, T>::type ret;
+        for (int i = 0; i < R * C; i++)
+            ret.data[i] = data[i];
+        return ret;
+    }
+    // comparison
+    bool operator==(const Matrix<R, C, T> &rhs) const {
+        using std::abs;
+        for (int i = 0; i < R * C; i++)
+            if (abs(data[i] - rhs.data[i]) >= VMATH_EPSILON)
+                return false;
+        return true;
+    }
+    bool operator!=(const Matrix<R, C, T> &rhs) const { return !(*this == rhs); }
+    /// element at position (i,j), with linear algebra matrix notation (row,column)
+    T &operator()(int i, int j) {
+        assert(i >= 0 && i < R && j >= 0 && j < C);
+        return data[j * R + i];
+    }
+    const T &operator()(int i, int j) const {
+        assert(i >= 0 && i < R && j >= 0 && j < C);
+        return data[j * R + i];
+    }
+    /// column j / row i as a vector
+    Vector<R, T> col(int j) const { return Vector<R, T>(data + j * R); }
+    Vector<C, T> row(int i) const {
+        Vector<C, T> ret;
+        for (int j = 0; j < C; j++)
+            ret.data[j] = data[j * R + i];
+        return ret;
+    }
+    void set_col(int j, const Vector<R, T> &v) {
+        for (int i = 0; i < R; i++)
+            data[j * R + i] = v.data[i];
+    }
+    void set_row(int i, const Vector<C, T> &v) {
+        for (int j = 0; j < C; j++)
+            data[j * R + i] = v.data[j];
+    }
+    // assignment operators
+    Matrix<R, C, T> &operator=(const Matrix<R, C, T> &rhs) = default;
+    void operator+=(const Matrix<R, C, T> &rhs) {
+        for (int i = 0; i < R * C; i++)
+            data[i] += rhs.data[i];
+    }
+    void operator-=(const Matrix<R, C, T> &rhs) {
+        for (int i = 0; i < R * C; i++)
+            data[i] -= rhs.data[i];
+    }
+    // scalar operations
+    void operator*=(T rhs) {
+        for (int i = 0; i < R * C; i++)
+            data[i] *= rhs;
+    }
+    void operator/=(T rhs) {
+        for (int i = 0; i < R * C; i++)
+            data[i] /= rhs;
+    }
+    // pointer to the underlying data (for passing the instance as a T*)
+    T *ptr() { return data; }
+    const T *ptr() const { return data; }
+};
+
+// unary operators
+template <int R, int C, typename T> Matrix<R, C, T> operator-(const Matrix<R, C, T> &m);
+// matrix operations
+template <int R, int C, typename T> Matrix<R, C, T> operator+(const Matrix<R, C, T> &m1, const Matrix<R, C, T> &m2);
+template <int R, int C, typename T> Matrix<R, C, T> operator-(const Matrix<R, C, T> &m1, const Matrix<R, C, T> &m2);
+template <int R, int K, int C, typename T>
+Matrix<R, C, T> operator*(const Matrix<R, K, T> &m1, const Matrix<K, C, T> &m2);
+// scalar operations
+template <int R, int C, typename T> Matrix<R, C, T> operator*(const Matrix<R, C, T> &m, T s);
+template <int R, int C, typename T> Matrix<R, C, T> operator*(T s, const Matrix<R, C, T> &m);
+template <int R, int C, typename T> Matrix<R, C, T> operator/(const Matrix<R, C, T> &m, T s);
+// vector operations
+template <int R, int C, typename T> Vector<R, T> operator*(const Matrix<R, C, T> &m, const Vector<C, T> &v);
+
+/// set matrix to zero
+template <int R, int C, typename T> void set_zero(Matrix<R, C, T> &m);
+/// set matrix to identity
+template <int N, typename T> void set_identity(Matrix<N, N, T> &m);
+/// transpose (square matrices only)
+template <int N, typename T> void transpose(Matrix<N, N, T> &m);
+/// get the transposed matrix
+template <int R, int C, typename T> Matrix<C, R, T> transposed(const Matrix<R, C, T> &m);
+/// transpose(m) * v, without forming the transposed matrix
+template <int R, int C, typename T> Vector<C, T> transpose_mul(const Matrix<R, C, T> &m, const Vector<R, T> &v);
+/// sum of the diagonal elements
+template <int N, typename T> T trace(const Matrix<N, N, T> &m);
+/// outer product v1 * transpose(v2)
+template <int R, int C, typename T> Matrix<R, C, T> outer(const Vector<R, T> &v1, const Vector<C, T> &v2);
+/// the R2xC2 block with the top left element at (i,j)
+template <int R2, int C2, int R, int C, typename T> Matrix<R2, C2, T> block(const Matrix<R, C, T> &m, int i, int j);
+/// overwrite the block with the top left element at (i,j)
+template <int R2, int C2, int R, int C, typename T>
+void set_block(Matrix<R, C, T> &m, int i, int j, const Matrix<R2, C2, T> &b);
+
+// ///////////// //
+// common sizes  //
+// ///////////// //
+
+template <typename T> using Vector6 = Vector<6, T>;
+template <typename T> using Matrix6 = Matrix<6, 6, T>;
+typedef Vector6<float> Vector6f;
+typedef Vector6<double> Vector6d;
+typedef Matrix6<float> Matrix6f;
+typedef Matrix6<double> Matrix6d;
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+// y = a * x, with a R x C column-major and x of size C (y must not alias x)
+template <int R, int C, typename T> inline void mat_vec(const T *a, const T *x, T *y) {
+    for (int i = 0; i < R; i++)
+        y[i] = a[i] * x[0];
+    for (int j = 1; j < C; j++)
+        for (int i = 0; i < R; i++)
+            y[i] += a[j * R + i] * x[j];
+}
+
+#if defined(VMATH_SSE2)
+// 4 rows at a time: each column contributes a broadcast multiply-add, so there are no horizontal sums
+template <int R, int C> inline void mat_vec(const float *a, const float *x, float *y) {
+    int i = 0;
+    for (; i + 4 <= R; i += 4) {
+        __m128 acc = _mm_mul_ps(_mm_loadu_ps(a + i), _mm_set1_ps(x[0]));
+        for (int j = 1; j < C; j++)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + j * R + i), _mm_set1_ps(x[j])));
+        _mm_storeu_ps(y + i, acc);
+    }
+    for (; i < R; i++) {
+        float acc = a[i] * x[0];
+        for (int j = 1; j < C; j++)
+            acc += a[j * R + i] * x[j];
+        y[i] = acc;
+    }
+}
+template <int R, int C> inline void mat_vec(const double *a, const double *x, double *y) {
+    int i = 0;
+    for (; i + 2 <= R; i += 2) {
+        __m128d acc = _mm_mul_pd(_mm_loadu_pd(a + i), _mm_set1_pd(x[0]));
+        for (int j = 1; j < C; j++)
+            acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(a + j * R + i), _mm_set1_pd(x[j])));
+        _mm_storeu_pd(y + i, acc);
+    }
+    for (; i < R; i++) {
+        double acc = a[i] * x[0];
+        for (int j = 1; j < C; j++)
+            acc += a[j * R + i] * x[j];
+        y[i] = acc;
+    }
+}
+#endif
+
+} // namespace detail
+
+template <int N, typename T> inline Vector<N, T> operator-(const Vector<N, T> &v) {
+    Vector<N, T> ret;
+    for (int i = 0; i < N; i++)
+        ret.data[i] = -v.data[i];
+    return ret;
+}
+template <int N, typename T> inline Vector<N, T> operator+(const Vector<N, T> &v1, const Vector<N, T> &v2) {
+    Vector<N, T> ret;
+    for (int i = 0; i < N; i++)
+        ret.data[i] = v1.data[i] + v2.data[i];
+    return ret;
+}
+template <int N, typename T> inline Vector<N, T> operator-(const Vector<N, T> &v1, const Vector<N, T> &v2) {
+    Vector<N, T> ret;
+    for (int i = 0; i < N; i++)
+        ret.data[i] = v1.data[i] - v2.data[i];
+    return ret;
+}
+template <int N, typename T> inline Vector<N, T> operator*(const Vector<N, T> &v, T s) {
+    Vector<N, T> ret;
+    for (int i = 0; i < N; i++)
+        ret.data[i] = v.data[i] * s;
+    return ret;
+}
+template <int N, typename T> inline Vector<N, T> operator*(T s, const Vector<N, T> &v) {
+    Vector<N, T> ret;
+    for (int i = 0; i < N; i++)
+        ret.data[i] = s * v.data[i];
+    return ret;
+}
+template <int N, typename T> inline Vector<N, T> operator/(const Vector<N, T> &v, T s) {
+    Vector<N, T> ret;
+    for (int i = 0; i < N; i++)
+        ret.data[i] = v.data[i] / s;
+    return ret;
+}
+
+template <int N, typename T> inline T dot(const Vector<N, T> &v1, const Vector<N, T> &v2) {
+    T ret = v1.data[0] * v2.data[0];
+    for (int i = 1; i < N; i++)
+        ret += v1.data[i] * v2.data[i];
+    return ret;
+}
+template <int N, typename T> inline T length(const Vector<N, T> &v) {
+    using std::sqrt;
+    return sqrt(length2(v));
+}
+template <int N, typename T> inline T length2(const Vector<N, T> &v) { return dot(v, v); }
+template <int N, typename T> inline Vector<N, T> normalized(const Vector<N, T> &v) { return v / length(v); }
+template <int N, typename T> inline void normalize(Vector<N, T> &v) { v /= length(v); }
+template <int M, int N, typename T> inline Vector<M, T> segment(const Vector<N, T> &v, int i) {
+    static_assert(M <= N, "the segment is larger than the vector");
+    assert(i >= 0 && i + M <= N);
+    return Vector<M, T>(v.data + i);
+}
+template <int M, int N, typename T> inline void set_segment(Vector<N, T> &v, int i, const Vector<M, T> &s) {
+    static_assert(M <= N, "the segment is larger than the vector");
+    assert(i >= 0 && i + M <= N);
+    for (int k = 0; k < M; k++)
+        v.data[i + k] = s.data[k];
+}
+
+template <int R, int C, typename T> inline Matrix<R, C, T> operator-(const Matrix<R, C, T> &m) {
+    Matrix<R, C, T> ret;
+    for (int i = 0; i < R * C; i++)
+        ret.data[i] = -m.data[i];
+    return ret;
+}
+template <int R, int C, typename T>
+inline Matrix<R, C, T> operator+(const Matrix<R, C, T> &m1, const Matrix<R, C, T> &m2) {
+    Matrix<R, C, T> ret;
+    for (int i = 0; i < R * C; i++)
+        ret.data[i] = m1.data[i] + m2.data[i];
+    return ret;
+}
+template <int R, int C, typename T>
+inline Matrix<R, C, T> operator-(const Matrix<R, C, T> &m1, const Matrix<R, C, T> &m2) {
+    Matrix<R, C, T> ret;
+    for (int i = 0; i < R * C; i++)
+        ret.data[i] = m1.data[i] - m2.data[i];
+    return ret;
+}
+template <int R, int K, int C, typename T>
+inline Matrix<R, C, T> operator*(const Matrix<R, K, T> &m1, const Matrix<K, C, T> &m2) {
+    // column j of the product is m1 * (column j of m2)
+    Matrix<R, C, T> ret;
+    for (int j = 0; j < C; j++)
+        detail::mat_vec<R, K>(m1.data, m2.data + j * K, ret.data + j * R);
+    return ret;
+}
+template <int R, int C, typename T> inline Matrix<R, C, T> operator*(const Matrix<R, C, T> &m, T s) {
+    Matrix<R, C, T> ret;
+    for (int i = 0; i < R * C; i++)
+        ret.data[i] = m.data[i] * s;
+    return ret;
+}
+template <int R, int C, typename T> inline Matrix<R, C, T> operator*(T s, const Matrix<R, C, T> &m) {
+    Matrix<R, C, T> ret;
+    for (int i = 0; i < R * C; i++)
+        ret.data[i] = s * m.data[i];
+    return ret;
+}
+template <int R, int C, typename T> inline Matrix<R, C, T> operator/(const Matrix<R, C, T> &m, T s) {
+    Matrix<R, C, T> ret;
+    for (int i = 0; i < R * C; i++)
+        ret.data[i] = m.data[i] / s;
+    return ret;
+}
+template <int R, int C, typename T> inline Vector<R, T> operator*(const Matrix<R, C, T> &m, const Vector<C, T> &v) {
+    Vector<R, T> ret;
+    detail::mat_vec<R, C>(m.data, v.data, ret.data);
+    return ret;
+}
+
+template <int R, int C, typename T> inline void set_zero(Matrix<R, C, T> &m) {
+    for (int i = 0; i < R * C; i++)
+        m.data[i] = T(0);
+}
+template <int N, typename T> inline void set_identity(Matrix<N, N, T> &m) {
+    for (int i = 0; i < N * N; i++)
+        m.data[i] = T(0);
+    for (int i = 0; i < N; i++)
+        m.data[i * N + i] = T(1);
+}
+template <int N, typename T> inline void transpose(Matrix<N, N, T> &m) {
+    for (int j = 1; j < N; j++)
+        for (int i = 0; i < j; i++) {
+            T tmp = m.data[j * N + i];
+            m.data[j * N + i] = m.data[i * N + j];
+            m.data[i * N + j] = tmp;
+        }
+}
+template <int R, int C, typename T> inline Matrix<C, R, T> transposed(const Matrix<R, C, T> &m) {
+    Matrix<C, R, T> ret;
+    for (int j = 0; j < C; j++)
+        for (int i = 0; i < R; i++)
+            ret.data[i * C + j] = m.data[j * R + i];
+    return ret;
+}
+template <int R, int C, typename T>
+inline Vector<C, T> transpose_mul(const Matrix<R, C, T> &m, const Vector<R, T> &v) {
+    // element j is the dot product of column j with v
+    Vector<C, T> ret;
+    for (int j = 0; j < C; j++) {
+        T acc = m.data[j * R] * v.data[0];
+        for (int i = 1; i < R; i++)
+            acc += m.data[j * R + i] * v.data[i];
+        ret.data[j] = acc;
+    }
+    return ret;
+}
+template <int N, typename T> inline T trace(const Matrix<N, N, T> &m) {
+    T ret = m.data[0];
+    for (int i = 1; i < N; i++)
+        ret += m.data[i * N + i];
+    return ret;
+}
+template <int R, int C, typename T> inline Matrix<R, C, T> outer(const Vector<R, T> &v1, const Vector<C, T> &v2) {
+    Matrix<R, C, T> ret;
+    for (int j = 0; j < C; j++)
+        for (int i = 0; i < R; i++)
+            ret.data[j * R + i] = v1.data[i] * v2.data[j];
+    return ret;
+}
+template <int R2, int C2, int R, int C, typename T>
+inline Matrix<R2, C2, T> block(const Matrix<R, C, T> &m, int i, int j) {
+    static_assert(R2 <= R && C2 <= C, "the block is larger than the matrix");
+    assert(i >= 0 && i + R2 <= R && j >= 0 && j + C2 <= C);
+    Matrix<R2, C2, T> ret;
+    for (int c = 0; c < C2; c++)
+        for (int r = 0; r < R2; r++)
+            ret.data[c * R2 + r] = m.data[(j + c) * R + i + r];
+    return ret;
+}
+template <int R2, int C2, int R, int C, typename T>
+inline void set_block(Matrix<R, C, T> &m, int i, int j, const Matrix<R2, C2, T> &b) {
+    static_assert(R2 <= R && C2 <= C, "the block is larger than the matrix");
+    assert(i >= 0 && i + R2 <= R && j >= 0 && j + C2 <= C);
+    for (int c = 0; c < C2; c++)
+        for (int r = 0; r < R2; r++)
+            m.data[(j + c) * R + i + r] = b.data[c * R2 + r];
+}
+
+static_assert(sizeof(Vector<3, float>) == sizeof(Vector3f) && sizeof(Vector<4, double>) == sizeof(Vector4d),
+              "Vector<N, T> must match the layout of the hand-written vectors");
+static_assert(sizeof(Matrix<3, 3, float>) == sizeof(Matrix3f) && sizeof(Matrix<4, 4, double>) == sizeof(Matrix4d),
+              "Matrix<R, C, T> must match the layout of the hand-written matrices");
+
+} // namespace math
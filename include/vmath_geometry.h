@@ -0,0 +1,673 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+#pragma once
+
+#include "vmath.h"
+#include "vmath_simd_detail.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace math {
+
+// ////////// //
+// primitives //
+// ////////// //
+
+/// axis aligned bounding box
+template <typename T> struct AABB {
+    typedef T value_type; // to access the inner type at compile time
+    Vector3<T> min; ///< minimum corner
+    Vector3<T> max; ///< maximum corner
+};
+
+/// oriented bounding box
+template <typename T> struct OBB {
+    typedef T value_type; // to access the inner type at compile time
+    Vector3<T> center;       ///< center of the box
+    Matrix3<T> rotation;     ///< orientation: the columns are the (unit) axes of the box
+    Vector3<T> half_extents; ///< half size along each of the box axes
+};
+
+/// sphere
+template <typename T> struct Sphere {
+    typedef T value_type; // to access the inner type at compile time
+    Vector3<T> center;
+    T radius = T(0);
+};
+
+/// capsule (sphere-swept segment)
+template <typename T> struct Capsule {
+    typedef T value_type; // to access the inner type at compile time
+    Vector3<T> p0; ///< first end point of the inner segment
+    Vector3<T> p1; ///< second end point of the inner segment
+    T radius = T(0);
+};
+
+typedef AABB<float> AABBf;
+typedef AABB<double> AABBd;
+typedef OBB<float> OBBf;
+typedef OBB<double> OBBd;
+typedef Sphere<float> Spheref;
+typedef Sphere<double> Sphered;
+typedef Capsule<float> Capsulef;
+typedef Capsule<double> Capsuled;
+
+/// create an OBB from a rigid transform (box pose) and the half extents of the box
+template <typename T> OBB<T> create_obb(const Transform<T> &pose, const Vector3<T> &half_extents);
+/// smallest AABB containing the points (count must be > 0)
+template <typename T> AABB<T> fit_aabb(const Vector3<T> *points, size_t count);
+/// OBB containing the points, oriented along the principal axes of their covariance matrix (PCA fit).
+/// The fit costs a single pass to accumulate the covariance, one 3x3 symmetric eigen decomposition and a
+/// second pass to project the points on the axes; the result is tight for elongated point sets but it is
+/// not the minimum volume box. count must be > 0.
+template <typename T> OBB<T> fit_obb(const Vector3<T> *points, size_t count);
+/// OBB moved by a rigid transform
+template <typename T> OBB<T> transformed(const OBB<T> &box, const Transform<T> &t);
+/// OBB transformed by an affine matrix. The axes are rotated and the extents are scaled by the length of the
+/// transformed axes, which is exact for rotation, translation and scaling along the box axes (in general,
+/// for any matrix that keeps the box axes orthogonal); shear is not represented.
+template <typename T> OBB<T> transformed(const OBB<T> &box, const Matrix4<T> &m);
+
+// ////////////// //
+// closest points //
+// ////////////// //
+
+/// closest point to p on the segment [a,b]
+template <typename T>
+Vector3<T> closest_point_on_segment(const Vector3<T> &p, const Vector3<T> &a, const Vector3<T> &b);
+/// closest point to p on the triangle (a,b,c)
+template <typename T>
+Vector3<T> closest_point_on_triangle(const Vector3<T> &p, const Vector3<T> &a, const Vector3<T> &b,
+                                    const Vector3<T> &c);
+/// closest point to p on (or inside) the box
+template <typename T> Vector3<T> closest_point_on_aabb(const Vector3<T> &p, const AABB<T> &box);
+/// closest point to p on (or inside) the box
+template <typename T> Vector3<T> closest_point_on_obb(const Vector3<T> &p, const OBB<T> &box);
+/// closest points between the segments [p1,q1] and [p2,q2].
+/// @param c1 closest point on the first segment
+/// @param c2 closest point on the second segment
+/// @return the squared distance between the segments
+template <typename T>
+T closest_points_segment_segment(const Vector3<T> &p1, const Vector3<T> &q1, const Vector3<T> &p2, const Vector3<T> &q2,
+                                 Vector3<T> &c1, Vector3<T> &c2);
+
+// ///////// //
+// distances //
+// ///////// //
+
+/// squared distance between the point p and the segment [a,b]
+template <typename T> T distance2_point_segment(const Vector3<T> &p, const Vector3<T> &a, const Vector3<T> &b);
+/// squared distance between the segments [p1,q1] and [p2,q2]
+template <typename T>
+T distance2_segment_segment(const Vector3<T> &p1, const Vector3<T> &q1, const Vector3<T> &p2, const Vector3<T> &q2);
+
+// ///////////// //
+// overlap tests //
+// ///////////// //
+
+template <typename T> bool overlap(const Sphere<T> &a, const Sphere<T> &b);
+template <typename T> bool overlap(const Sphere<T> &a, const Capsule<T> &b);
+template <typename T> bool overlap(const Capsule<T> &a, const Sphere<T> &b);
+template <typename T> bool overlap(const Capsule<T> &a, const Capsule<T> &b);
+template <typename T> bool overlap(const Sphere<T> &a, const AABB<T> &b);
+template <typename T> bool overlap(const AABB<T> &a, const Sphere<T> &b);
+template <typename T> bool overlap(const Sphere<T> &a, const OBB<T> &b);
+template <typename T> bool overlap(const OBB<T> &a, const Sphere<T> &b);
+template <typename T> bool overlap(const AABB<T> &a, const AABB<T> &b);
+/// separating axis test on the 15 candidate axes (3 + 3 face normals, 9 edge cross products)
+template <typename T> bool overlap(const OBB<T> &a, const OBB<T> &b);
+
+// ////////////// //
+// batch variants //
+// ////////////// //
+
+// the closest point queries on Vector3f arrays have SSE2 kernels working on 4 points at a time; the other types and
+// the batch overlap tests are plain loops over the scalar functions
+
+/// closest points on the segment [a,b] for an array of points
+template <typename T>
+void closest_point_on_segment(const Vector3<T> *p, size_t count, const Vector3<T> &a, const Vector3<T> &b,
+                              Vector3<T> *out);
+/// closest points on the triangle (a,b,c) for an array of points
+template <typename T>
+void closest_point_on_triangle(const Vector3<T> *p, size_t count, const Vector3<T> &a, const Vector3<T> &b,
+                               const Vector3<T> &c, Vector3<T> *out);
+/// closest points on the box for an array of points
+template <typename T>
+void closest_point_on_aabb(const Vector3<T> *p, size_t count, const AABB<T> &box, Vector3<T> *out);
+/// closest points on the box for an array of points
+template <typename T> void closest_point_on_obb(const Vector3<T> *p, size_t count, const OBB<T> &box, Vector3<T> *out);
+/// overlap test between the pairs (a[i], b[i]), for any pair of primitives supported by overlap(); a convenience loop
+/// over the scalar tests
+template <typename A, typename B> void overlap(const A *a, const B *b, size_t count, bool *result);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+template <typename T> inline OBB<T> create_obb(const Transform<T> &pose, const Vector3<T> &half_extents) {
+    OBB<T> box;
+    box.center = pose.p;
+    box.rotation = rot_matrix(pose.q);
+    box.half_extents = half_extents;
+    return box;
+}
+
+template <typename T> inline AABB<T> fit_aabb(const Vector3<T> *points, size_t count) {
+    AABB<T> box;
+    box.min = box.max = points[0];
+    for (size_t i = 1; i < count; i++) {
+        const Vector3<T> &p = points[i];
+        box.min = Vector3<T>(std::min(box.min.x, p.x), std::min(box.min.y, p.y), std::min(box.min.z, p.z));
+        box.max = Vector3<T>(std::max(box.max.x, p.x), std::max(box.max.y, p.y), std::max(box.max.z, p.z));
+    }
+    return box;
+}
+
+template <typename T> OBB<T> fit_obb(const Vector3<T> *points, size_t count) {
+    // covariance in a single pass; the sums are accumulated relative to the first point to limit cancellation
+    const Vector3<T> o = points[0];
+    T sx = 0, sy = 0, sz = 0, sxx = 0, syy = 0, szz = 0, sxy = 0, sxz = 0, syz = 0;
+    for (size_t i = 0; i < count; i++) {
+        const T x = points[i].x - o.x, y = points[i].y - o.y, z = points[i].z - o.z;
+        sx += x;
+        sy += y;
+        sz += z;
+        sxx += x * x;
+        syy += y * y;
+        szz += z * z;
+        sxy += x * y;
+        sxz += x * z;
+        syz += y * z;
+    }
+    const T inv_n = T(1) / T(count);
+    const T mx = sx * inv_n, my = sy * inv_n, mz = sz * inv_n;
+    const T cxy = sxy * inv_n - mx * my, cxz = sxz * inv_n - mx * mz, cyz = syz * inv_n - my * mz;
+    const Matrix3<T> cov{sxx * inv_n - mx * mx, cxy, cxz,
+                         cxy, syy * inv_n - my * my, cyz,
+                         cxz, cyz, szz * inv_n - mz * mz};
+    OBB<T> box;
+    Vector3<T> eigenvalues;
+    eigen_decompose(cov, box.rotation, eigenvalues);
+    // extent of the points along the principal axes
+    const Matrix3<T> &r = box.rotation;
+    const Vector3<T> ax(r(0, 0), r(1, 0), r(2, 0));
+    const Vector3<T> ay(r(0, 1), r(1, 1), r(2, 1));
+    const Vector3<T> az(r(0, 2), r(1, 2), r(2, 2));
+    Vector3<T> lo(ax.dot(points[0] - o), ay.dot(points[0] - o), az.dot(points[0] - o));
+    Vector3<T> hi = lo;
+    for (size_t i = 1; i < count; i++) {
+        const Vector3<T> d = points[i] - o;
+        const T x = ax.dot(d), y = ay.dot(d), z = az.dot(d);
+        lo = Vector3<T>(std::min(lo.x, x), std::min(lo.y, y), std::min(lo.z, z));
+        hi = Vector3<T>(std::max(hi.x, x), std::max(hi.y, y), std::max(hi.z, z));
+    }
+    const Vector3<T> mid = (lo + hi) * T(0.5);
+    box.center = o + ax * mid.x + ay * mid.y + az * mid.z;
+    box.half_extents = (hi - lo) * T(0.5);
+    return box;
+}
+
+template <typename T> inline OBB<T> transformed(const OBB<T> &box, const Transform<T> &t) {
+    OBB<T> res;
+    res.center = t.transform(box.center);
+    res.rotation = rot_matrix(t.q) * box.rotation;
+    res.half_extents = box.half_extents;
+    return res;
+}
+
+template <typename T> inline OBB<T> transformed(const OBB<T> &box, const Matrix4<T> &m) {
+    OBB<T> res;
+    res.center = m * box.center;
+    const Matrix3<T> &r = box.rotation;
+    for (int i = 0; i < 3; i++) {
+        const Vector3<T> axis(m(0, 0) * r(0, i) + m(0, 1) * r(1, i) + m(0, 2) * r(2, i),
+                              m(1, 0) * r(0, i) + m(1, 1) * r(1, i) + m(1, 2) * r(2, i),
+                              m(2, 0) * r(0, i) + m(2, 1) * r(1, i) + m(2, 2) * r(2, i));
+        const T len = length(axis);
+        res.half_extents[i] = box.half_extents[i] * len;
+        res.rotation(0, i) = axis.x / len;
+        res.rotation(1, i) = axis.y / len;
+        res.rotation(2, i) = axis.z / len;
+    }
+    return res;
+}
+
+template <typename T>
+inline Vector3<T> closest_point_on_segment(const Vector3<T> &p, const Vector3<T> &a, const Vector3<T> &b) {
+    const Vector3<T> ab = b - a;
+    const T len2 = ab.dot(ab);
+    // degenerate segments collapse to the first end point
+    T t = len2 > T(0) ? (p - a).dot(ab) / len2 : T(0);
+    t = std::min(std::max(t, T(0)), T(1));
+    return a + ab * t;
+}
+
+template <typename T>
+inline Vector3<T> closest_point_on_triangle(const Vector3<T> &p, const Vector3<T> &a, const Vector3<T> &b,
+                                            const Vector3<T> &c) {
+    // Voronoi region classification, from C. Ericson, "Real-Time Collision Detection", 5.1.5
+    const Vector3<T> ab = b - a;
+    const Vector3<T> ac = c - a;
+    const Vector3<T> ap = p - a;
+    const T d1 = ab.dot(ap);
+    const T d2 = ac.dot(ap);
+    if (d1 <= T(0) && d2 <= T(0))
+        return a; // vertex region a
+    const Vector3<T> bp = p - b;
+    const T d3 = ab.dot(bp);
+    const T d4 = ac.dot(bp);
+    if (d3 >= T(0) && d4 <= d3)
+        return b; // vertex region b
+    const T vc = d1 * d4 - d3 * d2;
+    if (vc <= T(0) && d1 >= T(0) && d3 <= T(0))
+        return a + ab * (d1 / (d1 - d3)); // edge region ab
+    const Vector3<T> cp = p - c;
+    const T d5 = ab.dot(cp);
+    const T d6 = ac.dot(cp);
+    if (d6 >= T(0) && d5 <= d6)
+        return c; // vertex region c
+    const T vb = d5 * d2 - d1 * d6;
+    if (vb <= T(0) && d2 >= T(0) && d6 <= T(0))
+        return a + ac * (d2 / (d2 - d6)); // edge region ac
+    const T va = d3 * d6 - d5 * d4;
+    if (va <= T(0) && (d4 - d3) >= T(0) && (d5 - d6) >= T(0))
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))); // edge region bc
+    // inside the face
+    const T denom = T(1) / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+template <typename T> inline Vector3<T> closest_point_on_aabb(const Vector3<T> &p, const AABB<T> &box) {
+    return Vector3<T>(std::min(std::max(p.x, box.min.x), box.max.x), std::min(std::max(p.y, box.min.y), box.max.y),
+                      std::min(std::max(p.z, box.min.z), box.max.z));
+}
+
+template <typename T> inline Vector3<T> closest_point_on_obb(const Vector3<T> &p, const OBB<T> &box) {
+    // clamp the coordinates of p in the box frame
+    const Matrix3<T> &r = box.rotation;
+    const Vector3<T> d = p - box.center;
+    Vector3<T> q = box.center;
+    for (int i = 0; i < 3; i++) {
+        const Vector3<T> axis(r(0, i), r(1, i), r(2, i));
+        const T dist = std::min(std::max(d.dot(axis), -box.half_extents[i]), box.half_extents[i]);
+        q += axis * dist;
+    }
+    return q;
+}
+
+template <typename T>
+inline T closest_points_segment_segment(const Vector3<T> &p1, const Vector3<T> &q1, const Vector3<T> &p2,
+                                        const Vector3<T> &q2, Vector3<T> &c1, Vector3<T> &c2) {
+    // from C. Ericson, "Real-Time Collision Detection", 5.1.9
+    const T eps = T(VMATH_EPSILON);
+    const Vector3<T> d1 = q1 - p1;
+    const Vector3<T> d2 = q2 - p2;
+    const Vector3<T> r = p1 - p2;
+    const T a = d1.dot(d1);
+    const T e = d2.dot(d2);
+    const T f = d2.dot(r);
+    T s, t;
+    if (a <= eps && e <= eps) {
+        // both segments degenerate into points
+        s = t = T(0);
+    } else if (a <= eps) {
+        // first segment degenerates into a point
+        s = T(0);
+        t = std::min(std::max(f / e, T(0)), T(1));
+    } else {
+        const T c = d1.dot(r);
+        if (e <= eps) {
+            // second segment degenerates into a point
+            t = T(0);
+            s = std::min(std::max(-c / a, T(0)), T(1));
+        } else {
+            const T b = d1.dot(d2);
+            const T denom = a * e - b * b;
+            // pick an arbitrary s for parallel segments
+            s = denom != T(0) ? std::min(std::max((b * f - c * e) / denom, T(0)), T(1)) : T(0);
+            t = (b * s + f) / e;
+            if (t < T(0)) {
+                t = T(0);
+                s = std::min(std::max(-c / a, T(0)), T(1));
+            } else if (t > T(1)) {
+                t = T(1);
+                s = std::min(std::max((b - c) / a, T(0)), T(1));
+            }
+        }
+    }
+    c1 = p1 + d1 * s;
+    c2 = p2 + d2 * t;
+    return length2(c1 - c2);
+}
+
+template <typename T> inline T distance2_point_segment(const Vector3<T> &p, const Vector3<T> &a, const Vector3<T> &b) {
+    return length2(p - closest_point_on_segment(p, a, b));
+}
+
+template <typename T>
+inline T distance2_segment_segment(const Vector3<T> &p1, const Vector3<T> &q1, const Vector3<T> &p2,
+                                   const Vector3<T> &q2) {
+    Vector3<T> c1, c2;
+    return closest_points_segment_segment(p1, q1, p2, q2, c1, c2);
+}
+
+template <typename T> inline bool overlap(const Sphere<T> &a, const Sphere<T> &b) {
+    const T r = a.radius + b.radius;
+    return length2(a.center - b.center) <= r * r;
+}
+
+template <typename T> inline bool overlap(const Sphere<T> &a, const Capsule<T> &b) {
+    const T r = a.radius + b.radius;
+    return distance2_point_segment(a.center, b.p0, b.p1) <= r * r;
+}
+
+template <typename T> inline bool overlap(const Capsule<T> &a, const Sphere<T> &b) {
+    return overlap(b, a);
+}
+
+template <typename T> inline bool overlap(const Capsule<T> &a, const Capsule<T> &b) {
+    const T r = a.radius + b.radius;
+    return distance2_segment_segment(a.p0, a.p1, b.p0, b.p1) <= r * r;
+}
+
+template <typename T> inline bool overlap(const Sphere<T> &a, const AABB<T> &b) {
+    return length2(closest_point_on_aabb(a.center, b) - a.center) <= a.radius * a.radius;
+}
+
+template <typename T> inline bool overlap(const AABB<T> &a, const Sphere<T> &b) {
+    return overlap(b, a);
+}
+
+template <typename T> inline bool overlap(const Sphere<T> &a, const OBB<T> &b) {
+    return length2(closest_point_on_obb(a.center, b) - a.center) <= a.radius * a.radius;
+}
+
+template <typename T> inline bool overlap(const OBB<T> &a, const Sphere<T> &b) {
+    return overlap(b, a);
+}
+
+template <typename T> inline bool overlap(const AABB<T> &a, const AABB<T> &b) {
+    return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y &&
+           a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+template <typename T> inline bool overlap(const OBB<T> &a, const OBB<T> &b) {
+    // from C. Ericson, "Real-Time Collision Detection", 4.4.1. Everything is expressed in the frame of a.
+    // The face axes of a are tested first and each one only needs one row of the relative rotation, so the
+    // rows are computed lazily: separated pairs (the common case in a broadphase) exit after a few dot products.
+    const Matrix3<T> &ra = a.rotation;
+    const Matrix3<T> &rb = b.rotation;
+    const Vector3<T> &ea = a.half_extents;
+    const Vector3<T> &eb = b.half_extents;
+    const Vector3<T> bx(rb(0, 0), rb(1, 0), rb(2, 0));
+    const Vector3<T> by(rb(0, 1), rb(1, 1), rb(2, 1));
+    const Vector3<T> bz(rb(0, 2), rb(1, 2), rb(2, 2));
+    const Vector3<T> d = b.center - a.center;
+    // rotation of b in the frame of a, r[i][j] = dot(a_i, b_j), and its absolute value (plus an epsilon that
+    // counteracts arithmetic errors when two edges are parallel and their cross product is close to zero);
+    // t is the translation in the frame of a
+    T r[3][3], abs_r[3][3], t[3];
+    for (int i = 0; i < 3; i++) {
+        const Vector3<T> ai(ra(0, i), ra(1, i), ra(2, i));
+        t[i] = d.dot(ai);
+        r[i][0] = ai.dot(bx);
+        r[i][1] = ai.dot(by);
+        r[i][2] = ai.dot(bz);
+        abs_r[i][0] = std::abs(r[i][0]) + T(VMATH_EPSILON);
+        abs_r[i][1] = std::abs(r[i][1]) + T(VMATH_EPSILON);
+        abs_r[i][2] = std::abs(r[i][2]) + T(VMATH_EPSILON);
+        // axis a_i
+        if (std::abs(t[i]) > ea[i] + eb.x * abs_r[i][0] + eb.y * abs_r[i][1] + eb.z * abs_r[i][2])
+            return false;
+    }
+    // axes b0, b1, b2
+    for (int j = 0; j < 3; j++) {
+        if (std::abs(t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j]) >
+            ea.x * abs_r[0][j] + ea.y * abs_r[1][j] + ea.z * abs_r[2][j] + eb[j])
+            return false;
+    }
+    // axes a_i x b_j (the loops have constant trip counts and are fully unrolled, so the index arithmetic folds)
+    for (int i = 0; i < 3; i++) {
+        const int i1 = i == 2 ? 0 : i + 1;
+        const int i2 = i == 0 ? 2 : i - 1;
+        for (int j = 0; j < 3; j++) {
+            const int j1 = j == 2 ? 0 : j + 1;
+            const int j2 = j == 0 ? 2 : j - 1;
+            const T ra_ij = ea[i1] * abs_r[i2][j] + ea[i2] * abs_r[i1][j];
+            const T rb_ij = eb[j1] * abs_r[i][j2] + eb[j2] * abs_r[i][j1];
+            if (std::abs(t[i2] * r[i1][j] - t[i1] * r[i2][j]) > ra_ij + rb_ij)
+                return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+inline void closest_point_on_segment(const Vector3<T> *p, size_t count, const Vector3<T> &a, const Vector3<T> &b,
+                                     Vector3<T> *out) {
+    const Vector3<T> ab = b - a;
+    const T len2 = ab.dot(ab);
+    const T inv_len2 = len2 > T(0) ? T(1) / len2 : T(0);
+    for (size_t i = 0; i < count; i++) {
+        const T t = std::min(std::max((p[i] - a).dot(ab) * inv_len2, T(0)), T(1));
+        out[i] = a + ab * t;
+    }
+}
+
+template <typename T>
+inline void closest_point_on_triangle(const Vector3<T> *p, size_t count, const Vector3<T> &a, const Vector3<T> &b,
+                                      const Vector3<T> &c, Vector3<T> *out) {
+    for (size_t i = 0; i < count; i++)
+        out[i] = closest_point_on_triangle(p[i], a, b, c);
+}
+
+template <typename T>
+inline void closest_point_on_aabb(const Vector3<T> *p, size_t count, const AABB<T> &box, Vector3<T> *out) {
+    for (size_t i = 0; i < count; i++)
+        out[i] = closest_point_on_aabb(p[i], box);
+}
+
+template <typename T>
+inline void closest_point_on_obb(const Vector3<T> *p, size_t count, const OBB<T> &box, Vector3<T> *out) {
+    // transform the points in the box frame, clamp, and transform back; the axes are extracted once
+    const Matrix3<T> &r = box.rotation;
+    const Vector3<T> ax(r(0, 0), r(1, 0), r(2, 0));
+    const Vector3<T> ay(r(0, 1), r(1, 1), r(2, 1));
+    const Vector3<T> az(r(0, 2), r(1, 2), r(2, 2));
+    const Vector3<T> &e = box.half_extents;
+    for (size_t i = 0; i < count; i++) {
+        const Vector3<T> d = p[i] - box.center;
+        const T x = std::min(std::max(d.dot(ax), -e.x), e.x);
+        const T y = std::min(std::max(d.dot(ay), -e.y), e.y);
+        const T z = std::min(std::max(d.dot(az), -e.z), e.z);
+        out[i] = box.center + ax * x + ay * y + az * z;
+    }
+}
+
+template <typename A, typename B> inline void overlap(const A *a, const B *b, size_t count, bool *result) {
+    for (size_t i = 0; i < count; i++)
+        result[i] = overlap(a[i], b[i]);
+}
+
+#if defined(VMATH_SSE2)
+namespace detail {
+
+inline __m128 clamp_sse2(__m128 v, __m128 lo, __m128 hi) { return _mm_min_ps(_mm_max_ps(v, lo), hi); }
+
+/// dot products between 4 transposed vectors and v
+inline __m128 dot3_sse2(__m128 x, __m128 y, __m128 z, const Vector3f &v) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(v.x)), _mm_mul_ps(y, _mm_set1_ps(v.y))),
+                      _mm_mul_ps(z, _mm_set1_ps(v.z)));
+}
+
+/// o + d * t on 4 transposed points
+inline void madd3_sse2(const Vector3f &o, const Vector3f &d, __m128 t, __m128 &x, __m128 &y, __m128 &z) {
+    x = _mm_add_ps(_mm_set1_ps(o.x), _mm_mul_ps(_mm_set1_ps(d.x), t));
+    y = _mm_add_ps(_mm_set1_ps(o.y), _mm_mul_ps(_mm_set1_ps(d.y), t));
+    z = _mm_add_ps(_mm_set1_ps(o.z), _mm_mul_ps(_mm_set1_ps(d.z), t));
+}
+
+/// replaces the lanes of (x,y,z) selected by mask with (sx,sy,sz)
+inline void select3_sse2(__m128 mask, __m128 sx, __m128 sy, __m128 sz, __m128 &x, __m128 &y, __m128 &z) {
+    x = _mm_or_ps(_mm_and_ps(mask, sx), _mm_andnot_ps(mask, x));
+    y = _mm_or_ps(_mm_and_ps(mask, sy), _mm_andnot_ps(mask, y));
+    z = _mm_or_ps(_mm_and_ps(mask, sz), _mm_andnot_ps(mask, z));
+}
+
+} // namespace detail
+
+template <>
+inline void closest_point_on_segment(const Vector3f *p, size_t count, const Vector3f &a, const Vector3f &b,
+                                     Vector3f *out) {
+    const Vector3f ab = b - a;
+    const float len2 = ab.dot(ab);
+    const float inv_len2 = len2 > 0.f ? 1.f / len2 : 0.f;
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f), inv4 = _mm_set1_ps(inv_len2);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x, y, z;
+        detail::load_vector3_sse2(p + i, x, y, z);
+        const __m128 d = detail::dot3_sse2(_mm_sub_ps(x, _mm_set1_ps(a.x)), _mm_sub_ps(y, _mm_set1_ps(a.y)),
+                                           _mm_sub_ps(z, _mm_set1_ps(a.z)), ab);
+        detail::madd3_sse2(a, ab, detail::clamp_sse2(_mm_mul_ps(d, inv4), zero, one), x, y, z);
+        detail::store_vector3_sse2(x, y, z, out + i);
+    }
+    for (; i < count; i++) {
+        const float t = std::min(std::max((p[i] - a).dot(ab) * inv_len2, 0.f), 1.f);
+        out[i] = a + ab * t;
+    }
+}
+
+template <>
+inline void closest_point_on_triangle(const Vector3f *p, size_t count, const Vector3f &a, const Vector3f &b,
+                                      const Vector3f &c, Vector3f *out) {
+    // all the Voronoi regions are evaluated, and the candidates are selected from the face region back to the first
+    // region of the scalar version, so that the first region that matches wins
+    const Vector3f ab = b - a, ac = c - a, bc = c - b;
+    const __m128 zero = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x, y, z;
+        detail::load_vector3_sse2(p + i, x, y, z);
+        const __m128 ax = _mm_sub_ps(x, _mm_set1_ps(a.x)), ay = _mm_sub_ps(y, _mm_set1_ps(a.y)),
+                     az = _mm_sub_ps(z, _mm_set1_ps(a.z));
+        const __m128 bx = _mm_sub_ps(x, _mm_set1_ps(b.x)), by = _mm_sub_ps(y, _mm_set1_ps(b.y)),
+                     bz = _mm_sub_ps(z, _mm_set1_ps(b.z));
+        const __m128 cx = _mm_sub_ps(x, _mm_set1_ps(c.x)), cy = _mm_sub_ps(y, _mm_set1_ps(c.y)),
+                     cz = _mm_sub_ps(z, _mm_set1_ps(c.z));
+        const __m128 d1 = detail::dot3_sse2(ax, ay, az, ab), d2 = detail::dot3_sse2(ax, ay, az, ac);
+        const __m128 d3 = detail::dot3_sse2(bx, by, bz, ab), d4 = detail::dot3_sse2(bx, by, bz, ac);
+        const __m128 d5 = detail::dot3_sse2(cx, cy, cz, ab), d6 = detail::dot3_sse2(cx, cy, cz, ac);
+        const __m128 va = _mm_sub_ps(_mm_mul_ps(d3, d6), _mm_mul_ps(d5, d4));
+        const __m128 vb = _mm_sub_ps(_mm_mul_ps(d5, d2), _mm_mul_ps(d1, d6));
+        const __m128 vc = _mm_sub_ps(_mm_mul_ps(d1, d4), _mm_mul_ps(d3, d2));
+        // inside the face
+        const __m128 denom = _mm_div_ps(_mm_set1_ps(1.f), _mm_add_ps(_mm_add_ps(va, vb), vc));
+        const __m128 v = _mm_mul_ps(vb, denom), w = _mm_mul_ps(vc, denom);
+        detail::madd3_sse2(a, ab, v, x, y, z);
+        x = _mm_add_ps(x, _mm_mul_ps(_mm_set1_ps(ac.x), w));
+        y = _mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(ac.y), w));
+        z = _mm_add_ps(z, _mm_mul_ps(_mm_set1_ps(ac.z), w));
+        __m128 sx, sy, sz, mask;
+        // edge region bc
+        const __m128 d43 = _mm_sub_ps(d4, d3), d56 = _mm_sub_ps(d5, d6);
+        mask = _mm_and_ps(_mm_cmple_ps(va, zero), _mm_and_ps(_mm_cmpge_ps(d43, zero), _mm_cmpge_ps(d56, zero)));
+        detail::madd3_sse2(b, bc, _mm_div_ps(d43, _mm_add_ps(d43, d56)), sx, sy, sz);
+        detail::select3_sse2(mask, sx, sy, sz, x, y, z);
+        // edge region ac
+        mask = _mm_and_ps(_mm_cmple_ps(vb, zero), _mm_and_ps(_mm_cmpge_ps(d2, zero), _mm_cmple_ps(d6, zero)));
+        detail::madd3_sse2(a, ac, _mm_div_ps(d2, _mm_sub_ps(d2, d6)), sx, sy, sz);
+        detail::select3_sse2(mask, sx, sy, sz, x, y, z);
+        // vertex region c
+        mask = _mm_and_ps(_mm_cmpge_ps(d6, zero), _mm_cmple_ps(d5, d6));
+        detail::select3_sse2(mask, _mm_set1_ps(c.x), _mm_set1_ps(c.y), _mm_set1_ps(c.z), x, y, z);
+        // edge region ab
+        mask = _mm_and_ps(_mm_cmple_ps(vc, zero), _mm_and_ps(_mm_cmpge_ps(d1, zero), _mm_cmple_ps(d3, zero)));
+        detail::madd3_sse2(a, ab, _mm_div_ps(d1, _mm_sub_ps(d1, d3)), sx, sy, sz);
+        detail::select3_sse2(mask, sx, sy, sz, x, y, z);
+        // vertex region b
+        mask = _mm_and_ps(_mm_cmpge_ps(d3, zero), _mm_cmple_ps(d4, d3));
+        detail::select3_sse2(mask, _mm_set1_ps(b.x), _mm_set1_ps(b.y), _mm_set1_ps(b.z), x, y, z);
+        // vertex region a
+        mask = _mm_and_ps(_mm_cmple_ps(d1, zero), _mm_cmple_ps(d2, zero));
+        detail::select3_sse2(mask, _mm_set1_ps(a.x), _mm_set1_ps(a.y), _mm_set1_ps(a.z), x, y, z);
+        detail::store_vector3_sse2(x, y, z, out + i);
+    }
+    for (; i < count; i++)
+        out[i] = closest_point_on_triangle(p[i], a, b, c);
+}
+
+template <>
+inline void closest_point_on_aabb(const Vector3f *p, size_t count, const AABBf &box, Vector3f *out) {
+    const __m128 lx = _mm_set1_ps(box.min.x), ly = _mm_set1_ps(box.min.y), lz = _mm_set1_ps(box.min.z);
+    const __m128 hx = _mm_set1_ps(box.max.x), hy = _mm_set1_ps(box.max.y), hz = _mm_set1_ps(box.max.z);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x, y, z;
+        detail::load_vector3_sse2(p + i, x, y, z);
+        detail::store_vector3_sse2(detail::clamp_sse2(x, lx, hx), detail::clamp_sse2(y, ly, hy),
+                                   detail::clamp_sse2(z, lz, hz), out + i);
+    }
+    for (; i < count; i++)
+        out[i] = closest_point_on_aabb(p[i], box);
+}
+
+template <>
+inline void closest_point_on_obb(const Vector3f *p, size_t count, const OBBf &box, Vector3f *out) {
+    const Matrix3f &r = box.rotation;
+    const Vector3f ax(r(0, 0), r(1, 0), r(2, 0));
+    const Vector3f ay(r(0, 1), r(1, 1), r(2, 1));
+    const Vector3f az(r(0, 2), r(1, 2), r(2, 2));
+    const Vector3f &e = box.half_extents;
+    const __m128 ex = _mm_set1_ps(e.x), ey = _mm_set1_ps(e.y), ez = _mm_set1_ps(e.z);
+    const __m128 sign = _mm_set1_ps(-0.f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x, y, z;
+        detail::load_vector3_sse2(p + i, x, y, z);
+        const __m128 dx = _mm_sub_ps(x, _mm_set1_ps(box.center.x)), dy = _mm_sub_ps(y, _mm_set1_ps(box.center.y)),
+                     dz = _mm_sub_ps(z, _mm_set1_ps(box.center.z));
+        const __m128 u = detail::clamp_sse2(detail::dot3_sse2(dx, dy, dz, ax), _mm_xor_ps(ex, sign), ex);
+        const __m128 v = detail::clamp_sse2(detail::dot3_sse2(dx, dy, dz, ay), _mm_xor_ps(ey, sign), ey);
+        const __m128 w = detail::clamp_sse2(detail::dot3_sse2(dx, dy, dz, az), _mm_xor_ps(ez, sign), ez);
+        detail::madd3_sse2(box.center, ax, u, x, y, z);
+        x = _mm_add_ps(_mm_add_ps(x, _mm_mul_ps(_mm_set1_ps(ay.x), v)), _mm_mul_ps(_mm_set1_ps(az.x), w));
+        y = _mm_add_ps(_mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(ay.y), v)), _mm_mul_ps(_mm_set1_ps(az.y), w));
+        z = _mm_add_ps(_mm_add_ps(z, _mm_mul_ps(_mm_set1_ps(ay.z), v)), _mm_mul_ps(_mm_set1_ps(az.z), w));
+        detail::store_vector3_sse2(x, y, z, out + i);
+    }
+    for (; i < count; i++) {
+        const Vector3f d = p[i] - box.center;
+        const float x = std::min(std::max(d.dot(ax), -e.x), e.x);
+        const float y = std::min(std::max(d.dot(ay), -e.y), e.y);
+        const float z = std::min(std::max(d.dot(az), -e.z), e.z);
+        out[i] = box.center + ax * x + ay * y + az * z;
+    }
+}
+#endif
+
+} // namespace math
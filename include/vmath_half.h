@@ -0,0 +1,384 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+#pragma once
+
+#include "vmath_types.h"
+#include "vmath_parallel.h"
+#include "vmath_simd_detail.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// F16C (vcvtps2ph/vcvtph2ps, 8 values per instruction) and AVX-512F (16 per instruction, detected in
+// vmath_simd_detail.h) are used when the compiler targets them (e.g. -mf16c, -mavx512f or -march=native); the SSE2
+// kernels are the fallback. All the paths give bit-identical results.
+#if !defined(VMATH_NO_SIMD) && defined(__F16C__)
+#define VMATH_F16C
+#include <immintrin.h>
+#endif
+
+namespace math {
+
+/// IEEE 754 binary16 storage type: 1 sign, 5 exponent and 10 mantissa bits (about 3 decimal digits, range
+/// +-65504, subnormals down to 6e-8). There is no arithmetic on it: values are converted to float for the math,
+/// either one at a time (explicit constructor and conversion) or in bulk with convert().
+/// Conversions round to nearest even; infinities and NaN are preserved, NaNs are returned quiet.
+struct Half {
+    uint16_t bits; // trivial default constructor, as required by the unions of the vector types
+
+    Half() = default;
+    explicit Half(float f);
+    explicit operator float() const;
+    static Half from_bits(uint16_t bits);
+};
+
+/// bfloat16 storage type: the upper half of a float (1 sign, 8 exponent and 7 mantissa bits). Same range as
+/// float with about 2 decimal digits; conversions round to nearest even, NaNs are returned quiet.
+struct BFloat16 {
+    uint16_t bits;
+
+    BFloat16() = default;
+    explicit BFloat16(float f);
+    explicit operator float() const;
+    static BFloat16 from_bits(uint16_t bits);
+};
+
+// storage types: half the size of the float ones. The converting constructors of the core types convert one
+// value at a time (e.g. Vector3f v(Vector3h(...))); use convert() for arrays.
+typedef Vector2<Half> Vector2h;
+typedef Vector3<Half> Vector3h;
+typedef Vector4<Half> Vector4h;
+typedef Quaternion<Half> Quath;
+typedef Vector2<BFloat16> Vector2bf;
+typedef Vector3<BFloat16> Vector3bf;
+typedef Vector4<BFloat16> Vector4bf;
+typedef Quaternion<BFloat16> Quatbf;
+
+/// bulk conversion of count values between float and the 16 bit storage types, with the widest conversion
+/// instructions available (see above). Large arrays are split over threads (0 = hardware threads).
+/// The results are identical to the ones of the scalar conversions.
+void convert(const float *src, Half *dst, size_t count, unsigned threads = 0);
+void convert(const Half *src, float *dst, size_t count, unsigned threads = 0);
+void convert(const float *src, BFloat16 *dst, size_t count, unsigned threads = 0);
+void convert(const BFloat16 *src, float *dst, size_t count, unsigned threads = 0);
+
+/// bulk conversion of count vectors or quaternions (e.g. Vector3f <-> Vector3h, Quatf <-> Quatbf)
+template <template <typename> class V, typename H>
+void convert(const V<float> *src, V<H> *dst, size_t count, unsigned threads = 0);
+template <template <typename> class V, typename H>
+void convert(const V<H> *src, V<float> *dst, size_t count, unsigned threads = 0);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+inline uint32_t float_bits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float bits_float(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// float -> half with round to nearest even, no branches on the value besides the range selection (F. Giesen,
+// "float->half variants"). Subnormal results are rounded by the FPU, adding a magic number that aligns the
+// mantissa.
+inline uint16_t half_from_float(float f) {
+    const uint32_t f16max = (127 + 16) << 23;                              // 65536, first value rounding to inf
+    const uint32_t f32inf = 255 << 23;
+    const uint32_t denorm_magic = ((127 - 15) + (23 - 10) + 1) << 23;      // 0.5
+    uint32_t u = float_bits(f);
+    const uint32_t sign = u & 0x80000000u;
+    u ^= sign;
+    uint32_t o;
+    if (u >= f16max) {
+        // inf, or quiet NaN with the upper bits of the payload
+        o = u > f32inf ? 0x7e00u | ((u >> 13) & 0x3ffu) : 0x7c00u;
+    } else if (u < (113u << 23)) {
+        // subnormal or zero
+        o = float_bits(bits_float(u) + bits_float(denorm_magic)) - denorm_magic;
+    } else {
+        const uint32_t mant_odd = (u >> 13) & 1;
+        u += (uint32_t(15 - 127) << 23) + 0xfff + mant_odd;
+        o = u >> 13;
+    }
+    return uint16_t(o | (sign >> 16));
+}
+
+inline float half_to_float(uint16_t h) {
+    const uint32_t shifted_exp = 0x7c00u << 13;
+    uint32_t o = uint32_t(h & 0x7fffu) << 13;
+    const uint32_t exp = o & shifted_exp;
+    o += uint32_t(127 - 15) << 23;
+    if (exp == shifted_exp) {
+        o += uint32_t(128 - 16) << 23; // inf/NaN
+        if (o & 0x7fffffu)
+            o |= 0x400000u; // quiet NaN
+    } else if (exp == 0) {
+        o = float_bits(bits_float(o + (1u << 23)) - bits_float(113u << 23)); // subnormal: renormalize
+    }
+    return bits_float(o | (uint32_t(h & 0x8000u) << 16));
+}
+
+inline uint16_t bfloat16_from_float(float f) {
+    const uint32_t u = float_bits(f);
+    if ((u & 0x7fffffffu) > 0x7f800000u)
+        return uint16_t((u >> 16) | 0x40u); // quiet NaN
+    return uint16_t((u + 0x7fffu + ((u >> 16) & 1)) >> 16);
+}
+
+inline float bfloat16_to_float(uint16_t h) { return bits_float(uint32_t(h) << 16); }
+
+#if defined(VMATH_SSE2)
+// 4 floats -> 4 halves in the low 16 bits of each lane (same steps as half_from_float)
+inline __m128i half_from_float_sse2(__m128 f) {
+    const __m128i f16max = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i f32inf = _mm_set1_epi32(255 << 23);
+    const __m128i denorm_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i mant_mask = _mm_set1_epi32(0x3ff);
+    __m128i u = _mm_castps_si128(f);
+    const __m128i sign = _mm_and_si128(u, _mm_set1_epi32(int(0x80000000u)));
+    u = _mm_xor_si128(u, sign);
+    // u is non-negative as a signed integer, so the signed comparisons work
+    const __m128i finite = _mm_cmpgt_epi32(f16max, u);
+    const __m128i nan = _mm_cmpgt_epi32(u, f32inf);
+    const __m128i subnormal = _mm_cmpgt_epi32(_mm_set1_epi32(113 << 23), u);
+    const __m128i nan_bits = _mm_or_si128(_mm_set1_epi32(0x200), _mm_and_si128(_mm_srli_epi32(u, 13), mant_mask));
+    const __m128i special = _mm_or_si128(_mm_set1_epi32(0x7c00), _mm_and_si128(nan, nan_bits));
+    const __m128i sub = _mm_sub_epi32(
+        _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(u), _mm_castsi128_ps(denorm_magic))), denorm_magic);
+    const __m128i mant_odd = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(1));
+    const __m128i norm = _mm_srli_epi32(
+        _mm_add_epi32(_mm_add_epi32(u, _mm_set1_epi32(int(uint32_t(15 - 127) << 23) + 0xfff)), mant_odd), 13);
+    __m128i o = _mm_or_si128(_mm_and_si128(subnormal, sub), _mm_andnot_si128(subnormal, norm));
+    o = _mm_or_si128(_mm_and_si128(finite, o), _mm_andnot_si128(finite, special));
+    return _mm_or_si128(o, _mm_srli_epi32(sign, 16));
+}
+
+// 4 halves (low 16 bits of each lane, upper bits zero) -> 4 floats (same steps as half_to_float)
+inline __m128 half_to_float_sse2(__m128i h) {
+    const __m128i shifted_exp = _mm_set1_epi32(0x7c00 << 13);
+    __m128i o = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+    const __m128i exp = _mm_and_si128(o, shifted_exp);
+    o = _mm_add_epi32(o, _mm_set1_epi32((127 - 15) << 23));
+    const __m128i infnan = _mm_cmpeq_epi32(exp, shifted_exp);
+    const __m128i mant = _mm_and_si128(h, _mm_set1_epi32(0x3ff));
+    const __m128i nan = _mm_and_si128(infnan, _mm_cmpgt_epi32(mant, _mm_setzero_si128()));
+    o = _mm_add_epi32(o, _mm_and_si128(infnan, _mm_set1_epi32((128 - 16) << 23)));
+    o = _mm_or_si128(o, _mm_and_si128(nan, _mm_set1_epi32(0x400000)));
+    const __m128i subnormal = _mm_cmpeq_epi32(exp, _mm_setzero_si128());
+    const __m128i sub = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(o, _mm_set1_epi32(1 << 23))),
+                                                    _mm_castsi128_ps(_mm_set1_epi32(113 << 23))));
+    o = _mm_or_si128(_mm_and_si128(subnormal, sub), _mm_andnot_si128(subnormal, o));
+    o = _mm_or_si128(o, _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16));
+    return _mm_castsi128_ps(o);
+}
+
+// 4 floats -> 4 bfloat16 in the low 16 bits of each lane, sign extended
+inline __m128i bfloat16_from_float_sse2(__m128 f) {
+    const __m128i u = _mm_castps_si128(f);
+    const __m128i lsb = _mm_and_si128(_mm_srli_epi32(u, 16), _mm_set1_epi32(1));
+    const __m128i rounded = _mm_add_epi32(_mm_add_epi32(u, _mm_set1_epi32(0x7fff)), lsb);
+    const __m128i quiet = _mm_or_si128(u, _mm_set1_epi32(0x400000));
+    const __m128i nan = _mm_castps_si128(_mm_cmpunord_ps(f, f));
+    return _mm_srai_epi32(_mm_or_si128(_mm_and_si128(nan, quiet), _mm_andnot_si128(nan, rounded)), 16);
+}
+
+// two vectors of 4 values in the low 16 bits of each lane -> 8 packed 16 bit values
+inline __m128i pack_16_sse2(__m128i lo, __m128i hi) {
+    // sign extend first, so that the signed saturation of packs does not change the values
+    return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16), _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+}
+#endif
+
+#if defined(VMATH_AVX512F)
+// the zero-masked forms of the intrinsics (all lanes enabled) compile to the same instructions, and avoid the
+// spurious maybe-uninitialized warnings of the unmasked ones in some gcc versions
+const __mmask16 all_lanes = 0xffff;
+
+inline __m512i bfloat16_from_float_avx512(__m512 f) {
+    const __m512i u = _mm512_castps_si512(f);
+    const __m512i lsb = _mm512_and_si512(_mm512_maskz_srli_epi32(all_lanes, u, 16), _mm512_set1_epi32(1));
+    __m512i r = _mm512_add_epi32(_mm512_add_epi32(u, _mm512_set1_epi32(0x7fff)), lsb);
+    r = _mm512_mask_or_epi32(r, _mm512_cmp_ps_mask(f, f, _CMP_UNORD_Q), u, _mm512_set1_epi32(0x400000));
+    return _mm512_maskz_srli_epi32(all_lanes, r, 16);
+}
+#endif
+
+inline void convert_range(const float *src, Half *dst, size_t count) {
+    uint16_t *out = &dst->bits;
+    size_t i = 0;
+#if defined(VMATH_AVX512F)
+    for (; i + 16 <= count; i += 16)
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                            _mm512_maskz_cvtps_ph(all_lanes, _mm512_loadu_ps(src + i),
+                                                  _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+#endif
+#if defined(VMATH_F16C)
+    for (; i + 8 <= count; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                         _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(VMATH_SSE2)
+    for (; i + 8 <= count; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                         pack_16_sse2(half_from_float_sse2(_mm_loadu_ps(src + i)),
+                                      half_from_float_sse2(_mm_loadu_ps(src + i + 4))));
+#endif
+    for (; i < count; i++)
+        out[i] = half_from_float(src[i]);
+}
+
+inline void convert_range(const Half *src, float *dst, size_t count) {
+    const uint16_t *in = &src->bits;
+    size_t i = 0;
+#if defined(VMATH_AVX512F)
+    for (; i + 16 <= count; i += 16) {
+        const __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        _mm512_storeu_ps(dst + i, _mm512_maskz_cvtph_ps(all_lanes, h));
+    }
+#endif
+#if defined(VMATH_F16C)
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))));
+#elif defined(VMATH_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        _mm_storeu_ps(dst + i, half_to_float_sse2(_mm_unpacklo_epi16(h, _mm_setzero_si128())));
+        _mm_storeu_ps(dst + i + 4, half_to_float_sse2(_mm_unpackhi_epi16(h, _mm_setzero_si128())));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = half_to_float(in[i]);
+}
+
+inline void convert_range(const float *src, BFloat16 *dst, size_t count) {
+    uint16_t *out = &dst->bits;
+    size_t i = 0;
+#if defined(VMATH_AVX512F)
+    for (; i + 16 <= count; i += 16) {
+        const __m512i b = bfloat16_from_float_avx512(_mm512_loadu_ps(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm512_maskz_cvtepi32_epi16(all_lanes, b));
+    }
+#endif
+#if defined(VMATH_SSE2)
+    for (; i + 8 <= count; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                         _mm_packs_epi32(bfloat16_from_float_sse2(_mm_loadu_ps(src + i)),
+                                         bfloat16_from_float_sse2(_mm_loadu_ps(src + i + 4))));
+#endif
+    for (; i < count; i++)
+        out[i] = bfloat16_from_float(src[i]);
+}
+
+inline void convert_range(const BFloat16 *src, float *dst, size_t count) {
+    const uint16_t *in = &src->bits;
+    size_t i = 0;
+#if defined(VMATH_AVX512F)
+    for (; i + 16 <= count; i += 16)
+        _mm512_storeu_si512(dst + i, _mm512_maskz_slli_epi32(all_lanes,
+                                                             _mm512_maskz_cvtepu16_epi32(all_lanes, _mm256_loadu_si256(
+                                                                 reinterpret_cast<const __m256i *>(in + i))),
+                                                             16));
+#endif
+#if defined(VMATH_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_unpacklo_epi16(_mm_setzero_si128(), h));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 4), _mm_unpackhi_epi16(_mm_setzero_si128(), h));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = bfloat16_to_float(in[i]);
+}
+
+template <typename S, typename D> void convert_parallel(const S *src, D *dst, size_t count, unsigned threads) {
+    // memory bound: only worth splitting for large arrays
+    parallel_for(count, threads, size_t(1) << 18,
+                 [&](size_t, size_t begin, size_t end) { convert_range(src + begin, dst + begin, end - begin); });
+}
+
+} // namespace detail
+
+inline Half::Half(float f)
+: bits(detail::half_from_float(f)) {}
+
+inline Half::operator float() const { return detail::half_to_float(bits); }
+
+inline Half Half::from_bits(uint16_t bits) {
+    Half h;
+    h.bits = bits;
+    return h;
+}
+
+inline BFloat16::BFloat16(float f)
+: bits(detail::bfloat16_from_float(f)) {}
+
+inline BFloat16::operator float() const { return detail::bfloat16_to_float(bits); }
+
+inline BFloat16 BFloat16::from_bits(uint16_t bits) {
+    BFloat16 h;
+    h.bits = bits;
+    return h;
+}
+
+inline void convert(const float *src, Half *dst, size_t count, unsigned threads) {
+    detail::convert_parallel(src, dst, count, threads);
+}
+
+inline void convert(const Half *src, float *dst, size_t count, unsigned threads) {
+    detail::convert_parallel(src, dst, count, threads);
+}
+
+inline void convert(const float *src, BFloat16 *dst, size_t count, unsigned threads) {
+    detail::convert_parallel(src, dst, count, threads);
+}
+
+inline void convert(const BFloat16 *src, float *dst, size_t count, unsigned threads) {
+    detail::convert_parallel(src, dst, count, threads);
+}
+
+template <template <typename> class V, typename H>
+void convert(const V<float> *src, V<H> *dst, size_t count, unsigned threads) {
+    const size_t n = sizeof(V<float>) / sizeof(float);
+    static_assert(sizeof(V<float>) == n * sizeof(float) && sizeof(V<H>) == n * sizeof(H),
+                  "convert() needs types made of float/16 bit components only");
+    convert(reinterpret_cast<const float *>(src), reinterpret_cast<H *>(dst), count * n, threads);
+}
+
+template <template <typename> class V, typename H>
+void convert(const V<H> *src, V<float> *dst, size_t count, unsigned threads) {
+    const size_t n = sizeof(V<float>) / sizeof(float);
+    static_assert(sizeof(V<float>) == n * sizeof(float) && sizeof(V<H>) == n * sizeof(H),
+                  "convert() needs types made of float/16 bit components only");
+    convert(reinterpret_cast<const H *>(src), reinterpret_cast<float *>(dst), count * n, threads);
+}
+
+} // namespace math
@@ -27,6 +27,7 @@
 #include <cmath>
 #include <cassert>
 #include <cstring>
+#include <utility>
 
 namespace math {
 
@@ -142,9 +143,10 @@ template <typename T> inline T det(const Matrix3<T> &mat) {
 }
 
 template <typename T> inline Matrix3<T> inverse(const Matrix3<T> &mat) {
+    using std::abs;
     T d = det(mat);
     /// \todo better API in case the inverse does not exist. See https://github.com/dbacchet/vmath/issues/3
-    if (std::abs(d)<VMATH_EPSILON) {
+    if (abs(d)<VMATH_EPSILON) {
         return Matrix3<T>(); // return null matrix
     }
     Matrix3<T> ret;
@@ -160,6 +162,245 @@ template <typename T> inline Matrix3<T> inverse(const Matrix3<T> &mat) {
     return ret * T(T(1) / d);
 }
 
+template <typename T> void polar_decompose(const Matrix3<T> &m, Matrix3<T> &r, Matrix3<T> &s, int iterations) {
+    // scaled Newton iteration (Higham): X' = (g * X + transpose(inverse(X)) / g) / 2, with g = |det(X)|^(-1/3).
+    // transpose(inverse(X)) is computed as cofactor(X)/det(X), so the loop body has no branches.
+    Matrix3<T> x = m;
+    for (int it = 0; it < iterations; it++) {
+        Matrix3<T> cof;
+        cof(0, 0) = x(1, 1) * x(2, 2) - x(1, 2) * x(2, 1);
+        cof(0, 1) = x(1, 2) * x(2, 0) - x(1, 0) * x(2, 2);
+        cof(0, 2) = x(1, 0) * x(2, 1) - x(1, 1) * x(2, 0);
+        cof(1, 0) = x(0, 2) * x(2, 1) - x(0, 1) * x(2, 2);
+        cof(1, 1) = x(0, 0) * x(2, 2) - x(0, 2) * x(2, 0);
+        cof(1, 2) = x(0, 1) * x(2, 0) - x(0, 0) * x(2, 1);
+        cof(2, 0) = x(0, 1) * x(1, 2) - x(0, 2) * x(1, 1);
+        cof(2, 1) = x(0, 2) * x(1, 0) - x(0, 0) * x(1, 2);
+        cof(2, 2) = x(0, 0) * x(1, 1) - x(0, 1) * x(1, 0);
+        T d = x(0, 0) * cof(0, 0) + x(0, 1) * cof(0, 1) + x(0, 2) * cof(0, 2);
+        T g = T(1) / std::cbrt(std::abs(d));
+        T sx = g / T(2);
+        T sc = T(1) / (T(2) * g * d);
+        for (int i = 0; i < 9; i++)
+            x.data[i] = sx * x.data[i] + sc * cof.data[i];
+    }
+    r = x;
+    // s = transpose(r) * m, symmetrized to remove the residual of the iteration
+    Matrix3<T> p;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            p(i, j) = r(0, i) * m(0, j) + r(1, i) * m(1, j) + r(2, i) * m(2, j);
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            s(i, j) = (p(i, j) + p(j, i)) / T(2);
+        }
+    }
+}
+
+template <typename T> void qr_decompose(const Matrix3<T> &m, Matrix3<T> &q, Matrix3<T> &r) {
+    // modified Gram-Schmidt on the columns
+    Vector3<T> a0(m(0, 0), m(1, 0), m(2, 0));
+    Vector3<T> a1(m(0, 1), m(1, 1), m(2, 1));
+    Vector3<T> a2(m(0, 2), m(1, 2), m(2, 2));
+    set_zero(r);
+    r(0, 0) = length(a0);
+    Vector3<T> q0 = a0 / r(0, 0);
+    r(0, 1) = q0.dot(a1);
+    a1 -= q0 * r(0, 1);
+    r(1, 1) = length(a1);
+    Vector3<T> q1 = a1 / r(1, 1);
+    r(0, 2) = q0.dot(a2);
+    a2 -= q0 * r(0, 2);
+    r(1, 2) = q1.dot(a2);
+    a2 -= q1 * r(1, 2);
+    r(2, 2) = length(a2);
+    Vector3<T> q2 = a2 / r(2, 2);
+    for (int i = 0; i < 3; i++) {
+        q(i, 0) = q0[i];
+        q(i, 1) = q1[i];
+        q(i, 2) = q2[i];
+    }
+}
+
+template <typename T> void eigen_decompose(const Matrix3<T> &m, Matrix3<T> &v, Vector3<T> &eigenvalues, int sweeps) {
+    // cyclic Jacobi: every sweep annihilates the off-diagonal elements (0,1), (0,2), (1,2) in turn.
+    // The rotation angle is computed with the formulation from Numerical Recipes, written to avoid the
+    // division by a(p,q) so that already-diagonal inputs need no special case.
+    T a[3][3];
+    T e[3][3] = {{T(1), T(0), T(0)}, {T(0), T(1), T(0)}, {T(0), T(0), T(1)}};
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            a[i][j] = (m(i, j) + m(j, i)) / T(2);
+        }
+    }
+    static const int pairs[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+    for (int sw = 0; sw < sweeps; sw++) {
+        for (int k = 0; k < 3; k++) {
+            const int p = pairs[k][0];
+            const int q = pairs[k][1];
+            const int o = 3 - p - q;
+            T apq = a[p][q];
+            T tau = a[q][q] - a[p][p];
+            T sgn = tau >= T(0) ? T(1) : T(-1);
+            T den = std::abs(tau) + std::sqrt(tau * tau + T(4) * apq * apq);
+            T t = den > T(0) ? T(2) * apq * sgn / den : T(0); // tan of the rotation angle
+            T c = T(1) / std::sqrt(T(1) + t * t);
+            T sn = t * c;
+            a[p][p] -= t * apq;
+            a[q][q] += t * apq;
+            a[p][q] = a[q][p] = T(0);
+            T aop = a[o][p];
+            T aoq = a[o][q];
+            a[o][p] = a[p][o] = c * aop - sn * aoq;
+            a[o][q] = a[q][o] = sn * aop + c * aoq;
+            for (int i = 0; i < 3; i++) {
+                T eip = e[i][p];
+                T eiq = e[i][q];
+                e[i][p] = c * eip - sn * eiq;
+                e[i][q] = sn * eip + c * eiq;
+            }
+        }
+    }
+    // sort by decreasing eigenvalue (3 compare-and-swap)
+    int idx[3] = {0, 1, 2};
+    if (a[idx[0]][idx[0]] < a[idx[1]][idx[1]])
+        std::swap(idx[0], idx[1]);
+    if (a[idx[1]][idx[1]] < a[idx[2]][idx[2]])
+        std::swap(idx[1], idx[2]);
+    if (a[idx[0]][idx[0]] < a[idx[1]][idx[1]])
+        std::swap(idx[0], idx[1]);
+    for (int j = 0; j < 3; j++) {
+        eigenvalues[j] = a[idx[j]][idx[j]];
+        for (int i = 0; i < 3; i++) {
+            v(i, j) = e[i][idx[j]];
+        }
+    }
+    // make v a proper rotation
+    if (det(v) < T(0)) {
+        v(0, 2) = -v(0, 2);
+        v(1, 2) = -v(1, 2);
+        v(2, 2) = -v(2, 2);
+    }
+}
+
+template <typename T>
+void svd_decompose(const Matrix3<T> &m, Matrix3<T> &u, Vector3<T> &sigma, Matrix3<T> &v, int sweeps) {
+    // 1. Jacobi eigenanalysis of the symmetric matrix transpose(m)*m, using the approximate Givens rotations
+    //    from the paper (half angle from a single reciprocal square root) accumulated in a quaternion.
+    //    The rotation planes (0,1), (1,2), (2,0) are all cyclic, so every rotation is a positive rotation about
+    //    the remaining axis.
+    const T gamma = T(5.828427124746190); // 3 + 2*sqrt(2)
+    const T cstar = T(0.923879532511287); // cos(pi/8)
+    const T sstar = T(0.382683432365090); // sin(pi/8)
+    T a[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            a[i][j] = m(0, i) * m(0, j) + m(1, i) * m(1, j) + m(2, i) * m(2, j);
+        }
+    }
+    Quaternion<T> qv;
+    static const int planes[3][2] = {{0, 1}, {1, 2}, {2, 0}};
+    for (int sw = 0; sw < sweeps; sw++) {
+        for (int k = 0; k < 3; k++) {
+            const int p = planes[k][0];
+            const int q = planes[k][1];
+            const int o = 3 - p - q;
+            T ch = T(2) * (a[p][p] - a[q][q]);
+            T sh = a[p][q];
+            const bool exact = gamma * sh * sh < ch * ch;
+            const T w = T(1) / std::sqrt(ch * ch + sh * sh);
+            ch = exact ? w * ch : cstar;
+            sh = exact ? w * sh : sstar;
+            const T c = ch * ch - sh * sh;
+            const T s = T(2) * ch * sh;
+            // a = transpose(G) * a * G, with G the rotation of angle atan2(s, c) in the (p,q) plane
+            const T app = a[p][p], aqq = a[q][q], apq = a[p][q], aop = a[o][p], aoq = a[o][q];
+            a[p][p] = c * c * app + T(2) * c * s * apq + s * s * aqq;
+            a[q][q] = s * s * app - T(2) * c * s * apq + c * c * aqq;
+            a[p][q] = a[q][p] = (c * c - s * s) * apq - c * s * (app - aqq);
+            a[o][p] = a[p][o] = c * aop + s * aoq;
+            a[o][q] = a[q][o] = c * aoq - s * aop;
+            // v = v * G
+            qv = qv * Quaternion<T>(ch, o == 0 ? sh : T(0), o == 1 ? sh : T(0), o == 2 ? sh : T(0));
+        }
+    }
+    normalize(qv);
+    v = rot_matrix(qv);
+    // 2. b = m * v, then sort the columns of b (and v) by decreasing norm. Every swap negates one of the two
+    //    columns, so that v stays a proper rotation.
+    Matrix3<T> b = m * v;
+    T rho[3];
+    for (int j = 0; j < 3; j++)
+        rho[j] = b(0, j) * b(0, j) + b(1, j) * b(1, j) + b(2, j) * b(2, j);
+    static const int swaps[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+    for (int k = 0; k < 3; k++) {
+        const int i = swaps[k][0];
+        const int j = swaps[k][1];
+        const bool sw = rho[i] < rho[j];
+        const T ri = rho[i];
+        rho[i] = sw ? rho[j] : rho[i];
+        rho[j] = sw ? ri : rho[j];
+        for (int r = 0; r < 3; r++) {
+            const T bi = b(r, i), vi = v(r, i);
+            b(r, i) = sw ? b(r, j) : bi;
+            b(r, j) = sw ? -bi : b(r, j);
+            v(r, i) = sw ? v(r, j) : vi;
+            v(r, j) = sw ? -vi : v(r, j);
+        }
+    }
+    // 3. QR decomposition of b with Givens rotations: b = u * r, with r diagonal up to the numerical error,
+    //    so the singular values are the diagonal of r
+    set_identity(u);
+    static const int givens[3][3] = {{0, 1, 0}, {0, 2, 0}, {1, 2, 1}}; // rows (p,q), column to eliminate
+    const T tiny = T(1e-30);
+    for (int k = 0; k < 3; k++) {
+        const int p = givens[k][0];
+        const int q = givens[k][1];
+        const int col = givens[k][2];
+        const T x = b(p, col);
+        const T y = b(q, col);
+        const T len = std::sqrt(x * x + y * y);
+        const bool valid = len > tiny;
+        const T inv = T(1) / (valid ? len : T(1));
+        const T c = valid ? x * inv : T(1);
+        const T s = valid ? y * inv : T(0);
+        for (int j = 0; j < 3; j++) {
+            const T bp = b(p, j), bq = b(q, j);
+            b(p, j) = c * bp + s * bq;
+            b(q, j) = c * bq - s * bp;
+            const T up = u(j, p), uq = u(j, q);
+            u(j, p) = c * up + s * uq;
+            u(j, q) = c * uq - s * up;
+        }
+    }
+    sigma = Vector3<T>(b(0, 0), b(1, 1), b(2, 2));
+}
+
+template <typename T>
+void polar_decompose(const Matrix3<T> *m, Matrix3<T> *r, Matrix3<T> *s, size_t count, int iterations) {
+    for (size_t i = 0; i < count; i++)
+        polar_decompose(m[i], r[i], s[i], iterations);
+}
+
+template <typename T> void qr_decompose(const Matrix3<T> *m, Matrix3<T> *q, Matrix3<T> *r, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        qr_decompose(m[i], q[i], r[i]);
+}
+
+template <typename T>
+void eigen_decompose(const Matrix3<T> *m, Matrix3<T> *v, Vector3<T> *eigenvalues, size_t count, int sweeps) {
+    for (size_t i = 0; i < count; i++)
+        eigen_decompose(m[i], v[i], eigenvalues[i], sweeps);
+}
+
+template <typename T>
+void svd_decompose(const Matrix3<T> *m, Matrix3<T> *u, Vector3<T> *sigma, Matrix3<T> *v, size_t count, int sweeps) {
+    for (size_t i = 0; i < count; i++)
+        svd_decompose(m[i], u[i], sigma[i], v[i], sweeps);
+}
+
 // namespace matrix4
 template <typename T> inline void set_zero(Matrix4<T> &mat) {
     for (int i = 0; i < 16; i++)
@@ -208,8 +449,9 @@ template <typename T> T det(const Matrix4<T> &m) {
 /// calc inverse matrix
 template <typename T> Matrix4<T> inverse(const Matrix4<T> &m) {
     /// \todo better API in case the inverse does not exist. See https://github.com/dbacchet/vmath/issues/3
+    using std::abs;
     T d = det(m);
-    if (std::abs(d)<VMATH_EPSILON) {
+    if (abs(d)<VMATH_EPSILON) {
         return Matrix4<T>(); // return null matrix
     }
     Matrix4<T> ret;
@@ -300,7 +542,8 @@ template <typename T> Quaternion<T> normalized(const Quaternion<T> &q) {
 }
 
 template <typename T> inline Vector3<T> axis(const Quaternion<T> &q) {
-    if (std::abs(q.w*q.w - 1) < VMATH_EPSILON)
+    using std::abs;
+    if (abs(q.w*q.w - 1) < VMATH_EPSILON)
         return (Vector3<T>(q.x,q.y,q.z)); // arbitrary when there is no rotation!!
     Vector3<T> axis;
     axis.x = q.x / sqrt(1 - q.w * q.w);
@@ -480,12 +723,14 @@ template <typename T> inline Quaternion<T> quat_from_euler_321(T x, T y, T z) {
     const T yaw = z;
     const T pitch = y;
     const T roll = x;
-    const T cy = std::cos(yaw * 0.5);
-    const T sy = std::sin(yaw * 0.5);
-    const T cp = std::cos(pitch * 0.5);
-    const T sp = std::sin(pitch * 0.5);
-    const T cr = std::cos(roll * 0.5);
-    const T sr = std::sin(roll * 0.5);
+    using std::cos;
+    using std::sin;
+    const T cy = cos(yaw * 0.5);
+    const T sy = sin(yaw * 0.5);
+    const T cp = cos(pitch * 0.5);
+    const T sp = sin(pitch * 0.5);
+    const T cr = cos(roll * 0.5);
+    const T sr = sin(roll * 0.5);
 
     Quaternion<T> q(cy * cp * cr + sy * sp * sr,
                     cy * cp * sr - sy * sp * cr,
@@ -497,22 +742,26 @@ template <typename T> inline Quaternion<T> quat_from_euler_321(T x, T y, T z) {
 
 template <typename T> Vector3<T> to_euler_321(Quaternion<T> const &q) {
     // from https://en.wikipedia.org/wiki/Conversion_between_quaternions_and_Euler_angles#Quaternion_to_Euler_Angles_Conversion
+    using std::abs;
+    using std::asin;
+    using std::atan2;
+    using std::copysign;
     Vector3<T> angles;
     // roll (x-axis rotation)
     T sinr_cosp = 2 * (q.w * q.x + q.y * q.z);
     T cosr_cosp = 1 - 2 * (q.x * q.x + q.y * q.y);
-    angles.x = std::atan2(sinr_cosp, cosr_cosp);
+    angles.x = atan2(sinr_cosp, cosr_cosp);
     // pitch (y-axis rotation)
     T sinp = 2 * (q.w * q.y - q.z * q.x);
-    if (std::abs(sinp) >= 1) {
-        angles.y = std::copysign(M_PI / 2, sinp); // use 90 degrees if out of range
+    if (abs(sinp) >= 1) {
+        angles.y = copysign(M_PI / 2, sinp); // use 90 degrees if out of range
     } else {
-        angles.y = std::asin(sinp);
+        angles.y = asin(sinp);
     }
     // yaw (z-axis rotation)
     T siny_cosp = 2 * (q.w * q.z + q.x * q.y);
     T cosy_cosp = 1 - 2 * (q.y * q.y + q.z * q.z);
-    angles.z = std::atan2(siny_cosp, cosy_cosp);
+    angles.z = atan2(siny_cosp, cosy_cosp);
     return angles;
 }
 
@@ -525,11 +774,12 @@ template <typename T> inline Quaternion<T> quat_from_axis_angle(Vector3<T> axis,
 template <typename T> Quaternion<T> quat_from_matrix(const Matrix4<T> &m) {
     // implement the algorithm described here: https://en.wikipedia.org/wiki/Rotation_matrix#Quaternion
     // only the rotation part is considered
+    using std::sqrt;
     Quaternion<T> q;
 
     T tr = m(0, 0) + m(1, 1) + m(2, 2);
     if (tr >= T(0)) {
-        T r = std::sqrt(T(1) + tr);
+        T r = sqrt(T(1) + tr);
         T s = T(1)/(T(2)*r);
         q.w = r/T(2);
         q.x = (m(2, 1) - m(1, 2)) * s;
@@ -544,21 +794,21 @@ template <typename T> Quaternion<T> quat_from_matrix(const Matrix4<T> &m) {
         char bigIdx = (d0 > d1) ? ((d0 > d2) ? 0 : 2) : ((d1 > d2) ? 1 : 2);
 
         if (bigIdx == 0) {
-            T r = std::sqrt(1.0 + m(0, 0) - m(1, 1) - m(2, 2));
+            T r = sqrt(1.0 + m(0, 0) - m(1, 1) - m(2, 2));
             T s = T(1)/(T(2)*r);
             q.w = (m(2, 1) - m(1, 2)) * s;
             q.x = r/T(2);
             q.y = (m(0, 1) + m(1, 0)) * s;
             q.z = (m(0, 2) + m(2, 0)) * s;
         } else if (bigIdx == 1) {
-            T r = std::sqrt(1.0 + m(1, 1) - m(0, 0) - m(2, 2));
+            T r = sqrt(1.0 + m(1, 1) - m(0, 0) - m(2, 2));
             T s = T(1)/(T(2)*r);
             q.w = (m(0, 2) - m(2, 0)) * s;
             q.x = (m(0, 1) + m(1, 0)) * s;
             q.y = r/T(2);
             q.z = (m(1, 2) + m(2, 1)) * s;
         } else {
-            T r = std::sqrt(1.0 + m(2, 2) - m(0, 0) - m(1, 1));
+            T r = sqrt(1.0 + m(2, 2) - m(0, 0) - m(1, 1));
             T s = T(1)/(T(2)*r);
             q.w = (m(1, 0) - m(0, 1)) * s;
             q.x = (m(0, 2) + m(2, 0)) * s;
@@ -572,11 +822,12 @@ template <typename T> Quaternion<T> quat_from_matrix(const Matrix4<T> &m) {
 
 template <typename T> Quaternion<T> quat_from_matrix(const Matrix3<T> &m) {
     // implement the algorithm described here: https://en.wikipedia.org/wiki/Rotation_matrix#Quaternion
+    using std::sqrt;
     Quaternion<T> q;
 
     T tr = m(0, 0) + m(1, 1) + m(2, 2);
     if (tr >= T(0)) {
-        T r = std::sqrt(T(1) + tr);
+        T r = sqrt(T(1) + tr);
         T s = T(1)/(T(2)*r);
         q.w = r/T(2);
         q.x = (m(2, 1) - m(1, 2)) * s;
@@ -591,21 +842,21 @@ template <typename T> Quaternion<T> quat_from_matrix(const Matrix3<T> &m) {
         char bigIdx = (d0 > d1) ? ((d0 > d2) ? 0 : 2) : ((d1 > d2) ? 1 : 2);
 
         if (bigIdx == 0) {
-            T r = std::sqrt(1.0 + m(0, 0) - m(1, 1) - m(2, 2));
+            T r = sqrt(1.0 + m(0, 0) - m(1, 1) - m(2, 2));
             T s = T(1)/(T(2)*r);
             q.w = (m(2, 1) - m(1, 2)) * s;
             q.x = r/T(2);
             q.y = (m(0, 1) + m(1, 0)) * s;
             q.z = (m(0, 2) + m(2, 0)) * s;
         } else if (bigIdx == 1) {
-            T r = std::sqrt(1.0 + m(1, 1) - m(0, 0) - m(2, 2));
+            T r = sqrt(1.0 + m(1, 1) - m(0, 0) - m(2, 2));
             T s = T(1)/(T(2)*r);
             q.w = (m(0, 2) - m(2, 0)) * s;
             q.x = (m(0, 1) + m(1, 0)) * s;
             q.y = r/T(2);
             q.z = (m(1, 2) + m(2, 1)) * s;
         } else {
-            T r = std::sqrt(1.0 + m(2, 2) - m(0, 0) - m(1, 1));
+            T r = sqrt(1.0 + m(2, 2) - m(0, 0) - m(1, 1));
             T s = T(1)/(T(2)*r);
             q.w = (m(1, 0) - m(0, 1)) * s;
             q.x = (m(0, 2) + m(2, 0)) * s;
@@ -0,0 +1,288 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+#pragma once
+
+#include "vmath.h"
+#include "vmath_exp_map.h"
+#include "vmath_parallel.h"
+#include "vmath_simd_detail.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace math {
+
+// ///////////////////////// //
+// rigid body integrators    //
+// ///////////////////////// //
+
+// One time step of the rigid body kinematics, with the angular velocities w in the world frame (dq/dt = w q / 2).
+// The velocities are first updated with the accelerations (if any), then the positions and orientations move
+// with the new velocities (semi-implicit, or symplectic, Euler). The orientations are renormalized at every step.
+
+/// explicit Euler orientation update, normalized(q + dt / 2 * (0, w) * q)
+template <typename T> Quaternion<T> integrate_euler(const Quaternion<T> &q, const Vector3<T> &w, T dt);
+/// exponential map orientation update, exp(dt / 2 * (0, w)) * q: exact for a constant angular velocity
+template <typename T> Quaternion<T> integrate_exp(const Quaternion<T> &q, const Vector3<T> &w, T dt);
+
+/// semi-implicit Euler step of count bodies: v += a * dt and w += alpha * dt (the accelerations a and alpha can be
+/// null), p += v * dt and the orientation update of integrate_euler(). The bodies are transposed in blocks to
+/// structure of arrays and integrated several at a time with SIMD; large arrays are split over threads
+/// (0 = hardware threads)
+template <typename T>
+void integrate_euler(Transform<T> *bodies, Vector3<T> *v, Vector3<T> *w, const Vector3<T> *a, const Vector3<T> *alpha,
+                     T dt, size_t count, unsigned threads = 0);
+/// as above, with the orientation update of integrate_exp()
+template <typename T>
+void integrate_exp(Transform<T> *bodies, Vector3<T> *v, Vector3<T> *w, const Vector3<T> *a, const Vector3<T> *alpha,
+                   T dt, size_t count, unsigned threads = 0);
+
+/// rigid body states as structure of arrays, count values per array. The acceleration pointers can be null.
+template <typename T> struct RigidBodyArrays {
+    T *px = nullptr, *py = nullptr, *pz = nullptr;                   ///< positions
+    T *qw = nullptr, *qx = nullptr, *qy = nullptr, *qz = nullptr;    ///< orientations
+    T *vx = nullptr, *vy = nullptr, *vz = nullptr;                   ///< linear velocities
+    T *wx = nullptr, *wy = nullptr, *wz = nullptr;                   ///< angular velocities (world frame)
+    const T *ax = nullptr, *ay = nullptr, *az = nullptr;             ///< linear accelerations (optional)
+    const T *alphax = nullptr, *alphay = nullptr, *alphaz = nullptr; ///< angular accelerations (optional)
+};
+
+/// batch versions over structure of arrays: 8 (AVX) or 4 (SSE2) float bodies per iteration (half as many double
+/// bodies for integrate_euler; the double integrate_exp is scalar)
+template <typename T> void integrate_euler(const RigidBodyArrays<T> &bodies, T dt, size_t count, unsigned threads = 0);
+template <typename T> void integrate_exp(const RigidBodyArrays<T> &bodies, T dt, size_t count, unsigned threads = 0);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+// the pack used by each integrator: the one of the exponential map kernels for integrate_exp()
+template <bool Exponential, typename T> struct IntegratorPack { typedef typename WidePack<T>::type type; };
+template <typename T> struct IntegratorPack<true, T> { typedef typename ExpMapPack<T>::type type; };
+
+// q + (0, u) * q for the explicit Euler step, exp((0, u)) * q = cos|u| q + sin|u| / |u| (0, u) * q for the
+// exponential map, then normalized
+template <bool Exponential> struct RotationStep {
+    template <typename P> static void apply(P, P &c, P &sinc) {
+        c = P(1);
+        sinc = P(1);
+    }
+};
+template <> struct RotationStep<true> {
+    template <typename P> static void apply(P u2, P &c, P &sinc) { lanes_half_angle(u2, c, sinc); }
+};
+
+template <bool Exponential, typename P> inline void rotate_lanes(P &qw, P &qx, P &qy, P &qz, P ux, P uy, P uz) {
+    // (0, u) * q = (-u.v, qw u + u x v)
+    const P dw = P(0) - (ux * qx + uy * qy + uz * qz);
+    const P dx = qw * ux + (uy * qz - uz * qy);
+    const P dy = qw * uy + (uz * qx - ux * qz);
+    const P dz = qw * uz + (ux * qy - uy * qx);
+    P c, sinc;
+    RotationStep<Exponential>::apply(ux * ux + uy * uy + uz * uz, c, sinc);
+    const P nw = c * qw + sinc * dw, nx = c * qx + sinc * dx, ny = c * qy + sinc * dy, nz = c * qz + sinc * dz;
+    const P inv_len = P(1) / lanes_sqrt(nw * nw + nx * nx + ny * ny + nz * nz);
+    qw = nw * inv_len;
+    qx = nx * inv_len;
+    qy = ny * inv_len;
+    qz = nz * inv_len;
+}
+
+// state components in the order p (3), q (4, w x y z), v (3), w (3); acceleration components a (3), alpha (3)
+const int body_state_size = 13;
+
+template <bool Exponential, typename P>
+inline void integrate_lanes(P *s, const P *acc, bool linear_acc, bool angular_acc, P dt) {
+    // the state is read into locals and written once: in place updates of s defeat store forwarding
+    P vx = s[7], vy = s[8], vz = s[9], wx = s[10], wy = s[11], wz = s[12];
+    if (linear_acc) {
+        vx = vx + acc[0] * dt;
+        vy = vy + acc[1] * dt;
+        vz = vz + acc[2] * dt;
+    }
+    if (angular_acc) {
+        wx = wx + acc[3] * dt;
+        wy = wy + acc[4] * dt;
+        wz = wz + acc[5] * dt;
+    }
+    const P half = dt * P(0.5f);
+    P qw = s[3], qx = s[4], qy = s[5], qz = s[6];
+    rotate_lanes<Exponential>(qw, qx, qy, qz, wx * half, wy * half, wz * half);
+    s[0] = s[0] + vx * dt;
+    s[1] = s[1] + vy * dt;
+    s[2] = s[2] + vz * dt;
+    s[3] = qw;
+    s[4] = qx;
+    s[5] = qy;
+    s[6] = qz;
+    s[7] = vx;
+    s[8] = vy;
+    s[9] = vz;
+    s[10] = wx;
+    s[11] = wy;
+    s[12] = wz;
+}
+
+// bodies [begin, end) of the structure of arrays
+template <bool Exponential, typename T>
+inline void integrate_soa_range(const RigidBodyArrays<T> &b, T dt, size_t begin, size_t end) {
+    typedef typename IntegratorPack<Exponential, T>::type P;
+    T *const state[body_state_size] = {b.px, b.py, b.pz, b.qw, b.qx, b.qy, b.qz,
+                                       b.vx, b.vy, b.vz, b.wx, b.wy, b.wz};
+    const T *const acc[6] = {b.ax, b.ay, b.az, b.alphax, b.alphay, b.alphaz};
+    const bool linear_acc = b.ax && b.ay && b.az, angular_acc = b.alphax && b.alphay && b.alphaz;
+    const size_t width = sizeof(P) / sizeof(T);
+    size_t k = begin;
+    for (; k + width <= end; k += width) {
+        P s[body_state_size], a[6];
+        for (int c = 0; c < body_state_size; c++)
+            lanes_load(s[c], state[c] + k);
+        for (int c = 0; c < 6; c++)
+            if (c < 3 ? linear_acc : angular_acc)
+                lanes_load(a[c], acc[c] + k);
+        integrate_lanes<Exponential>(s, a, linear_acc, angular_acc, P(dt));
+        for (int c = 0; c < body_state_size; c++)
+            lanes_store(state[c] + k, s[c]);
+    }
+    for (; k < end; k++) {
+        T s[body_state_size], a[6];
+        for (int c = 0; c < body_state_size; c++)
+            s[c] = state[c][k];
+        for (int c = 0; c < 6; c++)
+            a[c] = (c < 3 ? linear_acc : angular_acc) ? acc[c][k] : T(0);
+        integrate_lanes<Exponential>(s, a, linear_acc, angular_acc, dt);
+        for (int c = 0; c < body_state_size; c++)
+            state[c][k] = s[c];
+    }
+}
+
+// arrays of structures, transposed to structure of arrays in small blocks
+template <bool Exponential, typename T>
+inline void integrate_aos(Transform<T> *bodies, Vector3<T> *v, Vector3<T> *w, const Vector3<T> *a,
+                          const Vector3<T> *alpha, T dt, size_t count, unsigned threads) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        const size_t block = 64;
+        T s[body_state_size][block], acc[6][block];
+        RigidBodyArrays<T> soa;
+        T **const state[body_state_size] = {&soa.px, &soa.py, &soa.pz, &soa.qw, &soa.qx, &soa.qy, &soa.qz,
+                                            &soa.vx, &soa.vy, &soa.vz, &soa.wx, &soa.wy, &soa.wz};
+        for (int c = 0; c < body_state_size; c++)
+            *state[c] = s[c];
+        if (a) {
+            soa.ax = acc[0];
+            soa.ay = acc[1];
+            soa.az = acc[2];
+        }
+        if (alpha) {
+            soa.alphax = acc[3];
+            soa.alphay = acc[4];
+            soa.alphaz = acc[5];
+        }
+        for (size_t first = begin; first < end; first += block) {
+            const size_t n = std::min(block, end - first);
+            const Transform<T> *t = bodies + first;
+            const Vector3<T> *vk = v + first, *wk = w + first;
+            for (size_t k = 0; k < n; k++) {
+                s[0][k] = t[k].p.x;
+                s[1][k] = t[k].p.y;
+                s[2][k] = t[k].p.z;
+                s[3][k] = t[k].q.w;
+                s[4][k] = t[k].q.x;
+                s[5][k] = t[k].q.y;
+                s[6][k] = t[k].q.z;
+                s[7][k] = vk[k].x;
+                s[8][k] = vk[k].y;
+                s[9][k] = vk[k].z;
+                s[10][k] = wk[k].x;
+                s[11][k] = wk[k].y;
+                s[12][k] = wk[k].z;
+            }
+            for (size_t k = 0; a && k < n; k++) {
+                acc[0][k] = a[first + k].x;
+                acc[1][k] = a[first + k].y;
+                acc[2][k] = a[first + k].z;
+            }
+            for (size_t k = 0; alpha && k < n; k++) {
+                acc[3][k] = alpha[first + k].x;
+                acc[4][k] = alpha[first + k].y;
+                acc[5][k] = alpha[first + k].z;
+            }
+            integrate_soa_range<Exponential>(soa, dt, 0, n);
+            for (size_t k = 0; k < n; k++) {
+                Transform<T> &t = bodies[first + k];
+                t.p = Vector3<T>(s[0][k], s[1][k], s[2][k]);
+                t.q = Quaternion<T>(s[3][k], s[4][k], s[5][k], s[6][k]);
+                v[first + k] = Vector3<T>(s[7][k], s[8][k], s[9][k]);
+                w[first + k] = Vector3<T>(s[10][k], s[11][k], s[12][k]);
+            }
+        }
+    });
+}
+
+template <bool Exponential, typename T>
+inline Quaternion<T> integrate_rotation(const Quaternion<T> &q, const Vector3<T> &w, T dt) {
+    const T half = dt / T(2);
+    T qw = q.w, qx = q.x, qy = q.y, qz = q.z;
+    rotate_lanes<Exponential>(qw, qx, qy, qz, w.x * half, w.y * half, w.z * half);
+    return Quaternion<T>(qw, qx, qy, qz);
+}
+
+} // namespace detail
+
+template <typename T> inline Quaternion<T> integrate_euler(const Quaternion<T> &q, const Vector3<T> &w, T dt) {
+    return detail::integrate_rotation<false>(q, w, dt);
+}
+template <typename T> inline Quaternion<T> integrate_exp(const Quaternion<T> &q, const Vector3<T> &w, T dt) {
+    return detail::integrate_rotation<true>(q, w, dt);
+}
+
+template <typename T>
+inline void integrate_euler(Transform<T> *bodies, Vector3<T> *v, Vector3<T> *w, const Vector3<T> *a,
+                            const Vector3<T> *alpha, T dt, size_t count, unsigned threads) {
+    detail::integrate_aos<false>(bodies, v, w, a, alpha, dt, count, threads);
+}
+template <typename T>
+inline void integrate_exp(Transform<T> *bodies, Vector3<T> *v, Vector3<T> *w, const Vector3<T> *a,
+                          const Vector3<T> *alpha, T dt, size_t count, unsigned threads) {
+    detail::integrate_aos<true>(bodies, v, w, a, alpha, dt, count, threads);
+}
+
+template <typename T>
+inline void integrate_euler(const RigidBodyArrays<T> &bodies, T dt, size_t count, unsigned threads) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        detail::integrate_soa_range<false>(bodies, dt, begin, end);
+    });
+}
+template <typename T>
+inline void integrate_exp(const RigidBodyArrays<T> &bodies, T dt, size_t count, unsigned threads) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        detail::integrate_soa_range<true>(bodies, dt, begin, end);
+    });
+}
+
+} // namespace math
@@ -0,0 +1,363 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+#pragma once
+
+#include "vmath.h"
+#include "vmath_parallel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace math {
+
+/// number of coordinates of the vector types supported by KdTree
+template <typename V> struct vector_dimensions;
+template <typename T> struct vector_dimensions<Vector2<T>> { static constexpr int value = 2; };
+template <typename T> struct vector_dimensions<Vector3<T>> { static constexpr int value = 3; };
+
+/// approximate search parameters for the KdTree queries (the defaults give the exact result)
+template <typename T> struct KdTreeSearchParams {
+    /// (1 + eps)-approximate kNN: the subtrees that cannot contain a point closer than (the current k-th
+    /// distance) / (1 + eps) are skipped, so each returned distance is within (1 + eps) of the exact one
+    T eps = T(0);
+    /// maximum number of leaves scanned per query (0 = unlimited). The leaf containing the query is scanned
+    /// first, so even a small budget returns good candidates.
+    size_t max_leaves = 0;
+};
+
+/// k-d tree over an array of Vector2 or Vector3 points.
+///
+/// The tree does not copy the points: it keeps a pointer to the array (which must stay alive and unchanged
+/// while the tree is used) and a permutation of the point indices. The layout is implicit: the node spanning
+/// the range [begin, end) of the permutation stores its splitting point at mid = (begin + end) / 2, with the
+/// left subtree in [begin, mid) and the right one in [mid + 1, end); ranges of up to leaf_size points are
+/// leaves. The splitting coordinate and dimension are stored per slot, so the traversal only reads the points
+/// it compares against the query.
+template <typename V> class KdTree {
+  public:
+    typedef typename V::value_type value_type; // to access the inner type at compile time
+    typedef typename V::value_type T;
+    static constexpr int dimensions = vector_dimensions<V>::value;
+    /// index reported for the missing neighbors of a kNN query with fewer than k points in the tree
+    static constexpr uint32_t invalid_index = 0xffffffffu;
+
+    /// build the tree over points[0..count). Each node splits its cell (the bounding box of the points, cut by
+    /// the splits of its ancestors) along the longest side, at the median point. The build is parallel over
+    /// threads (0 = hardware threads) and the tree does not depend on the number of threads.
+    void build(const V *points, size_t count, unsigned threads = 0, size_t leaf_size = 8);
+
+    /// k nearest neighbors of q, sorted by increasing distance.
+    /// @param indices output array of k indices; if the tree has fewer than k points the remaining ones are
+    ///        set to invalid_index
+    /// @param dist2 optional output array of k squared distances (infinity for the missing neighbors)
+    /// @return the number of neighbors found, min(k, size())
+    size_t knn_search(const V &q, size_t k, uint32_t *indices, T *dist2 = nullptr,
+                      const KdTreeSearchParams<T> &params = KdTreeSearchParams<T>()) const;
+    /// append to out the indices of the points within radius from q (in no particular order)
+    void radius_search(const V &q, T radius, std::vector<uint32_t> &out) const;
+
+    /// kNN search for an array of queries, parallel over threads (0 = hardware threads). The queries are processed
+    /// in the order of the leaves containing them, for cache locality.
+    /// The neighbors of query i are stored in indices[i*k..(i+1)*k) (and dist2, if not null).
+    void knn_search(const V *queries, size_t count, size_t k, uint32_t *indices, T *dist2 = nullptr,
+                    const KdTreeSearchParams<T> &params = KdTreeSearchParams<T>(), unsigned threads = 0) const;
+    /// radius search for an array of queries, parallel over threads (0 = hardware threads).
+    /// The results are stored in CSR form: the neighbors of query i are indices[offsets[i]..offsets[i+1]).
+    void radius_search(const V *queries, size_t count, T radius, std::vector<uint32_t> &offsets,
+                       std::vector<uint32_t> &indices, unsigned threads = 0) const;
+
+    /// number of points in the tree
+    size_t size() const { return indices_.size(); }
+    /// the indexed points
+    const V *points() const { return points_; }
+
+  private:
+    void build_range(uint32_t begin, uint32_t end, V lo, V hi, unsigned threads);
+    uint32_t leaf_of(const V &q) const;
+    std::vector<uint32_t> query_order(const V *queries, size_t count, unsigned threads) const;
+
+    const V *points_ = nullptr;
+    size_t leaf_size_ = 8;
+    std::vector<uint32_t> indices_; // permutation of the point indices
+    std::vector<T> split_;          // splitting coordinate of the node whose median is at this slot
+    std::vector<uint8_t> dim_;      // splitting dimension of the node whose median is at this slot
+};
+
+typedef KdTree<Vector2<float>> KdTree2f;
+typedef KdTree<Vector2<double>> KdTree2d;
+typedef KdTree<Vector3<float>> KdTree3f;
+typedef KdTree<Vector3<double>> KdTree3d;
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+template <typename V> constexpr int KdTree<V>::dimensions;
+template <typename V> constexpr uint32_t KdTree<V>::invalid_index;
+
+template <typename V> void KdTree<V>::build(const V *points, size_t count, unsigned threads, size_t leaf_size) {
+    points_ = points;
+    leaf_size_ = std::max<size_t>(1, leaf_size);
+    indices_.resize(count);
+    split_.resize(count);
+    dim_.resize(count);
+    if (count == 0)
+        return;
+    std::vector<V> lo(parallel_chunk_count(count, threads, 65536), points[0]), hi(lo);
+    parallel_for(count, threads, 65536, [&](size_t chunk, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            indices_[i] = uint32_t(i);
+            for (int d = 0; d < dimensions; d++) {
+                lo[chunk][d] = std::min(lo[chunk][d], points[i][d]);
+                hi[chunk][d] = std::max(hi[chunk][d], points[i][d]);
+            }
+        }
+    });
+    for (size_t c = 1; c < lo.size(); c++) {
+        for (int d = 0; d < dimensions; d++) {
+            lo[0][d] = std::min(lo[0][d], lo[c][d]);
+            hi[0][d] = std::max(hi[0][d], hi[c][d]);
+        }
+    }
+    build_range(0, uint32_t(count), lo[0], hi[0], threads == 0 ? default_thread_count() : threads);
+}
+
+template <typename V> void KdTree<V>::build_range(uint32_t begin, uint32_t end, V lo, V hi, unsigned threads) {
+    while (end - begin > leaf_size_) {
+        // split the cell along its longest side
+        int dim = 0;
+        for (int d = 1; d < dimensions; d++)
+            if (hi[d] - lo[d] > hi[dim] - lo[dim])
+                dim = d;
+        const uint32_t mid = begin + (end - begin) / 2;
+        const V *pts = points_;
+        std::nth_element(indices_.begin() + begin, indices_.begin() + mid, indices_.begin() + end,
+                         [pts, dim](uint32_t a, uint32_t b) { return pts[a][dim] < pts[b][dim]; });
+        const T split = points_[indices_[mid]][dim];
+        split_[mid] = split;
+        dim_[mid] = uint8_t(dim);
+        V left_hi = hi, right_lo = lo;
+        left_hi[dim] = split;
+        right_lo[dim] = split;
+        if (threads > 1 && end - begin > 65536) {
+            // the two subtrees are independent: build them in parallel, splitting the thread budget
+            parallel_for(2, 2, 1, [&](size_t c, size_t, size_t) {
+                if (c == 0)
+                    build_range(begin, mid, lo, left_hi, threads / 2);
+                else
+                    build_range(mid + 1, end, right_lo, hi, threads - threads / 2);
+            });
+            return;
+        }
+        build_range(begin, mid, lo, left_hi, 1);
+        begin = mid + 1;
+        lo = right_lo;
+    }
+}
+
+template <typename V>
+size_t KdTree<V>::knn_search(const V &q, size_t k, uint32_t *indices, T *dist2,
+                             const KdTreeSearchParams<T> &params) const {
+    const T inf = std::numeric_limits<T>::infinity();
+    // max-heap of the best k candidates, (dist2, index)
+    std::vector<std::pair<T, uint32_t>> best;
+    best.reserve(k);
+    T worst = inf; // current k-th distance (infinity until k candidates are found)
+    auto add = [&](uint32_t index) {
+        const V d = points_[index] - q;
+        const T d2 = d.dot(d);
+        if (best.size() < k) {
+            best.push_back(std::make_pair(d2, index));
+            std::push_heap(best.begin(), best.end());
+            if (best.size() == k)
+                worst = best.front().first;
+        } else if (d2 < worst) {
+            std::pop_heap(best.begin(), best.end());
+            best.back() = std::make_pair(d2, index);
+            std::push_heap(best.begin(), best.end());
+            worst = best.front().first;
+        }
+    };
+    if (k > 0 && !indices_.empty()) {
+        // depth first, nearest child first; the far children wait on a stack with the squared distance of the
+        // query from their splitting plane, and are skipped if that is not closer than the k-th candidate
+        // (scaled for the approximate search)
+        const T scale = (T(1) + params.eps) * (T(1) + params.eps);
+        struct Pending {
+            uint32_t begin, end;
+            T d2;
+        };
+        Pending stack[64];
+        int top = 0;
+        stack[top++] = Pending{0, uint32_t(indices_.size()), T(0)};
+        size_t leaves = 0;
+        while (top > 0) {
+            const Pending n = stack[--top];
+            if (n.d2 * scale >= worst)
+                continue;
+            uint32_t begin = n.begin, end = n.end;
+            while (end - begin > leaf_size_) {
+                const uint32_t mid = begin + (end - begin) / 2;
+                const T diff = q[dim_[mid]] - split_[mid];
+                // the median is at least as far as its splitting plane
+                if (diff * diff < worst)
+                    add(indices_[mid]);
+                if (diff < T(0)) {
+                    stack[top++] = Pending{mid + 1, end, diff * diff};
+                    end = mid;
+                } else {
+                    stack[top++] = Pending{begin, mid, diff * diff};
+                    begin = mid + 1;
+                }
+            }
+            for (uint32_t i = begin; i < end; i++)
+                add(indices_[i]);
+            if (params.max_leaves > 0 && ++leaves >= params.max_leaves)
+                break;
+        }
+    }
+    std::sort_heap(best.begin(), best.end());
+    for (size_t i = 0; i < k; i++) {
+        indices[i] = i < best.size() ? best[i].second : invalid_index;
+        if (dist2)
+            dist2[i] = i < best.size() ? best[i].first : inf;
+    }
+    return best.size();
+}
+
+template <typename V> void KdTree<V>::radius_search(const V &q, T radius, std::vector<uint32_t> &out) const {
+    if (indices_.empty())
+        return;
+    const T r2 = radius * radius;
+    auto add = [&](uint32_t index) {
+        const V d = points_[index] - q;
+        if (d.dot(d) <= r2)
+            out.push_back(index);
+    };
+    uint32_t stack[64][2];
+    int top = 0;
+    stack[top][0] = 0;
+    stack[top++][1] = uint32_t(indices_.size());
+    while (top > 0) {
+        --top;
+        uint32_t begin = stack[top][0], end = stack[top][1];
+        while (end - begin > leaf_size_) {
+            const uint32_t mid = begin + (end - begin) / 2;
+            const T diff = q[dim_[mid]] - split_[mid];
+            if (diff * diff <= r2)
+                add(indices_[mid]);
+            // the far child is visited only if the ball crosses the splitting plane
+            if (diff < T(0)) {
+                if (diff * diff <= r2) {
+                    stack[top][0] = mid + 1;
+                    stack[top++][1] = end;
+                }
+                end = mid;
+            } else {
+                if (diff * diff <= r2) {
+                    stack[top][0] = begin;
+                    stack[top++][1] = mid;
+                }
+                begin = mid + 1;
+            }
+        }
+        for (uint32_t i = begin; i < end; i++)
+            add(indices_[i]);
+    }
+}
+
+// first slot of the leaf containing q
+template <typename V> uint32_t KdTree<V>::leaf_of(const V &q) const {
+    uint32_t begin = 0, end = uint32_t(indices_.size());
+    while (end - begin > leaf_size_) {
+        const uint32_t mid = begin + (end - begin) / 2;
+        if (q[dim_[mid]] < split_[mid])
+            end = mid;
+        else
+            begin = mid + 1;
+    }
+    return begin;
+}
+
+// order of the batch queries by leaf: consecutive queries visit the same nodes and points, which are then
+// still in cache
+template <typename V>
+std::vector<uint32_t> KdTree<V>::query_order(const V *queries, size_t count, unsigned threads) const {
+    std::vector<std::pair<uint32_t, uint32_t>> keys(count);
+    parallel_for(count, threads, 1024, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            keys[i] = std::make_pair(leaf_of(queries[i]), uint32_t(i));
+    });
+    std::sort(keys.begin(), keys.end());
+    std::vector<uint32_t> order(count);
+    for (size_t i = 0; i < count; i++)
+        order[i] = keys[i].second;
+    return order;
+}
+
+template <typename V>
+void KdTree<V>::knn_search(const V *queries, size_t count, size_t k, uint32_t *indices, T *dist2,
+                           const KdTreeSearchParams<T> &params, unsigned threads) const {
+    const std::vector<uint32_t> order = query_order(queries, count, threads);
+    parallel_for(count, threads, 256, [&](size_t, size_t begin, size_t end) {
+        for (size_t j = begin; j < end; j++) {
+            const size_t i = order[j];
+            knn_search(queries[i], k, indices + i * k, dist2 ? dist2 + i * k : nullptr, params);
+        }
+    });
+}
+
+template <typename V>
+void KdTree<V>::radius_search(const V *queries, size_t count, T radius, std::vector<uint32_t> &offsets,
+                              std::vector<uint32_t> &indices, unsigned threads) const {
+    const size_t min_chunk = 1024;
+    const std::vector<uint32_t> order = query_order(queries, count, threads);
+    std::vector<std::vector<uint32_t>> found(parallel_chunk_count(count, threads, min_chunk));
+    std::vector<uint32_t> start(count); // start of the neighbors of order[j] in the list of its chunk
+    offsets.assign(count + 1, 0);
+    parallel_for(count, threads, min_chunk, [&](size_t chunk, size_t begin, size_t end) {
+        for (size_t j = begin; j < end; j++) {
+            start[j] = uint32_t(found[chunk].size());
+            radius_search(queries[order[j]], radius, found[chunk]);
+            offsets[order[j] + 1] = uint32_t(found[chunk].size()) - start[j];
+        }
+    });
+    // prefix sum of the neighbor counts in query order, then scatter the lists
+    for (size_t i = 0; i < count; i++)
+        offsets[i + 1] += offsets[i];
+    indices.resize(offsets[count]);
+    parallel_for(count, threads, min_chunk, [&](size_t chunk, size_t begin, size_t end) {
+        for (size_t j = begin; j < end; j++) {
+            const size_t i = order[j];
+            std::copy(found[chunk].begin() + start[j], found[chunk].begin() + start[j] + (offsets[i + 1] - offsets[i]),
+                      indices.begin() + offsets[i]);
+        }
+    });
+}
+
+} // namespace math
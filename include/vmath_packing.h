@@ -0,0 +1,662 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+#pragma once
+
+#include "vmath_types.h"
+#include "vmath_parallel.h"
+#include "vmath_simd_detail.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace math {
+
+// ////////////////////////////////// //
+// smallest three quaternion encoding //
+// ////////////////////////////////// //
+
+// A unit quaternion is stored as the index of its largest component (2 bits) and the other three components, which
+// are in [-1/sqrt(2), 1/sqrt(2)], quantized uniformly (0 is exact). The largest component is made positive (q and -q
+// are the same rotation) and reconstructed from the unit length. With a quantization error of at most d per
+// component, the worst case is q = (1/2, 1/2, 1/2, 1/2), where the error of the largest component is 3d and the
+// rotation error 2 * sqrt(12) * d radians:
+//     PackedQuat32: 10 bits per component, max rotation error 0.28 degrees
+//     PackedQuat48: 15 bits per component, max rotation error 0.0086 degrees
+
+/// smallest three quaternion in 32 bits: index << 30 | a << 20 | b << 10 | c
+struct PackedQuat32 {
+    uint32_t bits;
+};
+
+/// smallest three quaternion in 48 bits: three 16 bit words, each with a 15 bit component in the low bits; the
+/// top bits of the first two words hold the index of the largest component
+struct PackedQuat48 {
+    uint16_t bits[3];
+};
+
+/// encode a unit quaternion (the input is not normalized)
+template <typename T> PackedQuat32 pack_quat32(const Quaternion<T> &q);
+template <typename T> PackedQuat48 pack_quat48(const Quaternion<T> &q);
+/// decode to a unit quaternion (up to rounding) with a positive largest component
+template <typename T> Quaternion<T> unpack_quat(PackedQuat32 p);
+template <typename T> Quaternion<T> unpack_quat(PackedQuat48 p);
+
+// ////////////////////////// //
+// octahedral normal encoding //
+// ////////////////////////// //
+
+// A unit vector is projected on the octahedron |x|+|y|+|z| = 1, whose lower half is folded over the upper one and
+// flattened to the square [-1,1]^2, and the two coordinates are quantized uniformly (Cigolle et al., "A Survey of
+// Efficient Representations for Independent Unit Vectors", 2014). Encoding picks the best of the 4 nearest grid
+// points. Max angular error (measured over 10M random directions):
+//     PackedNormal16: 8 bits per coordinate, 0.64 degrees
+//     PackedNormal24: 12 bits per coordinate, 0.040 degrees
+//     PackedNormal32: 16 bits per coordinate, 0.0025 degrees
+
+/// octahedral normal in 16 bits: u in the low byte, v in the high byte
+struct PackedNormal16 {
+    uint16_t bits;
+};
+
+/// octahedral normal in 24 bits: u in the low 12 bits, v in the high 12 bits (little endian bytes)
+struct PackedNormal24 {
+    uint8_t bits[3];
+};
+
+/// octahedral normal in 32 bits: u in the low 16 bits, v in the high 16 bits
+struct PackedNormal32 {
+    uint32_t bits;
+};
+
+/// encode a unit vector (the input is not normalized)
+template <typename T> PackedNormal16 pack_normal16(const Vector3<T> &n);
+template <typename T> PackedNormal24 pack_normal24(const Vector3<T> &n);
+template <typename T> PackedNormal32 pack_normal32(const Vector3<T> &n);
+/// decode to a unit vector
+template <typename T> Vector3<T> unpack_normal(PackedNormal16 p);
+template <typename T> Vector3<T> unpack_normal(PackedNormal24 p);
+template <typename T> Vector3<T> unpack_normal(PackedNormal32 p);
+
+// ////////////// //
+// batch versions //
+// ////////////// //
+
+/// encode/decode count values, 4 at a time with SSE2 when available; large arrays are split over threads
+/// (0 = hardware threads). The results are identical to the ones of the scalar functions, unless the compiler is
+/// allowed to fuse multiply-adds (e.g. -mfma), which makes them differ in the last bit.
+void pack(const Quatf *src, PackedQuat32 *dst, size_t count, unsigned threads = 0);
+void pack(const Quatf *src, PackedQuat48 *dst, size_t count, unsigned threads = 0);
+void unpack(const PackedQuat32 *src, Quatf *dst, size_t count, unsigned threads = 0);
+void unpack(const PackedQuat48 *src, Quatf *dst, size_t count, unsigned threads = 0);
+void pack(const Vector3f *src, PackedNormal16 *dst, size_t count, unsigned threads = 0);
+void pack(const Vector3f *src, PackedNormal24 *dst, size_t count, unsigned threads = 0);
+void pack(const Vector3f *src, PackedNormal32 *dst, size_t count, unsigned threads = 0);
+void unpack(const PackedNormal16 *src, Vector3f *dst, size_t count, unsigned threads = 0);
+void unpack(const PackedNormal24 *src, Vector3f *dst, size_t count, unsigned threads = 0);
+void unpack(const PackedNormal32 *src, Vector3f *dst, size_t count, unsigned threads = 0);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+// quantization of [-range, range] to [0, max] with round to nearest. The formats use an even max (the largest code
+// is not used), so that 0 is exact: the identity quaternion and the axes decode exactly. Written with the same
+// operations in the scalar and in the SIMD code so that both give the same results
+template <typename T> uint32_t quantize(T v, T range, uint32_t max) {
+    const T scale = T(max) / (range + range);
+    const T t = v * scale + (range * scale + T(0.5));
+    return t <= T(0) ? 0u : std::min(uint32_t(t), max);
+}
+
+template <typename T> T dequantize(uint32_t q, T range, uint32_t max) {
+    return T(q) * ((range + range) / T(max)) - range;
+}
+
+template <typename T> T smallest_three_range() { return T(0.70710678118654752); }
+
+// index of the largest component (w, x, y, z order) and the other three, with the sign that makes it positive
+template <typename T> int smallest_three(const Quaternion<T> &q, T c[3]) {
+    using std::abs;
+    const T v[4] = {q.w, q.x, q.y, q.z};
+    int largest = 0;
+    for (int i = 1; i < 4; i++)
+        if (abs(v[i]) > abs(v[largest]))
+            largest = i;
+    const T sign = v[largest] < T(0) ? T(-1) : T(1);
+    for (int i = 0, k = 0; i < 4; i++)
+        if (i != largest)
+            c[k++] = v[i] * sign;
+    return largest;
+}
+
+template <typename T> Quaternion<T> from_smallest_three(int largest, const T c[3]) {
+    using std::sqrt;
+    const T l = sqrt(std::max(T(0), T(1) - c[0] * c[0] - c[1] * c[1] - c[2] * c[2]));
+    T v[4];
+    for (int i = 0, k = 0; i < 4; i++)
+        v[i] = i == largest ? l : c[k++];
+    return Quaternion<T>(v[0], v[1], v[2], v[3]);
+}
+
+// octahedral projection of n to [-1,1]^2
+template <typename T> void oct_project(const Vector3<T> &n, T &u, T &v) {
+    using std::abs;
+    const T inv = T(1) / (abs(n.x) + abs(n.y) + abs(n.z));
+    u = n.x * inv;
+    v = n.y * inv;
+    if (n.z < T(0)) {
+        const T fu = (T(1) - abs(v)) * (u >= T(0) ? T(1) : T(-1));
+        const T fv = (T(1) - abs(u)) * (v >= T(0) ? T(1) : T(-1));
+        u = fu;
+        v = fv;
+    }
+}
+
+template <typename T> Vector3<T> oct_unproject(T u, T v) {
+    using std::abs;
+    using std::sqrt;
+    T x = u, y = v;
+    const T z = T(1) - abs(u) - abs(v);
+    const T t = std::max(T(0) - z, T(0));
+    x += x >= T(0) ? -t : t;
+    y += y >= T(0) ? -t : t;
+    const T inv = T(1) / sqrt(x * x + y * y + z * z);
+    return Vector3<T>(x * inv, y * inv, z * inv);
+}
+
+// quantized octahedral coordinates: the best of the 4 grid points around the projection
+template <typename T> void oct_encode(const Vector3<T> &n, uint32_t max, uint32_t &qu, uint32_t &qv) {
+    using std::floor;
+    T u, v;
+    oct_project(n, u, v);
+    const T scale = T(max) * T(0.5);
+    const uint32_t u0 = std::min(uint32_t(std::max(T(0), floor(u * scale + scale))), max - 1);
+    const uint32_t v0 = std::min(uint32_t(std::max(T(0), floor(v * scale + scale))), max - 1);
+    // distance rather than dot product: for the fine grids 1 - dot is below the float precision
+    T best = T(5);
+    for (uint32_t du = 0; du < 2; du++)
+        for (uint32_t dv = 0; dv < 2; dv++) {
+            const Vector3<T> d = oct_unproject(dequantize(u0 + du, T(1), max), dequantize(v0 + dv, T(1), max));
+            const T dist = (d.x - n.x) * (d.x - n.x) + (d.y - n.y) * (d.y - n.y) + (d.z - n.z) * (d.z - n.z);
+            if (dist < best) {
+                best = dist;
+                qu = u0 + du;
+                qv = v0 + dv;
+            }
+        }
+}
+
+template <typename T> Vector3<T> oct_decode(uint32_t qu, uint32_t qv, uint32_t max) {
+    return oct_unproject(dequantize(qu, T(1), max), dequantize(qv, T(1), max));
+}
+
+#if defined(VMATH_SSE2)
+inline __m128 select_sse2(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// quantize() of 4 values
+inline __m128i quantize_sse2(__m128 v, float range, uint32_t max) {
+    const float scale = float(max) / (range + range);
+    const __m128 t = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(scale)), _mm_set1_ps(range * scale + 0.5f));
+    const __m128i q = _mm_cvttps_epi32(_mm_max_ps(t, _mm_setzero_ps()));
+    const __m128i m = _mm_set1_epi32(int(max));
+    const __m128i over = _mm_cmpgt_epi32(q, m);
+    return _mm_or_si128(_mm_and_si128(over, m), _mm_andnot_si128(over, q));
+}
+
+// smallest_three() of 4 quaternions: index of the largest component and the other three with its sign removed
+inline __m128i smallest_three_sse2(const Quatf *src, __m128 c[3]) {
+    const float *in = &src->w;
+    __m128 w = _mm_loadu_ps(in), x = _mm_loadu_ps(in + 4), y = _mm_loadu_ps(in + 8), z = _mm_loadu_ps(in + 12);
+    _MM_TRANSPOSE4_PS(w, x, y, z);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    // the first largest one, as in the scalar loop
+    __m128 largest = w, m = _mm_and_ps(w, abs_mask);
+    __m128i index = _mm_setzero_si128();
+    const __m128 v[3] = {x, y, z};
+    for (int k = 0; k < 3; k++) {
+        const __m128 gt = _mm_cmpgt_ps(_mm_and_ps(v[k], abs_mask), m);
+        m = select_sse2(gt, _mm_and_ps(v[k], abs_mask), m);
+        largest = select_sse2(gt, v[k], largest);
+        index = _mm_or_si128(_mm_and_si128(_mm_castps_si128(gt), _mm_set1_epi32(k + 1)),
+                             _mm_andnot_si128(_mm_castps_si128(gt), index));
+    }
+    const __m128 sign = _mm_and_ps(_mm_cmplt_ps(largest, _mm_setzero_ps()),
+                                   _mm_castsi128_ps(_mm_set1_epi32(int(0x80000000u))));
+    // component k is v[k] before the largest one and v[k + 1] after it
+    const __m128 after0 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_setzero_si128()));
+    const __m128 after1 = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set1_epi32(2), index));
+    const __m128 after2 = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set1_epi32(3), index));
+    c[0] = _mm_xor_ps(select_sse2(after0, x, w), sign);
+    c[1] = _mm_xor_ps(select_sse2(after1, y, x), sign);
+    c[2] = _mm_xor_ps(select_sse2(after2, z, y), sign);
+    return index;
+}
+
+// 4 quaternions from their index and three quantized components (one lane each), stored to dst
+inline void unpack_quat_sse2(__m128i largest, __m128i qa, __m128i qb, __m128i qc, uint32_t max, Quatf *dst) {
+    const float range = smallest_three_range<float>();
+    const __m128 scale = _mm_set1_ps((range + range) / float(max));
+    const __m128 offset = _mm_set1_ps(range);
+    const __m128 a = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(qa), scale), offset);
+    const __m128 b = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(qb), scale), offset);
+    const __m128 c = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(qc), scale), offset);
+    const __m128 l = _mm_sqrt_ps(_mm_max_ps(
+        _mm_setzero_ps(),
+        _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.f), _mm_mul_ps(a, a)), _mm_mul_ps(b, b)), _mm_mul_ps(c, c))));
+    // component k is a/b/c before the largest one, l at its index, and the previous stored one after it
+    const __m128 is0 = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_setzero_si128()));
+    const __m128 is1 = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(1)));
+    const __m128 is2 = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(2)));
+    const __m128 is3 = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(3)));
+    __m128 w = select_sse2(is0, l, a);
+    __m128 x = select_sse2(is0, a, select_sse2(is1, l, b));
+    __m128 y = select_sse2(is3, c, select_sse2(is2, l, b));
+    __m128 z = select_sse2(is3, l, c);
+    _MM_TRANSPOSE4_PS(w, x, y, z);
+    float *out = &dst->w;
+    _mm_storeu_ps(out, w);
+    _mm_storeu_ps(out + 4, x);
+    _mm_storeu_ps(out + 8, y);
+    _mm_storeu_ps(out + 12, z);
+}
+
+// oct_decode() of 4 quantized coordinates
+inline void oct_decode_sse2(__m128i qu, __m128i qv, uint32_t max, __m128 &x, __m128 &y, __m128 &z) {
+    const __m128 scale = _mm_set1_ps((1.f + 1.f) / float(max));
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(int(0x80000000u)));
+    x = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(qu), scale), one);
+    y = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(qv), scale), one);
+    z = _mm_sub_ps(_mm_sub_ps(one, _mm_and_ps(x, abs_mask)), _mm_and_ps(y, abs_mask));
+    const __m128 t = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), z), _mm_setzero_ps());
+    // x += x >= 0 ? -t : t, as in the scalar code (t >= 0, so flipping its sign bit negates it)
+    x = _mm_add_ps(x, _mm_xor_ps(t, _mm_andnot_ps(_mm_cmplt_ps(x, _mm_setzero_ps()), sign_mask)));
+    y = _mm_add_ps(y, _mm_xor_ps(t, _mm_andnot_ps(_mm_cmplt_ps(y, _mm_setzero_ps()), sign_mask)));
+    const __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                                              _mm_mul_ps(z, z))));
+    x = _mm_mul_ps(x, inv);
+    y = _mm_mul_ps(y, inv);
+    z = _mm_mul_ps(z, inv);
+}
+
+// oct_encode() of 4 normals
+inline void oct_encode_sse2(const Vector3f *src, uint32_t max, __m128i &qu, __m128i &qv) {
+    __m128 x, y, z;
+    load_vector3_sse2(src, x, y, z);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(int(0x80000000u)));
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 l1 = _mm_add_ps(_mm_add_ps(_mm_and_ps(x, abs_mask), _mm_and_ps(y, abs_mask)), _mm_and_ps(z, abs_mask));
+    const __m128 inv = _mm_div_ps(_mm_set1_ps(1.f), l1);
+    __m128 u = _mm_mul_ps(x, inv), v = _mm_mul_ps(y, inv);
+    // lower half: folded, (1 - |v|) * (u >= 0 ? 1 : -1) and the same for v
+    const __m128 fu = _mm_xor_ps(_mm_sub_ps(_mm_set1_ps(1.f), _mm_and_ps(v, abs_mask)),
+                                 _mm_and_ps(_mm_cmplt_ps(u, zero), sign_mask));
+    const __m128 fv = _mm_xor_ps(_mm_sub_ps(_mm_set1_ps(1.f), _mm_and_ps(u, abs_mask)),
+                                 _mm_and_ps(_mm_cmplt_ps(v, zero), sign_mask));
+    const __m128 lower = _mm_cmplt_ps(z, zero);
+    u = select_sse2(lower, fu, u);
+    v = select_sse2(lower, fv, v);
+    // the 4 grid points around the projection
+    const __m128 scale = _mm_set1_ps(float(max) * 0.5f);
+    const __m128i top = _mm_set1_epi32(int(max - 1));
+    auto cell = [&](__m128 t) {
+        const __m128i q = _mm_cvttps_epi32(_mm_max_ps(_mm_add_ps(_mm_mul_ps(t, scale), scale), zero));
+        const __m128i over = _mm_cmpgt_epi32(q, top);
+        return _mm_or_si128(_mm_and_si128(over, top), _mm_andnot_si128(over, q));
+    };
+    const __m128i u0 = cell(u), v0 = cell(v);
+    __m128 best = _mm_set1_ps(5.f);
+    for (int du = 0; du < 2; du++)
+        for (int dv = 0; dv < 2; dv++) {
+            const __m128i cu = _mm_add_epi32(u0, _mm_set1_epi32(du)), cv = _mm_add_epi32(v0, _mm_set1_epi32(dv));
+            __m128 dx, dy, dz;
+            oct_decode_sse2(cu, cv, max, dx, dy, dz);
+            dx = _mm_sub_ps(dx, x);
+            dy = _mm_sub_ps(dy, y);
+            dz = _mm_sub_ps(dz, z);
+            const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            const __m128 closer = _mm_cmplt_ps(dist, best);
+            const __m128i closer_i = _mm_castps_si128(closer);
+            best = select_sse2(closer, dist, best);
+            if (du == 0 && dv == 0) {
+                qu = cu;
+                qv = cv;
+            } else {
+                qu = _mm_or_si128(_mm_and_si128(closer_i, cu), _mm_andnot_si128(closer_i, qu));
+                qv = _mm_or_si128(_mm_and_si128(closer_i, cv), _mm_andnot_si128(closer_i, qv));
+            }
+        }
+}
+#endif
+
+inline void unpack_range(const PackedQuat32 *src, Quatf *dst, size_t count) {
+    size_t i = 0;
+#if defined(VMATH_SSE2)
+    const __m128i mask = _mm_set1_epi32(0x3ff);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&src[i].bits));
+        unpack_quat_sse2(_mm_srli_epi32(p, 30), _mm_and_si128(_mm_srli_epi32(p, 20), mask),
+                         _mm_and_si128(_mm_srli_epi32(p, 10), mask), _mm_and_si128(p, mask), 0x3fe, dst + i);
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = unpack_quat<float>(src[i]);
+}
+
+inline void unpack_range(const PackedQuat48 *src, Quatf *dst, size_t count) {
+    size_t i = 0;
+#if defined(VMATH_SSE2)
+    // the 6 byte records are gathered with scalar loads, the rest is done 4 at a time
+    auto lanes = [&](int word) {
+        return _mm_set_epi32(src[i + 3].bits[word], src[i + 2].bits[word], src[i + 1].bits[word], src[i].bits[word]);
+    };
+    const __m128i mask = _mm_set1_epi32(0x7fff);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i w0 = lanes(0), w1 = lanes(1), w2 = lanes(2);
+        const __m128i largest = _mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(w0, 15), 1), _mm_srli_epi32(w1, 15));
+        unpack_quat_sse2(largest, _mm_and_si128(w0, mask), _mm_and_si128(w1, mask), _mm_and_si128(w2, mask), 0x7ffe,
+                         dst + i);
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = unpack_quat<float>(src[i]);
+}
+
+inline void unpack_range(const PackedNormal16 *src, Vector3f *dst, size_t count) {
+    size_t i = 0;
+#if defined(VMATH_SSE2)
+    const __m128i mask = _mm_set1_epi32(0xff);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i p = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(&src[i].bits)),
+                                             _mm_setzero_si128());
+        __m128 x, y, z;
+        oct_decode_sse2(_mm_and_si128(p, mask), _mm_srli_epi32(p, 8), 0xfe, x, y, z);
+        store_vector3_sse2(x, y, z, dst + i);
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = unpack_normal<float>(src[i]);
+}
+
+inline void unpack_range(const PackedNormal24 *src, Vector3f *dst, size_t count) {
+    size_t i = 0;
+#if defined(VMATH_SSE2)
+    const __m128i mask = _mm_set1_epi32(0xfff);
+    for (; i + 4 <= count; i += 4) {
+        // the 3 byte records are assembled with scalar loads
+        auto word = [&](size_t k) {
+            const uint8_t *b = src[i + k].bits;
+            return int(uint32_t(b[0]) | uint32_t(b[1]) << 8 | uint32_t(b[2]) << 16);
+        };
+        const __m128i p = _mm_set_epi32(word(3), word(2), word(1), word(0));
+        __m128 x, y, z;
+        oct_decode_sse2(_mm_and_si128(p, mask), _mm_srli_epi32(p, 12), 0xffe, x, y, z);
+        store_vector3_sse2(x, y, z, dst + i);
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = unpack_normal<float>(src[i]);
+}
+
+inline void unpack_range(const PackedNormal32 *src, Vector3f *dst, size_t count) {
+    size_t i = 0;
+#if defined(VMATH_SSE2)
+    const __m128i mask = _mm_set1_epi32(0xffff);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&src[i].bits));
+        __m128 x, y, z;
+        oct_decode_sse2(_mm_and_si128(p, mask), _mm_srli_epi32(p, 16), 0xfffe, x, y, z);
+        store_vector3_sse2(x, y, z, dst + i);
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = unpack_normal<float>(src[i]);
+}
+
+inline void pack_range(const Quatf *src, PackedQuat32 *dst, size_t count) {
+    size_t i = 0;
+#if defined(VMATH_SSE2)
+    const float range = smallest_three_range<float>();
+    for (; i + 4 <= count; i += 4) {
+        __m128 c[3];
+        const __m128i largest = smallest_three_sse2(src + i, c);
+        const __m128i p = _mm_or_si128(
+            _mm_or_si128(_mm_slli_epi32(largest, 30), _mm_slli_epi32(quantize_sse2(c[0], range, 0x3fe), 20)),
+            _mm_or_si128(_mm_slli_epi32(quantize_sse2(c[1], range, 0x3fe), 10), quantize_sse2(c[2], range, 0x3fe)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&dst[i].bits), p);
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = pack_quat32(src[i]);
+}
+
+inline void pack_range(const Quatf *src, PackedQuat48 *dst, size_t count) {
+    size_t i = 0;
+#if defined(VMATH_SSE2)
+    const float range = smallest_three_range<float>();
+    for (; i + 4 <= count; i += 4) {
+        __m128 c[3];
+        const __m128i largest = smallest_three_sse2(src + i, c);
+        uint32_t w[3][4];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(w[0]), _mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(largest, 1), 15),
+                                                                          quantize_sse2(c[0], range, 0x7ffe)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(w[1]),
+                         _mm_or_si128(_mm_slli_epi32(_mm_and_si128(largest, _mm_set1_epi32(1)), 15),
+                                      quantize_sse2(c[1], range, 0x7ffe)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(w[2]), quantize_sse2(c[2], range, 0x7ffe));
+        for (int k = 0; k < 4; k++)
+            for (int j = 0; j < 3; j++)
+                dst[i + k].bits[j] = uint16_t(w[j][k]);
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = pack_quat48(src[i]);
+}
+
+inline void pack_range(const Vector3f *src, PackedNormal16 *dst, size_t count) {
+    size_t i = 0;
+#if defined(VMATH_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128i u, v;
+        oct_encode_sse2(src + i, 0xfe, u, v);
+        const __m128i p = _mm_or_si128(u, _mm_slli_epi32(v, 8));
+        // sign extend, so that the signed saturation of packs keeps the 16 bit values
+        const __m128i p16 = _mm_srai_epi32(_mm_slli_epi32(p, 16), 16);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(&dst[i].bits), _mm_packs_epi32(p16, p16));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = pack_normal16(src[i]);
+}
+
+inline void pack_range(const Vector3f *src, PackedNormal24 *dst, size_t count) {
+    size_t i = 0;
+#if defined(VMATH_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128i u, v;
+        oct_encode_sse2(src + i, 0xffe, u, v);
+        uint32_t w[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(w), _mm_or_si128(u, _mm_slli_epi32(v, 12)));
+        for (int k = 0; k < 4; k++) {
+            dst[i + k].bits[0] = uint8_t(w[k]);
+            dst[i + k].bits[1] = uint8_t(w[k] >> 8);
+            dst[i + k].bits[2] = uint8_t(w[k] >> 16);
+        }
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = pack_normal24(src[i]);
+}
+
+inline void pack_range(const Vector3f *src, PackedNormal32 *dst, size_t count) {
+    size_t i = 0;
+#if defined(VMATH_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128i u, v;
+        oct_encode_sse2(src + i, 0xfffe, u, v);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&dst[i].bits), _mm_or_si128(u, _mm_slli_epi32(v, 16)));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = pack_normal32(src[i]);
+}
+
+template <typename S, typename D> void pack_parallel(const S *src, D *dst, size_t count, unsigned threads) {
+    parallel_for(count, threads, size_t(1) << 16,
+                 [&](size_t, size_t begin, size_t end) { pack_range(src + begin, dst + begin, end - begin); });
+}
+
+template <typename S, typename D> void unpack_parallel(const S *src, D *dst, size_t count, unsigned threads) {
+    parallel_for(count, threads, size_t(1) << 16,
+                 [&](size_t, size_t begin, size_t end) { unpack_range(src + begin, dst + begin, end - begin); });
+}
+
+} // namespace detail
+
+template <typename T> PackedQuat32 pack_quat32(const Quaternion<T> &q) {
+    T c[3];
+    const int largest = detail::smallest_three(q, c);
+    const T range = detail::smallest_three_range<T>();
+    PackedQuat32 p;
+    p.bits = uint32_t(largest) << 30 | detail::quantize(c[0], range, 0x3fe) << 20 |
+             detail::quantize(c[1], range, 0x3fe) << 10 | detail::quantize(c[2], range, 0x3fe);
+    return p;
+}
+
+template <typename T> PackedQuat48 pack_quat48(const Quaternion<T> &q) {
+    T c[3];
+    const int largest = detail::smallest_three(q, c);
+    const T range = detail::smallest_three_range<T>();
+    PackedQuat48 p;
+    p.bits[0] = uint16_t((largest >> 1) << 15 | detail::quantize(c[0], range, 0x7ffe));
+    p.bits[1] = uint16_t((largest & 1) << 15 | detail::quantize(c[1], range, 0x7ffe));
+    p.bits[2] = uint16_t(detail::quantize(c[2], range, 0x7ffe));
+    return p;
+}
+
+template <typename T> Quaternion<T> unpack_quat(PackedQuat32 p) {
+    const T range = detail::smallest_three_range<T>();
+    const T c[3] = {detail::dequantize((p.bits >> 20) & 0x3ff, range, 0x3fe),
+                    detail::dequantize((p.bits >> 10) & 0x3ff, range, 0x3fe),
+                    detail::dequantize(p.bits & 0x3ff, range, 0x3fe)};
+    return detail::from_smallest_three(int(p.bits >> 30), c);
+}
+
+template <typename T> Quaternion<T> unpack_quat(PackedQuat48 p) {
+    const T range = detail::smallest_three_range<T>();
+    const T c[3] = {detail::dequantize(p.bits[0] & 0x7fffu, range, 0x7ffe),
+                    detail::dequantize(p.bits[1] & 0x7fffu, range, 0x7ffe),
+                    detail::dequantize(p.bits[2] & 0x7fffu, range, 0x7ffe)};
+    return detail::from_smallest_three((p.bits[0] >> 15) << 1 | p.bits[1] >> 15, c);
+}
+
+template <typename T> PackedNormal16 pack_normal16(const Vector3<T> &n) {
+    uint32_t u, v;
+    detail::oct_encode(n, 0xfe, u, v);
+    PackedNormal16 p;
+    p.bits = uint16_t(u | v << 8);
+    return p;
+}
+
+template <typename T> PackedNormal24 pack_normal24(const Vector3<T> &n) {
+    uint32_t u, v;
+    detail::oct_encode(n, 0xffe, u, v);
+    const uint32_t w = u | v << 12;
+    PackedNormal24 p;
+    p.bits[0] = uint8_t(w);
+    p.bits[1] = uint8_t(w >> 8);
+    p.bits[2] = uint8_t(w >> 16);
+    return p;
+}
+
+template <typename T> PackedNormal32 pack_normal32(const Vector3<T> &n) {
+    uint32_t u, v;
+    detail::oct_encode(n, 0xfffe, u, v);
+    PackedNormal32 p;
+    p.bits = u | v << 16;
+    return p;
+}
+
+template <typename T> Vector3<T> unpack_normal(PackedNormal16 p) {
+    return detail::oct_decode<T>(p.bits & 0xffu, uint32_t(p.bits) >> 8, 0xfe);
+}
+
+template <typename T> Vector3<T> unpack_normal(PackedNormal24 p) {
+    const uint32_t w = uint32_t(p.bits[0]) | uint32_t(p.bits[1]) << 8 | uint32_t(p.bits[2]) << 16;
+    return detail::oct_decode<T>(w & 0xfff, w >> 12, 0xffe);
+}
+
+template <typename T> Vector3<T> unpack_normal(PackedNormal32 p) {
+    return detail::oct_decode<T>(p.bits & 0xffff, p.bits >> 16, 0xfffe);
+}
+
+inline void pack(const Quatf *src, PackedQuat32 *dst, size_t count, unsigned threads) {
+    detail::pack_parallel(src, dst, count, threads);
+}
+
+inline void pack(const Quatf *src, PackedQuat48 *dst, size_t count, unsigned threads) {
+    detail::pack_parallel(src, dst, count, threads);
+}
+
+inline void unpack(const PackedQuat32 *src, Quatf *dst, size_t count, unsigned threads) {
+    detail::unpack_parallel(src, dst, count, threads);
+}
+
+inline void unpack(const PackedQuat48 *src, Quatf *dst, size_t count, unsigned threads) {
+    detail::unpack_parallel(src, dst, count, threads);
+}
+
+inline void pack(const Vector3f *src, PackedNormal16 *dst, size_t count, unsigned threads) {
+    detail::pack_parallel(src, dst, count, threads);
+}
+
+inline void pack(const Vector3f *src, PackedNormal24 *dst, size_t count, unsigned threads) {
+    detail::pack_parallel(src, dst, count, threads);
+}
+
+inline void pack(const Vector3f *src, PackedNormal32 *dst, size_t count, unsigned threads) {
+    detail::pack_parallel(src, dst, count, threads);
+}
+
+inline void unpack(const PackedNormal16 *src, Vector3f *dst, size_t count, unsigned threads) {
+    detail::unpack_parallel(src, dst, count, threads);
+}
+
+inline void unpack(const PackedNormal24 *src, Vector3f *dst, size_t count, unsigned threads) {
+    detail::unpack_parallel(src, dst, count, threads);
+}
+
+inline void unpack(const PackedNormal32 *src, Vector3f *dst, size_t count, unsigned threads) {
+    detail::unpack_parallel(src, dst, count, threads);
+}
+
+} // namespace math
@@ -0,0 +1,80 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace math {
+
+/// number of threads used by the parallel batch functions when 0 is requested (hardware concurrency)
+inline unsigned default_thread_count() {
+    const unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+/// number of chunks parallel_for() splits count items into
+/// @param threads number of threads (0 = default_thread_count())
+/// @param min_chunk minimum number of items per chunk; small inputs run on the calling thread only
+inline size_t parallel_chunk_count(size_t count, unsigned threads, size_t min_chunk) {
+    if (threads == 0)
+        threads = default_thread_count();
+    const size_t max_chunks = std::max<size_t>(1, count / std::max<size_t>(1, min_chunk));
+    return std::min<size_t>(threads, max_chunks);
+}
+
+/// split [0, count) in parallel_chunk_count() contiguous chunks and call f(chunk, begin, end) for each one,
+/// one chunk per thread. The calling thread runs the first chunk; the call returns when all chunks are done.
+/// If f throws, the first exception is rethrown on the calling thread once all the chunks are done.
+template <typename F> void parallel_for(size_t count, unsigned threads, size_t min_chunk, F f) {
+    const size_t chunks = parallel_chunk_count(count, threads, min_chunk);
+    if (chunks <= 1) {
+        f(size_t(0), size_t(0), count);
+        return;
+    }
+    std::vector<std::exception_ptr> errors(chunks);
+    auto run = [&f, &errors, count, chunks](size_t c) {
+        try {
+            f(c, count * c / chunks, count * (c + 1) / chunks);
+        } catch (...) {
+            errors[c] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (size_t c = 1; c < chunks; c++)
+        workers.emplace_back(run, c);
+    run(0);
+    for (auto &w : workers)
+        w.join();
+    for (const auto &e : errors)
+        if (e)
+            std::rethrow_exception(e);
+}
+
+} // namespace math
@@ -0,0 +1,271 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+#pragma once
+
+#include "vmath_parallel.h"
+#include "vmath_simd_detail.h"
+#include "vmath_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace math {
+
+/// outcode bits of a vertex in clip space (x, y, z, w), OpenGL convention: the visible volume is
+/// -w <= x, y <= w and -w <= z <= w (0 <= z <= w with Viewport::depth_zero_to_one)
+enum ClipBits : uint8_t {
+    clip_left = 1,    ///< x < -w
+    clip_right = 2,   ///< x > w
+    clip_bottom = 4,  ///< y < -w
+    clip_top = 8,     ///< y > w
+    clip_near = 16,   ///< z < -w (z < 0 with depth_zero_to_one)
+    clip_far = 32,    ///< z > w
+};
+
+/// viewport transform from normalized device coordinates to the screen: x in [-1, 1] maps to [x, x + width],
+/// y to [y, y + height] (a negative height flips y, e.g. {0, h, w, -h} puts the row 0 at the top) and the depth
+/// to [min_depth, max_depth]
+struct Viewport {
+    float x = 0.f;
+    float y = 0.f;
+    float width = 1.f;
+    float height = 1.f;
+    float min_depth = 0.f;
+    float max_depth = 1.f;
+    bool depth_zero_to_one = false; ///< clip space depth in [0, w] (Direct3D, Vulkan) instead of [-w, w]
+
+    Viewport() = default;
+    Viewport(float x_, float y_, float width_, float height_)
+    : x(x_), y(y_), width(width_), height(height_) {}
+};
+
+/// screen space output of project_vertices(), one array per component (structure of arrays). Any of the pointers
+/// can be null to skip that output.
+struct ScreenVertices {
+    float *x = nullptr;          ///< screen x
+    float *y = nullptr;          ///< screen y
+    float *depth = nullptr;      ///< depth in [min_depth, max_depth] for the visible vertices
+    float *inv_w = nullptr;      ///< 1 / w, for perspective correct interpolation
+    uint8_t *outcode = nullptr;  ///< ClipBits of the vertex; 0 if it is in the visible volume
+};
+
+/// combined outcodes of a batch of vertices
+struct ClipSummary {
+    uint8_t any = 0;   ///< or of the outcodes: 0 if all the vertices are visible (no clipping needed)
+    uint8_t all = 0;   ///< and of the outcodes: non zero if all the vertices are outside the same plane (culled)
+};
+
+/// fused vertex processing: clip = mvp * (v, 1), outcodes of the clip space position, perspective divide and
+/// viewport transform, written to the screen space arrays, in a single pass over the vertices (4 at a time with
+/// SSE2). The screen coordinates of the vertices with a non zero outcode are computed all the same, but they are
+/// meaningless (or infinite) for w <= 0: clip the primitives using them first.
+/// Large arrays are split over threads (0 = hardware threads).
+ClipSummary project_vertices(const Matrix4f &mvp, const Vector3f *vertices, size_t count, const Viewport &viewport,
+                             const ScreenVertices &out, unsigned threads = 0);
+/// same as above, for homogeneous vertices (clip = mvp * v)
+ClipSummary project_vertices(const Matrix4f &mvp, const Vector4f *vertices, size_t count, const Viewport &viewport,
+                             const ScreenVertices &out, unsigned threads = 0);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+// viewport as scale and offset of the normalized device coordinates
+struct ViewportMap {
+    float sx, ox, sy, oy, sz, oz;
+    bool zero_to_one;
+
+    explicit ViewportMap(const Viewport &v) {
+        sx = 0.5f * v.width;
+        ox = v.x + sx;
+        sy = 0.5f * v.height;
+        oy = v.y + sy;
+        zero_to_one = v.depth_zero_to_one;
+        sz = zero_to_one ? v.max_depth - v.min_depth : 0.5f * (v.max_depth - v.min_depth);
+        oz = zero_to_one ? v.min_depth : v.min_depth + sz;
+    }
+};
+
+inline uint8_t project_one(const Matrix4f &m, float x, float y, float z, float w, const ViewportMap &v,
+                           const ScreenVertices &out, size_t i) {
+    const float *d = m.data;
+    const float cx = d[0] * x + d[4] * y + d[8] * z + d[12] * w;
+    const float cy = d[1] * x + d[5] * y + d[9] * z + d[13] * w;
+    const float cz = d[2] * x + d[6] * y + d[10] * z + d[14] * w;
+    const float cw = d[3] * x + d[7] * y + d[11] * z + d[15] * w;
+    const float near_limit = v.zero_to_one ? 0.f : -cw;
+    const uint8_t code = uint8_t((cx < -cw ? clip_left : 0) | (cx > cw ? clip_right : 0) |
+                                 (cy < -cw ? clip_bottom : 0) | (cy > cw ? clip_top : 0) |
+                                 (cz < near_limit ? clip_near : 0) | (cz > cw ? clip_far : 0));
+    const float iw = 1.f / cw;
+    if (out.x)
+        out.x[i] = cx * iw * v.sx + v.ox;
+    if (out.y)
+        out.y[i] = cy * iw * v.sy + v.oy;
+    if (out.depth)
+        out.depth[i] = cz * iw * v.sz + v.oz;
+    if (out.inv_w)
+        out.inv_w[i] = iw;
+    if (out.outcode)
+        out.outcode[i] = code;
+    return code;
+}
+
+#if defined(VMATH_SSE2)
+// 4 vertices in SoA form
+inline __m128i project_sse2(const Matrix4f &m, __m128 x, __m128 y, __m128 z, __m128 w, const ViewportMap &v,
+                            const ScreenVertices &out, size_t i) {
+    const float *d = m.data;
+    // clip = column 0 * x + column 1 * y + column 2 * z + column 3 * w
+    __m128 c[4];
+    for (int r = 0; r < 4; r++) {
+        c[r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(d[r]), x), _mm_mul_ps(_mm_set1_ps(d[4 + r]), y)),
+                          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(d[8 + r]), z), _mm_mul_ps(_mm_set1_ps(d[12 + r]), w)));
+    }
+    const __m128 cw = c[3];
+    const __m128 neg_w = _mm_sub_ps(_mm_setzero_ps(), cw);
+    const __m128 near_limit = v.zero_to_one ? _mm_setzero_ps() : neg_w;
+    auto bit = [](__m128 mask, int b) { return _mm_and_si128(_mm_castps_si128(mask), _mm_set1_epi32(b)); };
+    const __m128i code = _mm_or_si128(
+        _mm_or_si128(_mm_or_si128(bit(_mm_cmplt_ps(c[0], neg_w), clip_left), bit(_mm_cmpgt_ps(c[0], cw), clip_right)),
+                     _mm_or_si128(bit(_mm_cmplt_ps(c[1], neg_w), clip_bottom), bit(_mm_cmpgt_ps(c[1], cw), clip_top))),
+        _mm_or_si128(bit(_mm_cmplt_ps(c[2], near_limit), clip_near), bit(_mm_cmpgt_ps(c[2], cw), clip_far)));
+    const __m128 iw = _mm_div_ps(_mm_set1_ps(1.f), cw);
+    if (out.x)
+        _mm_storeu_ps(out.x + i, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(c[0], iw), _mm_set1_ps(v.sx)), _mm_set1_ps(v.ox)));
+    if (out.y)
+        _mm_storeu_ps(out.y + i, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(c[1], iw), _mm_set1_ps(v.sy)), _mm_set1_ps(v.oy)));
+    if (out.depth)
+        _mm_storeu_ps(out.depth + i,
+                      _mm_add_ps(_mm_mul_ps(_mm_mul_ps(c[2], iw), _mm_set1_ps(v.sz)), _mm_set1_ps(v.oz)));
+    if (out.inv_w)
+        _mm_storeu_ps(out.inv_w + i, iw);
+    if (out.outcode) {
+        const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(code, code), code);
+        const int packed = _mm_cvtsi128_si32(bytes);
+        std::memcpy(out.outcode + i, &packed, 4);
+    }
+    return code;
+}
+#endif
+
+template <typename V>
+ClipSummary project_range(const Matrix4f &m, const V *vertices, size_t begin, size_t end, const ViewportMap &v,
+                          const ScreenVertices &out);
+
+template <>
+inline ClipSummary project_range(const Matrix4f &m, const Vector3f *vertices, size_t begin, size_t end,
+                                 const ViewportMap &v, const ScreenVertices &out) {
+    uint8_t any = 0, all = 0xff;
+    size_t i = begin;
+#if defined(VMATH_SSE2)
+    __m128i any4 = _mm_setzero_si128(), all4 = _mm_set1_epi32(0xff);
+    const __m128 one = _mm_set1_ps(1.f);
+    for (; i + 4 <= end; i += 4) {
+        __m128 x, y, z;
+        load_vector3_sse2(vertices + i, x, y, z);
+        const __m128i code = project_sse2(m, x, y, z, one, v, out, i);
+        any4 = _mm_or_si128(any4, code);
+        all4 = _mm_and_si128(all4, code);
+    }
+    int lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), _mm_or_si128(any4, _mm_srli_si128(any4, 8)));
+    any = uint8_t(lanes[0] | lanes[1]);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), _mm_and_si128(all4, _mm_srli_si128(all4, 8)));
+    all = uint8_t(lanes[0] & lanes[1]);
+#endif
+    for (; i < end; i++) {
+        const uint8_t code = project_one(m, vertices[i].x, vertices[i].y, vertices[i].z, 1.f, v, out, i);
+        any |= code;
+        all &= code;
+    }
+    return ClipSummary{any, all};
+}
+
+template <>
+inline ClipSummary project_range(const Matrix4f &m, const Vector4f *vertices, size_t begin, size_t end,
+                                 const ViewportMap &v, const ScreenVertices &out) {
+    uint8_t any = 0, all = 0xff;
+    size_t i = begin;
+#if defined(VMATH_SSE2)
+    __m128i any4 = _mm_setzero_si128(), all4 = _mm_set1_epi32(0xff);
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(&vertices[i].x), y = _mm_loadu_ps(&vertices[i + 1].x);
+        __m128 z = _mm_loadu_ps(&vertices[i + 2].x), w = _mm_loadu_ps(&vertices[i + 3].x);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        const __m128i code = project_sse2(m, x, y, z, w, v, out, i);
+        any4 = _mm_or_si128(any4, code);
+        all4 = _mm_and_si128(all4, code);
+    }
+    int lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), _mm_or_si128(any4, _mm_srli_si128(any4, 8)));
+    any = uint8_t(lanes[0] | lanes[1]);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), _mm_and_si128(all4, _mm_srli_si128(all4, 8)));
+    all = uint8_t(lanes[0] & lanes[1]);
+#endif
+    for (; i < end; i++) {
+        const Vector4f &p = vertices[i];
+        const uint8_t code = project_one(m, p.x, p.y, p.z, p.w, v, out, i);
+        any |= code;
+        all &= code;
+    }
+    return ClipSummary{any, all};
+}
+
+template <typename V>
+ClipSummary project_parallel(const Matrix4f &mvp, const V *vertices, size_t count, const Viewport &viewport,
+                             const ScreenVertices &out, unsigned threads) {
+    static_assert(sizeof(V) == sizeof(float) * (sizeof(V) / sizeof(float)), "packed vertices expected");
+    const ViewportMap v(viewport);
+    const size_t min_chunk = size_t(1) << 14;
+    std::vector<ClipSummary> partial(parallel_chunk_count(count, threads, min_chunk));
+    parallel_for(count, threads, min_chunk, [&](size_t chunk, size_t begin, size_t end) {
+        partial[chunk] = project_range(mvp, vertices, begin, end, v, out);
+    });
+    ClipSummary s;
+    s.all = count > 0 ? 0xff : 0;
+    for (const auto &p : partial) {
+        s.any |= p.any;
+        s.all &= p.all;
+    }
+    return s;
+}
+
+} // namespace detail
+
+inline ClipSummary project_vertices(const Matrix4f &mvp, const Vector3f *vertices, size_t count,
+                                    const Viewport &viewport, const ScreenVertices &out, unsigned threads) {
+    return detail::project_parallel(mvp, vertices, count, viewport, out, threads);
+}
+
+inline ClipSummary project_vertices(const Matrix4f &mvp, const Vector4f *vertices, size_t count,
+                                    const Viewport &viewport, const ScreenVertices &out, unsigned threads) {
+    return detail::project_parallel(mvp, vertices, count, viewport, out, threads);
+}
+
+} // namespace math
@@ -0,0 +1,145 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+#pragma once
+
+#include "vmath.h"
+#include "vmath_parallel.h"
+#include "vmath_sampling.h" // warp_uniform_sphere()
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace math {
+
+/// small and fast seedable random generator (SplitMix64, 64 bit state), usable with the distributions of <random>.
+/// Skipping ahead is O(1), which the batch generators use to split the work over threads: their results are the
+/// ones of the scalar generators called count times on a Random(seed), whatever the number of threads.
+class Random {
+  public:
+    using result_type = uint64_t;
+
+    explicit Random(uint64_t seed = 0) : state_(seed) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+    /// next 64 random bits
+    result_type operator()();
+    /// skip n values
+    void discard(uint64_t n) { state_ += n * increment; }
+    /// uniformly distributed in [0, 1) (the other scalar types, e.g. Fixed, are converted from double)
+    template <typename T> T uniform() { return static_cast<T>(uniform<double>()); }
+    /// uniformly distributed in [lo, hi)
+    template <typename T> T uniform(T lo, T hi) { return lo + (hi - lo) * uniform<T>(); }
+
+  private:
+    static constexpr uint64_t increment = 0x9e3779b97f4a7c15ull;
+    uint64_t state_;
+};
+
+/// uniformly distributed rotation (Shoemake, "Uniform Random Rotations", 1992), from 3 random values
+template <typename T> Quaternion<T> random_quat(Random &rng);
+/// uniformly distributed unit vector, from 2 random values mapped by warp_uniform_sphere() (vmath_sampling.h)
+template <typename T> Vector3<T> random_unit_vector(Random &rng);
+/// random rigid transform: uniformly distributed rotation and translation uniformly distributed in
+/// [-translation_range, translation_range]^3, from 6 random values
+template <typename T> Transform<T> random_transform(Random &rng, T translation_range = T(1));
+
+/// batch versions: the values of the scalar generators called count times on a Random(seed), independent of the
+/// number of threads (0 = hardware threads)
+template <typename T> void random_quats(uint64_t seed, Quaternion<T> *out, size_t count, unsigned threads = 0);
+template <typename T> void random_unit_vectors(uint64_t seed, Vector3<T> *out, size_t count, unsigned threads = 0);
+template <typename T>
+void random_transforms(uint64_t seed, Transform<T> *out, size_t count, T translation_range = T(1),
+                       unsigned threads = 0);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+inline Random::result_type Random::operator()() {
+    uint64_t z = (state_ += increment);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// the top bits of the mantissa, so that the result is never rounded up to 1
+template <> inline float Random::uniform<float>() { return float((*this)() >> 40) * (1.f / 16777216.f); }
+template <> inline double Random::uniform<double>() {
+    return double((*this)() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+template <typename T> Quaternion<T> random_quat(Random &rng) {
+    const T u1 = rng.uniform<T>(), u2 = rng.uniform<T>(), u3 = rng.uniform<T>();
+    using std::cos;
+    using std::sin;
+    using std::sqrt;
+    const T r1 = sqrt(T(1) - u1), r2 = sqrt(u1);
+    const T t1 = T(2 * M_PI) * u2, t2 = T(2 * M_PI) * u3;
+    return Quaternion<T>(r2 * cos(t2), r1 * sin(t1), r1 * cos(t1), r2 * sin(t2));
+}
+
+template <typename T> Vector3<T> random_unit_vector(Random &rng) {
+    const T u1 = rng.uniform<T>(), u2 = rng.uniform<T>();
+    return warp_uniform_sphere(Vector2<T>(u1, u2));
+}
+
+template <typename T> Transform<T> random_transform(Random &rng, T translation_range) {
+    const T x = rng.uniform<T>(-translation_range, translation_range);
+    const T y = rng.uniform<T>(-translation_range, translation_range);
+    const T z = rng.uniform<T>(-translation_range, translation_range);
+    return Transform<T>(Vector3<T>(x, y, z), random_quat<T>(rng));
+}
+
+namespace detail {
+
+// chunks of count values, each generated with draws random values from its own position in the sequence
+template <typename V, typename F>
+void random_batch(uint64_t seed, V *out, size_t count, unsigned threads, uint64_t draws, F generate) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        Random rng(seed);
+        rng.discard(uint64_t(begin) * draws);
+        for (size_t i = begin; i < end; i++)
+            out[i] = generate(rng);
+    });
+}
+
+} // namespace detail
+
+template <typename T> void random_quats(uint64_t seed, Quaternion<T> *out, size_t count, unsigned threads) {
+    detail::random_batch(seed, out, count, threads, 3, [](Random &rng) { return random_quat<T>(rng); });
+}
+
+template <typename T> void random_unit_vectors(uint64_t seed, Vector3<T> *out, size_t count, unsigned threads) {
+    detail::random_batch(seed, out, count, threads, 2, [](Random &rng) { return random_unit_vector<T>(rng); });
+}
+
+template <typename T>
+void random_transforms(uint64_t seed, Transform<T> *out, size_t count, T translation_range, unsigned threads) {
+    detail::random_batch(seed, out, count, threads, 6,
+                         [translation_range](Random &rng) { return random_transform<T>(rng, translation_range); });
+}
+
+} // namespace math
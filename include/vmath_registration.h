@@ -0,0 +1,322 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+#pragma once
+
+#include "vmath.h"
+#include "vmath_parallel.h"
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace math {
+
+/// rigid registration of two corresponding point sets (Kabsch problem): the transform t minimizing
+///     sum_i weights[i] * |t.transform(src[i]) - dst[i]|^2
+/// The cross-covariance of the two sets is accumulated in a single pass (parallel over threads, 0 = hardware
+/// threads; double accumulators also for float data), and the rotation is found in closed form with Horn's
+/// quaternion method: the eigenvector of the largest eigenvalue of a symmetric 4x4 matrix, computed with a few
+/// Jacobi sweeps. The result is always a proper rotation (no reflection), also for planar or degenerate sets.
+/// @param weights optional array of count non-negative weights (nullptr = all ones)
+/// @return the identity if the total weight is 0
+template <typename T>
+Transform<T> kabsch(const Vector3<T> *src, const Vector3<T> *dst, size_t count, const T *weights = nullptr,
+                    unsigned threads = 0);
+
+/// similarity registration (Umeyama): the uniform scale and transform t minimizing
+///     sum_i weights[i] * |t.p + scale * t.rotate(src[i]) - dst[i]|^2
+/// Same single pass as kabsch(); the scale comes for free from the largest eigenvalue and the spread of src.
+/// @param scale output scale factor (0 if all the source points coincide)
+template <typename T>
+Transform<T> umeyama(const Vector3<T> *src, const Vector3<T> *dst, size_t count, T &scale,
+                     const T *weights = nullptr, unsigned threads = 0);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+/// weighted sums of a pair of point sets, relative to the first pair of points (for the accuracy of the
+/// single pass covariance)
+struct RegistrationSums {
+    double w = 0;               // sum w
+    double s[3] = {0, 0, 0};    // sum w * s
+    double d[3] = {0, 0, 0};    // sum w * d
+    double sd[3][3] = {};       // sum w * s_i * d_j
+    double ss = 0;              // sum w * |s|^2
+
+    void add(const RegistrationSums &o) {
+        w += o.w;
+        ss += o.ss;
+        for (int i = 0; i < 3; i++) {
+            s[i] += o.s[i];
+            d[i] += o.d[i];
+            for (int j = 0; j < 3; j++)
+                sd[i][j] += o.sd[i][j];
+        }
+    }
+};
+
+template <typename T>
+void accumulate_registration(const Vector3<T> *src, const Vector3<T> *dst, const T *weights, size_t begin,
+                             size_t end, const Vector3<T> &s0, const Vector3<T> &d0, RegistrationSums &sums) {
+    for (size_t i = begin; i < end; i++) {
+        const double w = weights ? double(weights[i]) : 1.0;
+        const double s[3] = {double(src[i].x - s0.x), double(src[i].y - s0.y), double(src[i].z - s0.z)};
+        const double d[3] = {double(dst[i].x - d0.x), double(dst[i].y - d0.y), double(dst[i].z - d0.z)};
+        sums.w += w;
+        sums.ss += w * (s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+        for (int a = 0; a < 3; a++) {
+            sums.s[a] += w * s[a];
+            sums.d[a] += w * d[a];
+            for (int b = 0; b < 3; b++)
+                sums.sd[a][b] += w * s[a] * d[b];
+        }
+    }
+}
+
+#if defined(VMATH_SSE2)
+// SSE2 accumulation: each point is held as (x, y) and (z, 0) double pairs, and the 3x3 cross products are three
+// broadcast-multiply-adds per pair. These plain overloads are preferred to the template for float and double.
+inline void load_registration_point(const Vector3<float> &v, __m128d &xy, __m128d &z) {
+    xy = _mm_cvtps_pd(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(&v.x))));
+    z = _mm_cvtss_sd(_mm_setzero_pd(), _mm_load_ss(&v.z));
+}
+inline void load_registration_point(const Vector3<double> &v, __m128d &xy, __m128d &z) {
+    xy = _mm_loadu_pd(&v.x);
+    z = _mm_load_sd(&v.z);
+}
+
+template <bool weighted, typename T>
+void accumulate_registration_sse2(const Vector3<T> *src, const Vector3<T> *dst, const T *weights, size_t begin,
+                                  size_t end, const Vector3<T> &s0, const Vector3<T> &d0,
+                                  RegistrationSums &sums) {
+    __m128d s0xy, s0z, d0xy, d0z;
+    load_registration_point(s0, s0xy, s0z);
+    load_registration_point(d0, d0xy, d0z);
+    __m128d w_sum = _mm_setzero_pd(), ss_xy = w_sum, ss_z = w_sum;
+    __m128d s_xy = w_sum, s_z = w_sum, d_xy = w_sum, d_z = w_sum;
+    __m128d xd_xy = w_sum, xd_z = w_sum, yd_xy = w_sum, yd_z = w_sum, zd_xy = w_sum, zd_z = w_sum;
+    for (size_t i = begin; i < end; i++) {
+        __m128d sxy, sz, dxy, dz;
+        load_registration_point(src[i], sxy, sz);
+        load_registration_point(dst[i], dxy, dz);
+        sxy = _mm_sub_pd(sxy, s0xy);
+        sz = _mm_sub_pd(sz, s0z);
+        dxy = _mm_sub_pd(dxy, d0xy);
+        dz = _mm_sub_pd(dz, d0z);
+        if (weighted) {
+            const __m128d w = _mm_set1_pd(double(weights[i]));
+            w_sum = _mm_add_pd(w_sum, w);
+            dxy = _mm_mul_pd(dxy, w);
+            dz = _mm_mul_pd(dz, w);
+            const __m128d wsxy = _mm_mul_pd(sxy, w), wsz = _mm_mul_pd(sz, w);
+            s_xy = _mm_add_pd(s_xy, wsxy);
+            s_z = _mm_add_pd(s_z, wsz);
+            ss_xy = _mm_add_pd(ss_xy, _mm_mul_pd(sxy, wsxy));
+            ss_z = _mm_add_pd(ss_z, _mm_mul_pd(sz, wsz));
+        } else {
+            s_xy = _mm_add_pd(s_xy, sxy);
+            s_z = _mm_add_pd(s_z, sz);
+            ss_xy = _mm_add_pd(ss_xy, _mm_mul_pd(sxy, sxy));
+            ss_z = _mm_add_pd(ss_z, _mm_mul_pd(sz, sz));
+        }
+        d_xy = _mm_add_pd(d_xy, dxy);
+        d_z = _mm_add_pd(d_z, dz);
+        const __m128d sx = _mm_unpacklo_pd(sxy, sxy), sy = _mm_unpackhi_pd(sxy, sxy);
+        const __m128d szz = _mm_unpacklo_pd(sz, sz);
+        xd_xy = _mm_add_pd(xd_xy, _mm_mul_pd(sx, dxy));
+        xd_z = _mm_add_pd(xd_z, _mm_mul_pd(sx, dz));
+        yd_xy = _mm_add_pd(yd_xy, _mm_mul_pd(sy, dxy));
+        yd_z = _mm_add_pd(yd_z, _mm_mul_pd(sy, dz));
+        zd_xy = _mm_add_pd(zd_xy, _mm_mul_pd(szz, dxy));
+        zd_z = _mm_add_pd(zd_z, _mm_mul_pd(szz, dz));
+    }
+    alignas(16) double v[2];
+    auto store2 = [&v](__m128d a, double &x, double &y) {
+        _mm_store_pd(v, a);
+        x += v[0];
+        y += v[1];
+    };
+    double unused = 0;
+    if (weighted)
+        sums.w += _mm_cvtsd_f64(w_sum);
+    else
+        sums.w += double(end - begin);
+    sums.ss += _mm_cvtsd_f64(_mm_add_sd(_mm_add_sd(ss_xy, _mm_unpackhi_pd(ss_xy, ss_xy)), ss_z));
+    store2(s_xy, sums.s[0], sums.s[1]);
+    store2(s_z, sums.s[2], unused);
+    store2(d_xy, sums.d[0], sums.d[1]);
+    store2(d_z, sums.d[2], unused);
+    store2(xd_xy, sums.sd[0][0], sums.sd[0][1]);
+    store2(xd_z, sums.sd[0][2], unused);
+    store2(yd_xy, sums.sd[1][0], sums.sd[1][1]);
+    store2(yd_z, sums.sd[1][2], unused);
+    store2(zd_xy, sums.sd[2][0], sums.sd[2][1]);
+    store2(zd_z, sums.sd[2][2], unused);
+}
+
+inline void accumulate_registration(const Vector3<float> *src, const Vector3<float> *dst, const float *weights,
+                                    size_t begin, size_t end, const Vector3<float> &s0, const Vector3<float> &d0,
+                                    RegistrationSums &sums) {
+    if (weights)
+        accumulate_registration_sse2<true>(src, dst, weights, begin, end, s0, d0, sums);
+    else
+        accumulate_registration_sse2<false>(src, dst, weights, begin, end, s0, d0, sums);
+}
+inline void accumulate_registration(const Vector3<double> *src, const Vector3<double> *dst, const double *weights,
+                                    size_t begin, size_t end, const Vector3<double> &s0, const Vector3<double> &d0,
+                                    RegistrationSums &sums) {
+    if (weights)
+        accumulate_registration_sse2<true>(src, dst, weights, begin, end, s0, d0, sums);
+    else
+        accumulate_registration_sse2<false>(src, dst, weights, begin, end, s0, d0, sums);
+}
+#endif // VMATH_SSE2
+
+/// eigenvector of the largest eigenvalue of the symmetric 4x4 matrix a (cyclic Jacobi); returns the eigenvalue
+inline double max_eigenvector4(double a[4][4], double vec[4]) {
+    double v[4][4] = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+    double norm = 0;
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            norm += a[i][j] * a[i][j];
+    for (int sweep = 0; sweep < 16; sweep++) {
+        double off = 0;
+        for (int p = 0; p < 3; p++)
+            for (int q = p + 1; q < 4; q++)
+                off += a[p][q] * a[p][q];
+        if (off <= 1e-30 * norm)
+            break;
+        for (int p = 0; p < 3; p++) {
+            for (int q = p + 1; q < 4; q++) {
+                if (a[p][q] == 0)
+                    continue;
+                // rotation in the (p, q) plane zeroing a[p][q]
+                const double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                const double t = (theta >= 0 ? 1 : -1) / (std::abs(theta) + std::sqrt(theta * theta + 1));
+                const double c = 1 / std::sqrt(t * t + 1), s = t * c;
+                for (int k = 0; k < 4; k++) {
+                    const double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < 4; k++) {
+                    const double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 4; k++) {
+                    const double vkp = v[k][p], vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    int best = 0;
+    for (int i = 1; i < 4; i++)
+        if (a[i][i] > a[best][best])
+            best = i;
+    for (int k = 0; k < 4; k++)
+        vec[k] = v[k][best];
+    return a[best][best];
+}
+
+/// Horn's method on the weighted sums; computes the rotation and, optionally, the Umeyama scale
+template <typename T>
+Transform<T> solve_registration(const RegistrationSums &sums, const Vector3<T> &s0, const Vector3<T> &d0,
+                                T *scale) {
+    if (!(sums.w > 0)) {
+        if (scale)
+            *scale = T(0);
+        return Transform<T>();
+    }
+    const double inv_w = 1.0 / sums.w;
+    const double ms[3] = {sums.s[0] * inv_w, sums.s[1] * inv_w, sums.s[2] * inv_w};
+    const double md[3] = {sums.d[0] * inv_w, sums.d[1] * inv_w, sums.d[2] * inv_w};
+    // cross-covariance h[i][j] = E[(s_i - ms_i) * (d_j - md_j)]
+    double h[3][3];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            h[i][j] = sums.sd[i][j] * inv_w - ms[i] * md[j];
+    // Horn's symmetric matrix: its top eigenvector is the rotation quaternion (w, x, y, z)
+    const double xx = h[0][0], xy = h[0][1], xz = h[0][2];
+    const double yx = h[1][0], yy = h[1][1], yz = h[1][2];
+    const double zx = h[2][0], zy = h[2][1], zz = h[2][2];
+    double n[4][4] = {{xx + yy + zz, yz - zy, zx - xz, xy - yx},
+                      {yz - zy, xx - yy - zz, xy + yx, zx + xz},
+                      {zx - xz, xy + yx, -xx + yy - zz, yz + zy},
+                      {xy - yx, zx + xz, yz + zy, -xx - yy + zz}};
+    double qv[4];
+    const double lambda = max_eigenvector4(n, qv);
+    const double qn = 1.0 / std::sqrt(qv[0] * qv[0] + qv[1] * qv[1] + qv[2] * qv[2] + qv[3] * qv[3]);
+    const Quaternion<T> q(T(qv[0] * qn), T(qv[1] * qn), T(qv[2] * qn), T(qv[3] * qn));
+    // the largest eigenvalue is E[(d - md) . R (s - ms)]; divided by the variance of s it is the optimal scale
+    double c = 1.0;
+    if (scale) {
+        const double var = sums.ss * inv_w - (ms[0] * ms[0] + ms[1] * ms[1] + ms[2] * ms[2]);
+        c = var > 0 ? lambda / var : 0.0;
+        *scale = T(c);
+    }
+    // t = mean(dst) - c * R * mean(src), back in the original frame
+    const Vector3<T> mean_s = s0 + Vector3<T>(T(ms[0]), T(ms[1]), T(ms[2]));
+    const Vector3<T> mean_d = d0 + Vector3<T>(T(md[0]), T(md[1]), T(md[2]));
+    return Transform<T>(mean_d - q.rotate(mean_s) * T(c), q);
+}
+
+template <typename T>
+Transform<T> register_point_sets(const Vector3<T> *src, const Vector3<T> *dst, size_t count, const T *weights,
+                                 unsigned threads, T *scale) {
+    if (count == 0)
+        return solve_registration(RegistrationSums(), Vector3<T>(T(0), T(0), T(0)),
+                                  Vector3<T>(T(0), T(0), T(0)), scale);
+    const Vector3<T> s0 = src[0], d0 = dst[0];
+    const size_t min_chunk = 65536;
+    std::vector<RegistrationSums> partial(parallel_chunk_count(count, threads, min_chunk));
+    parallel_for(count, threads, min_chunk, [&](size_t chunk, size_t begin, size_t end) {
+        accumulate_registration(src, dst, weights, begin, end, s0, d0, partial[chunk]);
+    });
+    for (size_t c = 1; c < partial.size(); c++)
+        partial[0].add(partial[c]);
+    return solve_registration(partial[0], s0, d0, scale);
+}
+
+} // namespace detail
+
+template <typename T>
+Transform<T> kabsch(const Vector3<T> *src, const Vector3<T> *dst, size_t count, const T *weights,
+                    unsigned threads) {
+    return detail::register_point_sets(src, dst, count, weights, threads, static_cast<T *>(nullptr));
+}
+
+template <typename T>
+Transform<T> umeyama(const Vector3<T> *src, const Vector3<T> *dst, size_t count, T &scale, const T *weights,
+                     unsigned threads) {
+    return detail::register_point_sets(src, dst, count, weights, threads, &scale);
+}
+
+} // namespace math
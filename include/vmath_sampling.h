@@ -0,0 +1,541 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+#pragma once
+
+#include "vmath.h"
+#include "vmath_parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace math {
+
+// ///////////////////////// //
+// low discrepancy sequences //
+// ///////////////////////// //
+
+/// sequences of sample points in [0, 1)^2 and [0, 1)^3
+enum class SampleSequence : uint8_t {
+    sobol,      ///< Sobol (0, 2)-sequence in 2D (Joe-Kuo direction numbers)
+    owen_sobol, ///< Sobol with hash based Owen scrambling (Burley 2020), randomized by the seed
+    halton,     ///< Halton (bases 2, 3 and 5), shifted modulo 1 by the seed if not 0
+    r2,         ///< R2/R3 additive recurrence of Roberts (plastic number), shifted modulo 1 by the seed if not 0
+};
+
+/// number of dimensions of the Sobol direction numbers
+constexpr unsigned sobol_dimensions = 5;
+
+/// Sobol sample of the given index in the given dimension (< sobol_dimensions), as a 32 bit fixed point fraction
+uint32_t sobol(uint32_t index, unsigned dimension);
+/// Owen scrambled Sobol sample: the index is shuffled and the sample scrambled with nested uniform permutations
+/// derived from the seed, which keeps the stratification of the sequence
+uint32_t owen_sobol(uint32_t index, unsigned dimension, uint32_t seed);
+/// radical inverse of index in the given base (van der Corput sequence), in [0, 1)
+template <typename T> T radical_inverse(unsigned base, uint32_t index);
+/// seed of a pixel (and frame), to decorrelate the sequences of the pixels of an image
+uint32_t pixel_seed(uint32_t x, uint32_t y, uint32_t frame = 0);
+
+/// sample of the given index of a sequence. The samples only depend on (sequence, index, seed): pixels (seeds) and
+/// ranges of indices can be generated independently, in any order and on any thread.
+template <typename T> Vector2<T> sample_2d(SampleSequence sequence, uint32_t index, uint32_t seed = 0);
+template <typename T> Vector3<T> sample_3d(SampleSequence sequence, uint32_t index, uint32_t seed = 0);
+
+/// the count samples first_index, first_index + 1, ... of a sequence; identical to the scalar functions. The Owen
+/// scrambling and the R2 sequence are computed 4 samples at a time with SSE2 when available, the Halton radical
+/// inverses are updated digit by digit; large arrays are split over threads (0 = hardware threads).
+template <typename T>
+void generate_samples(SampleSequence sequence, uint32_t first_index, uint32_t seed, Vector2<T> *out, size_t count,
+                      unsigned threads = 0);
+template <typename T>
+void generate_samples(SampleSequence sequence, uint32_t first_index, uint32_t seed, Vector3<T> *out, size_t count,
+                      unsigned threads = 0);
+
+// ///// //
+// warps //
+// ///// //
+
+/// concentric map (Shirley and Chiu) of [0, 1)^2 to the unit disk
+template <typename T> Vector2<T> warp_disk(const Vector2<T> &u);
+/// cosine weighted direction of the hemisphere around +z
+template <typename T> Vector3<T> warp_cosine_hemisphere(const Vector2<T> &u);
+/// uniformly distributed direction
+template <typename T> Vector3<T> warp_uniform_sphere(const Vector2<T> &u);
+/// uniformly distributed barycentric coordinates (b0, b1, 1 - b0 - b1) of a triangle, with the low distortion map of
+/// Heitz (2019), which preserves the stratification of the samples better than the square root map
+template <typename T> Vector3<T> warp_triangle(const Vector2<T> &u);
+
+/// density of warp_cosine_hemisphere() for a direction of the given z (cosine of the angle to the normal)
+template <typename T> T cosine_hemisphere_pdf(T cos_theta);
+/// density of warp_uniform_sphere()
+template <typename T> T uniform_sphere_pdf();
+
+/// batch versions of the warps; large arrays are split over threads (0 = hardware threads)
+template <typename T> void warp_disk(const Vector2<T> *u, Vector2<T> *out, size_t count, unsigned threads = 0);
+template <typename T>
+void warp_cosine_hemisphere(const Vector2<T> *u, Vector3<T> *out, size_t count, unsigned threads = 0);
+template <typename T>
+void warp_uniform_sphere(const Vector2<T> *u, Vector3<T> *out, size_t count, unsigned threads = 0);
+template <typename T> void warp_triangle(const Vector2<T> *u, Vector3<T> *out, size_t count, unsigned threads = 0);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+// generator matrices of the first dimensions from the direction numbers of Joe and Kuo (new-joe-kuo-6.21201), the
+// first one being the van der Corput sequence. The product with an index is linear over xor, and is tabulated for
+// each byte of the index: 4 lookups (in 4 KB per dimension) instead of up to 32 conditional xors.
+struct SobolMatrices {
+    uint32_t bytes[sobol_dimensions][4][256];
+    SobolMatrices() {
+        static const uint32_t s[] = {0, 1, 2, 3, 3}, a[] = {0, 0, 1, 1, 2};
+        static const uint32_t m[][3] = {{0, 0, 0}, {1, 0, 0}, {1, 3, 0}, {1, 3, 1}, {1, 1, 1}};
+        for (unsigned d = 0; d < sobol_dimensions; d++) {
+            uint32_t v[32];
+            for (unsigned i = 0; i < 32; i++) {
+                if (d == 0 || i < s[d]) {
+                    v[i] = (d == 0 ? 1u : m[d][i]) << (31 - i);
+                    continue;
+                }
+                v[i] = v[i - s[d]] ^ (v[i - s[d]] >> s[d]);
+                for (unsigned k = 1; k < s[d]; k++)
+                    v[i] ^= ((a[d] >> (s[d] - 1 - k)) & 1) * v[i - k];
+            }
+            for (unsigned b = 0; b < 4; b++) {
+                for (unsigned x = 0; x < 256; x++) {
+                    uint32_t r = 0;
+                    for (unsigned i = 0; i < 8; i++)
+                        r ^= (x >> i) & 1 ? v[8 * b + i] : 0u;
+                    bytes[d][b][x] = r;
+                }
+            }
+        }
+    }
+};
+
+inline const SobolMatrices &sobol_matrices() {
+    static const SobolMatrices matrices;
+    return matrices;
+}
+
+inline uint32_t hash32(uint32_t x) {
+    // lowbias32 (Wellons)
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+inline uint32_t reverse_bits(uint32_t x) {
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+    x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+// nested uniform scrambling of the bits of x, from the most significant one (Laine and Karras 2011, with the
+// constants of Burley 2020)
+inline uint32_t nested_uniform_scramble(uint32_t x, uint32_t seed) {
+    x = reverse_bits(x);
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return reverse_bits(x);
+}
+
+inline uint32_t sobol(uint32_t index, const uint32_t (*bytes)[256]) {
+    return bytes[0][index & 0xff] ^ bytes[1][(index >> 8) & 0xff] ^ bytes[2][(index >> 16) & 0xff] ^
+           bytes[3][index >> 24];
+}
+
+// seeds of the scrambling and of the shifts of the dimensions of a sample
+inline uint32_t dimension_seed(uint32_t seed, unsigned dimension) {
+    return hash32(seed ^ (0x9e3779b9u * (dimension + 1)));
+}
+
+// 32 bit fraction to [0, 1): float keeps the top 24 bits, so that the result is never rounded up to 1
+template <typename T> T unit_interval(uint32_t x);
+template <> inline float unit_interval<float>(uint32_t x) { return float(x >> 8) * (1.f / 16777216.f); }
+template <> inline double unit_interval<double>(uint32_t x) { return double(x) * (1.0 / 4294967296.0); }
+
+template <typename T> T below_one() { return T(1) - std::numeric_limits<T>::epsilon() / 2; }
+
+template <unsigned Base> double radical_inverse(uint32_t index) {
+    // the digits are extracted with a division by a constant and the power of the base is exact in 64 bits (the
+    // index has at most 21 digits in base 3), so that there is a single floating point division
+    uint64_t reversed = 0, power = 1;
+    while (index != 0) {
+        const uint32_t next = index / Base;
+        reversed = reversed * Base + (index - next * Base);
+        power *= Base;
+        index = next;
+    }
+    return double(reversed) / double(power);
+}
+
+inline double radical_inverse(unsigned base, uint32_t index) {
+    switch (base) {
+    case 2:
+        return double(reverse_bits(index)) * (1.0 / 4294967296.0);
+    case 3:
+        return radical_inverse<3>(index);
+    case 5:
+        return radical_inverse<5>(index);
+    default:
+        break;
+    }
+    const double inv_base = 1.0 / base;
+    double inv = 1.0;
+    uint64_t reversed = 0;
+    while (index != 0) {
+        const uint32_t next = index / base;
+        reversed = reversed * base + (index - next * base);
+        inv *= inv_base;
+        index = next;
+    }
+    return double(reversed) * inv;
+}
+
+inline void set(Vector2f &v, const float *u) { v = Vector2f(u[0], u[1]); }
+inline void set(Vector2d &v, const double *u) { v = Vector2d(u[0], u[1]); }
+inline void set(Vector3f &v, const float *u) { v = Vector3f(u[0], u[1], u[2]); }
+inline void set(Vector3d &v, const double *u) { v = Vector3d(u[0], u[1], u[2]); }
+
+// shift modulo 1 of a Halton coordinate (0 = none)
+template <typename T> T halton_shifted(double u, uint32_t shift) {
+    u += unit_interval<double>(shift);
+    u -= u >= 1.0 ? 1.0 : 0.0;
+    return std::min(T(u), below_one<T>());
+}
+
+inline uint32_t halton_shift(uint32_t seed, unsigned dimension) {
+    return seed != 0 ? dimension_seed(seed, dimension) : 0u;
+}
+
+template <typename T> T halton(unsigned base, uint32_t index, uint32_t seed, unsigned dimension) {
+    return halton_shifted<T>(radical_inverse(base, index), halton_shift(seed, dimension));
+}
+
+// radical inverses of consecutive indices, updated digit by digit (amortized one digit per increment). The value is
+// kept as an integer over base^digits (exact in 64 bits), so that it is the one of radical_inverse() to the bit.
+template <unsigned Base> class RadicalInverseCounter {
+  public:
+    explicit RadicalInverseCounter(uint32_t index) {
+        for (digits_ = 0, power_ = 1; power_ <= 0xffffffffu; digits_++)
+            power_ *= Base;
+        uint64_t weight = power_;
+        for (unsigned k = 0; k < digits_; k++) {
+            weight /= Base;
+            weights_[k] = weight;
+            digit_[k] = index % Base;
+            reversed_ += digit_[k] * weight;
+            index /= Base;
+        }
+    }
+    double value() const { return double(reversed_) / double(power_); }
+    // the counter of index + 1; index 2^32 - 1 is the last one
+    void next() {
+        unsigned k = 0;
+        for (; digit_[k] == Base - 1; k++) {
+            digit_[k] = 0;
+            reversed_ -= (Base - 1) * weights_[k];
+        }
+        digit_[k]++;
+        reversed_ += weights_[k];
+    }
+
+  private:
+    unsigned digits_;
+    uint64_t power_, reversed_ = 0;
+    uint64_t weights_[32];
+    uint32_t digit_[32];
+};
+
+template <typename T, unsigned D, typename V>
+void generate_halton(uint32_t first_index, uint32_t seed, V *out, size_t count) {
+    RadicalInverseCounter<3> c3(first_index);
+    RadicalInverseCounter<5> c5(first_index);
+    const uint32_t shift[3] = {halton_shift(seed, 0), halton_shift(seed, 1), halton_shift(seed, 2)};
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t index = first_index + uint32_t(i);
+        if (index == 0 && i > 0) {
+            // wrapped around
+            c3 = RadicalInverseCounter<3>(0);
+            c5 = RadicalInverseCounter<5>(0);
+        }
+        T u[3];
+        u[0] = halton_shifted<T>(radical_inverse(2, index), shift[0]);
+        u[1] = halton_shifted<T>(c3.value(), shift[1]);
+        if (D == 3)
+            u[2] = halton_shifted<T>(c5.value(), shift[2]);
+        set(out[i], u);
+        if (index != 0xffffffffu) {
+            c3.next();
+            if (D == 3)
+                c5.next();
+        }
+    }
+}
+
+// fixed point increments of the R2 and R3 sequences: the powers of the inverse of the plastic number (the real
+// root of x^3 = x + 1) and of the root of x^4 = x + 1
+constexpr uint32_t r2_alpha[2] = {3242174889u, 2447445414u};
+constexpr uint32_t r3_alpha[3] = {3518319155u, 2882110345u, 2360945575u};
+
+inline uint32_t roberts(uint32_t index, uint32_t alpha, uint32_t seed, unsigned dimension) {
+    // the index wraps around modulo 2^32 like the fractional part
+    return 0x80000000u + index * alpha + (seed != 0 ? dimension_seed(seed, dimension) : 0u);
+}
+
+template <typename T, unsigned D>
+void sample(SampleSequence sequence, uint32_t index, uint32_t seed, T *u) {
+    switch (sequence) {
+    case SampleSequence::sobol:
+        for (unsigned d = 0; d < D; d++)
+            u[d] = unit_interval<T>(math::sobol(index, d));
+        break;
+    case SampleSequence::owen_sobol:
+        for (unsigned d = 0; d < D; d++)
+            u[d] = unit_interval<T>(owen_sobol(index, d, seed));
+        break;
+    case SampleSequence::halton: {
+        static const unsigned bases[] = {2, 3, 5};
+        for (unsigned d = 0; d < D; d++)
+            u[d] = halton<T>(bases[d], index, seed, d);
+        break;
+    }
+    case SampleSequence::r2:
+        for (unsigned d = 0; d < D; d++)
+            u[d] = unit_interval<T>(roberts(index, (D == 2 ? r2_alpha : r3_alpha)[d], seed, d));
+        break;
+    }
+}
+
+#if defined(VMATH_SSE2)
+// low 32 bits of the products (SSE4.1 _mm_mullo_epi32)
+inline __m128i mullo_epi32_sse2(__m128i a, __m128i b) {
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline __m128i reverse_bits_sse2(__m128i x) {
+    auto swap = [](__m128i x, int shift, uint32_t mask) {
+        const __m128i m = _mm_set1_epi32(int(mask));
+        return _mm_or_si128(_mm_and_si128(_mm_srli_epi32(x, shift), m), _mm_slli_epi32(_mm_and_si128(x, m), shift));
+    };
+    x = swap(x, 1, 0x55555555u);
+    x = swap(x, 2, 0x33333333u);
+    x = swap(x, 4, 0x0f0f0f0fu);
+    x = swap(x, 8, 0x00ff00ffu);
+    return _mm_or_si128(_mm_srli_epi32(x, 16), _mm_slli_epi32(x, 16));
+}
+
+inline __m128i nested_uniform_scramble_sse2(__m128i x, uint32_t seed) {
+    x = _mm_add_epi32(reverse_bits_sse2(x), _mm_set1_epi32(int(seed)));
+    x = _mm_xor_si128(x, mullo_epi32_sse2(x, _mm_set1_epi32(int(0x6c50b47cu))));
+    x = _mm_xor_si128(x, mullo_epi32_sse2(x, _mm_set1_epi32(int(0xb82f1e52u))));
+    x = _mm_xor_si128(x, mullo_epi32_sse2(x, _mm_set1_epi32(int(0xc7afe638u))));
+    x = _mm_xor_si128(x, mullo_epi32_sse2(x, _mm_set1_epi32(int(0x8d22f6e6u))));
+    return reverse_bits_sse2(x);
+}
+#endif
+
+template <typename T, unsigned D, typename V>
+void generate_range(SampleSequence sequence, uint32_t first_index, uint32_t seed, V *out, size_t count) {
+    if (sequence == SampleSequence::halton)
+        return generate_halton<T, D>(first_index, seed, out, count);
+    size_t i = 0;
+#if defined(VMATH_SSE2)
+    // the scrambling and the R2 products are computed 4 at a time, the Sobol table lookups are scalar (no gathers)
+    if (sequence == SampleSequence::owen_sobol || sequence == SampleSequence::r2) {
+        const SobolMatrices &matrices = sobol_matrices();
+        uint32_t dimension_seeds[D];
+        for (unsigned d = 0; d < D; d++)
+            dimension_seeds[d] = sequence == SampleSequence::owen_sobol || seed != 0 ? dimension_seed(seed, d) : 0u;
+        for (; i + 4 <= count; i += 4) {
+            const __m128i index =
+                _mm_add_epi32(_mm_set1_epi32(int(first_index + uint32_t(i))), _mm_setr_epi32(0, 1, 2, 3));
+            uint32_t bits[D][4];
+            if (sequence == SampleSequence::r2) {
+                for (unsigned d = 0; d < D; d++) {
+                    const __m128i alpha = _mm_set1_epi32(int((D == 2 ? r2_alpha : r3_alpha)[d]));
+                    const __m128i offset = _mm_set1_epi32(int(0x80000000u + dimension_seeds[d]));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(bits[d]),
+                                     _mm_add_epi32(mullo_epi32_sse2(index, alpha), offset));
+                }
+            } else {
+                uint32_t shuffled[4];
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(shuffled), nested_uniform_scramble_sse2(index, seed));
+                for (unsigned d = 0; d < D; d++) {
+                    const __m128i x = _mm_setr_epi32(
+                        int(sobol(shuffled[0], matrices.bytes[d])), int(sobol(shuffled[1], matrices.bytes[d])),
+                        int(sobol(shuffled[2], matrices.bytes[d])), int(sobol(shuffled[3], matrices.bytes[d])));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(bits[d]),
+                                     nested_uniform_scramble_sse2(x, dimension_seeds[d]));
+                }
+            }
+            for (unsigned k = 0; k < 4; k++) {
+                T u[D];
+                for (unsigned d = 0; d < D; d++)
+                    u[d] = unit_interval<T>(bits[d][k]);
+                set(out[i + k], u);
+            }
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        T u[D];
+        sample<T, D>(sequence, first_index + uint32_t(i), seed, u);
+        set(out[i], u);
+    }
+}
+
+// batch warps
+template <typename S, typename D, typename F>
+void warp_batch(const S *u, D *out, size_t count, unsigned threads, F warp) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            out[i] = warp(u[i]);
+    });
+}
+
+} // namespace detail
+
+inline uint32_t sobol(uint32_t index, unsigned dimension) {
+    return detail::sobol(index, detail::sobol_matrices().bytes[dimension]);
+}
+
+inline uint32_t owen_sobol(uint32_t index, unsigned dimension, uint32_t seed) {
+    const uint32_t shuffled = detail::nested_uniform_scramble(index, seed);
+    return detail::nested_uniform_scramble(sobol(shuffled, dimension), detail::dimension_seed(seed, dimension));
+}
+
+template <typename T> T radical_inverse(unsigned base, uint32_t index) {
+    return std::min(T(detail::radical_inverse(base, index)), detail::below_one<T>());
+}
+
+inline uint32_t pixel_seed(uint32_t x, uint32_t y, uint32_t frame) {
+    return detail::hash32(x ^ detail::hash32(y ^ detail::hash32(frame)));
+}
+
+template <typename T> Vector2<T> sample_2d(SampleSequence sequence, uint32_t index, uint32_t seed) {
+    T u[2];
+    detail::sample<T, 2>(sequence, index, seed, u);
+    return Vector2<T>(u[0], u[1]);
+}
+
+template <typename T> Vector3<T> sample_3d(SampleSequence sequence, uint32_t index, uint32_t seed) {
+    T u[3];
+    detail::sample<T, 3>(sequence, index, seed, u);
+    return Vector3<T>(u[0], u[1], u[2]);
+}
+
+template <typename T>
+void generate_samples(SampleSequence sequence, uint32_t first_index, uint32_t seed, Vector2<T> *out, size_t count,
+                      unsigned threads) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        detail::generate_range<T, 2>(sequence, first_index + uint32_t(begin), seed, out + begin, end - begin);
+    });
+}
+
+template <typename T>
+void generate_samples(SampleSequence sequence, uint32_t first_index, uint32_t seed, Vector3<T> *out, size_t count,
+                      unsigned threads) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        detail::generate_range<T, 3>(sequence, first_index + uint32_t(begin), seed, out + begin, end - begin);
+    });
+}
+
+template <typename T> Vector2<T> warp_disk(const Vector2<T> &u) {
+    const T a = T(2) * u.x - T(1), b = T(2) * u.y - T(1);
+    if (a == T(0) && b == T(0))
+        return Vector2<T>(T(0), T(0));
+    T r, phi;
+    if (a * a > b * b) {
+        r = a;
+        phi = T(M_PI / 4) * (b / a);
+    } else {
+        r = b;
+        phi = T(M_PI / 2) - T(M_PI / 4) * (a / b);
+    }
+    return Vector2<T>(r * std::cos(phi), r * std::sin(phi));
+}
+
+template <typename T> Vector3<T> warp_cosine_hemisphere(const Vector2<T> &u) {
+    const Vector2<T> d = warp_disk(u);
+    return Vector3<T>(d.x, d.y, std::sqrt(std::max(T(0), T(1) - d.x * d.x - d.y * d.y)));
+}
+
+template <typename T> Vector3<T> warp_uniform_sphere(const Vector2<T> &u) {
+    const T z = T(1) - T(2) * u.x;
+    const T r = std::sqrt(std::max(T(0), T(1) - z * z));
+    const T phi = T(2 * M_PI) * u.y;
+    return Vector3<T>(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+template <typename T> Vector3<T> warp_triangle(const Vector2<T> &u) {
+    T b0, b1;
+    if (u.y > u.x) {
+        b0 = u.x / T(2);
+        b1 = u.y - b0;
+    } else {
+        b1 = u.y / T(2);
+        b0 = u.x - b1;
+    }
+    return Vector3<T>(b0, b1, T(1) - b0 - b1);
+}
+
+template <typename T> T cosine_hemisphere_pdf(T cos_theta) { return std::max(T(0), cos_theta) * T(M_1_PI); }
+
+template <typename T> T uniform_sphere_pdf() { return T(0.25 * M_1_PI); }
+
+template <typename T> void warp_disk(const Vector2<T> *u, Vector2<T> *out, size_t count, unsigned threads) {
+    detail::warp_batch(u, out, count, threads, [](const Vector2<T> &v) { return warp_disk(v); });
+}
+
+template <typename T>
+void warp_cosine_hemisphere(const Vector2<T> *u, Vector3<T> *out, size_t count, unsigned threads) {
+    detail::warp_batch(u, out, count, threads, [](const Vector2<T> &v) { return warp_cosine_hemisphere(v); });
+}
+
+template <typename T> void warp_uniform_sphere(const Vector2<T> *u, Vector3<T> *out, size_t count, unsigned threads) {
+    detail::warp_batch(u, out, count, threads, [](const Vector2<T> &v) { return warp_uniform_sphere(v); });
+}
+
+template <typename T> void warp_triangle(const Vector2<T> *u, Vector3<T> *out, size_t count, unsigned threads) {
+    detail::warp_batch(u, out, count, threads, [](const Vector2<T> &v) { return warp_triangle(v); });
+}
+
+} // namespace math
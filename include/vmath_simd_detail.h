@@ -0,0 +1,188 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+
+#pragma once
+
+#include "vmath_types.h"
+
+#include <cmath>
+
+// internal SIMD helpers shared by the batch kernels of the optional modules; nothing here is part of the API.
+// AVX and AVX-512F are used when the compiler targets them (e.g. -mavx, -mavx512f or -march=native); SSE2
+// (VMATH_SSE2, from vmath_types.h) is the fallback. Define VMATH_NO_SIMD to use the generic implementations.
+#if !defined(VMATH_NO_SIMD) && defined(__AVX__)
+#define VMATH_AVX
+#include <immintrin.h>
+#endif
+#if !defined(VMATH_NO_SIMD) && defined(__AVX512F__)
+#define VMATH_AVX512F
+#include <immintrin.h>
+#endif
+
+namespace math {
+
+namespace detail {
+
+// the SoA kernels are written once for a "pack" of lanes: a scalar, or one of the SIMD wrappers below. The
+// lanes take their own paths through selects instead of branches.
+template <typename T> inline T lanes_abs(T v) {
+    using std::abs;
+    return abs(v);
+}
+template <typename T> inline T lanes_sqrt(T v) {
+    using std::sqrt;
+    return sqrt(v);
+}
+template <typename T> inline bool lanes_greater(T a, T b) { return a > b; }
+inline bool lanes_and(bool a, bool b) { return a && b; }
+template <typename T> inline T lanes_select(bool mask, T a, T b) { return mask ? a : b; }
+template <typename T> inline void lanes_load(T &v, const T *p) { v = *p; }
+template <typename T> inline void lanes_store(T *p, T v) { *p = v; }
+
+#if defined(VMATH_SSE2)
+// 4 packed Vector3f <-> x, y, z lanes
+inline void load_vector3_sse2(const Vector3f *src, __m128 &x, __m128 &y, __m128 &z) {
+    const float *in = &src->x;
+    // x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+    const __m128 a = _mm_loadu_ps(in), b = _mm_loadu_ps(in + 4), c = _mm_loadu_ps(in + 8);
+    x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+                       _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)),
+                       _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+inline void store_vector3_sse2(__m128 x, __m128 y, __m128 z, Vector3f *dst) {
+    const __m128 lo = _mm_unpacklo_ps(x, y);                          // x0 y0 x1 y1
+    const __m128 hi = _mm_unpackhi_ps(x, y);                          // x2 y2 x3 y3
+    const __m128 t0 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));  // z0 z0 x1 x1
+    const __m128 t1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));  // y1 y1 z1 z1
+    const __m128 t2 = _mm_shuffle_ps(z, hi, _MM_SHUFFLE(3, 2, 3, 2)); // z2 z3 x3 y3
+    float *out = &dst->x;
+    _mm_storeu_ps(out, _mm_shuffle_ps(lo, t0, _MM_SHUFFLE(2, 0, 1, 0)));     // x0 y0 z0 x1
+    _mm_storeu_ps(out + 4, _mm_shuffle_ps(t1, hi, _MM_SHUFFLE(1, 0, 2, 0))); // y1 z1 x2 y2
+    _mm_storeu_ps(out + 8, _mm_shuffle_ps(t2, t2, _MM_SHUFFLE(1, 3, 2, 0))); // z2 x3 y3 z3
+}
+
+struct Float4 {
+    __m128 v;
+    Float4() {}
+    Float4(__m128 v0)
+    : v(v0) {}
+    Float4(float s)
+    : v(_mm_set1_ps(s)) {}
+};
+inline Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+inline Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+inline Float4 operator/(Float4 a, Float4 b) { return _mm_div_ps(a.v, b.v); }
+inline Float4 lanes_abs(Float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a.v); }
+inline Float4 lanes_sqrt(Float4 a) { return _mm_sqrt_ps(a.v); }
+inline Float4 lanes_greater(Float4 a, Float4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+inline Float4 lanes_and(Float4 a, Float4 b) { return _mm_and_ps(a.v, b.v); }
+inline Float4 lanes_select(Float4 mask, Float4 a, Float4 b) {
+    return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+}
+inline void lanes_load(Float4 &v, const float *p) { v = _mm_loadu_ps(p); }
+inline void lanes_store(float *p, Float4 v) { _mm_storeu_ps(p, v.v); }
+
+struct Double2 {
+    __m128d v;
+    Double2() {}
+    Double2(__m128d v0)
+    : v(v0) {}
+    Double2(double s)
+    : v(_mm_set1_pd(s)) {}
+};
+inline Double2 operator+(Double2 a, Double2 b) { return _mm_add_pd(a.v, b.v); }
+inline Double2 operator-(Double2 a, Double2 b) { return _mm_sub_pd(a.v, b.v); }
+inline Double2 operator*(Double2 a, Double2 b) { return _mm_mul_pd(a.v, b.v); }
+inline Double2 operator/(Double2 a, Double2 b) { return _mm_div_pd(a.v, b.v); }
+inline Double2 lanes_abs(Double2 a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a.v); }
+inline Double2 lanes_sqrt(Double2 a) { return _mm_sqrt_pd(a.v); }
+inline Double2 lanes_greater(Double2 a, Double2 b) { return _mm_cmpgt_pd(a.v, b.v); }
+inline Double2 lanes_and(Double2 a, Double2 b) { return _mm_and_pd(a.v, b.v); }
+inline Double2 lanes_select(Double2 mask, Double2 a, Double2 b) {
+    return _mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v));
+}
+inline void lanes_load(Double2 &v, const double *p) { v = _mm_loadu_pd(p); }
+inline void lanes_store(double *p, Double2 v) { _mm_storeu_pd(p, v.v); }
+#endif
+
+#if defined(VMATH_AVX)
+struct Float8 {
+    __m256 v;
+    Float8() {}
+    Float8(__m256 v0)
+    : v(v0) {}
+    Float8(float s)
+    : v(_mm256_set1_ps(s)) {}
+};
+inline Float8 operator+(Float8 a, Float8 b) { return _mm256_add_ps(a.v, b.v); }
+inline Float8 operator-(Float8 a, Float8 b) { return _mm256_sub_ps(a.v, b.v); }
+inline Float8 operator*(Float8 a, Float8 b) { return _mm256_mul_ps(a.v, b.v); }
+inline Float8 operator/(Float8 a, Float8 b) { return _mm256_div_ps(a.v, b.v); }
+inline Float8 lanes_abs(Float8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v); }
+inline Float8 lanes_sqrt(Float8 a) { return _mm256_sqrt_ps(a.v); }
+inline Float8 lanes_greater(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+inline Float8 lanes_and(Float8 a, Float8 b) { return _mm256_and_ps(a.v, b.v); }
+inline Float8 lanes_select(Float8 mask, Float8 a, Float8 b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+inline void lanes_load(Float8 &v, const float *p) { v = _mm256_loadu_ps(p); }
+inline void lanes_store(float *p, Float8 v) { _mm256_storeu_ps(p, v.v); }
+
+struct Double4 {
+    __m256d v;
+    Double4() {}
+    Double4(__m256d v0)
+    : v(v0) {}
+    Double4(double s)
+    : v(_mm256_set1_pd(s)) {}
+};
+inline Double4 operator+(Double4 a, Double4 b) { return _mm256_add_pd(a.v, b.v); }
+inline Double4 operator-(Double4 a, Double4 b) { return _mm256_sub_pd(a.v, b.v); }
+inline Double4 operator*(Double4 a, Double4 b) { return _mm256_mul_pd(a.v, b.v); }
+inline Double4 operator/(Double4 a, Double4 b) { return _mm256_div_pd(a.v, b.v); }
+inline Double4 lanes_abs(Double4 a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v); }
+inline Double4 lanes_sqrt(Double4 a) { return _mm256_sqrt_pd(a.v); }
+inline Double4 lanes_greater(Double4 a, Double4 b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ); }
+inline Double4 lanes_and(Double4 a, Double4 b) { return _mm256_and_pd(a.v, b.v); }
+inline Double4 lanes_select(Double4 mask, Double4 a, Double4 b) { return _mm256_blendv_pd(b.v, a.v, mask.v); }
+inline void lanes_load(Double4 &v, const double *p) { v = _mm256_loadu_pd(p); }
+inline void lanes_store(double *p, Double4 v) { _mm256_storeu_pd(p, v.v); }
+#endif
+
+// the widest pack for float and double
+template <typename T> struct WidePack { typedef T type; };
+#if defined(VMATH_AVX)
+template <> struct WidePack<float> { typedef Float8 type; };
+template <> struct WidePack<double> { typedef Double4 type; };
+#elif defined(VMATH_SSE2)
+template <> struct WidePack<float> { typedef Float4 type; };
+template <> struct WidePack<double> { typedef Double2 type; };
+#endif
+
+} // namespace detail
+
+} // namespace math
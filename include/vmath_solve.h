@@ -0,0 +1,328 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+#pragma once
+
+#include "vmath.h"
+#include "vmath_generic.h"
+#include "vmath_parallel.h"
+#include "vmath_simd_detail.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// AVX (8 float or 4 double systems per iteration) is used when the compiler targets it (e.g. -mavx or
+// -march=native); the SSE2 kernels (4 float or 2 double systems) are the fallback. The SIMD paths run partial
+// pivoting on the same magnitudes as the single system functions, with per lane selects instead of branches (the
+// lane packs are in vmath_simd_detail.h). They swap rows in a different order, so when a later column has pivot
+// candidates of equal magnitude they can pick another row and the results differ by rounding.
+
+namespace math {
+
+// //////////////////////// //
+// small linear systems     //
+// //////////////////////// //
+
+/// solution of m * x = b by LU decomposition with partial pivoting. Faster and more accurate than inverse(m) * b.
+/// Returns the zero vector if m is singular (a pivot smaller than VMATH_EPSILON in magnitude, as for inverse()).
+template <typename T> Vector3<T> solve(const Matrix3<T> &m, const Vector3<T> &b);
+template <typename T> Vector4<T> solve(const Matrix4<T> &m, const Vector4<T> &b);
+template <int N, typename T> Vector<N, T> solve(const Matrix<N, N, T> &m, const Vector<N, T> &b);
+/// solution of m * x = b for a symmetric positive definite m by Cholesky decomposition; only the lower triangle of
+/// m is read. Returns the zero vector if m is not positive definite (a pivot smaller than VMATH_EPSILON).
+template <typename T> Vector3<T> solve_cholesky(const Matrix3<T> &m, const Vector3<T> &b);
+template <typename T> Vector4<T> solve_cholesky(const Matrix4<T> &m, const Vector4<T> &b);
+template <int N, typename T> Vector<N, T> solve_cholesky(const Matrix<N, N, T> &m, const Vector<N, T> &b);
+
+/// batch versions over arrays of systems, x[i] = solve(m[i], b[i]). The systems are transposed in blocks to
+/// structure of arrays and solved several at a time with SIMD; large arrays are split over threads (0 = hardware
+/// threads)
+template <typename T>
+void solve(const Matrix3<T> *m, const Vector3<T> *b, Vector3<T> *x, size_t count, unsigned threads = 0);
+template <typename T>
+void solve(const Matrix4<T> *m, const Vector4<T> *b, Vector4<T> *x, size_t count, unsigned threads = 0);
+template <typename T>
+void solve_cholesky(const Matrix3<T> *m, const Vector3<T> *b, Vector3<T> *x, size_t count, unsigned threads = 0);
+template <typename T>
+void solve_cholesky(const Matrix4<T> *m, const Vector4<T> *b, Vector4<T> *x, size_t count, unsigned threads = 0);
+
+/// batch versions over structure of arrays of N x N systems (float or double): a holds N * N arrays of count
+/// values, with a[c * count + k] the element c (in the column-major order of Matrix3/Matrix4::data) of system k;
+/// b and x hold N arrays of count values. 8 (AVX) or 4 (SSE2) float systems are solved per iteration, half as many
+/// for double.
+template <int N, typename T> void solve_soa(const T *a, const T *b, T *x, size_t count, unsigned threads = 0);
+template <int N, typename T>
+void solve_cholesky_soa(const T *a, const T *b, T *x, size_t count, unsigned threads = 0);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+// LU decomposition with partial pivoting and substitution, in place on a (column-major) and b
+struct LuKernel {
+    template <int N, typename P> static void run(P *a, P *b, P *x) {
+        // single systems (the lane mask is a bool) exchange row indices, SIMD lanes exchange the rows with selects
+        run<N>(a, b, x, std::integral_constant<bool, std::is_same<decltype(lanes_greater(P(1), P(0))), bool>::value>());
+    }
+    template <int N, typename T> static void run(T *a, T *b, T *x, std::true_type) {
+        int row[N];
+        for (int i = 0; i < N; i++)
+            row[i] = i;
+        bool ok = true;
+        T inv_pivot[N];
+        for (int k = 0; k < N; k++) {
+            int p = k;
+            T largest = lanes_abs(a[k * N + row[k]]);
+            for (int i = k + 1; i < N; i++) {
+                const T v = lanes_abs(a[k * N + row[i]]);
+                p = v > largest ? i : p;
+                largest = v > largest ? v : largest;
+            }
+            std::swap(row[k], row[p]);
+            const int rk = row[k];
+            ok = ok && largest > T(VMATH_EPSILON);
+            inv_pivot[k] = T(1) / a[k * N + rk];
+            for (int i = k + 1; i < N; i++) {
+                const int ri = row[i];
+                const T f = a[k * N + ri] * inv_pivot[k];
+                for (int j = k + 1; j < N; j++)
+                    a[j * N + ri] = a[j * N + ri] - f * a[j * N + rk];
+                b[ri] = b[ri] - f * b[rk];
+            }
+        }
+        for (int i = N - 1; i >= 0; i--) {
+            T s = b[row[i]];
+            for (int j = i + 1; j < N; j++)
+                s = s - a[j * N + row[i]] * x[j];
+            x[i] = s * inv_pivot[i];
+        }
+        for (int i = 0; i < N; i++)
+            x[i] = ok ? x[i] : T(0);
+    }
+    template <int N, typename P> static void run(P *a, P *b, P *x, std::false_type) {
+        auto ok = lanes_greater(P(1), P(0));
+        P inv_pivot[N];
+        for (int k = 0; k < N; k++) {
+            // bring the largest remaining element of column k to the diagonal, one candidate row at a time
+            for (int i = k + 1; i < N; i++) {
+                const auto swap = lanes_greater(lanes_abs(a[k * N + i]), lanes_abs(a[k * N + k]));
+                for (int j = k; j < N; j++) {
+                    const P top = a[j * N + k], row = a[j * N + i];
+                    a[j * N + k] = lanes_select(swap, row, top);
+                    a[j * N + i] = lanes_select(swap, top, row);
+                }
+                const P top = b[k], row = b[i];
+                b[k] = lanes_select(swap, row, top);
+                b[i] = lanes_select(swap, top, row);
+            }
+            ok = lanes_and(ok, lanes_greater(lanes_abs(a[k * N + k]), P(VMATH_EPSILON)));
+            inv_pivot[k] = P(1) / a[k * N + k];
+            for (int i = k + 1; i < N; i++) {
+                const P f = a[k * N + i] * inv_pivot[k];
+                for (int j = k + 1; j < N; j++)
+                    a[j * N + i] = a[j * N + i] - f * a[j * N + k];
+                b[i] = b[i] - f * b[k];
+            }
+        }
+        for (int i = N - 1; i >= 0; i--) {
+            P s = b[i];
+            for (int j = i + 1; j < N; j++)
+                s = s - a[j * N + i] * x[j];
+            x[i] = s * inv_pivot[i];
+        }
+        for (int i = 0; i < N; i++)
+            x[i] = lanes_select(ok, x[i], P(0));
+    }
+};
+
+// Cholesky decomposition a = L * transpose(L) (L in the lower triangle of a) and substitution
+struct CholeskyKernel {
+    template <int N, typename P> static void run(P *a, P *b, P *x) {
+        auto ok = lanes_greater(P(1), P(0));
+        P inv_diag[N];
+        for (int j = 0; j < N; j++) {
+            P d = a[j * N + j];
+            for (int k = 0; k < j; k++)
+                d = d - a[k * N + j] * a[k * N + j];
+            ok = lanes_and(ok, lanes_greater(d, P(VMATH_EPSILON)));
+            inv_diag[j] = P(1) / lanes_sqrt(d);
+            for (int i = j + 1; i < N; i++) {
+                P s = a[j * N + i];
+                for (int k = 0; k < j; k++)
+                    s = s - a[k * N + i] * a[k * N + j];
+                a[j * N + i] = s * inv_diag[j];
+            }
+        }
+        for (int i = 0; i < N; i++) {
+            P s = b[i];
+            for (int k = 0; k < i; k++)
+                s = s - a[k * N + i] * x[k];
+            x[i] = s * inv_diag[i];
+        }
+        for (int i = N - 1; i >= 0; i--) {
+            P s = x[i];
+            for (int k = i + 1; k < N; k++)
+                s = s - a[i * N + k] * x[k];
+            x[i] = s * inv_diag[i];
+        }
+        for (int i = 0; i < N; i++)
+            x[i] = lanes_select(ok, x[i], P(0));
+    }
+};
+
+// one system, from column-major data
+template <typename K, int N, typename T> inline void solve_one(const T *m, const T *b, T *x) {
+    T a[N * N], r[N];
+    for (int i = 0; i < N * N; i++)
+        a[i] = m[i];
+    for (int i = 0; i < N; i++)
+        r[i] = b[i];
+    K::template run<N>(a, r, x);
+}
+
+// systems [begin, end) of a structure of arrays with the given number of systems per array
+template <typename K, int N, typename T>
+inline void solve_soa_range(const T *a, const T *b, T *x, size_t stride, size_t begin, size_t end) {
+    typedef typename WidePack<T>::type P;
+    const size_t width = sizeof(P) / sizeof(T);
+    size_t k = begin;
+    for (; k + width <= end; k += width) {
+        P pa[N * N], pb[N], px[N];
+        for (int c = 0; c < N * N; c++)
+            lanes_load(pa[c], a + c * stride + k);
+        for (int c = 0; c < N; c++)
+            lanes_load(pb[c], b + c * stride + k);
+        K::template run<N>(pa, pb, px);
+        for (int c = 0; c < N; c++)
+            lanes_store(x + c * stride + k, px[c]);
+    }
+    for (; k < end; k++) {
+        T sa[N * N], sb[N], sx[N];
+        for (int c = 0; c < N * N; c++)
+            sa[c] = a[c * stride + k];
+        for (int c = 0; c < N; c++)
+            sb[c] = b[c * stride + k];
+        K::template run<N>(sa, sb, sx);
+        for (int c = 0; c < N; c++)
+            x[c * stride + k] = sx[c];
+    }
+}
+
+// arrays of systems (N * N and N scalars each, without padding): transposed to structure of arrays in small blocks
+template <typename K, int N, typename T>
+inline void solve_aos(const T *m, const T *b, T *x, size_t count, unsigned threads) {
+    static_assert(sizeof(Matrix3<T>) == 9 * sizeof(T) && sizeof(Matrix4<T>) == 16 * sizeof(T) &&
+                      sizeof(Vector3<T>) == 3 * sizeof(T) && sizeof(Vector4<T>) == 4 * sizeof(T),
+                  "packed matrices and vectors expected");
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        const size_t block = 64;
+        T sa[N * N * block], sb[N * block], sx[N * block];
+        for (size_t first = begin; first < end; first += block) {
+            const size_t n = std::min(block, end - first);
+            for (size_t k = 0; k < n; k++) {
+                for (int c = 0; c < N * N; c++)
+                    sa[c * block + k] = m[(first + k) * N * N + c];
+                for (int c = 0; c < N; c++)
+                    sb[c * block + k] = b[(first + k) * N + c];
+            }
+            solve_soa_range<K, N>(sa, sb, sx, block, 0, n);
+            for (size_t k = 0; k < n; k++)
+                for (int c = 0; c < N; c++)
+                    x[(first + k) * N + c] = sx[c * block + k];
+        }
+    });
+}
+
+} // namespace detail
+
+template <typename T> inline Vector3<T> solve(const Matrix3<T> &m, const Vector3<T> &b) {
+    Vector3<T> x;
+    detail::solve_one<detail::LuKernel, 3>(m.data, b.ptr(), x.ptr());
+    return x;
+}
+template <typename T> inline Vector4<T> solve(const Matrix4<T> &m, const Vector4<T> &b) {
+    Vector4<T> x;
+    detail::solve_one<detail::LuKernel, 4>(m.data, b.ptr(), x.ptr());
+    return x;
+}
+template <int N, typename T> inline Vector<N, T> solve(const Matrix<N, N, T> &m, const Vector<N, T> &b) {
+    Vector<N, T> x;
+    detail::solve_one<detail::LuKernel, N>(m.data, b.data, x.data);
+    return x;
+}
+template <typename T> inline Vector3<T> solve_cholesky(const Matrix3<T> &m, const Vector3<T> &b) {
+    Vector3<T> x;
+    detail::solve_one<detail::CholeskyKernel, 3>(m.data, b.ptr(), x.ptr());
+    return x;
+}
+template <typename T> inline Vector4<T> solve_cholesky(const Matrix4<T> &m, const Vector4<T> &b) {
+    Vector4<T> x;
+    detail::solve_one<detail::CholeskyKernel, 4>(m.data, b.ptr(), x.ptr());
+    return x;
+}
+template <int N, typename T> inline Vector<N, T> solve_cholesky(const Matrix<N, N, T> &m, const Vector<N, T> &b) {
+    Vector<N, T> x;
+    detail::solve_one<detail::CholeskyKernel, N>(m.data, b.data, x.data);
+    return x;
+}
+
+template <typename T>
+inline void solve(const Matrix3<T> *m, const Vector3<T> *b, Vector3<T> *x, size_t count, unsigned threads) {
+    detail::solve_aos<detail::LuKernel, 3>(reinterpret_cast<const T *>(m), reinterpret_cast<const T *>(b),
+                                           reinterpret_cast<T *>(x), count, threads);
+}
+template <typename T>
+inline void solve(const Matrix4<T> *m, const Vector4<T> *b, Vector4<T> *x, size_t count, unsigned threads) {
+    detail::solve_aos<detail::LuKernel, 4>(reinterpret_cast<const T *>(m), reinterpret_cast<const T *>(b),
+                                           reinterpret_cast<T *>(x), count, threads);
+}
+template <typename T>
+inline void solve_cholesky(const Matrix3<T> *m, const Vector3<T> *b, Vector3<T> *x, size_t count, unsigned threads) {
+    detail::solve_aos<detail::CholeskyKernel, 3>(reinterpret_cast<const T *>(m), reinterpret_cast<const T *>(b),
+                                                 reinterpret_cast<T *>(x), count, threads);
+}
+template <typename T>
+inline void solve_cholesky(const Matrix4<T> *m, const Vector4<T> *b, Vector4<T> *x, size_t count, unsigned threads) {
+    detail::solve_aos<detail::CholeskyKernel, 4>(reinterpret_cast<const T *>(m), reinterpret_cast<const T *>(b),
+                                                 reinterpret_cast<T *>(x), count, threads);
+}
+
+template <int N, typename T> inline void solve_soa(const T *a, const T *b, T *x, size_t count, unsigned threads) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        detail::solve_soa_range<detail::LuKernel, N>(a, b, x, count, begin, end);
+    });
+}
+template <int N, typename T>
+inline void solve_cholesky_soa(const T *a, const T *b, T *x, size_t count, unsigned threads) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        detail::solve_soa_range<detail::CholeskyKernel, N>(a, b, x, count, begin, end);
+    });
+}
+
+} // namespace math
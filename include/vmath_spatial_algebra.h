@@ -0,0 +1,481 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+#pragma once
+
+#include "vmath.h"
+#include "vmath_generic.h"
+
+namespace math {
+
+// Featherstone spatial vector algebra ("Rigid Body Dynamics Algorithms", 2008), with the angular part first. All the
+// operations work on the 3D blocks directly, without forming the dense 6x6 matrices (to_matrix() builds them for
+// interoperability and testing).
+
+// //////////////// //
+// spatial vectors  //
+// //////////////// //
+
+/// spatial motion vector (twist): angular velocity and linear velocity of the body point at the frame origin
+template <typename T> struct MotionVector {
+    typedef T value_type; // to access the inner type at compile time
+    Vector3<T> angular;   ///< angular part (omega)
+    Vector3<T> linear;    ///< linear part (velocity of the point at the origin)
+
+    MotionVector() {}
+    MotionVector(const Vector3<T> &angular0, const Vector3<T> &linear0)
+    : angular(angular0)
+    , linear(linear0) {}
+    explicit MotionVector(const Vector<6, T> &v)
+    : angular(v[0], v[1], v[2])
+    , linear(v[3], v[4], v[5]) {}
+    explicit operator Vector<6, T>() const {
+        return Vector<6, T>{angular.x, angular.y, angular.z, linear.x, linear.y, linear.z};
+    }
+
+    bool operator==(const MotionVector<T> &rhs) const { return angular == rhs.angular && linear == rhs.linear; }
+    bool operator!=(const MotionVector<T> &rhs) const { return !(*this == rhs); }
+    void operator+=(const MotionVector<T> &rhs) {
+        angular += rhs.angular;
+        linear += rhs.linear;
+    }
+    void operator-=(const MotionVector<T> &rhs) {
+        angular -= rhs.angular;
+        linear -= rhs.linear;
+    }
+    void operator*=(T rhs) {
+        angular *= rhs;
+        linear *= rhs;
+    }
+};
+
+/// spatial force vector (wrench): moment about the frame origin and force
+template <typename T> struct ForceVector {
+    typedef T value_type; // to access the inner type at compile time
+    Vector3<T> angular;   ///< angular part (moment about the origin)
+    Vector3<T> linear;    ///< linear part (force)
+
+    ForceVector() {}
+    ForceVector(const Vector3<T> &angular0, const Vector3<T> &linear0)
+    : angular(angular0)
+    , linear(linear0) {}
+    explicit ForceVector(const Vector<6, T> &v)
+    : angular(v[0], v[1], v[2])
+    , linear(v[3], v[4], v[5]) {}
+    explicit operator Vector<6, T>() const {
+        return Vector<6, T>{angular.x, angular.y, angular.z, linear.x, linear.y, linear.z};
+    }
+
+    bool operator==(const ForceVector<T> &rhs) const { return angular == rhs.angular && linear == rhs.linear; }
+    bool operator!=(const ForceVector<T> &rhs) const { return !(*this == rhs); }
+    void operator+=(const ForceVector<T> &rhs) {
+        angular += rhs.angular;
+        linear += rhs.linear;
+    }
+    void operator-=(const ForceVector<T> &rhs) {
+        angular -= rhs.angular;
+        linear -= rhs.linear;
+    }
+    void operator*=(T rhs) {
+        angular *= rhs;
+        linear *= rhs;
+    }
+};
+
+// vector operations
+template <typename T> MotionVector<T> operator-(const MotionVector<T> &m);
+template <typename T> MotionVector<T> operator+(const MotionVector<T> &m1, const MotionVector<T> &m2);
+template <typename T> MotionVector<T> operator-(const MotionVector<T> &m1, const MotionVector<T> &m2);
+template <typename T> MotionVector<T> operator*(const MotionVector<T> &m, T s);
+template <typename T> MotionVector<T> operator*(T s, const MotionVector<T> &m);
+template <typename T> ForceVector<T> operator-(const ForceVector<T> &f);
+template <typename T> ForceVector<T> operator+(const ForceVector<T> &f1, const ForceVector<T> &f2);
+template <typename T> ForceVector<T> operator-(const ForceVector<T> &f1, const ForceVector<T> &f2);
+template <typename T> ForceVector<T> operator*(const ForceVector<T> &f, T s);
+template <typename T> ForceVector<T> operator*(T s, const ForceVector<T> &f);
+
+/// scalar product of a motion and a force (power)
+template <typename T> T dot(const MotionVector<T> &m, const ForceVector<T> &f);
+template <typename T> T dot(const ForceVector<T> &f, const MotionVector<T> &m);
+/// spatial cross product of two motions, m1 x m2 (the derivative of m2 moving with velocity m1)
+template <typename T> MotionVector<T> cross(const MotionVector<T> &m1, const MotionVector<T> &m2);
+/// spatial cross product of a motion and a force, m x* f
+template <typename T> ForceVector<T> cross(const MotionVector<T> &m, const ForceVector<T> &f);
+
+// ////////////////// //
+// spatial transforms //
+// ////////////////// //
+
+/// Plucker transform of the spatial vectors from the coordinates of frame A to the ones of frame B, stored as the
+/// rotation E (A to B coordinates) and the origin r of B in A coordinates: X m = (E w, E (v - r x w)).
+template <typename T> struct SpatialTransform {
+    typedef T value_type; // to access the inner type at compile time
+    Matrix3<T> E;         ///< rotation from the A to the B coordinates
+    Vector3<T> r;         ///< origin of B, in A coordinates
+
+    /// identity transform
+    SpatialTransform() { set_identity(E); }
+    SpatialTransform(const Matrix3<T> &E0, const Vector3<T> &r0)
+    : E(E0)
+    , r(r0) {}
+    /// from the pose of frame B in frame A (x_A = pose.transform(x_B), as for a child frame in its parent)
+    explicit SpatialTransform(const Transform<T> &pose);
+};
+
+/// composition: (X2 * X1) maps from the source frame of X1 to the destination frame of X2
+template <typename T> SpatialTransform<T> operator*(const SpatialTransform<T> &X2, const SpatialTransform<T> &X1);
+/// inverse transform (B to A)
+template <typename T> SpatialTransform<T> inverse(const SpatialTransform<T> &X);
+/// transform a motion / a force from the A to the B coordinates
+template <typename T> MotionVector<T> operator*(const SpatialTransform<T> &X, const MotionVector<T> &m);
+template <typename T> ForceVector<T> operator*(const SpatialTransform<T> &X, const ForceVector<T> &f);
+/// transform a motion / a force from the B to the A coordinates, without forming the inverse
+template <typename T> MotionVector<T> inverse_mul(const SpatialTransform<T> &X, const MotionVector<T> &m);
+template <typename T> ForceVector<T> inverse_mul(const SpatialTransform<T> &X, const ForceVector<T> &f);
+/// pose of B in A (the inverse of the constructor from a Transform)
+template <typename T> Transform<T> pose(const SpatialTransform<T> &X);
+/// the dense 6x6 motion transform [E 0; -E rx E]
+template <typename T> Matrix<6, 6, T> to_matrix(const SpatialTransform<T> &X);
+
+// //////////////// //
+// spatial inertias //
+// //////////////// //
+
+/// rigid body inertia, stored as the mass, the first moment of mass h = mass * com and the (symmetric) rotational
+/// inertia about the frame origin, 10 parameters
+template <typename T> struct RigidInertia {
+    typedef T value_type; // to access the inner type at compile time
+    T mass = T(0);
+    Vector3<T> h; ///< first moment of mass (mass * center of mass)
+    Matrix3<T> I; ///< rotational inertia about the origin
+
+    RigidInertia() {}
+    /// from the mass, the center of mass and the rotational inertia about the center of mass
+    RigidInertia(T mass0, const Vector3<T> &com, const Matrix3<T> &inertia_com);
+};
+
+/// articulated body inertia: a general symmetric 6x6 inertia [I H; transpose(H) M], with I and M symmetric
+template <typename T> struct ArticulatedInertia {
+    typedef T value_type; // to access the inner type at compile time
+    Matrix3<T> I; ///< angular block
+    Matrix3<T> H; ///< coupling block
+    Matrix3<T> M; ///< linear (mass) block
+
+    ArticulatedInertia() {}
+    ArticulatedInertia(const Matrix3<T> &I0, const Matrix3<T> &H0, const Matrix3<T> &M0)
+    : I(I0)
+    , H(H0)
+    , M(M0) {}
+    ArticulatedInertia(const RigidInertia<T> &rb);
+
+    void operator+=(const ArticulatedInertia<T> &rhs) {
+        I = I + rhs.I;
+        H = H + rhs.H;
+        M = M + rhs.M;
+    }
+    void operator-=(const ArticulatedInertia<T> &rhs) {
+        I = I - rhs.I;
+        H = H - rhs.H;
+        M = M - rhs.M;
+    }
+};
+
+/// sum of inertias (bodies rigidly attached together)
+template <typename T> RigidInertia<T> operator+(const RigidInertia<T> &i1, const RigidInertia<T> &i2);
+template <typename T>
+ArticulatedInertia<T> operator+(const ArticulatedInertia<T> &i1, const ArticulatedInertia<T> &i2);
+template <typename T>
+ArticulatedInertia<T> operator-(const ArticulatedInertia<T> &i1, const ArticulatedInertia<T> &i2);
+/// momentum of a body moving with velocity m
+template <typename T> ForceVector<T> operator*(const RigidInertia<T> &i, const MotionVector<T> &m);
+template <typename T> ForceVector<T> operator*(const ArticulatedInertia<T> &i, const MotionVector<T> &m);
+/// i += s * u * transpose(u), the update of the articulated body algorithm for a one degree of freedom joint
+template <typename T> void rank1_update(ArticulatedInertia<T> &i, const ForceVector<T> &u, T s);
+/// transform an inertia from the A to the B coordinates (X* i inverse(X))
+template <typename T> RigidInertia<T> operator*(const SpatialTransform<T> &X, const RigidInertia<T> &i);
+template <typename T> ArticulatedInertia<T> operator*(const SpatialTransform<T> &X, const ArticulatedInertia<T> &i);
+/// transform an inertia from the B to the A coordinates (transpose(X) i X), without forming the inverse
+template <typename T> RigidInertia<T> inverse_mul(const SpatialTransform<T> &X, const RigidInertia<T> &i);
+template <typename T>
+ArticulatedInertia<T> inverse_mul(const SpatialTransform<T> &X, const ArticulatedInertia<T> &i);
+/// the dense 6x6 inertia matrices
+template <typename T> Matrix<6, 6, T> to_matrix(const RigidInertia<T> &i);
+template <typename T> Matrix<6, 6, T> to_matrix(const ArticulatedInertia<T> &i);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+template <typename T> inline Matrix3<T> transposed3(const Matrix3<T> &m) {
+    Matrix3<T> ret = m;
+    transpose(ret);
+    return ret;
+}
+// transpose(m) * v
+template <typename T> inline Vector3<T> mul_transposed3(const Matrix3<T> &m, const Vector3<T> &v) {
+    return Vector3<T>(m.data[0] * v.x + m.data[1] * v.y + m.data[2] * v.z,
+                      m.data[3] * v.x + m.data[4] * v.y + m.data[5] * v.z,
+                      m.data[6] * v.x + m.data[7] * v.y + m.data[8] * v.z);
+}
+// rx * m, column by column
+template <typename T> inline Matrix3<T> skew_mul(const Vector3<T> &r, const Matrix3<T> &m) {
+    Matrix3<T> ret;
+    for (int j = 0; j < 3; j++) {
+        const T *c = m.data + 3 * j;
+        ret.data[3 * j + 0] = r.y * c[2] - r.z * c[1];
+        ret.data[3 * j + 1] = r.z * c[0] - r.x * c[2];
+        ret.data[3 * j + 2] = r.x * c[1] - r.y * c[0];
+    }
+    return ret;
+}
+// rx * transpose(m), row by row
+template <typename T> inline Matrix3<T> skew_mul_transposed(const Vector3<T> &r, const Matrix3<T> &m) {
+    Matrix3<T> ret;
+    for (int j = 0; j < 3; j++) {
+        const T c0 = m.data[j], c1 = m.data[3 + j], c2 = m.data[6 + j];
+        ret.data[3 * j + 0] = r.y * c2 - r.z * c1;
+        ret.data[3 * j + 1] = r.z * c0 - r.x * c2;
+        ret.data[3 * j + 2] = r.x * c1 - r.y * c0;
+    }
+    return ret;
+}
+// transpose(E) * m * E, on the raw column-major data
+template <typename T> inline Matrix3<T> rotate_transposed3(const Matrix3<T> &E, const Matrix3<T> &m) {
+    T b[9];
+    for (int j = 0; j < 3; j++)
+        for (int i = 0; i < 3; i++)
+            b[3 * j + i] = m.data[i] * E.data[3 * j] + m.data[3 + i] * E.data[3 * j + 1] +
+                           m.data[6 + i] * E.data[3 * j + 2];
+    Matrix3<T> ret;
+    for (int j = 0; j < 3; j++)
+        for (int i = 0; i < 3; i++)
+            ret.data[3 * j + i] = E.data[3 * i] * b[3 * j] + E.data[3 * i + 1] * b[3 * j + 1] +
+                                  E.data[3 * i + 2] * b[3 * j + 2];
+    return ret;
+}
+// a * transpose(b)
+template <typename T> inline Matrix3<T> outer3(const Vector3<T> &a, const Vector3<T> &b) {
+    Matrix3<T> ret;
+    for (int j = 0; j < 3; j++)
+        for (int i = 0; i < 3; i++)
+            ret.data[3 * j + i] = a[i] * b[j];
+    return ret;
+}
+template <typename T> inline Matrix3<T> skew(const Vector3<T> &v) {
+    return Matrix3<T>{T(0), -v.z, v.y, v.z, T(0), -v.x, -v.y, v.x, T(0)};
+}
+template <typename T> inline void add_diagonal(Matrix3<T> &m, T s) {
+    m.data[0] += s;
+    m.data[4] += s;
+    m.data[8] += s;
+}
+template <typename T> inline void set_block3(Matrix<6, 6, T> &dst, int i, int j, const Matrix3<T> &m) {
+    set_block(dst, i, j, Matrix<3, 3, T>(m));
+}
+
+} // namespace detail
+
+template <typename T> inline MotionVector<T> operator-(const MotionVector<T> &m) {
+    return MotionVector<T>(-m.angular, -m.linear);
+}
+template <typename T> inline MotionVector<T> operator+(const MotionVector<T> &m1, const MotionVector<T> &m2) {
+    return MotionVector<T>(m1.angular + m2.angular, m1.linear + m2.linear);
+}
+template <typename T> inline MotionVector<T> operator-(const MotionVector<T> &m1, const MotionVector<T> &m2) {
+    return MotionVector<T>(m1.angular - m2.angular, m1.linear - m2.linear);
+}
+template <typename T> inline MotionVector<T> operator*(const MotionVector<T> &m, T s) {
+    return MotionVector<T>(m.angular * s, m.linear * s);
+}
+template <typename T> inline MotionVector<T> operator*(T s, const MotionVector<T> &m) {
+    return MotionVector<T>(s * m.angular, s * m.linear);
+}
+template <typename T> inline ForceVector<T> operator-(const ForceVector<T> &f) {
+    return ForceVector<T>(-f.angular, -f.linear);
+}
+template <typename T> inline ForceVector<T> operator+(const ForceVector<T> &f1, const ForceVector<T> &f2) {
+    return ForceVector<T>(f1.angular + f2.angular, f1.linear + f2.linear);
+}
+template <typename T> inline ForceVector<T> operator-(const ForceVector<T> &f1, const ForceVector<T> &f2) {
+    return ForceVector<T>(f1.angular - f2.angular, f1.linear - f2.linear);
+}
+template <typename T> inline ForceVector<T> operator*(const ForceVector<T> &f, T s) {
+    return ForceVector<T>(f.angular * s, f.linear * s);
+}
+template <typename T> inline ForceVector<T> operator*(T s, const ForceVector<T> &f) {
+    return ForceVector<T>(s * f.angular, s * f.linear);
+}
+
+template <typename T> inline T dot(const MotionVector<T> &m, const ForceVector<T> &f) {
+    return m.angular.dot(f.angular) + m.linear.dot(f.linear);
+}
+template <typename T> inline T dot(const ForceVector<T> &f, const MotionVector<T> &m) { return dot(m, f); }
+template <typename T> inline MotionVector<T> cross(const MotionVector<T> &m1, const MotionVector<T> &m2) {
+    return MotionVector<T>(m1.angular.cross(m2.angular),
+                           m1.angular.cross(m2.linear) + m1.linear.cross(m2.angular));
+}
+template <typename T> inline ForceVector<T> cross(const MotionVector<T> &m, const ForceVector<T> &f) {
+    return ForceVector<T>(m.angular.cross(f.angular) + m.linear.cross(f.linear), m.angular.cross(f.linear));
+}
+
+template <typename T>
+inline SpatialTransform<T>::SpatialTransform(const Transform<T> &pose)
+: E(detail::transposed3(rot_matrix(pose.q)))
+, r(pose.p) {}
+
+template <typename T>
+inline SpatialTransform<T> operator*(const SpatialTransform<T> &X2, const SpatialTransform<T> &X1) {
+    return SpatialTransform<T>(X2.E * X1.E, X1.r + detail::mul_transposed3(X1.E, X2.r));
+}
+template <typename T> inline SpatialTransform<T> inverse(const SpatialTransform<T> &X) {
+    return SpatialTransform<T>(detail::transposed3(X.E), -(X.E * X.r));
+}
+template <typename T> inline MotionVector<T> operator*(const SpatialTransform<T> &X, const MotionVector<T> &m) {
+    return MotionVector<T>(X.E * m.angular, X.E * (m.linear - X.r.cross(m.angular)));
+}
+template <typename T> inline ForceVector<T> operator*(const SpatialTransform<T> &X, const ForceVector<T> &f) {
+    return ForceVector<T>(X.E * (f.angular - X.r.cross(f.linear)), X.E * f.linear);
+}
+template <typename T> inline MotionVector<T> inverse_mul(const SpatialTransform<T> &X, const MotionVector<T> &m) {
+    const Vector3<T> w = detail::mul_transposed3(X.E, m.angular);
+    return MotionVector<T>(w, detail::mul_transposed3(X.E, m.linear) + X.r.cross(w));
+}
+template <typename T> inline ForceVector<T> inverse_mul(const SpatialTransform<T> &X, const ForceVector<T> &f) {
+    const Vector3<T> force = detail::mul_transposed3(X.E, f.linear);
+    return ForceVector<T>(detail::mul_transposed3(X.E, f.angular) + X.r.cross(force), force);
+}
+template <typename T> inline Transform<T> pose(const SpatialTransform<T> &X) {
+    return Transform<T>(X.r, quat_from_matrix(detail::transposed3(X.E)));
+}
+template <typename T> inline Matrix<6, 6, T> to_matrix(const SpatialTransform<T> &X) {
+    Matrix<6, 6, T> ret;
+    detail::set_block3(ret, 0, 0, X.E);
+    detail::set_block3(ret, 3, 3, X.E);
+    detail::set_block3(ret, 3, 0, -(X.E * detail::skew(X.r)));
+    return ret;
+}
+
+template <typename T>
+inline RigidInertia<T>::RigidInertia(T mass0, const Vector3<T> &com, const Matrix3<T> &inertia_com)
+: mass(mass0)
+, h(com * mass0)
+// parallel axis theorem: I = Ic - m cx cx = Ic + m (|c|^2 1 - c c^T)
+, I(inertia_com - detail::outer3(com, com) * mass0) {
+    detail::add_diagonal(I, mass0 * com.dot(com));
+}
+
+template <typename T>
+inline ArticulatedInertia<T>::ArticulatedInertia(const RigidInertia<T> &rb)
+: I(rb.I)
+, H(detail::skew(rb.h)) {
+    set_zero(M);
+    detail::add_diagonal(M, rb.mass);
+}
+
+template <typename T> inline RigidInertia<T> operator+(const RigidInertia<T> &i1, const RigidInertia<T> &i2) {
+    RigidInertia<T> ret;
+    ret.mass = i1.mass + i2.mass;
+    ret.h = i1.h + i2.h;
+    ret.I = i1.I + i2.I;
+    return ret;
+}
+template <typename T>
+inline ArticulatedInertia<T> operator+(const ArticulatedInertia<T> &i1, const ArticulatedInertia<T> &i2) {
+    return ArticulatedInertia<T>(i1.I + i2.I, i1.H + i2.H, i1.M + i2.M);
+}
+template <typename T>
+inline ArticulatedInertia<T> operator-(const ArticulatedInertia<T> &i1, const ArticulatedInertia<T> &i2) {
+    return ArticulatedInertia<T>(i1.I - i2.I, i1.H - i2.H, i1.M - i2.M);
+}
+template <typename T> inline ForceVector<T> operator*(const RigidInertia<T> &i, const MotionVector<T> &m) {
+    return ForceVector<T>(i.I * m.angular + i.h.cross(m.linear), m.linear * i.mass - i.h.cross(m.angular));
+}
+template <typename T> inline ForceVector<T> operator*(const ArticulatedInertia<T> &i, const MotionVector<T> &m) {
+    return ForceVector<T>(i.I * m.angular + i.H * m.linear,
+                          detail::mul_transposed3(i.H, m.angular) + i.M * m.linear);
+}
+template <typename T> inline void rank1_update(ArticulatedInertia<T> &i, const ForceVector<T> &u, T s) {
+    const Vector3<T> sa = u.angular * s, sl = u.linear * s;
+    for (int c = 0; c < 3; c++)
+        for (int r = 0; r < 3; r++) {
+            i.I.data[3 * c + r] += u.angular[r] * sa[c];
+            i.H.data[3 * c + r] += u.angular[r] * sl[c];
+            i.M.data[3 * c + r] += u.linear[r] * sl[c];
+        }
+}
+
+template <typename T> inline RigidInertia<T> operator*(const SpatialTransform<T> &X, const RigidInertia<T> &i) {
+    // Featherstone table 2.8: I' = E (I + rx hx + (h - m r)x rx) E^T, with ax bx = b a^T - (a.b) 1
+    const Vector3<T> d = i.h - X.r * i.mass;
+    Matrix3<T> J = i.I + detail::outer3(i.h, X.r) + detail::outer3(X.r, d);
+    detail::add_diagonal(J, -(X.r.dot(i.h) + d.dot(X.r)));
+    RigidInertia<T> ret;
+    ret.mass = i.mass;
+    ret.h = X.E * d;
+    ret.I = X.E * J * detail::transposed3(X.E);
+    return ret;
+}
+template <typename T> inline RigidInertia<T> inverse_mul(const SpatialTransform<T> &X, const RigidInertia<T> &i) {
+    // I' = E^T I E - rx (E^T h)x - (E^T h + m r)x rx
+    const Vector3<T> h = detail::mul_transposed3(X.E, i.h);
+    const Vector3<T> d = h + X.r * i.mass;
+    RigidInertia<T> ret;
+    ret.mass = i.mass;
+    ret.h = d;
+    ret.I = detail::rotate_transposed3(X.E, i.I) - detail::outer3(h, X.r) - detail::outer3(X.r, d);
+    detail::add_diagonal(ret.I, X.r.dot(h) + d.dot(X.r));
+    return ret;
+}
+template <typename T>
+inline ArticulatedInertia<T> inverse_mul(const SpatialTransform<T> &X, const ArticulatedInertia<T> &i) {
+    // transpose(X) i X, with X = [1 0; -rx 1] [E 0; 0 E]: rotate the blocks to the A orientation, then
+    // M' = M, H' = H + rx M, I' = I - H rx + rx H^T - rx M rx (with a rx = -(rx a^T)^T for the right products)
+    const Matrix3<T> I = detail::rotate_transposed3(X.E, i.I);
+    const Matrix3<T> H = detail::rotate_transposed3(X.E, i.H);
+    const Matrix3<T> M = detail::rotate_transposed3(X.E, i.M);
+    const Matrix3<T> A = detail::skew_mul_transposed(X.r, H); // rx H^T
+    const Matrix3<T> B = detail::skew_mul(X.r, M);            // rx M
+    const Matrix3<T> C = detail::skew_mul_transposed(X.r, B); // -rx M rx
+    return ArticulatedInertia<T>(I + A + detail::transposed3(A) + C, H + B, M);
+}
+template <typename T>
+inline ArticulatedInertia<T> operator*(const SpatialTransform<T> &X, const ArticulatedInertia<T> &i) {
+    return inverse_mul(inverse(X), i);
+}
+
+template <typename T> inline Matrix<6, 6, T> to_matrix(const RigidInertia<T> &i) {
+    return to_matrix(ArticulatedInertia<T>(i));
+}
+template <typename T> inline Matrix<6, 6, T> to_matrix(const ArticulatedInertia<T> &i) {
+    Matrix<6, 6, T> ret;
+    detail::set_block3(ret, 0, 0, i.I);
+    detail::set_block3(ret, 0, 3, i.H);
+    detail::set_block3(ret, 3, 0, detail::transposed3(i.H));
+    detail::set_block3(ret, 3, 3, i.M);
+    return ret;
+}
+
+} // namespace math
@@ -0,0 +1,515 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+#pragma once
+
+#include "vmath.h"
+#include "vmath_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace math {
+
+/// Uniform grid over a Vector3 point set, stored as a spatial hash in compressed (CSR) layout.
+///
+/// Every point is assigned to the cell floor(p / cell_size), and each cell is hashed to one of a power of two
+/// number of buckets (about one per point). The points are sorted by bucket, so the points of a cell are
+/// contiguous in memory. The hash only mixes the y and z coordinates and adds x, so a row of cells along x
+/// maps to consecutive buckets and a query scans a few contiguous ranges of points instead of one random
+/// location per cell. Different cells can share a bucket: queries always test the distance of each
+/// candidate, so collisions only cost time.
+/// The grid keeps a sorted copy of the points; query results are the indices in the original array.
+///
+/// The cell coordinates (p / cell_size) of the points must be within +-2^30; the coordinates of the queries are
+/// clamped to that range, so queries can be anywhere. A cell size close to the typical query radius gives the best
+/// performance.
+template <typename T> class SpatialHashGrid {
+  public:
+    typedef T value_type; // to access the inner type at compile time
+    /// index reported for the missing neighbors of a kNN query with fewer than k points in the grid
+    static constexpr uint32_t invalid_index = 0xffffffffu;
+
+    explicit SpatialHashGrid(T cell_size) : cell_size_(cell_size), inv_cell_size_(T(1) / cell_size) {}
+
+    /// (re)build the grid from an array of points. The building is parallel over threads (0 = hardware threads);
+    /// the resulting layout does not depend on the number of threads.
+    void build(const Vector3<T> *points, size_t count, unsigned threads = 0);
+    /// update the grid after the points moved; points must be the same array (same size and order) used for
+    /// build(). Points that stay in their bucket are updated in place. The others are moved to a small sorted
+    /// overflow table that is searched together with the main table; when the overflow grows beyond a fraction
+    /// of the points the grid is rebuilt.
+    void update(const Vector3<T> *points, unsigned threads = 0);
+
+    /// append to out the indices of the points within radius from q (in no particular order)
+    void radius_search(const Vector3<T> &q, T radius, std::vector<uint32_t> &out) const;
+    /// k nearest neighbors of q, sorted by increasing distance.
+    /// @param indices output array of k indices; if the grid has fewer than k points the remaining ones are
+    ///        set to invalid_index
+    /// @param dist2 optional output array of k squared distances (infinity for the missing neighbors)
+    /// @return the number of neighbors found, min(k, size())
+    size_t knn_search(const Vector3<T> &q, size_t k, uint32_t *indices, T *dist2 = nullptr) const;
+
+    /// radius search for an array of queries, parallel over threads (0 = hardware threads).
+    /// The results are stored in CSR form: the neighbors of query i are indices[offsets[i]..offsets[i+1]).
+    void radius_search(const Vector3<T> *queries, size_t count, T radius, std::vector<uint32_t> &offsets,
+                       std::vector<uint32_t> &indices, unsigned threads = 0) const;
+    /// kNN search for an array of queries, parallel over threads (0 = hardware threads).
+    /// The neighbors of query i are stored in indices[i*k..(i+1)*k) (and dist2, if not null).
+    void knn_search(const Vector3<T> *queries, size_t count, size_t k, uint32_t *indices, T *dist2 = nullptr,
+                    unsigned threads = 0) const;
+
+    /// number of points in the grid
+    size_t size() const { return indices_.size(); }
+    /// edge length of the cells
+    T cell_size() const { return cell_size_; }
+    /// number of hash buckets
+    size_t bucket_count() const { return cell_start_.empty() ? 0 : cell_start_.size() - 1; }
+    /// number of points currently stored in the overflow table (see update())
+    size_t overflow_size() const { return ov_indices_.size(); }
+
+  private:
+    // clamped before the conversion, so that far away queries (and the c +- r arithmetic) cannot overflow
+    int32_t cell_coord(T v) const {
+        const T limit = T(1 << 30);
+        return int32_t(std::min(limit, std::max(-limit, std::floor(v * inv_cell_size_))));
+    }
+    uint32_t bucket(int32_t x, int32_t y, int32_t z) const {
+        // y/z mixing from M. Teschner et al., "Optimized Spatial Hashing for Collision Detection of Deformable
+        // Objects" (2003)
+        return (((uint32_t(y) * 19349663u) ^ (uint32_t(z) * 83492791u)) + uint32_t(x)) & mask_;
+    }
+    uint32_t bucket(const Vector3<T> &p) const { return bucket(cell_coord(p.x), cell_coord(p.y), cell_coord(p.z)); }
+    // range of the cells occupied by the points
+    void compute_bounds(const Vector3<T> *points, size_t count, unsigned threads);
+    // call f(index, dist2) for all the points of the buckets [first, last) (main and overflow tables) closer
+    // than sqrt(max_dist2) from q
+    template <typename F> void scan_range(uint32_t first, uint32_t last, const Vector3<T> &q, T max_dist2, F &f) const;
+    // order of the queries that follows the bucket order (for memory locality in the batch queries)
+    std::vector<uint32_t> query_order(const Vector3<T> *queries, size_t count) const;
+    // scan the row of cells [x0, x1] x {y} x {z}, skipping the buckets already in visited (sorted disjoint
+    // [first, last) ranges), and add the row to visited
+    template <typename F>
+    void scan_row(int32_t x0, int32_t x1, int32_t y, int32_t z, const Vector3<T> &q, T &max_dist2,
+                  std::vector<std::pair<uint32_t, uint32_t>> &visited, F &f) const;
+
+    T cell_size_;
+    T inv_cell_size_;
+    uint32_t mask_ = 0;
+    int32_t lo_[3] = {0, 0, 0}; // range of the occupied cells
+    int32_t hi_[3] = {-1, -1, -1};
+    std::vector<uint32_t> cell_start_;  // bucket b spans [cell_start_[b], cell_start_[b+1])
+    std::vector<Vector3<T>> points_;    // points sorted by bucket (infinity for the slots moved to overflow)
+    std::vector<uint32_t> indices_;     // original index of each sorted point
+    std::vector<uint32_t> ov_buckets_;  // overflow table (see update()): bucket, position and original index
+    std::vector<Vector3<T>> ov_points_; // of the points that left their bucket, sorted by bucket
+    std::vector<uint32_t> ov_indices_;
+};
+
+typedef SpatialHashGrid<float> SpatialHashGridf;
+typedef SpatialHashGrid<double> SpatialHashGridd;
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+template <typename T> constexpr uint32_t SpatialHashGrid<T>::invalid_index;
+
+template <typename T> void SpatialHashGrid<T>::build(const Vector3<T> *points, size_t count, unsigned threads) {
+    const size_t min_chunk = 16384;
+    size_t buckets = 64;
+    while (buckets < count)
+        buckets *= 2;
+    mask_ = uint32_t(buckets - 1);
+    // counting sort by bucket: parallel histogram, prefix sum, parallel scatter
+    std::vector<uint32_t> point_bucket(count);
+    std::unique_ptr<std::atomic<uint32_t>[]> counter(new std::atomic<uint32_t>[buckets]);
+    parallel_for(buckets, threads, min_chunk, [&](size_t, size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++)
+            counter[b].store(0, std::memory_order_relaxed);
+    });
+    parallel_for(count, threads, min_chunk, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            point_bucket[i] = bucket(points[i]);
+            counter[point_bucket[i]].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    cell_start_.resize(buckets + 1);
+    uint32_t sum = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        cell_start_[b] = sum;
+        sum += counter[b].load(std::memory_order_relaxed);
+        counter[b].store(cell_start_[b], std::memory_order_relaxed);
+    }
+    cell_start_[buckets] = sum;
+    indices_.resize(count);
+    parallel_for(count, threads, min_chunk, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            indices_[counter[point_bucket[i]].fetch_add(1, std::memory_order_relaxed)] = uint32_t(i);
+    });
+    // the scatter order within a bucket depends on the thread scheduling: sort the (few) points of each bucket
+    // by index so that the layout is deterministic, then gather the points in the bucket order
+    points_.resize(count);
+    parallel_for(buckets, threads, min_chunk, [&](size_t, size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++) {
+            uint32_t *first = indices_.data() + cell_start_[b];
+            uint32_t *last = indices_.data() + cell_start_[b + 1];
+            for (uint32_t *i = first + 1; i < last; i++) {
+                const uint32_t v = *i;
+                uint32_t *j = i;
+                for (; j > first && *(j - 1) > v; j--)
+                    *j = *(j - 1);
+                *j = v;
+            }
+            for (uint32_t *i = first; i < last; i++)
+                points_[i - indices_.data()] = points[*i];
+        }
+    });
+    ov_buckets_.clear();
+    ov_points_.clear();
+    ov_indices_.clear();
+    compute_bounds(points, count, threads);
+}
+
+template <typename T>
+void SpatialHashGrid<T>::compute_bounds(const Vector3<T> *points, size_t count, unsigned threads) {
+    const size_t min_chunk = 16384;
+    const size_t chunks = parallel_chunk_count(count, threads, min_chunk);
+    std::vector<int32_t> bounds(chunks * 6);
+    parallel_for(count, threads, min_chunk, [&](size_t chunk, size_t begin, size_t end) {
+        int32_t lo[3] = {std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::max(),
+                         std::numeric_limits<int32_t>::max()};
+        int32_t hi[3] = {std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::min(),
+                         std::numeric_limits<int32_t>::min()};
+        for (size_t i = begin; i < end; i++) {
+            const int32_t c[3] = {cell_coord(points[i].x), cell_coord(points[i].y), cell_coord(points[i].z)};
+            for (int a = 0; a < 3; a++) {
+                lo[a] = std::min(lo[a], c[a]);
+                hi[a] = std::max(hi[a], c[a]);
+            }
+        }
+        std::copy(lo, lo + 3, bounds.begin() + chunk * 6);
+        std::copy(hi, hi + 3, bounds.begin() + chunk * 6 + 3);
+    });
+    for (int a = 0; a < 3; a++) {
+        lo_[a] = std::numeric_limits<int32_t>::max();
+        hi_[a] = std::numeric_limits<int32_t>::min();
+        for (size_t c = 0; c < chunks; c++) {
+            lo_[a] = std::min(lo_[a], bounds[c * 6 + a]);
+            hi_[a] = std::max(hi_[a], bounds[c * 6 + 3 + a]);
+        }
+    }
+}
+
+template <typename T> void SpatialHashGrid<T>::update(const Vector3<T> *points, unsigned threads) {
+    const size_t count = indices_.size();
+    if (count == 0)
+        return;
+    const T inf = std::numeric_limits<T>::infinity();
+    // points that stay in their bucket are updated in place, the others are collected per chunk
+    const size_t min_chunk = 16384;
+    std::vector<std::vector<uint32_t>> moved(parallel_chunk_count(count, threads, min_chunk));
+    parallel_for(count, threads, min_chunk, [&](size_t chunk, size_t begin, size_t end) {
+        size_t b = std::upper_bound(cell_start_.begin(), cell_start_.end(), uint32_t(begin)) - cell_start_.begin() - 1;
+        for (size_t i = begin; i < end; i++) {
+            while (cell_start_[b + 1] <= i)
+                b++;
+            if (points_[i].x == inf)
+                continue; // already in overflow
+            const Vector3<T> &p = points[indices_[i]];
+            if (bucket(p) == b) {
+                points_[i] = p;
+            } else {
+                points_[i] = Vector3<T>(inf, inf, inf);
+                moved[chunk].push_back(indices_[i]);
+            }
+        }
+    });
+    for (auto &m : moved)
+        ov_indices_.insert(ov_indices_.end(), m.begin(), m.end());
+    // rebuild when the overflow holds more than 1/16 of the points. The floor of 1024 points keeps small grids
+    // from being rebuilt at every update: searching a short overflow table is cheaper than a rebuild.
+    if (ov_indices_.size() > std::max<size_t>(1024, count / 16)) {
+        build(points, count, threads);
+        return;
+    }
+    // rebuild the (small) overflow table, sorted by (bucket, index)
+    std::vector<std::pair<uint32_t, uint32_t>> ov(ov_indices_.size());
+    for (size_t i = 0; i < ov.size(); i++)
+        ov[i] = std::make_pair(bucket(points[ov_indices_[i]]), ov_indices_[i]);
+    std::sort(ov.begin(), ov.end());
+    ov_buckets_.resize(ov.size());
+    ov_points_.resize(ov.size());
+    for (size_t i = 0; i < ov.size(); i++) {
+        ov_buckets_[i] = ov[i].first;
+        ov_indices_[i] = ov[i].second;
+        ov_points_[i] = points[ov[i].second];
+    }
+    compute_bounds(points, count, threads);
+}
+
+template <typename T>
+template <typename F>
+inline void SpatialHashGrid<T>::scan_range(uint32_t first, uint32_t last, const Vector3<T> &q, T max_dist2,
+                                           F &f) const {
+    for (uint32_t i = cell_start_[first], end = cell_start_[last]; i < end; i++) {
+        const T d2 = length2(points_[i] - q);
+        if (d2 <= max_dist2)
+            f(indices_[i], d2);
+    }
+    if (!ov_buckets_.empty()) {
+        auto it = std::lower_bound(ov_buckets_.begin(), ov_buckets_.end(), first);
+        for (size_t i = it - ov_buckets_.begin(); i < ov_buckets_.size() && ov_buckets_[i] < last; i++) {
+            const T d2 = length2(ov_points_[i] - q);
+            if (d2 <= max_dist2)
+                f(ov_indices_[i], d2);
+        }
+    }
+}
+
+template <typename T>
+template <typename F>
+void SpatialHashGrid<T>::scan_row(int32_t x0, int32_t x1, int32_t y, int32_t z, const Vector3<T> &q, T &max_dist2,
+                                  std::vector<std::pair<uint32_t, uint32_t>> &visited, F &f) const {
+    const uint32_t first = bucket(x0, y, z);
+    const uint32_t len = uint32_t(std::min<int64_t>(int64_t(x1) - x0 + 1, int64_t(mask_) + 1));
+    // the row wraps around the end of the table in at most two ranges
+    const uint32_t ranges[2][2] = {{first, uint32_t(std::min<uint64_t>(uint64_t(first) + len, uint64_t(mask_) + 1))},
+                                   {0, uint32_t(std::max<int64_t>(int64_t(first) + len - int64_t(mask_) - 1, 0))}};
+    for (int r = 0; r < 2; r++) {
+        const uint32_t a = ranges[r][0], b = ranges[r][1];
+        if (a >= b)
+            continue;
+        // scan the gaps between the visited ranges
+        auto it = std::upper_bound(visited.begin(), visited.end(), a,
+                                   [](uint32_t v, const std::pair<uint32_t, uint32_t> &e) { return v < e.second; });
+        auto lo = it;
+        uint32_t cur = a;
+        while (cur < b) {
+            if (it != visited.end() && it->first <= cur) {
+                cur = std::max(cur, it->second);
+                ++it;
+                continue;
+            }
+            const uint32_t next = it != visited.end() ? std::min(b, it->first) : b;
+            scan_range(cur, next, q, max_dist2, f);
+            cur = next;
+        }
+        // merge [a, b) with the visited ranges it overlaps or touches
+        if (lo != visited.begin() && (lo - 1)->second >= a)
+            --lo;
+        auto hi = lo;
+        uint32_t ma = a, mb = b;
+        while (hi != visited.end() && hi->first <= b) {
+            ma = std::min(ma, hi->first);
+            mb = std::max(mb, hi->second);
+            ++hi;
+        }
+        lo = visited.erase(lo, hi);
+        visited.insert(lo, std::make_pair(ma, mb));
+    }
+}
+
+template <typename T>
+void SpatialHashGrid<T>::radius_search(const Vector3<T> &q, T radius, std::vector<uint32_t> &out) const {
+    if (indices_.empty())
+        return;
+    const int32_t x0 = std::max(cell_coord(q.x - radius), lo_[0]), x1 = std::min(cell_coord(q.x + radius), hi_[0]);
+    const int32_t y0 = std::max(cell_coord(q.y - radius), lo_[1]), y1 = std::min(cell_coord(q.y + radius), hi_[1]);
+    const int32_t z0 = std::max(cell_coord(q.z - radius), lo_[2]), z1 = std::min(cell_coord(q.z + radius), hi_[2]);
+    if (x0 > x1 || y0 > y1 || z0 > z1)
+        return;
+    const T r2 = radius * radius;
+    auto add = [&out](uint32_t index, T) { out.push_back(index); };
+    // cells covered by the query, in floating point (the volume of a huge query does not fit in 64 bits)
+    const double cells = double(int64_t(x1) - x0 + 1) * double(int64_t(y1) - y0 + 1) * double(int64_t(z1) - z0 + 1);
+    if (cells > double(bucket_count())) {
+        // the query covers more cells than there are buckets: scanning everything once is cheaper
+        scan_range(0, mask_ + 1, q, r2, add);
+        return;
+    }
+    // bucket ranges of the rows along x; a row wraps around the end of the table in at most two ranges.
+    // Different rows can hash to overlapping buckets: the ranges are sorted and merged, so that each bucket
+    // is scanned only once. The (common) small queries use a local array.
+    const size_t rows = size_t(y1 - y0 + 1) * size_t(z1 - z0 + 1);
+    std::pair<uint32_t, uint32_t> local[64];
+    std::vector<std::pair<uint32_t, uint32_t>> heap_ranges;
+    std::pair<uint32_t, uint32_t> *ranges = local;
+    if (2 * rows > 64) {
+        heap_ranges.resize(2 * rows);
+        ranges = heap_ranges.data();
+    }
+    const uint32_t len = uint32_t(x1 - x0 + 1);
+    size_t n = 0;
+    for (int32_t z = z0; z <= z1; z++) {
+        for (int32_t y = y0; y <= y1; y++) {
+            const uint32_t first = bucket(x0, y, z);
+            if (first + uint64_t(len) <= uint64_t(mask_) + 1) {
+                ranges[n++] = std::make_pair(first, first + len);
+            } else {
+                ranges[n++] = std::make_pair(first, mask_ + 1);
+                ranges[n++] = std::make_pair(0u, uint32_t(first + uint64_t(len) - mask_ - 1));
+            }
+        }
+    }
+    std::sort(ranges, ranges + n);
+    uint32_t a = ranges[0].first, b = ranges[0].second;
+    for (size_t i = 1; i < n; i++) {
+        if (ranges[i].first > b) {
+            scan_range(a, b, q, r2, add);
+            a = ranges[i].first;
+        }
+        b = std::max(b, ranges[i].second);
+    }
+    scan_range(a, b, q, r2, add);
+}
+
+template <typename T>
+size_t SpatialHashGrid<T>::knn_search(const Vector3<T> &q, size_t k, uint32_t *indices, T *dist2) const {
+    const T inf = std::numeric_limits<T>::infinity();
+    // max-heap of the best k candidates, (dist2, index)
+    std::vector<std::pair<T, uint32_t>> best;
+    best.reserve(k);
+    T worst = inf; // current k-th distance (infinity until k candidates are found)
+    auto add = [&](uint32_t index, T d2) {
+        if (!(d2 < inf))
+            return; // slot moved to the overflow table
+        if (best.size() < k) {
+            best.push_back(std::make_pair(d2, index));
+            std::push_heap(best.begin(), best.end());
+            if (best.size() == k)
+                worst = best.front().first;
+        } else if (d2 < worst) {
+            std::pop_heap(best.begin(), best.end());
+            best.back() = std::make_pair(d2, index);
+            std::push_heap(best.begin(), best.end());
+            worst = best.front().first;
+        }
+    };
+    if (k > 0 && !indices_.empty()) {
+        // visit the cells in cubes of increasing half size r around the cell of q (the buckets of the inner cubes
+        // are skipped). The search stops when the k-th candidate is closer than the occupied cells outside the
+        // cube, or when the cube covers all the occupied cells.
+        // The smaller cubes contain no occupied cells when q is outside the grid: the first cube is the one that
+        // reaches the occupied range (Chebyshev distance in cells), so far queries do not walk the empty space.
+        const int32_t c[3] = {cell_coord(q.x), cell_coord(q.y), cell_coord(q.z)};
+        int64_t r0 = 0;
+        for (int a = 0; a < 3; a++)
+            r0 = std::max(r0, std::max(int64_t(lo_[a]) - c[a], int64_t(c[a]) - hi_[a]));
+        std::vector<std::pair<uint32_t, uint32_t>> visited;
+        for (int64_t r = r0;; r++) {
+            int32_t b0[3], b1[3]; // the cube clipped to the occupied range
+            for (int a = 0; a < 3; a++) {
+                b0[a] = int32_t(std::max(c[a] - r, int64_t(lo_[a])));
+                b1[a] = int32_t(std::min(c[a] + r, int64_t(hi_[a])));
+            }
+            for (int32_t z = b0[2]; z <= b1[2]; z++)
+                for (int32_t y = b0[1]; y <= b1[1]; y++)
+                    if (b0[0] <= b1[0])
+                        scan_row(b0[0], b1[0], y, z, q, worst, visited, add);
+            // distance from q to the occupied cells outside the cube (at least r * cell_size, more for the clamped
+            // coordinates of a far query); infinity when the cube covers all the occupied cells
+            T reach = inf;
+            for (int a = 0; a < 3; a++) {
+                if (c[a] - r > lo_[a])
+                    reach = std::min(reach, q[a] - T(c[a] - r) * cell_size_);
+                if (c[a] + r < hi_[a])
+                    reach = std::min(reach, T(c[a] + r + 1) * cell_size_ - q[a]);
+            }
+            if (reach == inf || (best.size() == k && worst <= reach * reach))
+                break;
+        }
+    }
+    std::sort_heap(best.begin(), best.end());
+    for (size_t i = 0; i < k; i++) {
+        indices[i] = i < best.size() ? best[i].second : invalid_index;
+        if (dist2)
+            dist2[i] = i < best.size() ? best[i].first : inf;
+    }
+    return best.size();
+}
+
+template <typename T>
+std::vector<uint32_t> SpatialHashGrid<T>::query_order(const Vector3<T> *queries, size_t count) const {
+    std::vector<std::pair<uint32_t, uint32_t>> keys(count);
+    for (size_t i = 0; i < count; i++)
+        keys[i] = std::make_pair(bucket(queries[i]), uint32_t(i));
+    std::sort(keys.begin(), keys.end());
+    std::vector<uint32_t> order(count);
+    for (size_t i = 0; i < count; i++)
+        order[i] = keys[i].second;
+    return order;
+}
+
+template <typename T>
+void SpatialHashGrid<T>::radius_search(const Vector3<T> *queries, size_t count, T radius,
+                                       std::vector<uint32_t> &offsets, std::vector<uint32_t> &indices,
+                                       unsigned threads) const {
+    // the queries are processed in bucket order, so that consecutive queries touch the same memory
+    const std::vector<uint32_t> order = query_order(queries, count);
+    const size_t min_chunk = 1024;
+    std::vector<std::vector<uint32_t>> found(parallel_chunk_count(count, threads, min_chunk));
+    std::vector<uint32_t> chunk_of(count), start(count), num(count);
+    parallel_for(count, threads, min_chunk, [&](size_t chunk, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const uint32_t qi = order[i];
+            chunk_of[qi] = uint32_t(chunk);
+            start[qi] = uint32_t(found[chunk].size());
+            radius_search(queries[qi], radius, found[chunk]);
+            num[qi] = uint32_t(found[chunk].size()) - start[qi];
+        }
+    });
+    // lay out the results in the original query order
+    offsets.resize(count + 1);
+    offsets[0] = 0;
+    for (size_t i = 0; i < count; i++)
+        offsets[i + 1] = offsets[i] + num[i];
+    indices.resize(offsets[count]);
+    parallel_for(count, threads, min_chunk, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const uint32_t *src = found[chunk_of[i]].data() + start[i];
+            std::copy(src, src + num[i], indices.begin() + offsets[i]);
+        }
+    });
+}
+
+template <typename T>
+void SpatialHashGrid<T>::knn_search(const Vector3<T> *queries, size_t count, size_t k, uint32_t *indices, T *dist2,
+                                    unsigned threads) const {
+    // the queries are processed in bucket order, so that consecutive queries touch the same memory
+    const std::vector<uint32_t> order = query_order(queries, count);
+    parallel_for(count, threads, 256, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const uint32_t qi = order[i];
+            knn_search(queries[qi], k, indices + size_t(qi) * k, dist2 ? dist2 + size_t(qi) * k : nullptr);
+        }
+    });
+}
+
+} // namespace math
@@ -0,0 +1,410 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+
+#pragma once
+
+#include "vmath.h"
+#include "vmath_geometry.h"
+#include "vmath_parallel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// BMI2 pdep/pext are used for the Morton codes when the compiler targets them (e.g. -mbmi2 or -march=native)
+#if !defined(VMATH_NO_SIMD) && defined(__BMI2__) && (defined(__x86_64__) || defined(_M_X64))
+#define VMATH_BMI2
+#include <immintrin.h>
+#endif
+
+namespace math {
+
+// //////////////// //
+// Morton (Z-order) //
+// //////////////// //
+
+/// 30-bit Morton code of 10-bit integer coordinates (bit 0 of the code is bit 0 of x, bit 1 of y, bit 2 of z)
+inline uint32_t morton_encode_30(uint32_t x, uint32_t y, uint32_t z);
+/// 10-bit integer coordinates of a 30-bit Morton code
+inline void morton_decode_30(uint32_t code, uint32_t &x, uint32_t &y, uint32_t &z);
+/// 63-bit Morton code of 21-bit integer coordinates
+inline uint64_t morton_encode_63(uint32_t x, uint32_t y, uint32_t z);
+/// 21-bit integer coordinates of a 63-bit Morton code
+inline void morton_decode_63(uint64_t code, uint32_t &x, uint32_t &y, uint32_t &z);
+
+// ///////////// //
+// Hilbert curve //
+// ///////////// //
+
+/// 30-bit index along the 3D Hilbert curve of 10-bit integer coordinates. Consecutive indices are neighboring
+/// cells, which gives a better locality than the Morton order at a higher cost per key.
+inline uint32_t hilbert_encode_30(uint32_t x, uint32_t y, uint32_t z);
+/// 10-bit integer coordinates of a 30-bit Hilbert index
+inline void hilbert_decode_30(uint32_t code, uint32_t &x, uint32_t &y, uint32_t &z);
+/// 63-bit index along the 3D Hilbert curve of 21-bit integer coordinates
+inline uint64_t hilbert_encode_63(uint32_t x, uint32_t y, uint32_t z);
+/// 21-bit integer coordinates of a 63-bit Hilbert index
+inline void hilbert_decode_63(uint64_t code, uint32_t &x, uint32_t &y, uint32_t &z);
+
+// //////////// //
+// spatial sort //
+// //////////// //
+
+/// space filling curves available for the spatial keys
+enum class SpaceFillingCurve { morton, hilbert };
+
+/// 63-bit spatial keys of an array of points: the points are quantized to 21 bits per axis inside bounds
+/// (points outside are clamped) and mapped along the curve. Parallel over threads (0 = hardware threads).
+template <typename T>
+void spatial_keys(const Vector3<T> *points, size_t count, const AABB<T> &bounds, SpaceFillingCurve curve,
+                  uint64_t *keys, unsigned threads = 0);
+/// stable radix sort of 64-bit keys: one MSD pass on the 11 most significant bits in use, then LSD passes with
+/// 8-bit digits inside each (cache resident) bucket, skipping the digits where all its keys are equal.
+/// Parallel over threads (0 = hardware threads); the result does not depend on the number of threads.
+/// @param permutation output: keys[permutation[i]] is the i-th smallest key. count must be < 2^32.
+/// @param sorted_keys optional output of the sorted keys
+inline void radix_sort(const uint64_t *keys, size_t count, uint32_t *permutation, uint64_t *sorted_keys = nullptr,
+                       unsigned threads = 0);
+/// permutation that sorts an array of points along a space filling curve over their bounding box
+template <typename T>
+void spatial_sort(const Vector3<T> *points, size_t count, uint32_t *permutation,
+                  SpaceFillingCurve curve = SpaceFillingCurve::morton, unsigned threads = 0);
+/// gather out[i] = in[permutation[i]], e.g. to reorder a point array (or any attribute array) after spatial_sort()
+template <typename V>
+void apply_permutation(const V *in, const uint32_t *permutation, size_t count, V *out, unsigned threads = 0);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+// spread the lower 10 bits of v so that there are two zero bits between each bit
+inline uint32_t morton_spread_10(uint32_t v) {
+    v &= 0x000003ffu;
+    v = (v | (v << 16)) & 0x030000ffu;
+    v = (v | (v << 8)) & 0x0300f00fu;
+    v = (v | (v << 4)) & 0x030c30c3u;
+    v = (v | (v << 2)) & 0x09249249u;
+    return v;
+}
+// inverse of morton_spread_10
+inline uint32_t morton_compact_10(uint32_t v) {
+    v &= 0x09249249u;
+    v = (v ^ (v >> 2)) & 0x030c30c3u;
+    v = (v ^ (v >> 4)) & 0x0300f00fu;
+    v = (v ^ (v >> 8)) & 0xff0000ffu;
+    v = (v ^ (v >> 16)) & 0x000003ffu;
+    return v;
+}
+// spread the lower 21 bits of v so that there are two zero bits between each bit
+inline uint64_t morton_spread_21(uint64_t v) {
+    v &= 0x1fffffull;
+    v = (v | (v << 32)) & 0x001f00000000ffffull;
+    v = (v | (v << 16)) & 0x001f0000ff0000ffull;
+    v = (v | (v << 8)) & 0x100f00f00f00f00full;
+    v = (v | (v << 4)) & 0x10c30c30c30c30c3ull;
+    v = (v | (v << 2)) & 0x1249249249249249ull;
+    return v;
+}
+// inverse of morton_spread_21
+inline uint32_t morton_compact_21(uint64_t v) {
+    v &= 0x1249249249249249ull;
+    v = (v ^ (v >> 2)) & 0x10c30c30c30c30c3ull;
+    v = (v ^ (v >> 4)) & 0x100f00f00f00f00full;
+    v = (v ^ (v >> 8)) & 0x001f0000ff0000ffull;
+    v = (v ^ (v >> 16)) & 0x001f00000000ffffull;
+    v = (v ^ (v >> 32)) & 0x1fffffull;
+    return uint32_t(v);
+}
+
+// Hilbert transform from J. Skilling, "Programming the Hilbert curve" (2004): the coordinates are converted
+// in place to the "transposed" Hilbert index, whose bits interleaved (x[0] most significant) give the index
+inline void hilbert_axes_to_transpose(uint32_t x[3], int bits) {
+    const uint32_t m = 1u << (bits - 1);
+    for (uint32_t q = m; q > 1; q >>= 1) {
+        const uint32_t p = q - 1;
+        // branchless form of: if (x[i] & q) invert the low bits of x[0], else exchange them with x[i]
+        for (int i = 0; i < 3; i++) {
+            const uint32_t set = 0u - ((x[i] & q) ? 1u : 0u);
+            const uint32_t t = (x[0] ^ x[i]) & p & ~set;
+            x[0] ^= (p & set) ^ t;
+            x[i] ^= t;
+        }
+    }
+    // Gray encode
+    x[1] ^= x[0];
+    x[2] ^= x[1];
+    uint32_t t = 0;
+    for (uint32_t q = m; q > 1; q >>= 1)
+        if (x[2] & q)
+            t ^= q - 1;
+    x[0] ^= t;
+    x[1] ^= t;
+    x[2] ^= t;
+}
+inline void hilbert_transpose_to_axes(uint32_t x[3], int bits) {
+    const uint32_t n = 2u << (bits - 1);
+    // Gray decode
+    uint32_t t = x[2] >> 1;
+    x[2] ^= x[1];
+    x[1] ^= x[0];
+    x[0] ^= t;
+    // undo excess work
+    for (uint32_t q = 2; q != n; q <<= 1) {
+        const uint32_t p = q - 1;
+        for (int i = 2; i >= 0; i--) {
+            const uint32_t set = 0u - ((x[i] & q) ? 1u : 0u);
+            t = (x[0] ^ x[i]) & p & ~set;
+            x[0] ^= (p & set) ^ t;
+            x[i] ^= t;
+        }
+    }
+}
+} // namespace detail
+
+inline uint32_t morton_encode_30(uint32_t x, uint32_t y, uint32_t z) {
+#if defined(VMATH_BMI2)
+    return _pdep_u32(x, 0x09249249u) | _pdep_u32(y, 0x12492492u) | _pdep_u32(z, 0x24924924u);
+#else
+    return detail::morton_spread_10(x) | (detail::morton_spread_10(y) << 1) | (detail::morton_spread_10(z) << 2);
+#endif
+}
+
+inline void morton_decode_30(uint32_t code, uint32_t &x, uint32_t &y, uint32_t &z) {
+#if defined(VMATH_BMI2)
+    x = _pext_u32(code, 0x09249249u);
+    y = _pext_u32(code, 0x12492492u);
+    z = _pext_u32(code, 0x24924924u);
+#else
+    x = detail::morton_compact_10(code);
+    y = detail::morton_compact_10(code >> 1);
+    z = detail::morton_compact_10(code >> 2);
+#endif
+}
+
+inline uint64_t morton_encode_63(uint32_t x, uint32_t y, uint32_t z) {
+#if defined(VMATH_BMI2)
+    return _pdep_u64(x, 0x1249249249249249ull) | _pdep_u64(y, 0x2492492492492492ull) |
+           _pdep_u64(z, 0x4924924924924924ull);
+#else
+    return detail::morton_spread_21(x) | (detail::morton_spread_21(y) << 1) | (detail::morton_spread_21(z) << 2);
+#endif
+}
+
+inline void morton_decode_63(uint64_t code, uint32_t &x, uint32_t &y, uint32_t &z) {
+#if defined(VMATH_BMI2)
+    x = uint32_t(_pext_u64(code, 0x1249249249249249ull));
+    y = uint32_t(_pext_u64(code, 0x2492492492492492ull));
+    z = uint32_t(_pext_u64(code, 0x4924924924924924ull));
+#else
+    x = detail::morton_compact_21(code);
+    y = detail::morton_compact_21(code >> 1);
+    z = detail::morton_compact_21(code >> 2);
+#endif
+}
+
+inline uint32_t hilbert_encode_30(uint32_t x, uint32_t y, uint32_t z) {
+    uint32_t t[3] = {x & 0x3ffu, y & 0x3ffu, z & 0x3ffu};
+    detail::hilbert_axes_to_transpose(t, 10);
+    return morton_encode_30(t[2], t[1], t[0]);
+}
+
+inline void hilbert_decode_30(uint32_t code, uint32_t &x, uint32_t &y, uint32_t &z) {
+    uint32_t t[3];
+    morton_decode_30(code, t[2], t[1], t[0]);
+    detail::hilbert_transpose_to_axes(t, 10);
+    x = t[0];
+    y = t[1];
+    z = t[2];
+}
+
+inline uint64_t hilbert_encode_63(uint32_t x, uint32_t y, uint32_t z) {
+    uint32_t t[3] = {x & 0x1fffffu, y & 0x1fffffu, z & 0x1fffffu};
+    detail::hilbert_axes_to_transpose(t, 21);
+    return morton_encode_63(t[2], t[1], t[0]);
+}
+
+inline void hilbert_decode_63(uint64_t code, uint32_t &x, uint32_t &y, uint32_t &z) {
+    uint32_t t[3];
+    morton_decode_63(code, t[2], t[1], t[0]);
+    detail::hilbert_transpose_to_axes(t, 21);
+    x = t[0];
+    y = t[1];
+    z = t[2];
+}
+
+template <typename T>
+void spatial_keys(const Vector3<T> *points, size_t count, const AABB<T> &bounds, SpaceFillingCurve curve,
+                  uint64_t *keys, unsigned threads) {
+    const T cells = T(0x1fffff);
+    const Vector3<T> ext = bounds.max - bounds.min;
+    const Vector3<T> scale(ext.x > T(0) ? cells / ext.x : T(0), ext.y > T(0) ? cells / ext.y : T(0),
+                           ext.z > T(0) ? cells / ext.z : T(0));
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const Vector3<T> d = points[i] - bounds.min;
+            const uint32_t x = uint32_t(std::min(std::max(d.x * scale.x, T(0)), cells));
+            const uint32_t y = uint32_t(std::min(std::max(d.y * scale.y, T(0)), cells));
+            const uint32_t z = uint32_t(std::min(std::max(d.z * scale.z, T(0)), cells));
+            keys[i] = curve == SpaceFillingCurve::hilbert ? hilbert_encode_63(x, y, z) : morton_encode_63(x, y, z);
+        }
+    });
+}
+
+namespace detail {
+// stable LSD radix sort of the (key, index) pairs k[0..n), i[0..n) on the bits [0, bits) of the keys, with
+// 8-bit digits; the digits that are the same for all the keys are skipped. k2 and i2 are scratch arrays of
+// size n. Used on the (cache resident) buckets of the MSD pass of radix_sort().
+inline void radix_sort_lsd(uint64_t *k, uint32_t *i, size_t n, int bits, uint64_t *k2, uint32_t *i2) {
+    if (n < 32) {
+        // insertion sort (stable) for the small buckets
+        for (size_t a = 1; a < n; a++) {
+            const uint64_t key = k[a];
+            const uint32_t idx = i[a];
+            size_t b = a;
+            for (; b > 0 && k[b - 1] > key; b--) {
+                k[b] = k[b - 1];
+                i[b] = i[b - 1];
+            }
+            k[b] = key;
+            i[b] = idx;
+        }
+        return;
+    }
+    uint64_t *ks = k, *kd = k2;
+    uint32_t *is = i, *id = i2;
+    for (int shift = 0; shift < bits; shift += 8) {
+        uint32_t hist[256] = {0};
+        for (size_t a = 0; a < n; a++)
+            hist[(ks[a] >> shift) & 0xff]++;
+        if (hist[(ks[0] >> shift) & 0xff] == n)
+            continue;
+        uint32_t sum = 0;
+        for (int d = 0; d < 256; d++) {
+            const uint32_t c = hist[d];
+            hist[d] = sum;
+            sum += c;
+        }
+        for (size_t a = 0; a < n; a++) {
+            const uint32_t pos = hist[(ks[a] >> shift) & 0xff]++;
+            kd[pos] = ks[a];
+            id[pos] = is[a];
+        }
+        std::swap(ks, kd);
+        std::swap(is, id);
+    }
+    if (ks != k) {
+        std::copy(ks, ks + n, k);
+        std::copy(is, is + n, i);
+    }
+}
+} // namespace detail
+
+inline void radix_sort(const uint64_t *keys, size_t count, uint32_t *permutation, uint64_t *sorted_keys,
+                       unsigned threads) {
+    // A single MSD pass on the 11 most significant (non zero) bits scatters the keys to 2048 buckets, which are
+    // then small enough to be sorted in cache by LSD passes on the remaining bits. Only the MSD pass goes
+    // through main memory; both steps are stable, so the result is the same as a full LSD sort.
+    const size_t min_chunk = 65536;
+    const size_t chunks = parallel_chunk_count(count, threads, min_chunk);
+    std::vector<uint64_t> chunk_or(chunks, 0);
+    parallel_for(count, threads, min_chunk, [&](size_t chunk, size_t begin, size_t end) {
+        uint64_t v = 0;
+        for (size_t i = begin; i < end; i++)
+            v |= keys[i];
+        chunk_or[chunk] = v;
+    });
+    uint64_t all = 0;
+    for (uint64_t v : chunk_or)
+        all |= v;
+    int bits = 0;
+    while (bits < 64 && (all >> bits) != 0)
+        bits++;
+    const int msd_bits = std::min(bits, 11);
+    const int shift = bits - msd_bits;
+    const size_t buckets = size_t(1) << msd_bits;
+    // MSD pass: per-chunk histograms, exclusive prefix sum in (digit, chunk) order, stable scatter
+    std::vector<uint32_t> offset(chunks * buckets, 0);
+    parallel_for(count, threads, min_chunk, [&](size_t chunk, size_t begin, size_t end) {
+        uint32_t *h = offset.data() + chunk * buckets;
+        for (size_t i = begin; i < end; i++)
+            h[shift < 64 ? keys[i] >> shift : 0]++;
+    });
+    std::vector<uint32_t> bucket_start(buckets + 1);
+    uint32_t sum = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        bucket_start[b] = sum;
+        for (size_t c = 0; c < chunks; c++) {
+            const uint32_t n = offset[c * buckets + b];
+            offset[c * buckets + b] = sum;
+            sum += n;
+        }
+    }
+    bucket_start[buckets] = sum;
+    std::vector<uint64_t> sorted(count);
+    parallel_for(count, threads, min_chunk, [&](size_t chunk, size_t begin, size_t end) {
+        uint32_t *o = offset.data() + chunk * buckets;
+        for (size_t i = begin; i < end; i++) {
+            const uint32_t pos = o[shift < 64 ? keys[i] >> shift : 0]++;
+            sorted[pos] = keys[i];
+            permutation[pos] = uint32_t(i);
+        }
+    });
+    // LSD passes inside each bucket
+    if (shift > 0) {
+        parallel_for(buckets, threads, 16, [&](size_t, size_t begin, size_t end) {
+            size_t largest = 0;
+            for (size_t b = begin; b < end; b++)
+                largest = std::max<size_t>(largest, bucket_start[b + 1] - bucket_start[b]);
+            std::vector<uint64_t> k2(largest);
+            std::vector<uint32_t> i2(largest);
+            for (size_t b = begin; b < end; b++)
+                detail::radix_sort_lsd(sorted.data() + bucket_start[b], permutation + bucket_start[b],
+                                       bucket_start[b + 1] - bucket_start[b], shift, k2.data(), i2.data());
+        });
+    }
+    if (sorted_keys)
+        std::copy(sorted.begin(), sorted.end(), sorted_keys);
+}
+
+template <typename T>
+void spatial_sort(const Vector3<T> *points, size_t count, uint32_t *permutation, SpaceFillingCurve curve,
+                  unsigned threads) {
+    if (count == 0)
+        return;
+    std::vector<uint64_t> keys(count);
+    spatial_keys(points, count, fit_aabb(points, count), curve, keys.data(), threads);
+    radix_sort(keys.data(), count, permutation, nullptr, threads);
+}
+
+template <typename V>
+void apply_permutation(const V *in, const uint32_t *permutation, size_t count, V *out, unsigned threads) {
+    parallel_for(count, threads, 16384, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            out[i] = in[permutation[i]];
+    });
+}
+
+} // namespace math
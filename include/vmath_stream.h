@@ -0,0 +1,453 @@
+// ///////////////////////////////////////////////////////////////////////////// //
+// The MIT License (MIT)                                                         //
+//                                                                               //
+// Copyright (c) 2012-2021, Davide Bacchet (davide.bacchet@gmail.com)            //
+//                                                                               //
+// Permission is hereby granted, free of charge, to any person obtaining a copy  //
+// of this software and associated documentation files (the "Software"), to deal //
+// in the Software without restriction, including without limitation the rights  //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell     //
+// copies of the Software, and to permit persons to whom the Software is         //
+// furnished to do so, subject to the following conditions:                      //
+//                                                                               //
+// The above copyright notice and this permission notice shall be included in    //
+// all copies or substantial portions of the Software.                           //
+//                                                                               //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR    //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,      //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE   //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER        //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN     //
+// THE SOFTWARE.                                                                 //
+// ///////////////////////////////////////////////////////////////////////////// //
+#pragma once
+
+#include "vmath_parallel.h"
+#include "vmath_types.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define VMATH_PREAD
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace math {
+
+/// transform count points: out[i] = t.transform(in[i]). The rotation is converted to a matrix once, so the
+/// results can differ from Transform::transform() in the last bits. in and out can be the same array.
+template <typename T>
+void transform_points(const Transform<T> &t, const Vector3<T> *in, Vector3<T> *out, size_t count,
+                      unsigned threads = 0);
+
+/// options of stream_points()
+struct StreamOptions {
+    size_t chunk_points = size_t(1) << 20; ///< points read, processed and written at once
+    unsigned buffers = 3;                  ///< chunks in flight: 1 = no overlap, 2 = double buffering, 3 = the
+                                           ///< read, compute and write of consecutive chunks all overlap
+    unsigned threads = 0;                  ///< threads for the kernel (0 = default_thread_count())
+    uint64_t input_offset = 0;             ///< byte offset of the first point in the input file
+    uint64_t output_offset = 0;            ///< byte offset of the first point in the output file
+    uint64_t count = uint64_t(-1);         ///< points to process; by default all the points in the input file
+};
+
+/// result of stream_points()
+struct StreamStats {
+    uint64_t points = 0;        ///< points processed
+    uint64_t bytes = 0;         ///< bytes read (the same amount is written)
+    double seconds = 0.0;       ///< total time
+    size_t memory = 0;          ///< size of the chunk buffers
+    std::string error;          ///< reason of the failure, if any
+
+    /// throughput of the stage, in GB (of input) per second
+    double gb_per_s() const { return seconds > 0.0 ? double(bytes) / seconds * 1e-9 : 0.0; }
+};
+
+/// streaming pipeline stage for point files larger than memory: reads the Vector3<T> array stored in the input
+/// file in chunks, calls kernel(points, n) on each chunk (split between options.threads threads, so the kernel
+/// must be thread safe) and writes the modified chunk to the output file. A reader and a writer thread run the
+/// I/O of the other chunks meanwhile, and the memory used is bounded by options.buffers chunks.
+/// The output is created (or truncated), unless it is the input file (through any path, where the file identity is
+/// available), which is then modified in place: options.output_offset must not be beyond options.input_offset.
+/// The bytes before options.output_offset are left to the caller. The input is validated before the output is
+/// created or truncated. An exception thrown by the kernel is passed on to the caller once the I/O threads stop.
+/// @return false if a file cannot be read or written; stats->error gives the reason
+template <typename T, typename F>
+bool stream_points(const std::string &input, const std::string &output, F kernel,
+                   const StreamOptions &options = StreamOptions(), StreamStats *stats = nullptr);
+
+/// stream_points() with the transform_points() kernel
+template <typename T>
+bool transform_points_file(const std::string &input, const std::string &output, const Transform<T> &t,
+                           const StreamOptions &options = StreamOptions(), StreamStats *stats = nullptr);
+
+// ////////////// //
+// implementation //
+// ////////////// //
+
+namespace detail {
+
+// row major rotation matrix and translation of a rigid transform
+template <typename T> struct PointTransform {
+    T m[9];
+    T p[3];
+
+    explicit PointTransform(const Transform<T> &t) {
+        const Quaternion<T> &q = t.q;
+        const T xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        const T xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        const T wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+        m[0] = T(1) - T(2) * (yy + zz);
+        m[1] = T(2) * (xy - wz);
+        m[2] = T(2) * (xz + wy);
+        m[3] = T(2) * (xy + wz);
+        m[4] = T(1) - T(2) * (xx + zz);
+        m[5] = T(2) * (yz - wx);
+        m[6] = T(2) * (xz - wy);
+        m[7] = T(2) * (yz + wx);
+        m[8] = T(1) - T(2) * (xx + yy);
+        p[0] = t.p.x;
+        p[1] = t.p.y;
+        p[2] = t.p.z;
+    }
+
+    void apply(const Vector3<T> *in, Vector3<T> *out, size_t count) const {
+        const T m0 = m[0], m1 = m[1], m2 = m[2], m3 = m[3], m4 = m[4], m5 = m[5], m6 = m[6], m7 = m[7], m8 = m[8];
+        const T px = p[0], py = p[1], pz = p[2];
+        for (size_t i = 0; i < count; i++) {
+            const T x = in[i].x, y = in[i].y, z = in[i].z;
+            out[i].x = m0 * x + m1 * y + m2 * z + px;
+            out[i].y = m3 * x + m4 * y + m5 * z + py;
+            out[i].z = m6 * x + m7 * y + m8 * z + pz;
+        }
+    }
+};
+
+// blocking queue of chunk indices between the stages of stream_points()
+class ChunkQueue {
+  public:
+    void push(size_t v) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            items_.push_back(v);
+        }
+        cv_.notify_one();
+    }
+    // false once cancelled
+    bool pop(size_t &v) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return cancelled_ || !items_.empty(); });
+        if (cancelled_)
+            return false;
+        v = items_.front();
+        items_.pop_front();
+        return true;
+    }
+    void cancel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cancelled_ = true;
+        }
+        cv_.notify_all();
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<size_t> items_;
+    bool cancelled_ = false;
+};
+
+// joins the reader and writer threads of stream_points() on every exit path: when the kernel throws, the threads
+// still wait on the queues, which are cancelled first so that they return
+class StageJoiner {
+  public:
+    StageJoiner(std::initializer_list<std::thread *> threads, std::initializer_list<ChunkQueue *> queues)
+        : threads_(threads), queues_(queues) {}
+    StageJoiner(const StageJoiner &) = delete;
+    StageJoiner &operator=(const StageJoiner &) = delete;
+    ~StageJoiner() {
+        for (std::thread *t : threads_) {
+            if (t->joinable()) {
+                for (ChunkQueue *q : queues_)
+                    q->cancel();
+                break;
+            }
+        }
+        join();
+    }
+    void join() {
+        for (std::thread *t : threads_)
+            if (t->joinable())
+                t->join();
+    }
+
+  private:
+    std::vector<std::thread *> threads_;
+    std::vector<ChunkQueue *> queues_;
+};
+
+// positional reads and writes (pread/pwrite where available), so that the reader and the writer thread can use
+// the same file
+class StreamFile {
+  public:
+    StreamFile() = default;
+    StreamFile(const StreamFile &) = delete;
+    StreamFile &operator=(const StreamFile &) = delete;
+    ~StreamFile() { close(); }
+
+    // the file is created if write is set, but never truncated here (see truncate())
+    bool open(const std::string &path, bool write) {
+#if defined(VMATH_PREAD)
+        fd_ = ::open(path.c_str(), write ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+        return fd_ >= 0;
+#else
+        path_ = path;
+        file_ = std::fopen(path.c_str(), write ? "r+b" : "rb");
+        if (!file_ && write)
+            file_ = std::fopen(path.c_str(), "w+b");
+        return file_ != nullptr;
+#endif
+    }
+
+    bool truncate() {
+#if defined(VMATH_PREAD)
+        return ::ftruncate(fd_, 0) == 0;
+#else
+        file_ = std::freopen(path_.c_str(), "w+b", file_);
+        return file_ != nullptr;
+#endif
+    }
+
+    // true if both are open on the same file (device and inode); always false without pread, where the callers
+    // can only compare the paths
+    bool same_file(const StreamFile &other) const {
+#if defined(VMATH_PREAD)
+        struct stat a, b;
+        return fstat(fd_, &a) == 0 && fstat(other.fd_, &b) == 0 && a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+#else
+        (void)other;
+        return false;
+#endif
+    }
+
+    uint64_t size() {
+#if defined(VMATH_PREAD)
+        struct stat st;
+        return fstat(fd_, &st) == 0 ? uint64_t(st.st_size) : 0;
+#else
+        std::lock_guard<std::mutex> lock(mutex_);
+        return seek(0, SEEK_END) ? uint64_t(tell()) : 0;
+#endif
+    }
+
+    bool read(void *data, size_t len, uint64_t offset) {
+        char *p = static_cast<char *>(data);
+#if defined(VMATH_PREAD)
+        while (len > 0) {
+            const ssize_t r = ::pread(fd_, p, len, off_t(offset));
+            if (r <= 0)
+                return false;
+            p += r;
+            len -= size_t(r);
+            offset += uint64_t(r);
+        }
+        return true;
+#else
+        std::lock_guard<std::mutex> lock(mutex_);
+        return seek(offset, SEEK_SET) && std::fread(p, 1, len, file_) == len;
+#endif
+    }
+
+    bool write(const void *data, size_t len, uint64_t offset) {
+        const char *p = static_cast<const char *>(data);
+#if defined(VMATH_PREAD)
+        while (len > 0) {
+            const ssize_t r = ::pwrite(fd_, p, len, off_t(offset));
+            if (r <= 0)
+                return false;
+            p += r;
+            len -= size_t(r);
+            offset += uint64_t(r);
+        }
+        return true;
+#else
+        std::lock_guard<std::mutex> lock(mutex_);
+        return seek(offset, SEEK_SET) && std::fwrite(p, 1, len, file_) == len;
+#endif
+    }
+
+    bool close() {
+#if defined(VMATH_PREAD)
+        const bool ok = fd_ < 0 || ::close(fd_) == 0;
+        fd_ = -1;
+#else
+        const bool ok = !file_ || std::fclose(file_) == 0;
+        file_ = nullptr;
+#endif
+        return ok;
+    }
+
+  private:
+#if defined(VMATH_PREAD)
+    int fd_ = -1;
+#else
+    bool seek(uint64_t offset, int origin) {
+#if defined(_WIN32)
+        return _fseeki64(file_, int64_t(offset), origin) == 0;
+#else
+        return std::fseek(file_, long(offset), origin) == 0;
+#endif
+    }
+    uint64_t tell() {
+#if defined(_WIN32)
+        return uint64_t(_ftelli64(file_));
+#else
+        return uint64_t(std::ftell(file_));
+#endif
+    }
+    std::string path_;
+    std::FILE *file_ = nullptr;
+    std::mutex mutex_; // the position of the stream is shared by the reader and the writer
+#endif
+};
+
+} // namespace detail
+
+template <typename T>
+void transform_points(const Transform<T> &t, const Vector3<T> *in, Vector3<T> *out, size_t count,
+                      unsigned threads) {
+    const detail::PointTransform<T> m(t);
+    parallel_for(count, threads, size_t(1) << 16,
+                 [&](size_t, size_t begin, size_t end) { m.apply(in + begin, out + begin, end - begin); });
+}
+
+template <typename T, typename F>
+bool stream_points(const std::string &input, const std::string &output, F kernel, const StreamOptions &options,
+                   StreamStats *stats) {
+    static_assert(sizeof(Vector3<T>) == 3 * sizeof(T), "the points are stored as packed arrays of 3 scalars");
+    const auto start = std::chrono::steady_clock::now();
+    StreamStats result;
+    auto finish = [&](bool ok) {
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (stats)
+            *stats = result;
+        return ok;
+    };
+    auto fail = [&](const std::string &message) {
+        result.error = message;
+        return finish(false);
+    };
+
+    // all the checks are done before the output is truncated: it can be the input, through another path
+    detail::StreamFile in, out;
+    if (!in.open(input, false))
+        return fail("cannot open " + input);
+    const uint64_t size = in.size();
+    if (options.input_offset > size)
+        return fail("input offset beyond the end of " + input);
+    const uint64_t count = std::min(options.count, (size - options.input_offset) / sizeof(Vector3<T>));
+    if (options.count != uint64_t(-1) && options.count > count)
+        return fail("not enough points in " + input);
+    if (!out.open(output, true))
+        return fail("cannot create " + output);
+    const bool in_place = input == output || in.same_file(out);
+    // in place, the writer must stay behind the reader
+    if (in_place && options.output_offset > options.input_offset)
+        return fail("output offset beyond the input offset when writing in place " + input);
+    if (!in_place && !out.truncate())
+        return fail("cannot create " + output);
+
+    const size_t chunk = std::max<size_t>(1, options.chunk_points);
+    const uint64_t chunks = (count + chunk - 1) / chunk;
+    const size_t buffers = size_t(std::max<uint64_t>(1, std::min<uint64_t>(options.buffers, chunks)));
+    std::vector<std::vector<Vector3<T>>> buffer(buffers);
+    for (auto &e : buffer)
+        e.resize(size_t(std::min<uint64_t>(chunk, count)));
+    result.memory = buffers * buffer[0].size() * sizeof(Vector3<T>);
+
+    // chunk c goes through the buffer c % buffers: the reader fills it, the calling thread runs the kernel and the
+    // writer empties it, then hands it back to the reader for chunk c + buffers
+    auto points_in = [&](uint64_t c) { return size_t(std::min<uint64_t>(chunk, count - c * chunk)); };
+    detail::ChunkQueue free_queue, compute_queue, write_queue;
+    std::atomic<bool> failed(false);
+    std::string error;
+    std::mutex error_mutex;
+    auto cancel = [&](const std::string &message) {
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (error.empty())
+                error = message;
+        }
+        failed = true;
+        free_queue.cancel();
+        compute_queue.cancel();
+        write_queue.cancel();
+    };
+    for (size_t b = 0; b < buffers; b++)
+        free_queue.push(b);
+
+    std::thread reader, writer;
+    detail::StageJoiner joiner({&reader, &writer}, {&free_queue, &compute_queue, &write_queue});
+    reader = std::thread([&] {
+        size_t b;
+        for (uint64_t c = 0; c < chunks && free_queue.pop(b); c++) {
+            if (!in.read(buffer[b].data(), points_in(c) * sizeof(Vector3<T>),
+                         options.input_offset + c * chunk * sizeof(Vector3<T>))) {
+                cancel("cannot read " + input);
+                return;
+            }
+            compute_queue.push(b);
+        }
+    });
+    writer = std::thread([&] {
+        size_t b;
+        for (uint64_t c = 0; c < chunks && write_queue.pop(b); c++) {
+            if (!out.write(buffer[b].data(), points_in(c) * sizeof(Vector3<T>),
+                           options.output_offset + c * chunk * sizeof(Vector3<T>))) {
+                cancel("cannot write " + output);
+                return;
+            }
+            free_queue.push(b);
+        }
+    });
+    size_t b;
+    for (uint64_t c = 0; c < chunks && compute_queue.pop(b); c++) {
+        Vector3<T> *points = buffer[b].data();
+        parallel_for(points_in(c), options.threads, size_t(1) << 14,
+                     [&](size_t, size_t begin, size_t end) { kernel(points + begin, end - begin); });
+        write_queue.push(b);
+    }
+    joiner.join();
+
+    if (!out.close() && !failed)
+        cancel("cannot write " + output);
+    if (failed)
+        return fail(error);
+    result.points = count;
+    result.bytes = count * sizeof(Vector3<T>);
+    return finish(true);
+}
+
+template <typename T>
+bool transform_points_file(const std::string &input, const std::string &output, const Transform<T> &t,
+                           const StreamOptions &options, StreamStats *stats) {
+    const detail::PointTransform<T> m(t);
+    return stream_points<T>(input, output, [&m](Vector3<T> *p, size_t n) { m.apply(p, p, n); }, options, stats);
+}
+
+} // namespace math
@@ -35,6 +35,13 @@
 #include <cstring>
 #include <initializer_list>
 
+// SSE2 is part of the x86-64 baseline, so the hand-written kernels are enabled by default on that architecture.
+// Define VMATH_NO_SIMD to always use the generic implementations.
+#if !defined(VMATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define VMATH_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace math {
 
 // ///////// //
@@ -687,6 +694,92 @@ template <typename T> inline Vector3<T> operator*(const Matrix3<T> &m1, const Ve
                       m1.data[2] * rhs.x + m1.data[5] * rhs.y + m1.data[8] * rhs.z);
 }
 
+#if defined(VMATH_SSE2)
+// SSE2 kernels for the float/double 3x3 products. These are plain (non-template) overloads, so they are picked
+// over the generic templates above. The public layout is unchanged (9 packed scalars): the matrix is read and
+// written with the same chunks (data[0..3], data[4..7], data[8]) and the columns are rebuilt in padded registers
+// with shuffles, so nothing is accessed past data[8] and a product feeding the next one (e.g. a chain of
+// rotations) does not stall on store-to-load forwarding.
+inline void sse_load_cols3(const float *p, __m128 &c0, __m128 &c1, __m128 &c2) {
+    const __m128 a = _mm_loadu_ps(p);     // c0.x c0.y c0.z c1.x
+    const __m128 b = _mm_loadu_ps(p + 4); // c1.y c1.z c2.x c2.y
+    const __m128 c = _mm_load_ss(p + 8);  // c2.z
+    c0 = a;
+    c1 = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 3, 3)), b, _MM_SHUFFLE(1, 1, 2, 0));
+    c2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 0, 3, 2));
+}
+inline void sse_store_cols3(float *p, __m128 c0, __m128 c1, __m128 c2) {
+    const __m128 t = _mm_shuffle_ps(c0, c1, _MM_SHUFFLE(0, 0, 2, 2)); // c0.z c0.z c1.x c1.x
+    _mm_storeu_ps(p, _mm_shuffle_ps(c0, t, _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps(p + 4, _mm_shuffle_ps(c1, c2, _MM_SHUFFLE(1, 0, 2, 1)));
+    _mm_store_ss(p + 8, _mm_movehl_ps(c2, c2));
+}
+inline __m128 sse_mul_col3(__m128 c0, __m128 c1, __m128 c2, float x, float y, float z) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(x)), _mm_mul_ps(c1, _mm_set1_ps(y))),
+                      _mm_mul_ps(c2, _mm_set1_ps(z)));
+}
+inline Matrix3<float> operator*(const Matrix3<float> &m1, const Matrix3<float> &m2) {
+    __m128 c0, c1, c2;
+    sse_load_cols3(m1.data, c0, c1, c2);
+    const float *b = m2.data;
+    Matrix3<float> w;
+    sse_store_cols3(w.data, sse_mul_col3(c0, c1, c2, b[0], b[1], b[2]), sse_mul_col3(c0, c1, c2, b[3], b[4], b[5]),
+                    sse_mul_col3(c0, c1, c2, b[6], b[7], b[8]));
+    return w;
+}
+inline Vector3<float> operator*(const Matrix3<float> &m1, const Vector3<float> &rhs) {
+    // the matrix is usually not a freshly computed value here, so the columns are loaded directly
+    // (the last one ending at data[8] and shifted down)
+    const __m128 c2 = _mm_loadu_ps(m1.data + 5);
+    const __m128 r = sse_mul_col3(_mm_loadu_ps(m1.data), _mm_loadu_ps(m1.data + 3),
+                                  _mm_shuffle_ps(c2, c2, _MM_SHUFFLE(3, 3, 2, 1)), rhs.x, rhs.y, rhs.z);
+    Vector3<float> ret;
+    _mm_storel_pi(reinterpret_cast<__m64 *>(ret.ptr()), r);
+    _mm_store_ss(ret.ptr() + 2, _mm_movehl_ps(r, r));
+    return ret;
+}
+// double: each column is split in an (x,y) register and a scalar z lane; the matrix is accessed in the
+// chunks data[0..1], data[2..3], data[4..5], data[6..7], data[8] for the same reason as above
+inline void sse_load_cols3(const double *p, __m128d *xy, __m128d *z) {
+    const __m128d b = _mm_loadu_pd(p + 2); // c0.z c1.x
+    const __m128d c = _mm_loadu_pd(p + 4); // c1.y c1.z
+    xy[0] = _mm_loadu_pd(p);
+    xy[1] = _mm_shuffle_pd(b, c, 1);
+    xy[2] = _mm_loadu_pd(p + 6);
+    z[0] = b;
+    z[1] = _mm_unpackhi_pd(c, c);
+    z[2] = _mm_load_sd(p + 8);
+}
+inline Matrix3<double> operator*(const Matrix3<double> &m1, const Matrix3<double> &m2) {
+    __m128d cxy[3], cz[3], rxy[3], rz[3];
+    sse_load_cols3(m1.data, cxy, cz);
+    for (int j = 0; j < 3; j++) {
+        const double *b = m2.data + 3 * j;
+        const __m128d b0 = _mm_set1_pd(b[0]), b1 = _mm_set1_pd(b[1]), b2 = _mm_set1_pd(b[2]);
+        rxy[j] = _mm_add_pd(_mm_add_pd(_mm_mul_pd(cxy[0], b0), _mm_mul_pd(cxy[1], b1)), _mm_mul_pd(cxy[2], b2));
+        rz[j] = _mm_add_sd(_mm_add_sd(_mm_mul_sd(cz[0], b0), _mm_mul_sd(cz[1], b1)), _mm_mul_sd(cz[2], b2));
+    }
+    Matrix3<double> w;
+    _mm_storeu_pd(w.data, rxy[0]);
+    _mm_storeu_pd(w.data + 2, _mm_unpacklo_pd(rz[0], rxy[1]));
+    _mm_storeu_pd(w.data + 4, _mm_shuffle_pd(rxy[1], rz[1], 1));
+    _mm_storeu_pd(w.data + 6, rxy[2]);
+    _mm_store_sd(w.data + 8, rz[2]);
+    return w;
+}
+inline Vector3<double> operator*(const Matrix3<double> &m1, const Vector3<double> &rhs) {
+    __m128d cxy[3], cz[3];
+    sse_load_cols3(m1.data, cxy, cz);
+    const __m128d vx = _mm_set1_pd(rhs.x), vy = _mm_set1_pd(rhs.y), vz = _mm_set1_pd(rhs.z);
+    const __m128d xy = _mm_add_pd(_mm_add_pd(_mm_mul_pd(cxy[0], vx), _mm_mul_pd(cxy[1], vy)), _mm_mul_pd(cxy[2], vz));
+    const __m128d z = _mm_add_sd(_mm_add_sd(_mm_mul_sd(cz[0], vx), _mm_mul_sd(cz[1], vy)), _mm_mul_sd(cz[2], vz));
+    Vector3<double> ret;
+    _mm_storeu_pd(ret.ptr(), xy);
+    _mm_store_sd(ret.ptr() + 2, z);
+    return ret;
+}
+#endif // VMATH_SSE2
+
 
 // matrix4
 template <typename T> inline Matrix4<T> operator-(const Matrix4<T> &m1) {
@@ -97,7 +97,8 @@ template <typename T> inline void Vector2<T>::operator/=(T rhs) {
 }
 
 template <typename T> inline bool Vector2<T>::operator==(const Vector2<T> &rhs) const {
-    return (std::abs(x - rhs.x) < VMATH_EPSILON) && (std::abs(y - rhs.y) < VMATH_EPSILON);
+    using std::abs; // scalar types other than the builtin ones provide abs() found by ADL (see vmath_fixed.h)
+    return (abs(x - rhs.x) < VMATH_EPSILON) && (abs(y - rhs.y) < VMATH_EPSILON);
 }
 
 template <typename T> inline bool Vector2<T>::operator!=(const Vector2<T> &rhs) const {
@@ -184,7 +185,8 @@ template <typename T> inline void Vector3<T>::operator/=(T rhs) {
 }
 
 template <typename T> inline bool Vector3<T>::operator==(const Vector3<T> &rhs) const {
-    return std::abs(x - rhs.x) < VMATH_EPSILON && std::abs(y - rhs.y) < VMATH_EPSILON && std::abs(z - rhs.z) < VMATH_EPSILON;
+    using std::abs;
+    return abs(x - rhs.x) < VMATH_EPSILON && abs(y - rhs.y) < VMATH_EPSILON && abs(z - rhs.z) < VMATH_EPSILON;
 }
 
 template <typename T> inline bool Vector3<T>::operator!=(const Vector3<T> &rhs) const {
@@ -249,8 +251,9 @@ template <typename T> inline T Vector4<T>::dot(const Vector4<T> &rhs) const {
 
 
 template <typename T> inline bool Vector4<T>::operator==(const Vector4<T> &rhs) const {
-    return std::abs(x - rhs.x) < VMATH_EPSILON && std::abs(y - rhs.y) < VMATH_EPSILON && std::abs(z - rhs.z) < VMATH_EPSILON &&
-           std::abs(w - rhs.w) < VMATH_EPSILON;
+    using std::abs;
+    return abs(x - rhs.x) < VMATH_EPSILON && abs(y - rhs.y) < VMATH_EPSILON && abs(z - rhs.z) < VMATH_EPSILON &&
+           abs(w - rhs.w) < VMATH_EPSILON;
 }
 
 template <typename T> inline bool Vector4<T>::operator!=(const Vector4<T> &rhs) const {
@@ -313,8 +316,9 @@ template <typename T> inline Matrix3<T>::Matrix3(std::initializer_list<T> init)
 }
 
 template <typename T> inline bool Matrix3<T>::operator==(const Matrix3<T> &rhs) const {
+    using std::abs;
     for (int i = 0; i < 9; i++)
-        if (std::abs(data[i] - rhs.data[i]) >= VMATH_EPSILON)
+        if (abs(data[i] - rhs.data[i]) >= VMATH_EPSILON)
             return false;
     return true;
 }
@@ -393,8 +397,9 @@ template <typename T> inline Matrix4<T>::Matrix4(std::initializer_list<T> init)
 
 
 template <typename T> inline bool Matrix4<T>::operator==(const Matrix4<T> &rhs) const {
+    using std::abs;
     for (int i = 0; i < 16; i++) {
-        if (std::abs(data[i] - rhs.data[i]) >= VMATH_EPSILON)
+        if (abs(data[i] - rhs.data[i]) >= VMATH_EPSILON)
             return false;
     }
     return true;
@@ -487,11 +492,12 @@ template <typename T> inline void Quaternion<T>::operator*=(T rhs) {
 }
 
 template <typename T> inline bool Quaternion<T>::operator==(const Quaternion<T> &rhs) const {
+    using std::abs;
     const Quaternion<T> &lhs = *this;
-    return (std::abs(lhs.w - rhs.w) < VMATH_EPSILON) 
-        && (std::abs(lhs.x - rhs.x) < VMATH_EPSILON)
-        && (std::abs(lhs.y - rhs.y) < VMATH_EPSILON)
-        && (std::abs(lhs.z - rhs.z) < VMATH_EPSILON);
+    return (abs(lhs.w - rhs.w) < VMATH_EPSILON) 
+        && (abs(lhs.x - rhs.x) < VMATH_EPSILON)
+        && (abs(lhs.y - rhs.y) < VMATH_EPSILON)
+        && (abs(lhs.z - rhs.z) < VMATH_EPSILON);
 }
 
 template <typename T> inline bool Quaternion<T>::operator!=(const Quaternion<T> &rhs) const {
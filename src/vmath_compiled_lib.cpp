@@ -1,5 +1,6 @@
 #include "vmath_types.h"
 #include "vmath_types_impl.h"
+#include "vmath_fixed.h"
 
 #include <cstdint>
 
@@ -9,36 +10,50 @@ template struct math::Vector2<int32_t>;
 template struct math::Vector2<int64_t>;
 template struct math::Vector2<float>;
 template struct math::Vector2<double>;
+template struct math::Vector2<math::Fixed16>;
+template struct math::Vector2<math::Fixed32>;
 
 template struct math::Vector3<int8_t>;
 template struct math::Vector3<int32_t>;
 template struct math::Vector3<int64_t>;
 template struct math::Vector3<float>;
 template struct math::Vector3<double>;
+template struct math::Vector3<math::Fixed16>;
+template struct math::Vector3<math::Fixed32>;
 
 template struct math::Vector4<int8_t>;
 template struct math::Vector4<int32_t>;
 template struct math::Vector4<int64_t>;
 template struct math::Vector4<float>;
 template struct math::Vector4<double>;
+template struct math::Vector4<math::Fixed16>;
+template struct math::Vector4<math::Fixed32>;
 
 template struct math::Matrix3<int8_t>;
 template struct math::Matrix3<int32_t>;
 template struct math::Matrix3<int64_t>;
 template struct math::Matrix3<float>;
 template struct math::Matrix3<double>;
+template struct math::Matrix3<math::Fixed16>;
+template struct math::Matrix3<math::Fixed32>;
 
 template struct math::Matrix4<int8_t>;
 template struct math::Matrix4<int32_t>;
 template struct math::Matrix4<int64_t>;
 template struct math::Matrix4<float>;
 template struct math::Matrix4<double>;
+template struct math::Matrix4<math::Fixed16>;
+template struct math::Matrix4<math::Fixed32>;
 
 template struct math::Quaternion<float>;
 template struct math::Quaternion<double>;
+template struct math::Quaternion<math::Fixed16>;
+template struct math::Quaternion<math::Fixed32>;
 
 template struct math::Transform<float>;
 template struct math::Transform<double>;
+template struct math::Transform<math::Fixed16>;
+template struct math::Transform<math::Fixed32>;
 
 
 #include "vmath.h"
@@ -107,7 +122,9 @@ namespace math { \
     template Matrix4<T>    matrix4_identity<T>(); \
     template Matrix4<T>    create_translation<T>(const Vector3<T>& v); \
     template Matrix4<T>    create_transformation<T>(const Vector3<T>& v, const Quaternion<T> &q); \
-    template Matrix4<T>    create_lookat<T>(const Vector3<T>& eye, const Vector3<T>& to, const Vector3<T>& up=Vector3<T>(T(0),T(0),T(1))); \
+    template Matrix4<T>    create_scaling<T>(const Vector3<T>& s); \
+    template Matrix4<T>    create_lookat<T>(const Vector3<T>& eye, const Vector3<T>& to, \
+                                            const Vector3<T>& up=Vector3<T>(T(0),T(0),T(1))); \
     template Quaternion<T> quat_from_euler_321<T>(T x, T y, T z); \
     template Quaternion<T> quat_from_axis_angle<T>(Vector3<T> axis, T angle); \
     template Quaternion<T> quat_from_matrix<T>(const Matrix4<T>& m); \
@@ -115,21 +132,46 @@ namespace math { \
     template Vector3<T>    to_euler_321(Quaternion<T> const &q); \
 }
 
+#define VMATH_FUNCTIONS_DECOMPOSITIONS(T) \
+namespace math { \
+    template void polar_decompose<T>(const Matrix3<T> &m, Matrix3<T> &r, Matrix3<T> &s, int iterations); \
+    template void qr_decompose<T>(const Matrix3<T> &m, Matrix3<T> &q, Matrix3<T> &r); \
+    template void eigen_decompose<T>(const Matrix3<T> &m, Matrix3<T> &v, Vector3<T> &eigenvalues, int sweeps); \
+    template void svd_decompose<T>(const Matrix3<T> &m, Matrix3<T> &u, Vector3<T> &sigma, Matrix3<T> &v, int sweeps); \
+    template void polar_decompose<T>(const Matrix3<T> *m, Matrix3<T> *r, Matrix3<T> *s, size_t count, int iterations); \
+    template void qr_decompose<T>(const Matrix3<T> *m, Matrix3<T> *q, Matrix3<T> *r, size_t count); \
+    template void eigen_decompose<T>(const Matrix3<T> *m, Matrix3<T> *v, Vector3<T> *eigenvalues, size_t count, \
+                                     int sweeps); \
+    template void svd_decompose<T>(const Matrix3<T> *m, Matrix3<T> *u, Vector3<T> *sigma, Matrix3<T> *v, size_t count, \
+                                   int sweeps); \
+}
+
 VMATH_FUNCTIONS_VECTOR(uint8_t)
 VMATH_FUNCTIONS_VECTOR(int8_t)
 VMATH_FUNCTIONS_VECTOR(int32_t)
 VMATH_FUNCTIONS_VECTOR(int64_t)
 VMATH_FUNCTIONS_VECTOR(float)
 VMATH_FUNCTIONS_VECTOR(double)
+VMATH_FUNCTIONS_VECTOR(math::Fixed16)
+VMATH_FUNCTIONS_VECTOR(math::Fixed32)
 
 VMATH_FUNCTIONS_MATRIX(int8_t)
 VMATH_FUNCTIONS_MATRIX(int32_t)
 VMATH_FUNCTIONS_MATRIX(int64_t)
 VMATH_FUNCTIONS_MATRIX(float)
 VMATH_FUNCTIONS_MATRIX(double)
+VMATH_FUNCTIONS_MATRIX(math::Fixed16)
+VMATH_FUNCTIONS_MATRIX(math::Fixed32)
 
 VMATH_FUNCTIONS_QUATERNION(float)
 VMATH_FUNCTIONS_QUATERNION(double)
+VMATH_FUNCTIONS_QUATERNION(math::Fixed16)
+VMATH_FUNCTIONS_QUATERNION(math::Fixed32)
 
 VMATH_FUNCTIONS_FACTORIES(float)
 VMATH_FUNCTIONS_FACTORIES(double)
+VMATH_FUNCTIONS_FACTORIES(math::Fixed16)
+VMATH_FUNCTIONS_FACTORIES(math::Fixed32)
+
+VMATH_FUNCTIONS_DECOMPOSITIONS(float)
+VMATH_FUNCTIONS_DECOMPOSITIONS(double)
@@ -0,0 +1,121 @@
+#include "vmath.h"
+#include "vmath_arena.h"
+#include "vmath_convert.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+bool aligned(const void *p, size_t alignment) { return reinterpret_cast<uintptr_t>(p) % alignment == 0; }
+} // namespace
+
+TEST(Arena, allocate) {
+    math::FrameArena arena(4096);
+    EXPECT_EQ(arena.capacity(), 0u);
+    void *a = arena.allocate(10);
+    void *b = arena.allocate(1, 1);
+    void *c = arena.allocate(100, 16);
+    void *d = arena.allocate(8, 256);
+    EXPECT_TRUE(aligned(a, 64));
+    EXPECT_EQ(static_cast<char *>(b), static_cast<char *>(a) + 10);
+    EXPECT_TRUE(aligned(c, 16));
+    EXPECT_EQ(static_cast<char *>(c), static_cast<char *>(a) + 16);
+    EXPECT_TRUE(aligned(d, 256));
+    EXPECT_EQ(arena.block_count(), 1u);
+    EXPECT_EQ(arena.used(), size_t(static_cast<char *>(d) - static_cast<char *>(a)) + 8);
+
+    // larger than a block, then a new block when the current one is full
+    void *e = arena.allocate(10000);
+    EXPECT_TRUE(aligned(e, 64));
+    EXPECT_EQ(arena.block_count(), 2u);
+    arena.allocate(4000);
+    EXPECT_EQ(arena.block_count(), 3u);
+    const size_t capacity = arena.capacity();
+    EXPECT_GE(capacity, 4096u + 10000u + 4096u);
+    EXPECT_GE(arena.used(), 14000u);
+    EXPECT_LT(arena.used(), 14500u); // the unused end of the full blocks is not counted
+
+    // reset merges the blocks: the same allocations then fit in one block
+    const size_t peak = arena.used();
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.peak(), peak);
+    EXPECT_EQ(arena.block_count(), 1u);
+    EXPECT_EQ(arena.capacity(), capacity);
+    void *f = arena.allocate(10);
+    arena.allocate(10000);
+    arena.allocate(4000);
+    EXPECT_EQ(arena.block_count(), 1u);
+    // and the same memory is reused frame after frame
+    arena.reset();
+    EXPECT_EQ(arena.allocate(10), f);
+
+    // scoped temporaries reuse the same memory
+    void *g = arena.allocate(100);
+    for (int i = 0; i < 3; i++) {
+        math::ArenaScope scope(arena);
+        EXPECT_EQ(arena.allocate(1000), static_cast<char *>(g) + 128);
+    }
+    const math::FrameArena::Marker marker = arena.mark();
+    arena.allocate(1000);
+    arena.rewind(marker);
+    EXPECT_EQ(arena.used(), 100u + 64u);
+    // a marker before a new block: the memory of the new block is reused after the reset only
+    arena.allocate(capacity);
+    EXPECT_EQ(arena.block_count(), 2u);
+    arena.rewind(marker);
+    EXPECT_GT(arena.used(), capacity);
+
+    arena.release();
+    EXPECT_EQ(arena.capacity(), 0u);
+    EXPECT_EQ(arena.block_count(), 0u);
+    EXPECT_TRUE(aligned(arena.allocate(0), 64));
+}
+
+TEST(Arena, containers) {
+    math::FrameArena arena(1 << 16);
+    math::ArenaAllocator<math::Matrix4f> alloc(arena);
+    for (int frame = 0; frame < 3; frame++) {
+        math::ArenaVector<math::Matrix4f> m(alloc);
+        m.reserve(100);
+        for (int i = 0; i < 100; i++)
+            m.push_back(math::create_translation(math::Vector3f(float(i), 0.f, 0.f)));
+        EXPECT_TRUE(aligned(m.data(), 64));
+        EXPECT_EQ(m[99].data[12], 99.f);
+
+        // growth without reserve, other types from the same arena
+        math::ArenaVector<math::Transff> t{math::ArenaAllocator<math::Transff>(arena)};
+        for (int i = 0; i < 1000; i++)
+            t.push_back(math::Transff(math::Vector3f(float(i), 1.f, 2.f)));
+        EXPECT_TRUE(aligned(t.data(), 64));
+        EXPECT_EQ(t[999].p.x, 999.f);
+
+        // storage for the batch functions
+        std::vector<math::Vector3d> src(1000, math::Vector3d(1.0, 2.0, 3.0));
+        math::ArenaVector<math::Vector3f> dst(src.size(), math::Vector3f(),
+                                              math::ArenaAllocator<math::Vector3f>(arena));
+        math::convert(src.data(), dst.data(), src.size());
+        EXPECT_EQ(dst[999], math::Vector3f(1.f, 2.f, 3.f));
+        EXPECT_GT(arena.used(), 100 * sizeof(math::Matrix4f) + 1000 * sizeof(math::Transff));
+        m.clear();
+        m.shrink_to_fit();
+        t = math::ArenaVector<math::Transff>(alloc);
+        dst.clear();
+        arena.reset();
+    }
+    EXPECT_EQ(arena.block_count(), 1u);
+
+    // allocator requirements: rebind, comparison
+    math::ArenaAllocator<float> f(alloc);
+    math::FrameArena other;
+    EXPECT_TRUE(f == alloc);
+    EXPECT_TRUE(math::ArenaAllocator<float>(other) != alloc);
+    EXPECT_EQ(&f.arena(), &arena);
+    static_assert(std::is_same<std::allocator_traits<math::ArenaAllocator<float>>::rebind_alloc<int>,
+                               math::ArenaAllocator<int>>::value,
+                  "rebind");
+    math::ArenaAllocator<double, 128> wide(arena);
+    EXPECT_TRUE(aligned(wide.allocate(3), 128));
+}
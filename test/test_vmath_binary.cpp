@@ -0,0 +1,231 @@
+#include "vmath.h"
+#include "vmath_binary.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+std::string temp_path(const char *name) { return testing::TempDir() + "/" + name; }
+
+template <typename T> std::vector<math::Matrix4<T>> random_matrices(size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<T> d(-10, 10);
+    std::vector<math::Matrix4<T>> m(n);
+    for (auto &e : m)
+        for (auto &v : e.data)
+            v = d(gen);
+    return m;
+}
+
+template <typename T> std::vector<math::Transform<T>> random_transforms(size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<T> d(-10, 10);
+    std::vector<math::Transform<T>> t(n);
+    for (auto &e : t)
+        e = math::Transform<T>(math::Vector3<T>(d(gen), d(gen), d(gen)),
+                               math::normalized(math::Quaternion<T>(d(gen), d(gen), d(gen), d(gen))));
+    return t;
+}
+
+std::vector<unsigned char> read_file(const std::string &path) {
+    std::vector<unsigned char> bytes;
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return bytes;
+    std::fseek(f, 0, SEEK_END);
+    bytes.resize(size_t(std::ftell(f)));
+    std::fseek(f, 0, SEEK_SET);
+    EXPECT_EQ(std::fread(bytes.data(), 1, bytes.size(), f), bytes.size());
+    std::fclose(f);
+    return bytes;
+}
+
+void write_file(const std::string &path, const std::vector<unsigned char> &bytes) {
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    ASSERT_TRUE(f);
+    EXPECT_EQ(std::fwrite(bytes.data(), 1, bytes.size(), f), bytes.size());
+    std::fclose(f);
+}
+} // namespace
+
+TEST(Binary, checksum) {
+    // reference values of XXH64 with seed 0
+    EXPECT_EQ(math::detail::hash64("", 0), 0xEF46DB3751D8E999ull);
+    EXPECT_EQ(math::detail::hash64("a", 1), 0xD24EC4F1A98C6E5Bull);
+    EXPECT_EQ(math::detail::hash64("abc", 3), 0x44BC2CF5AD770999ull);
+    const std::string text = "Nobody inspects the spammish repetition";
+    EXPECT_EQ(math::detail::hash64(text.data(), text.size()), 0xFBCEA83C8A378BF1ull);
+    // streaming in pieces of any size gives the same value
+    std::vector<unsigned char> data(1000);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = (unsigned char)(i * 7 + 3);
+    const uint64_t h = math::detail::hash64(data.data(), data.size());
+    for (size_t piece : {1, 5, 31, 32, 33, 100}) {
+        math::detail::Hash64 s;
+        for (size_t i = 0; i < data.size(); i += piece)
+            s.update(&data[i], std::min(piece, data.size() - i));
+        EXPECT_EQ(s.digest(), h);
+    }
+}
+
+TEST(Binary, round_trip) {
+    const size_t n = 1001;
+    const auto m = random_matrices<float>(n, 1);
+    const auto t = random_transforms<float>(n, 2);
+    const auto md = random_matrices<double>(n, 3);
+    const auto td = random_transforms<double>(n, 4);
+    std::vector<math::Vector3f> v(n);
+    for (size_t i = 0; i < n; i++)
+        v[i] = t[i].p;
+
+    math::BinaryFileWriter writer;
+    EXPECT_TRUE(writer.add("matrices", m.data(), n));
+    EXPECT_TRUE(writer.add("transforms", t.data(), n));
+    EXPECT_TRUE(writer.add("matrices_soa", md.data(), n, math::BinaryLayout::soa));
+    EXPECT_TRUE(writer.add("transforms_soa", td.data(), n, math::BinaryLayout::soa));
+    EXPECT_TRUE(writer.add("points", v.data(), n));
+    EXPECT_TRUE(writer.add("empty", v.data(), 0));
+    EXPECT_FALSE(writer.add("points", v.data(), n));
+    EXPECT_FALSE(writer.add(std::string(32, 'x'), v.data(), n));
+    const std::string path = temp_path("vmath_round_trip.bin");
+    ASSERT_TRUE(writer.write(path));
+
+    math::BinaryFileReader reader;
+    ASSERT_TRUE(reader.open(path)) << reader.error();
+    EXPECT_EQ(reader.section_count(), 6u);
+    for (size_t i = 0; i < reader.section_count(); i++)
+        EXPECT_EQ(reader.section(i).offset % 64, 0u);
+
+    const auto ms = reader.aos<math::Matrix4f>("matrices");
+    ASSERT_EQ(ms.size(), n);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ms.data()) % 64, 0u);
+    EXPECT_EQ(std::memcmp(ms.data(), m.data(), n * sizeof(m[0])), 0);
+    const auto ts = reader.aos<math::Transff>("transforms");
+    ASSERT_EQ(ts.size(), n);
+    for (size_t i = 0; i < n; i++) {
+        EXPECT_EQ(ts[i].p, t[i].p);
+        EXPECT_EQ(ts[i].q, t[i].q);
+    }
+    const auto ps = reader.aos<math::Vector3f>("points");
+    ASSERT_EQ(ps.size(), n);
+    EXPECT_EQ(ps[n - 1], v[n - 1]);
+    EXPECT_TRUE(reader.aos<math::Vector3f>("empty").empty());
+
+    const auto msoa = reader.soa<math::Matrix4d>("matrices_soa");
+    ASSERT_EQ(msoa.size(), n);
+    ASSERT_EQ(msoa.components, 16u);
+    for (uint32_t k = 0; k < 16; k++) {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(msoa.component(k)) % 64, 0u);
+        for (size_t i = 0; i < n; i++)
+            ASSERT_EQ(msoa.component(k)[i], md[i].data[k]);
+    }
+    const auto tsoa = reader.soa<math::Transfd>("transforms_soa");
+    ASSERT_EQ(tsoa.size(), n);
+    for (size_t i = 0; i < n; i++) {
+        EXPECT_EQ(tsoa.component(0)[i], td[i].p.x);
+        EXPECT_EQ(tsoa.component(2)[i], td[i].p.z);
+        EXPECT_EQ(tsoa.component(3)[i], td[i].q.w);
+        EXPECT_EQ(tsoa.component(6)[i], td[i].q.z);
+    }
+
+    // missing sections, wrong types and layouts give empty spans
+    EXPECT_EQ(reader.find("transforms"), 1);
+    EXPECT_EQ(reader.find("nothing"), -1);
+    EXPECT_TRUE(reader.aos<math::Matrix4f>("nothing").empty());
+    EXPECT_TRUE(reader.aos<math::Matrix4d>("matrices").empty());
+    EXPECT_TRUE(reader.aos<math::Transff>("matrices").empty());
+    EXPECT_TRUE(reader.aos<math::Matrix4d>("matrices_soa").empty());
+    EXPECT_TRUE(reader.soa<math::Matrix4f>("matrices").empty());
+
+    // a file without sections
+    const std::string empty_path = temp_path("vmath_empty.bin");
+    ASSERT_TRUE(math::BinaryFileWriter().write(empty_path));
+    EXPECT_TRUE(reader.open(empty_path)) << reader.error();
+    EXPECT_EQ(reader.section_count(), 0u);
+}
+
+TEST(Binary, invalid_files) {
+    const auto m = random_matrices<float>(100, 5);
+    math::BinaryFileWriter writer;
+    writer.add("matrices", m.data(), m.size());
+    writer.add("matrices_soa", m.data(), m.size(), math::BinaryLayout::soa);
+    const std::string path = temp_path("vmath_valid.bin");
+    ASSERT_TRUE(writer.write(path));
+    const std::vector<unsigned char> bytes = read_file(path);
+    ASSERT_GT(bytes.size(), 64u * 3);
+
+    math::BinaryFileReader reader;
+    const std::string bad_path = temp_path("vmath_invalid.bin");
+    auto check_invalid = [&](std::vector<unsigned char> b, const char *what) {
+        write_file(bad_path, b);
+        EXPECT_FALSE(reader.open(bad_path)) << what;
+        EXPECT_FALSE(reader.error().empty());
+        EXPECT_EQ(reader.section_count(), 0u);
+    };
+    EXPECT_FALSE(reader.open(temp_path("vmath_missing.bin")));
+
+    std::vector<unsigned char> b = bytes;
+    b[0] = 'X';
+    check_invalid(b, "magic");
+    b = bytes;
+    std::swap(b[8], b[11]);
+    std::swap(b[9], b[10]);
+    check_invalid(b, "byte order");
+    EXPECT_EQ(reader.error(), "file written with a different byte order");
+    b = bytes;
+    b[12] = 2;
+    check_invalid(b, "version");
+    b = bytes;
+    b.resize(b.size() - 1);
+    check_invalid(b, "truncated");
+    b = bytes;
+    b.resize(40);
+    check_invalid(b, "header only");
+    b = bytes;
+    b[64 + 40] ^= 1;
+    check_invalid(b, "section table");
+    // section table past the end of the address space: the end of the table wraps around to 0
+    b = bytes;
+    const uint64_t wrap_count = 2, wrap_offset = 0 - wrap_count * sizeof(math::BinarySection);
+    std::memcpy(b.data() + 16, &wrap_count, 8);
+    std::memcpy(b.data() + 24, &wrap_offset, 8);
+    check_invalid(b, "table offset");
+    EXPECT_EQ(reader.error(), "invalid file header");
+    // section table with a valid checksum, but components that do not match the type tag: a matrix4 section
+    // with 9 components (that fits in the file), and a matrix3 tag on 16 components
+    auto patch_table = [&](size_t offset, const void *value, size_t size) {
+        b = bytes;
+        uint64_t table_offset, section_count;
+        std::memcpy(&section_count, b.data() + 16, 8);
+        std::memcpy(&table_offset, b.data() + 24, 8);
+        std::memcpy(b.data() + table_offset + offset, value, size);
+        const uint64_t checksum =
+            math::detail::hash64(b.data() + table_offset, size_t(section_count) * sizeof(math::BinarySection));
+        std::memcpy(b.data() + 32, &checksum, 8);
+    };
+    const uint16_t components = 9;
+    patch_table(offsetof(math::BinarySection, components), &components, sizeof(components));
+    check_invalid(b, "components");
+    EXPECT_EQ(reader.error(), "invalid section 0");
+    const math::BinaryElementType type = math::BinaryElementType::matrix3;
+    patch_table(offsetof(math::BinarySection, type), &type, sizeof(type));
+    check_invalid(b, "type");
+
+    // corrupted data: detected on open, or by verify() when the data is not checked on open
+    const size_t soa_offset = size_t(reader.open(path) ? reader.section(1).offset : 0);
+    ASSERT_GT(soa_offset, 0u);
+    b = bytes;
+    b[soa_offset + 100] ^= 0x10;
+    check_invalid(b, "section data");
+    EXPECT_EQ(reader.error(), "corrupted section matrices_soa");
+    write_file(bad_path, b);
+    ASSERT_TRUE(reader.open(bad_path, false));
+    EXPECT_TRUE(reader.verify(0));
+    EXPECT_FALSE(reader.verify(1));
+}
@@ -0,0 +1,135 @@
+#include "vmath.h"
+#include "vmath_camera.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+// OpenGL perspective projection
+math::Matrix4f perspective(float fovy, float aspect, float znear, float zfar) {
+    const float f = 1.f / std::tan(0.5f * fovy);
+    math::Matrix4f m = math::matrix4_identity<float>();
+    m(0, 0) = f / aspect;
+    m(1, 1) = f;
+    m(2, 2) = (zfar + znear) / (znear - zfar);
+    m(2, 3) = 2.f * zfar * znear / (znear - zfar);
+    m(3, 2) = -1.f;
+    m(3, 3) = 0.f;
+    return m;
+}
+
+struct Rays {
+    std::vector<float> ox, oy, oz, dx, dy, dz;
+    explicit Rays(size_t n) : ox(n, -9.f), oy(n, -9.f), oz(n, -9.f), dx(n, -9.f), dy(n, -9.f), dz(n, -9.f) {}
+    math::RayArrays arrays() {
+        math::RayArrays r;
+        r.ox = ox.data();
+        r.oy = oy.data();
+        r.oz = oz.data();
+        r.dx = dx.data();
+        r.dy = dy.data();
+        r.dz = dz.data();
+        return r;
+    }
+    math::Vector3d origin(size_t i) const { return math::Vector3d(ox[i], oy[i], oz[i]); }
+    math::Vector3d direction(size_t i) const { return math::Vector3d(dx[i], dy[i], dz[i]); }
+};
+
+// reference: unproject the ndc point of the pixel with the inverse view projection in double
+void check(const math::Matrix4d &inverse_vp, uint32_t width, uint32_t height, double px, double py, const Rays &r,
+           size_t i) {
+    const double x = 2.0 * px / width - 1.0, y = 1.0 - 2.0 * py / height;
+    const math::Vector4d n = inverse_vp * math::Vector4d(x, y, -1.0, 1.0);
+    const math::Vector4d f = inverse_vp * math::Vector4d(x, y, 1.0, 1.0);
+    const math::Vector3d origin(n.x / n.w, n.y / n.w, n.z / n.w);
+    const math::Vector3d dir = math::normalized(math::Vector3d(f.x / f.w, f.y / f.w, f.z / f.w) - origin);
+    ASSERT_NEAR(math::length(r.origin(i) - origin), 0.0, 1e-4 * (1.0 + math::length(origin))) << i;
+    ASSERT_NEAR(math::length(r.direction(i) - dir), 0.0, 2e-5) << i;
+}
+} // namespace
+
+TEST(Camera, perspective) {
+    const math::Vector3f eye(3.f, -20.f, 4.f);
+    const math::Matrix4f view = math::inverse(math::create_lookat(eye, math::Vector3f(0.f, 0.f, 0.f)));
+    const math::Matrix4f vp = perspective(1.f, 1.5f, 0.1f, 100.f) * view;
+    const math::Matrix4d inverse_vp = math::inverse(math::Matrix4d(vp));
+    const uint32_t width = 96, height = 64;
+    const math::CameraRays camera = math::camera_rays(vp, width, height);
+
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> d(0.f, 1.f);
+    std::vector<math::Vector2f> jitter(7);
+    for (auto &j : jitter)
+        j = math::Vector2f(d(gen), d(gen));
+
+    // tile widths covering the tails of the SIMD loop, pixel centers and jittered
+    for (uint32_t tile_width = 1; tile_width <= 9; tile_width++) {
+        for (bool jittered : {false, true}) {
+            const uint32_t x0 = 40 + tile_width, y0 = 17, tile_height = 3;
+            const size_t n = size_t(tile_width) * tile_height;
+            Rays r(n + 1);
+            math::generate_rays(camera, x0, y0, tile_width, tile_height, jittered ? jitter.data() : nullptr,
+                                jitter.size(), r.arrays(), 1);
+            for (uint32_t j = 0; j < tile_height; j++) {
+                for (uint32_t i = 0; i < tile_width; i++) {
+                    const size_t k = size_t(j) * tile_width + i;
+                    const math::Vector2f o = jittered ? jitter[k % jitter.size()] : math::Vector2f(0.5f, 0.5f);
+                    check(inverse_vp, width, height, x0 + i + o.x, y0 + j + o.y, r, k);
+                }
+            }
+            EXPECT_EQ(r.dx[n], -9.f);
+        }
+    }
+
+    // the whole image on several threads: the rays go through the eye, the center one looks at the target,
+    // row 0 is at the top
+    Rays r(size_t(width) * height);
+    math::generate_rays(camera, 0, 0, width, height, nullptr, 0, r.arrays(), 4);
+    for (size_t k = 0; k < r.dx.size(); k++) {
+        const math::Vector3d to_eye = math::Vector3d(eye) - r.origin(k);
+        ASSERT_LT(math::length(to_eye.cross(r.direction(k))), 1e-4) << k;
+        ASSERT_LT(to_eye.dot(r.direction(k)), 0.0) << k;
+    }
+    const math::Vector3d forward = math::normalized(-math::Vector3d(eye));
+    const size_t center = size_t(height / 2) * width + width / 2;
+    EXPECT_GT(r.direction(center).dot(forward), 0.999);
+    EXPECT_GT(r.dz[0], r.dz[r.dz.size() - 1]);
+
+    // null origins
+    Rays r2(size_t(width) * height);
+    math::RayArrays directions = r2.arrays();
+    directions.ox = directions.oy = directions.oz = nullptr;
+    math::generate_rays(camera, 0, 0, width, height, nullptr, 0, directions, 1);
+    EXPECT_EQ(r2.ox[5], -9.f);
+    EXPECT_EQ(r2.dx, r.dx);
+}
+
+TEST(Camera, orthographic) {
+    const math::Vector3f eye(1.f, 2.f, 10.f), target(1.f, 8.f, 2.f);
+    const math::Matrix4f view = math::inverse(math::create_lookat(eye, target));
+    math::Matrix4f ortho = math::matrix4_identity<float>();
+    ortho(0, 0) = 0.1f;
+    ortho(1, 1) = 0.2f;
+    ortho(2, 2) = -0.05f;
+    ortho(2, 3) = -1.f;
+    const math::Matrix4f vp = ortho * view;
+    const uint32_t width = 33, height = 21;
+    const math::CameraRays camera = math::camera_rays(vp, width, height);
+    Rays r(size_t(width) * height);
+    math::generate_rays(camera, 0, 0, width, height, nullptr, 0, r.arrays(), 2);
+    const math::Matrix4d inverse_vp = math::inverse(math::Matrix4d(vp));
+    const math::Vector3d forward = math::normalized(math::Vector3d(target) - math::Vector3d(eye));
+    for (uint32_t j = 0; j < height; j++) {
+        for (uint32_t i = 0; i < width; i++) {
+            const size_t k = size_t(j) * width + i;
+            check(inverse_vp, width, height, i + 0.5, j + 0.5, r, k);
+            ASSERT_NEAR(r.direction(k).dot(forward), 1.0, 1e-6) << k;
+        }
+    }
+    // the center ray starts on the near plane (z_view = 0) in front of the eye
+    const size_t center = size_t(height / 2) * width + width / 2;
+    EXPECT_LT(math::length(r.origin(center) - math::Vector3d(eye)), 1e-4);
+}
@@ -0,0 +1,133 @@
+#include "vmath.h"
+#include "vmath_convert.h"
+#include "vmath_half.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+bool same_bits(float a, float b) { return std::memcmp(&a, &b, sizeof(float)) == 0; }
+
+std::vector<math::Vector3d> random_points(size_t n, const math::Vector3d &center, double radius, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> d(-radius, radius);
+    std::vector<math::Vector3d> v(n);
+    for (auto &e : v)
+        e = center + math::Vector3d(d(gen), d(gen), d(gen));
+    return v;
+}
+} // namespace
+
+TEST(Convert, scalars) {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> d(-1e6, 1e6);
+    std::vector<double> src(100003);
+    for (auto &e : src)
+        e = d(gen);
+    const double specials[] = {0.0, -0.0, 1e-40, -1e-310, 1e39, -1e300, std::numeric_limits<double>::infinity(),
+                               -std::numeric_limits<double>::infinity(), 1.0 + 1e-9, 0.1};
+    std::copy(std::begin(specials), std::end(specials), src.begin() + 7);
+    src[20] = std::numeric_limits<double>::quiet_NaN();
+    std::vector<float> dst(src.size());
+    // all the sizes around the vector widths, then a large array over several threads
+    for (size_t n = 0; n < 40; n++) {
+        std::fill(dst.begin(), dst.end(), -1.f);
+        math::convert(src.data(), dst.data(), n);
+        for (size_t i = 0; i < n; i++)
+            ASSERT_TRUE(same_bits(dst[i], float(src[i])) || (std::isnan(dst[i]) && std::isnan(src[i])))
+                << n << " " << i;
+        EXPECT_EQ(dst[n], -1.f);
+    }
+    math::convert(src.data(), dst.data(), src.size(), 4);
+    for (size_t i = 0; i < src.size(); i++)
+        ASSERT_TRUE(same_bits(dst[i], float(src[i])) || std::isnan(src[i])) << i;
+}
+
+TEST(Convert, types) {
+    const auto p = random_points(1001, math::Vector3d(1, 2, 3), 1e4, 2);
+    std::vector<math::Vector3f> pf(p.size());
+    math::convert(p.data(), pf.data(), p.size());
+    for (size_t i = 0; i < p.size(); i++)
+        ASSERT_EQ(pf[i], math::Vector3f(p[i]));
+
+    std::vector<math::Matrix4d> m(37);
+    for (size_t i = 0; i < m.size(); i++)
+        m[i] = math::create_transformation(p[i], math::normalized(math::Quatd(p[i + 1].x, 1, 2, 3)));
+    std::vector<math::Matrix4f> mf(m.size());
+    math::convert(m.data(), mf.data(), m.size());
+    for (size_t i = 0; i < m.size(); i++)
+        ASSERT_EQ(std::memcmp(mf[i].data, math::Matrix4f(m[i]).data, sizeof(mf[i].data)), 0);
+
+    // the 16 bit conversions of vmath_half.h still work alongside
+    std::vector<math::Vector3h> ph(pf.size());
+    math::convert(pf.data(), ph.data(), pf.size());
+    EXPECT_EQ(float(ph[0].x), float(math::Half(pf[0].x)));
+}
+
+TEST(Convert, relative) {
+    // points of a large world (around 6400 km from the origin) relative to a camera close to them
+    const math::Vector3d center(6.4e6, -1.3e6, 2.1e5);
+    const math::Vector3d origin = center + math::Vector3d(0.25, -0.5, 1.0 / 3.0);
+    const auto p = random_points(100003, center, 100.0, 3);
+    std::vector<math::Vector3f> rel(p.size());
+    for (size_t n = 0; n < 40; n++) {
+        std::fill(rel.begin(), rel.end(), math::Vector3f(-1.f, -1.f, -1.f));
+        math::convert_relative(p.data(), origin, rel.data(), n);
+        for (size_t i = 0; i < n; i++)
+            ASSERT_EQ(rel[i], math::Vector3f(p[i] - origin)) << n << " " << i;
+        EXPECT_EQ(rel[n], math::Vector3f(-1.f, -1.f, -1.f));
+    }
+    math::convert_relative(p.data(), origin, rel.data(), p.size(), 4);
+    double max_error = 0.0, max_error_float = 0.0;
+    for (size_t i = 0; i < p.size(); i++) {
+        ASSERT_EQ(rel[i], math::Vector3f(p[i] - origin)) << i;
+        max_error = std::max(max_error, math::length(math::Vector3d(rel[i]) - (p[i] - origin)));
+        const math::Vector3f naive = math::Vector3f(p[i]) - math::Vector3f(origin);
+        max_error_float = std::max(max_error_float, math::length(math::Vector3d(naive) - (p[i] - origin)));
+    }
+    EXPECT_LT(max_error, 1e-5);       // float precision at 100 m
+    EXPECT_GT(max_error_float, 0.1);  // float precision at 6400 km
+
+    std::vector<math::Transfd> t(33);
+    for (size_t i = 0; i < t.size(); i++)
+        t[i] = math::Transfd(p[i], math::normalized(math::Quatd(1, p[i].x - center.x, 0.5, -0.25)));
+    std::vector<math::Transff> tf(t.size());
+    math::convert_relative(t.data(), origin, tf.data(), t.size());
+    for (size_t i = 0; i < t.size(); i++) {
+        EXPECT_EQ(tf[i].p, math::Vector3f(t[i].p - origin));
+        EXPECT_EQ(tf[i].q, math::Quatf(t[i].q));
+    }
+}
+
+TEST(Convert, relative_to_eye) {
+    const math::Vector3d eye(6.4e6 + 0.3, -1.3e6 + 0.7, 2.1e5 + 0.1);
+    const math::Matrix4d view = math::inverse(math::create_lookat(eye, eye + math::Vector3d(1, 2, 0.5)));
+    const math::Matrix4f view_rte = math::view_relative_to_eye(view, eye);
+    EXPECT_LT(std::abs(view_rte.data[12]) + std::abs(view_rte.data[13]) + std::abs(view_rte.data[14]), 1e-6f);
+
+    std::vector<math::Matrix4d> models(100);
+    const auto positions = random_points(models.size(), eye, 50.0, 4);
+    for (size_t i = 0; i < models.size(); i++)
+        models[i] = math::create_transformation(positions[i], math::normalized(math::Quatd(1, 0.1 * double(i), 2, 3)));
+    std::vector<math::Matrix4f> rte(models.size());
+    math::relative_to_eye(models.data(), eye, rte.data(), models.size());
+    const math::Vector3d local(0.5, -0.25, 1.0);
+    double max_error = 0.0, max_error_float = 0.0;
+    for (size_t i = 0; i < models.size(); i++) {
+        const math::Matrix4f single = math::relative_to_eye(models[i], eye);
+        ASSERT_EQ(std::memcmp(single.data, rte[i].data, sizeof(single.data)), 0);
+        // model-view in float against the exact one in double
+        const math::Vector3d exact = view * (models[i] * local);
+        const math::Vector3f v = (view_rte * rte[i]) * math::Vector3f(local);
+        const math::Vector3f naive = (math::Matrix4f(view) * math::Matrix4f(models[i])) * math::Vector3f(local);
+        max_error = std::max(max_error, math::length(math::Vector3d(v) - exact));
+        max_error_float = std::max(max_error_float, math::length(math::Vector3d(naive) - exact));
+    }
+    EXPECT_LT(max_error, 1e-4);
+    EXPECT_GT(max_error_float, 0.01);
+}
@@ -0,0 +1,107 @@
+#include "vmath.h"
+#include "vmath_exp_map.h"
+#include "vmath_random.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+template <typename T> T quat_error(const math::Quaternion<T> &a, const math::Quaternion<T> &b) {
+    return std::sqrt((a.w - b.w) * (a.w - b.w) + (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) +
+                     (a.z - b.z) * (a.z - b.z));
+}
+
+} // namespace
+
+TEST(ExpMap, exp_log) {
+    math::Random rng(1);
+    for (int n = 0; n < 100; n++) {
+        // general quaternions: the vector part of log(q) has a norm in [0, pi]
+        const math::Quatd q(rng.uniform(-2.0, 2.0), rng.uniform(-2.0, 2.0), rng.uniform(-2.0, 2.0),
+                            rng.uniform(-2.0, 2.0));
+        EXPECT_NEAR(quat_error(math::quat_exp(math::quat_log(q)), q), 0.0, 1e-14);
+        const math::Quatd v(rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 1.0),
+                            rng.uniform(-1.0, 1.0));
+        EXPECT_NEAR(quat_error(math::quat_log(math::quat_exp(v)), v), 0.0, 1e-14);
+        // exp(a) exp(b) = exp(a + b) when the vector parts are parallel
+        const math::Quatd a(0.3, 0.2 * v.x, 0.2 * v.y, 0.2 * v.z), b(-0.1, 0.5 * v.x, 0.5 * v.y, 0.5 * v.z);
+        EXPECT_NEAR(quat_error(math::quat_exp(a) * math::quat_exp(b), math::quat_exp(a + b)), 0.0, 1e-14);
+
+        // powers of unit quaternions scale the angle
+        const math::Quatd r = math::random_quat<double>(rng);
+        const double t = rng.uniform(-2.0, 2.0);
+        EXPECT_NEAR(quat_error(math::quat_pow(r, t), math::quat_from_axis_angle(math::axis(r), t * math::angle(r))),
+                    0.0, 1e-12);
+        EXPECT_NEAR(quat_error(math::quat_pow(math::quat_pow(q, 0.5), 2.0), q), 0.0, 1e-14);
+    }
+    EXPECT_EQ(math::quat_exp(math::Quatf(0, 0, 0, 0)), math::Quatf());
+    EXPECT_EQ(math::quat_log(math::Quatf()), math::Quatf(0, 0, 0, 0));
+    EXPECT_EQ(math::quat_pow(math::Quatf(0, 1, 0, 0), 0.f), math::Quatf());
+    // q = -1: arbitrary axis, returned as zero
+    EXPECT_NEAR(math::quat_log(math::Quatd(-1, 0, 0, 0)).w, 0.0, 1e-15);
+}
+
+TEST(ExpMap, rotation_vector) {
+    math::Random rng(2);
+    for (int n = 0; n < 100; n++) {
+        const math::Vector3d axis = math::random_unit_vector<double>(rng);
+        const double angle = rng.uniform(0.0, M_PI);
+        const math::Quatd q = math::quat_from_rotation_vector(axis * angle);
+        EXPECT_NEAR(quat_error(q, math::quat_from_axis_angle(axis, angle)), 0.0, 1e-15);
+        EXPECT_NEAR(math::length(math::rotation_vector(q) - axis * angle), 0.0, 1e-14);
+        // q and -q: the same rotation vector
+        EXPECT_NEAR(math::length(math::rotation_vector(-q) - axis * angle), 0.0, 1e-14);
+
+        // small angles keep their relative accuracy, where axis() / angle() lose it
+        const math::Vector3f small = math::Vector3f(axis) * 1e-6f;
+        const math::Vector3f back = math::rotation_vector(math::quat_from_rotation_vector(small));
+        EXPECT_NEAR(math::length(back - small), 0.f, 1e-12f);
+    }
+    EXPECT_EQ(math::quat_from_rotation_vector(math::Vector3f(0, 0, 0)), math::Quatf());
+    EXPECT_EQ(math::rotation_vector(math::Quatf()), math::Vector3f(0, 0, 0));
+}
+
+TEST(ExpMap, batch) {
+    math::Random rng(3);
+    // 1037 values: SIMD iterations and a scalar tail; angles up to 2 pi for the polynomial fallbacks, tiny angles
+    const size_t n = 1037;
+    std::vector<math::Vector3f> r(n), rb(n);
+    std::vector<math::Quatf> q(n), qb(n);
+    for (size_t i = 0; i < n; i++) {
+        const double scale = i % 7 == 0 ? 1e-6 : i % 7 == 1 ? 2.0 * M_PI : M_PI;
+        r[i] = math::random_unit_vector<float>(rng) * float(rng.uniform(0.0, scale));
+        q[i] = math::random_quat<float>(rng);
+    }
+    r[5] = math::Vector3f(0, 0, 0);
+    q[6] = math::Quatf();
+    q[7] = math::Quatf(-1, 0, 0, 0);
+    q[8] = math::Quatf(0, 1, 0, 0);
+    for (unsigned threads : {1u, 3u}) {
+        math::quat_from_rotation_vector(r.data(), qb.data(), n, threads);
+        math::rotation_vector(q.data(), rb.data(), n, threads);
+        for (size_t i = 0; i < n; i++) {
+            const math::Quatd qd = math::quat_from_rotation_vector(math::Vector3d(r[i]));
+            ASSERT_NEAR(quat_error(math::Quatd(qb[i]), qd), 0.0, 5e-7) << i;
+            const math::Vector3d rd = math::rotation_vector(math::Quatd(q[i]));
+            ASSERT_NEAR(math::length(math::Vector3d(rb[i]) - rd), 0.0, 1e-6 * (1e-6 + math::length(rd))) << i;
+        }
+        for (float t : {0.f, 0.25f, -1.5f, 3.f}) {
+            math::quat_pow(q.data(), t, qb.data(), n, threads);
+            for (size_t i = 0; i < n; i++)
+                ASSERT_NEAR(quat_error(math::Quatd(qb[i]), math::quat_pow(math::Quatd(q[i]), double(t))), 0.0, 2e-6)
+                    << i << " " << t;
+        }
+    }
+
+    // double: scalar kernels
+    std::vector<math::Quatd> qd(n), qdb(n);
+    for (size_t i = 0; i < n; i++)
+        qd[i] = math::normalized(math::Quatd(q[i]));
+    math::quat_pow(qd.data(), 0.5, qdb.data(), n, 2);
+    for (size_t i = 0; i < n; i++) // but q = -1, whose square roots have an arbitrary axis
+        ASSERT_NEAR(quat_error(qdb[i] * qdb[i], qd[i]), 0.0, i == 7 ? 2.0 : 1e-14) << i;
+    EXPECT_EQ(qdb[7], math::Quatd());
+}
@@ -0,0 +1,130 @@
+#include "vmath_fixed.h"
+#include "vmath.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+using math::Fixed16;
+using math::Fixed32;
+
+TEST(Fixed, arithmetic) {
+    EXPECT_EQ(Fixed16(3).raw, 3 << 16);
+    EXPECT_EQ(Fixed16(-1.5).raw, -(3 << 15));
+    EXPECT_EQ(Fixed32(0.25f).raw, int64_t(1) << 30);
+    EXPECT_EQ(double(Fixed16(2.5) + Fixed16(-4)), -1.5);
+    EXPECT_EQ(double(Fixed16(2.5) * Fixed16(-4)), -10.0);
+    EXPECT_EQ(double(Fixed32(7) / Fixed32(2)), 3.5);
+    EXPECT_EQ(int(Fixed16(-2.75)), -2); // truncation toward zero
+    // multiplication rounds to nearest, division truncates
+    EXPECT_EQ((Fixed16::from_raw(3) * Fixed16(0.5)).raw, 2);
+    EXPECT_EQ((Fixed16::from_raw(1) / Fixed16(3)).raw, 0);
+    EXPECT_EQ(Fixed16(1) / Fixed16(0), Fixed16::max());
+    EXPECT_EQ(Fixed32(-1) / Fixed32(0), Fixed32::lowest());
+    EXPECT_EQ(reciprocal(Fixed32(4)), Fixed32(0.25));
+    // conversions between formats
+    EXPECT_EQ(Fixed16(Fixed32(1.25)), Fixed16(1.25));
+    EXPECT_EQ(Fixed32(Fixed16(-3.5)), Fixed32(-3.5));
+    EXPECT_NEAR(double(Fixed32::pi()), M_PI, 1e-9);
+    EXPECT_NEAR(double(Fixed16::pi()), M_PI, 1e-5);
+
+    // comparisons with builtin values are exact: 1e-7 is not representable in Q16.16, but 0 < 1e-7
+    EXPECT_TRUE(Fixed16(0) < 1e-7);
+    EXPECT_TRUE(Fixed16::epsilon() > 1e-7);
+    EXPECT_FALSE(Fixed16(0) == 1e-7);
+    EXPECT_TRUE(Fixed16(2) == 2);
+    EXPECT_TRUE(1.5 <= Fixed32(1.5));
+    EXPECT_TRUE(-1 > Fixed32(-1.5));
+}
+
+TEST(Fixed, functions) {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> u(-20, 20);
+    for (int i = 0; i < 20000; i++) {
+        const double a = u(gen), b = u(gen);
+        const Fixed16 a16(a), b16(b);
+        const Fixed32 a32(a), b32(b);
+        // the errors are relative to the rounded inputs
+        EXPECT_NEAR(double(sin(a16)), std::sin(double(a16)), 1.2e-5);
+        EXPECT_NEAR(double(cos(a16)), std::cos(double(a16)), 1.2e-5);
+        EXPECT_NEAR(double(sin(a32)), std::sin(double(a32)), 5e-9);
+        EXPECT_NEAR(double(cos(a32)), std::cos(double(a32)), 5e-9);
+        EXPECT_NEAR(double(atan2(a16, b16)), std::atan2(double(a16), double(b16)), 2e-5);
+        EXPECT_NEAR(double(atan2(a32, b32)), std::atan2(double(a32), double(b32)), 5e-9);
+        EXPECT_NEAR(double(sqrt(abs(a32))), std::sqrt(std::abs(double(a32))), 1e-9);
+        // the 32 bit sqrt is exact: floor(sqrt(raw * 2^16))
+        const int64_t n = int64_t(abs(a16).raw) << 16;
+        const int64_t r = sqrt(abs(a16)).raw;
+        EXPECT_TRUE(r * r <= n && (r + 1) * (r + 1) > n);
+        const double c = u(gen) / 20;
+        EXPECT_NEAR(double(asin(Fixed32(c))), std::asin(double(Fixed32(c))), 1e-8);
+        EXPECT_NEAR(double(acos(Fixed32(c))), std::acos(double(Fixed32(c))), 1e-8);
+    }
+    EXPECT_EQ(sqrt(Fixed16(-1)), Fixed16(0));
+    EXPECT_EQ(sqrt(Fixed32(16)), Fixed32(4));
+    EXPECT_NEAR(double(sqrt(Fixed32(2e9))), std::sqrt(2e9), 1e-4);
+    EXPECT_EQ(atan2(Fixed32(0), Fixed32(0)), Fixed32(0));
+}
+
+TEST(Fixed, types) {
+    typedef math::Vector3<Fixed32> V;
+    typedef math::Quaternion<Fixed32> Q;
+    V v(1.0, -2.0, 3.0);
+    const V n = math::normalized(v);
+    EXPECT_NEAR(double(math::length(n)), 1.0, 1e-8);
+    // the epsilon comparisons are exact for Q16.16
+    typedef math::Vector3<Fixed16> V16;
+    EXPECT_TRUE(V16(1, 2, 3) == V16(1, 2, 3));
+    EXPECT_FALSE(V16(1, 2, 3) == V16(Fixed16(1) + Fixed16::epsilon(), 2, 3));
+    EXPECT_TRUE(V(1, 2, 3) == V(Fixed32(1) + Fixed32::epsilon(), 2, 3));
+    EXPECT_FALSE(V(1, 2, 3) == V(1.000001, 2, 3));
+
+    const Q q = math::quat_from_euler_321<Fixed32>(Fixed32(0.1), Fixed32(-0.7), Fixed32(2.3));
+    const math::Quatd qd = math::quat_from_euler_321<double>(0.1, -0.7, 2.3);
+    EXPECT_NEAR(double(q.w), qd.w, 1e-8);
+    EXPECT_NEAR(double(q.z), qd.z, 1e-8);
+    const V e = math::to_euler_321(q);
+    EXPECT_NEAR(double(e.x), 0.1, 1e-8);
+    EXPECT_NEAR(double(e.y), -0.7, 1e-8);
+    EXPECT_NEAR(double(e.z), 2.3, 1e-8);
+    const V r = q.rotate(v);
+    const math::Vector3d rd = qd.rotate(math::Vector3d(1, -2, 3));
+    EXPECT_NEAR(double(r.x), rd.x, 5e-8);
+    EXPECT_NEAR(double(r.y), rd.y, 5e-8);
+    EXPECT_NEAR(double(r.z), rd.z, 5e-8);
+
+    const Q m = math::quat_from_matrix(math::rot_matrix(q));
+    EXPECT_NEAR(double(m.w * q.w + m.x * q.x + m.y * q.y + m.z * q.z), 1.0, 1e-8);
+    const Q s = math::slerp(Q(), q, Fixed32(0.25));
+    const math::Quatd sd = math::slerp(math::Quatd(), qd, 0.25);
+    EXPECT_NEAR(double(s.x), sd.x, 1e-8);
+    EXPECT_NEAR(double(math::angle(q)), math::angle(qd), 1e-8);
+
+    const math::Matrix4<Fixed32> t = math::create_transformation(V(1, 2, 3), q);
+    const math::Matrix4<Fixed32> id = t * math::inverse(t);
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            EXPECT_NEAR(double(id(i, j)), i == j ? 1.0 : 0.0, 1e-8);
+    const math::Transform<Fixed16> tf(math::Vector3<Fixed16>(1, 2, 3), math::Quaternion<Fixed16>(q));
+    const math::Vector3<Fixed16> p = tf.inv_transform(tf.transform(math::Vector3<Fixed16>(4, 5, 6)));
+    EXPECT_NEAR(double(p.x), 4.0, 1e-3);
+    EXPECT_NEAR(double(p.z), 6.0, 1e-3);
+}
+
+TEST(Fixed, determinism) {
+    // a small rigid body simulation; the hash of the final state is the same on every machine and compiler
+    math::Transform<Fixed16> body(math::Vector3<Fixed16>(0.5, -1, 2), math::Quaternion<Fixed16>());
+    const math::Vector3<Fixed16> w(0.3, -0.2, 0.9), vel(0.01, 0.02, -0.005);
+    const Fixed16 dt(1.0 / 60);
+    uint64_t hash = 0;
+    for (int i = 0; i < 1000; i++) {
+        const math::Quaternion<Fixed16> dq = math::quat_from_axis_angle(math::normalized(w), math::length(w) * dt);
+        body.q = math::normalized(dq * body.q);
+        body.p += body.q.rotate(vel);
+        const math::Vector3<Fixed16> e = math::to_euler_321(body.q);
+        hash = hash * 1000003u ^ uint32_t(body.p.x.raw) ^ (uint64_t(uint32_t(body.q.w.raw)) << 32) ^ uint32_t(e.z.raw);
+    }
+    EXPECT_EQ(hash, 9204547076459204833u);
+}
@@ -0,0 +1,164 @@
+#include "vmath.h"
+#include "vmath_frame.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+std::vector<math::Vector3f> random_normals(size_t n, uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> d;
+    std::vector<math::Vector3f> normals(n);
+    for (auto &v : normals)
+        v = math::normalized(math::Vector3f(d(gen), d(gen), d(gen)));
+    // poles, the discontinuity plane z = 0 and the neighbourhood of -z
+    normals[0] = math::Vector3f(0.f, 0.f, 1.f);
+    normals[1] = math::Vector3f(0.f, 0.f, -1.f);
+    normals[2] = math::Vector3f(1.f, 0.f, 0.f);
+    normals[3] = math::Vector3f(0.f, -1.f, 0.f);
+    normals[4] = math::normalized(math::Vector3f(1e-4f, -2e-4f, -1.f));
+    normals[5] = math::normalized(math::Vector3f(0.6f, 0.8f, -0.f));
+    return normals;
+}
+
+// grid of n x n vertices in the plane z = 0, texture coordinates (sign * x, y)
+void grid(size_t n, float sign, std::vector<math::Vector3f> &positions, std::vector<math::Vector3f> &normals,
+          std::vector<math::Vector2f> &uvs, std::vector<uint32_t> &indices) {
+    for (size_t j = 0; j < n; j++) {
+        for (size_t i = 0; i < n; i++) {
+            positions.push_back(math::Vector3f(float(i), float(j), 0.f));
+            normals.push_back(math::Vector3f(0.f, 0.f, 1.f));
+            uvs.push_back(math::Vector2f(sign * float(i) * 0.1f, float(j) * 0.1f));
+        }
+    }
+    for (uint32_t j = 0; j + 1 < n; j++) {
+        for (uint32_t i = 0; i + 1 < n; i++) {
+            const uint32_t v = j * uint32_t(n) + i;
+            for (uint32_t k : {v, v + 1, v + uint32_t(n) + 1, v, v + uint32_t(n) + 1, v + uint32_t(n)})
+                indices.push_back(k);
+        }
+    }
+}
+} // namespace
+
+TEST(Frame, orthonormal_basis) {
+    const size_t n = 10007;
+    const std::vector<math::Vector3f> normals = random_normals(n, 1);
+    for (const math::Vector3f &v : normals) {
+        const math::Vector3d nd = math::normalized(math::Vector3d(v));
+        math::Vector3d b1, b2;
+        math::orthonormal_basis(nd, b1, b2);
+        ASSERT_NEAR(math::length(b1), 1.0, 1e-9);
+        ASSERT_NEAR(math::length(b2), 1.0, 1e-9);
+        ASSERT_NEAR(b1.dot(b2), 0.0, 1e-9);
+        ASSERT_NEAR(b1.dot(nd), 0.0, 1e-9);
+        ASSERT_NEAR(math::length(b1.cross(b2) - nd), 0.0, 1e-9);
+        // the matrix is the rotation with these columns
+        const math::Matrix3d m = math::orthonormal_basis(nd);
+        ASSERT_EQ(m(0, 0), b1.x);
+        ASSERT_EQ(m(2, 1), b2.z);
+        ASSERT_EQ(m(1, 2), nd.y);
+    }
+    // batch, with the tails of the SIMD loop
+    for (size_t count : {size_t(0), size_t(3), size_t(6), n}) {
+        std::vector<math::Vector3f> b1(count + 1), b2(count + 1);
+        math::orthonormal_basis(normals.data(), b1.data(), b2.data(), count, 4);
+        for (size_t i = 0; i < count; i++) {
+            math::Vector3f s1, s2;
+            math::orthonormal_basis(normals[i], s1, s2);
+            ASSERT_NEAR(math::length(b1[i] - s1), 0.f, 1e-6f) << i;
+            ASSERT_NEAR(math::length(b2[i] - s2), 0.f, 1e-6f) << i;
+            ASSERT_NEAR(b1[i].dot(normals[i]), 0.f, 1e-6f) << i;
+        }
+        EXPECT_EQ(b1[count], math::Vector3f(0.f, 0.f, 0.f));
+    }
+}
+
+TEST(Frame, tangents) {
+    for (float sign : {1.f, -1.f}) {
+        std::vector<math::Vector3f> positions, normals;
+        std::vector<math::Vector2f> uvs;
+        std::vector<uint32_t> indices;
+        grid(9, sign, positions, normals, uvs, indices);
+        std::vector<math::Vector4f> tangents(positions.size());
+        std::vector<math::Vector3f> bitangents(positions.size());
+        math::compute_tangents(positions.data(), normals.data(), uvs.data(), positions.size(), indices.data(),
+                               indices.size() / 3, tangents.data(), bitangents.data(), 2);
+        for (size_t v = 0; v < positions.size(); v++) {
+            // a mirrored mapping flips the tangent and the handedness, the bitangent still follows v
+            ASSERT_NEAR(tangents[v].x, sign, 1e-6f);
+            ASSERT_NEAR(tangents[v].y, 0.f, 1e-6f);
+            ASSERT_NEAR(tangents[v].z, 0.f, 1e-6f);
+            ASSERT_EQ(tangents[v].w, sign);
+            ASSERT_NEAR(math::length(bitangents[v] - math::Vector3f(0.f, 1.f, 0.f)), 0.f, 1e-6f);
+        }
+    }
+
+    // curved mesh with noisy normals, degenerate texture coordinates and an unreferenced vertex: orthonormal
+    // frames, independent of the number of threads
+    std::vector<math::Vector3f> positions, normals;
+    std::vector<math::Vector2f> uvs;
+    std::vector<uint32_t> indices;
+    grid(150, 1.f, positions, normals, uvs, indices);
+    std::mt19937 gen(2);
+    std::uniform_real_distribution<float> d(-0.3f, 0.3f);
+    for (size_t v = 0; v < positions.size(); v++) {
+        positions[v].z = std::sin(positions[v].x * 0.1f) * 3.f;
+        normals[v] = math::normalized(math::Vector3f(d(gen), d(gen), 1.f));
+    }
+    for (size_t v = 0; v < 150; v++)
+        uvs[v] = math::Vector2f(0.f, 0.f);
+    indices.resize(indices.size() - 6); // the last vertex is not referenced
+    std::vector<math::Vector4f> t1(positions.size()), t4(positions.size());
+    math::compute_tangents(positions.data(), normals.data(), uvs.data(), positions.size(), indices.data(),
+                           indices.size() / 3, t1.data(), static_cast<math::Vector3f *>(nullptr), 1);
+    math::compute_tangents(positions.data(), normals.data(), uvs.data(), positions.size(), indices.data(),
+                           indices.size() / 3, t4.data(), static_cast<math::Vector3f *>(nullptr), 4);
+    for (size_t v = 0; v < positions.size(); v++) {
+        ASSERT_EQ(t1[v], t4[v]) << v;
+        const math::Vector3f t(t1[v].x, t1[v].y, t1[v].z);
+        ASSERT_NEAR(math::length(t), 1.f, 1e-5f) << v;
+        ASSERT_NEAR(t.dot(normals[v]), 0.f, 1e-5f) << v;
+        ASSERT_TRUE(t1[v].w == 1.f || t1[v].w == -1.f);
+    }
+}
+
+TEST(Frame, qtangent) {
+    const size_t n = 4096;
+    std::vector<math::Vector3f> normals = random_normals(n, 3);
+    std::vector<math::Vector4f> tangents(n);
+    std::mt19937 gen(4);
+    std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+    for (size_t i = 0; i < n; i++) {
+        math::Vector3f b1, b2;
+        math::orthonormal_basis(normals[i], b1, b2);
+        const float a = i == 7 ? 3.14159265f : angle(gen);
+        const math::Vector3f t = b1 * std::cos(a) + b2 * std::sin(a);
+        tangents[i] = math::Vector4f(t.x, t.y, t.z, i % 3 == 0 ? -1.f : 1.f);
+    }
+    // a frame rotated by 180 degrees (w = 0) with both handedness
+    tangents[8] = math::Vector4f(-1.f, 0.f, 0.f, 1.f);
+    tangents[9] = math::Vector4f(-1.f, 0.f, 0.f, -1.f);
+    normals[8] = normals[9] = math::Vector3f(0.f, 0.f, -1.f);
+
+    std::vector<math::Quatf> q(n);
+    math::qtangent_encode(normals.data(), tangents.data(), q.data(), n, 2);
+    std::vector<math::Vector3f> decoded_normals(n);
+    std::vector<math::Vector4f> decoded_tangents(n);
+    math::qtangent_decode(q.data(), decoded_normals.data(), decoded_tangents.data(), n, 2);
+    for (size_t i = 0; i < n; i++) {
+        ASSERT_EQ(q[i], math::qtangent_encode(normals[i], tangents[i]));
+        ASSERT_NEAR(math::length(q[i]), 1.f, 1e-5f);
+        ASSERT_GE(std::abs(q[i].w), 1.f / 32767.f) << i;
+        ASSERT_NEAR(math::length(decoded_normals[i] - normals[i]), 0.f, 1e-4f) << i;
+        const math::Vector3f t(tangents[i].x, tangents[i].y, tangents[i].z);
+        const math::Vector3f dt(decoded_tangents[i].x, decoded_tangents[i].y, decoded_tangents[i].z);
+        ASSERT_NEAR(math::length(dt - t), 0.f, 1e-4f) << i;
+        ASSERT_EQ(decoded_tangents[i].w, tangents[i].w) << i;
+        // the sign of w survives a 16 bit snorm quantization
+        ASSERT_NE(std::round(q[i].w * 32767.f), 0.f) << i;
+    }
+}
@@ -127,6 +127,119 @@ TEST(Functions, matrix3) {
                                            0, 0, 0}));
 }
 
+TEST(Functions, matrix3_decompositions) {
+    // rotation * (scaling + shear): polar decomposition must recover the rotation
+    math::Matrix3d rot = math::rot_matrix(math::normalized(math::Quatd(0.8, 0.1, -0.3, 0.5)));
+    math::Matrix3d stretch {2.0, 0.3, 0.1,
+                            0.3, 0.5, 0.2,
+                            0.1, 0.2, 1.5};
+    math::Matrix3d m = rot * stretch;
+    math::Matrix3d r, s;
+    math::polar_decompose(m, r, s);
+    ASSERT_EQ(r, rot);
+    ASSERT_EQ(s, stretch);
+    ASSERT_EQ(r * s, m);
+    // heavily scaled input (condition number 1e4)
+    math::Matrix3d m2 = rot * math::Matrix3d({100.0, 0.0,  0.0,
+                                              0.0,   1.0,  0.0,
+                                              0.0,   0.0,  0.01});
+    math::polar_decompose(m2, r, s);
+    ASSERT_EQ(r, rot);
+    // QR
+    math::Matrix3d m3 {1,2,3,
+                       6,5,4,
+                       3,8,5};
+    math::Matrix3d q, rr;
+    math::qr_decompose(m3, q, rr);
+    ASSERT_EQ(q * rr, m3);
+    math::Matrix3d qt = q;
+    math::transpose(qt);
+    ASSERT_EQ(qt * q, math::matrix3_identity<double>());
+    ASSERT_DOUBLE_EQ(rr(1, 0), 0.0);
+    ASSERT_DOUBLE_EQ(rr(2, 0), 0.0);
+    ASSERT_DOUBLE_EQ(rr(2, 1), 0.0);
+    ASSERT_GT(rr(0, 0), 0.0);
+    ASSERT_GT(rr(1, 1), 0.0);
+    ASSERT_GT(rr(2, 2), 0.0);
+    // symmetric eigen decomposition
+    math::Matrix3d inertia {4.0, -1.0, 0.5,
+                           -1.0,  3.0, 0.2,
+                            0.5,  0.2, 1.0};
+    math::Matrix3d v;
+    math::Vector3d ev;
+    math::eigen_decompose(inertia, v, ev);
+    ASSERT_GE(ev.x, ev.y);
+    ASSERT_GE(ev.y, ev.z);
+    ASSERT_NEAR(math::det(v), 1.0, 1e-12);
+    math::Matrix3d d {ev.x, 0,    0,
+                      0,    ev.y, 0,
+                      0,    0,    ev.z};
+    math::Matrix3d vt = v;
+    math::transpose(vt);
+    ASSERT_EQ(v * d * vt, inertia);
+    // SVD: u and v are rotations, singular values sorted by magnitude
+    math::Matrix3d u;
+    math::Vector3d sigma;
+    math::Matrix3d m5 {6,5,4,
+                       1,2,3,
+                       3,8,5}; // rows swapped => det(m5) = -56
+    math::svd_decompose(m5, u, sigma, v);
+    ASSERT_NEAR(math::det(u), 1.0, 1e-9);
+    ASSERT_NEAR(math::det(v), 1.0, 1e-9);
+    ASSERT_GE(std::abs(sigma.x), std::abs(sigma.y));
+    ASSERT_GE(std::abs(sigma.y), std::abs(sigma.z));
+    ASSERT_LT(sigma.z, 0.0); // the sign of the determinant goes in the smallest singular value
+    math::Matrix3d ds {sigma.x, 0,       0,
+                       0,       sigma.y, 0,
+                       0,       0,       sigma.z};
+    vt = v;
+    math::transpose(vt);
+    ASSERT_EQ(u * ds * vt, m5);
+    // a rotation times a scaling: the singular values are the scale factors, sorted
+    math::svd_decompose(rot * math::Matrix3d({3,0,0, 0,1,0, 0,0,2}), u, sigma, v);
+    ASSERT_EQ(sigma, math::Vector3d(3, 2, 1));
+    // rank deficient input
+    math::Matrix3d singular {1,2,3,
+                             2,4,6,
+                             1,1,1};
+    math::svd_decompose(singular, u, sigma, v);
+    vt = v;
+    math::transpose(vt);
+    ASSERT_NEAR(sigma.z, 0.0, 1e-6);
+    ASSERT_EQ(u * math::Matrix3d({sigma.x,0,0, 0,sigma.y,0, 0,0,sigma.z}) * vt, singular);
+    // already diagonal (and with repeated eigenvalues)
+    math::eigen_decompose(math::Matrix3d({1,0,0,
+                                          0,3,0,
+                                          0,0,3}), v, ev);
+    ASSERT_EQ(ev, math::Vector3d(3, 3, 1));
+    ASSERT_EQ(math::Vector3d(v(0, 2), v(1, 2), v(2, 2)), math::Vector3d(1, 0, 0));
+    // batch versions give the same results as the single matrix ones
+    std::vector<math::Matrix3f> mf = {math::Matrix3f(m), math::Matrix3f(m2), math::Matrix3f(inertia)};
+    std::vector<math::Matrix3f> out1(3), out2(3);
+    std::vector<math::Vector3f> evf(3);
+    math::polar_decompose(mf.data(), out1.data(), out2.data(), mf.size());
+    math::Matrix3f rf, sf;
+    math::polar_decompose(mf[1], rf, sf);
+    ASSERT_EQ(out1[1], rf);
+    ASSERT_EQ(out2[1], sf);
+    math::qr_decompose(mf.data(), out1.data(), out2.data(), mf.size());
+    math::qr_decompose(mf[2], rf, sf);
+    ASSERT_EQ(out1[2], rf);
+    ASSERT_EQ(out2[2], sf);
+    math::svd_decompose(mf.data(), out1.data(), evf.data(), out2.data(), mf.size());
+    math::Vector3f sv;
+    math::Matrix3f uf, vf;
+    math::svd_decompose(mf[0], uf, sv, vf);
+    ASSERT_EQ(out1[0], uf);
+    ASSERT_EQ(evf[0], sv);
+    ASSERT_EQ(out2[0], vf);
+    math::eigen_decompose(mf.data(), out1.data(), evf.data(), mf.size());
+    math::Vector3f evs;
+    math::eigen_decompose(mf[2], rf, evs);
+    ASSERT_EQ(out1[2], rf);
+    ASSERT_EQ(evf[2], evs);
+}
+
 TEST(Functions, matrix4) {
     math::Matrix4d m1 {1,2,3,4,
                        5,6,7,8,
@@ -0,0 +1,185 @@
+#include "vmath.h"
+#include "vmath_generic.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+namespace {
+
+template <int R, int C, typename T> void fill_random(math::Matrix<R, C, T> &m, std::mt19937 &gen) {
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (int i = 0; i < R * C; i++)
+        m.data[i] = T(dist(gen));
+}
+
+// naive reference product in double
+template <int R, int K, int C, typename T>
+math::Matrix<R, C, double> reference_mul(const math::Matrix<R, K, T> &a, const math::Matrix<K, C, T> &b) {
+    math::Matrix<R, C, double> ret;
+    for (int i = 0; i < R; i++)
+        for (int j = 0; j < C; j++) {
+            double acc = 0;
+            for (int k = 0; k < K; k++)
+                acc += double(a(i, k)) * double(b(k, j));
+            ret(i, j) = acc;
+        }
+    return ret;
+}
+
+template <int R, int K, int C, typename T> void check_products(std::mt19937 &gen, double tol) {
+    math::Matrix<R, K, T> a;
+    math::Matrix<K, C, T> b;
+    fill_random(a, gen);
+    fill_random(b, gen);
+    const auto ref = reference_mul(a, b);
+    const auto ab = a * b;
+    for (int i = 0; i < R; i++)
+        for (int j = 0; j < C; j++)
+            EXPECT_NEAR(ab(i, j), ref(i, j), tol) << R << "x" << K << "x" << C << " (" << i << "," << j << ")";
+    const math::Vector<R, T> av = a * b.col(0);
+    for (int i = 0; i < R; i++)
+        EXPECT_NEAR(av[i], ref(i, 0), tol);
+    // transpose(a) * v against the explicitly transposed matrix
+    const math::Vector<K, T> atv = math::transpose_mul(a, av);
+    const math::Vector<K, T> atv_ref = math::transposed(a) * av;
+    for (int k = 0; k < K; k++)
+        EXPECT_NEAR(atv[k], atv_ref[k], tol);
+}
+
+} // namespace
+
+TEST(Generic, vector) {
+    math::Vector6d v = {1, 2, 3, 4, 5, 6};
+    const math::Vector6d zero;
+    for (int i = 0; i < 6; i++)
+        EXPECT_EQ(zero[i], 0.0);
+    EXPECT_EQ(v[5], 6.0);
+    EXPECT_EQ(math::dot(v, v), 91.0);
+    EXPECT_DOUBLE_EQ(math::length(v), std::sqrt(91.0));
+    EXPECT_NEAR(math::length(math::normalized(v)), 1.0, 1e-15);
+    EXPECT_EQ(v + v, 2.0 * v);
+    EXPECT_EQ(v - v, zero);
+    EXPECT_EQ(-v + v, zero);
+    EXPECT_EQ((v * 4.0) / 2.0, v * 2.0);
+    // comparison within VMATH_EPSILON, as the fixed size types
+    math::Vector6d close = v;
+    close[3] += 1e-8;
+    EXPECT_EQ(close, v);
+    close[3] += 1e-3;
+    EXPECT_NE(close, v);
+    v += v;
+    EXPECT_EQ(v[2], 6.0);
+    v /= 2.0;
+    EXPECT_EQ(v[2], 3.0);
+
+    const math::Vector<3, double> top = math::segment<3>(v, 0), bottom = math::segment<3>(v, 3);
+    EXPECT_EQ(bottom[0], 4.0);
+    math::Vector6d swapped;
+    math::set_segment(swapped, 0, bottom);
+    math::set_segment(swapped, 3, top);
+    EXPECT_EQ(swapped[0], 4.0);
+    EXPECT_EQ(swapped[5], 3.0);
+
+    // float to double conversion
+    const math::Vector6f vf = v;
+    EXPECT_EQ(math::Vector6d(vf), v);
+}
+
+TEST(Generic, compatibility) {
+    // round trips with the hand-written types, and the same results for the same operations
+    const math::Vector3f a(1.f, -2.f, 0.5f), b(0.25f, 3.f, -1.f);
+    const math::Vector<3, float> ga = a, gb = b;
+    EXPECT_EQ(ga[1], -2.f);
+    const math::Vector3f back = ga + gb;
+    EXPECT_EQ(back, a + b);
+    EXPECT_EQ(math::dot(ga, gb), a.dot(b));
+
+    const math::Vector4d v4(1, 2, 3, 4);
+    const math::Vector<4, double> gv4 = v4;
+    EXPECT_EQ(math::Vector4d(gv4), v4);
+
+    const math::Matrix3f m3 = {1, 2, 3, 4, 5, 6, 7, 8, 10};
+    const math::Matrix<3, 3, float> gm3 = {1, 2, 3, 4, 5, 6, 7, 8, 10};
+    EXPECT_EQ((math::Matrix<3, 3, float>(m3)), gm3);
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            EXPECT_EQ(gm3(i, j), m3(i, j));
+    EXPECT_EQ(math::Matrix3f(gm3 * gm3), m3 * m3);
+    EXPECT_EQ(math::Vector3f(gm3 * ga), m3 * a);
+
+    std::mt19937 gen(3);
+    math::Matrix<4, 4, double> gm4;
+    fill_random(gm4, gen);
+    const math::Matrix4d m4 = gm4;
+    const math::Matrix4d p4 = gm4 * gm4;
+    const math::Matrix4d r4 = m4 * m4;
+    for (int i = 0; i < 16; i++)
+        EXPECT_NEAR(p4.data[i], r4.data[i], 1e-15);
+    const math::Vector4d mv = gm4 * math::Vector<4, double>(v4);
+    EXPECT_NEAR(math::length(mv - m4 * v4), 0.0, 1e-14);
+}
+
+TEST(Generic, matrix) {
+    std::mt19937 gen(1);
+    // all the sizes hit the SSE2 kernels with and without scalar tails
+    check_products<6, 6, 6, float>(gen, 1e-5);
+    check_products<6, 6, 6, double>(gen, 1e-13);
+    check_products<3, 5, 7, float>(gen, 1e-5);
+    check_products<7, 3, 2, double>(gen, 1e-13);
+    check_products<9, 4, 1, float>(gen, 1e-5);
+    check_products<1, 6, 5, double>(gen, 1e-13);
+
+    math::Matrix6d m;
+    fill_random(m, gen);
+    math::Matrix6d id;
+    math::set_identity(id);
+    EXPECT_EQ(m * id, m);
+    EXPECT_EQ(id * m, m);
+    EXPECT_DOUBLE_EQ(math::trace(id), 6.0);
+    math::Matrix6d mt = m;
+    math::transpose(mt);
+    EXPECT_EQ(mt, math::transposed(m));
+    EXPECT_EQ(mt(1, 4), m(4, 1));
+    EXPECT_EQ(math::transposed(mt), m);
+    EXPECT_EQ(m.row(2), mt.col(2));
+    EXPECT_EQ(m + m, 2.0 * m);
+    EXPECT_EQ(-m + m, math::Matrix6d());
+    math::set_zero(mt);
+    EXPECT_EQ(mt, math::Matrix6d());
+
+    // row-major initialization, as for Matrix3/Matrix4
+    const math::Matrix<2, 3, float> r = {1, 2, 3, 4, 5, 6};
+    EXPECT_EQ(r(0, 2), 3.f);
+    EXPECT_EQ(r(1, 0), 4.f);
+    const float rows[] = {1, 2, 3, 4, 5, 6};
+    EXPECT_EQ((math::Matrix<2, 3, float>(rows)), r);
+
+    const math::Vector<3, double> u = {1, 2, 3}, w = {4, 5, 6};
+    const math::Matrix<3, 3, double> uw = math::outer(u, w);
+    EXPECT_EQ(uw(2, 0), 12.0);
+    EXPECT_EQ(uw * w, u * math::dot(w, w));
+}
+
+TEST(Generic, blocks) {
+    // a 6x6 spatial style matrix assembled from 3x3 blocks
+    const math::Matrix3d a = {1, 2, 3, 4, 5, 6, 7, 8, 9}, b = {0, -3, 2, 3, 0, -1, -2, 1, 0};
+    math::Matrix6d m;
+    math::set_block(m, 0, 0, math::Matrix<3, 3, double>(a));
+    math::set_block(m, 3, 3, math::Matrix<3, 3, double>(a));
+    math::set_block(m, 3, 0, math::Matrix<3, 3, double>(b));
+    EXPECT_EQ(m(4, 0), b(1, 0));
+    EXPECT_EQ(m(0, 4), 0.0);
+    EXPECT_EQ(math::Matrix3d(math::block<3, 3>(m, 3, 3)), a);
+    EXPECT_EQ(math::Matrix3d(math::block<3, 3>(m, 3, 0)), b);
+    EXPECT_EQ((math::block<1, 2>(m, 4, 1)(0, 1)), b(1, 2));
+
+    // the block product matches the 3x3 products
+    const math::Vector6d v = {1, -1, 2, 0.5, 3, -2};
+    const math::Vector6d mv = m * v;
+    const math::Vector3d top = math::Vector<3, double>(math::Matrix<3, 3, double>(a) * math::segment<3>(v, 0));
+    const math::Vector3d bottom = b * math::Vector3d(1, -1, 2) + a * math::Vector3d(0.5, 3, -2);
+    EXPECT_EQ(math::Vector3d(math::segment<3>(mv, 0)), top);
+    EXPECT_EQ(math::Vector3d(math::segment<3>(mv, 3)), bottom);
+}
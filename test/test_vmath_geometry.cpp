@@ -0,0 +1,287 @@
+#include "vmath_geometry.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+template <typename T> math::Vector3<T> rand_point(std::mt19937 &gen, T range) {
+    std::uniform_real_distribution<T> d(-range, range);
+    return math::Vector3<T>(d(gen), d(gen), d(gen));
+}
+template <typename T> math::OBB<T> rand_obb(std::mt19937 &gen, T range) {
+    std::uniform_real_distribution<T> ext(T(0.1), T(2));
+    math::Quaternion<T> q(rand_point(gen, T(1)).x, rand_point(gen, T(1)).y, rand_point(gen, T(1)).z,
+                          rand_point(gen, T(1)).x);
+    return math::create_obb(math::Transform<T>(rand_point(gen, range), normalized(q)),
+                            math::Vector3<T>(ext(gen), ext(gen), ext(gen)));
+}
+} // namespace
+
+TEST(Geometry, closest_point_on_segment) {
+    math::Vector3d a(0, 0, 0), b(2, 0, 0);
+    ASSERT_TRUE(closest_point_on_segment(math::Vector3d(1, 3, 0), a, b) == math::Vector3d(1, 0, 0));
+    ASSERT_TRUE(closest_point_on_segment(math::Vector3d(-1, 1, 0), a, b) == a);
+    ASSERT_TRUE(closest_point_on_segment(math::Vector3d(5, 1, 1), a, b) == b);
+    // degenerate segment
+    ASSERT_TRUE(closest_point_on_segment(math::Vector3d(5, 1, 1), a, a) == a);
+    ASSERT_DOUBLE_EQ(distance2_point_segment(math::Vector3d(1, 3, 4), a, b), 25.0);
+}
+
+TEST(Geometry, closest_point_on_triangle) {
+    math::Vector3d a(0, 0, 0), b(1, 0, 0), c(0, 1, 0);
+    // face
+    ASSERT_TRUE(closest_point_on_triangle(math::Vector3d(0.25, 0.25, 2), a, b, c) == math::Vector3d(0.25, 0.25, 0));
+    // vertices
+    ASSERT_TRUE(closest_point_on_triangle(math::Vector3d(-1, -1, 1), a, b, c) == a);
+    ASSERT_TRUE(closest_point_on_triangle(math::Vector3d(2, -1, 0), a, b, c) == b);
+    ASSERT_TRUE(closest_point_on_triangle(math::Vector3d(-1, 2, 0), a, b, c) == c);
+    // edges
+    ASSERT_TRUE(closest_point_on_triangle(math::Vector3d(0.5, -1, 0), a, b, c) == math::Vector3d(0.5, 0, 0));
+    ASSERT_TRUE(closest_point_on_triangle(math::Vector3d(-1, 0.5, 0), a, b, c) == math::Vector3d(0, 0.5, 0));
+    ASSERT_TRUE(closest_point_on_triangle(math::Vector3d(1, 1, 0), a, b, c) == math::Vector3d(0.5, 0.5, 0));
+    // the result is never farther than any vertex and is on the plane of the triangle
+    std::mt19937 gen(1);
+    for (int i = 0; i < 1000; i++) {
+        math::Vector3d p = rand_point(gen, 3.0);
+        math::Vector3d q = closest_point_on_triangle(p, a, b, c);
+        ASSERT_NEAR(q.z, 0.0, 1e-12);
+        ASSERT_GE(q.x, -1e-12);
+        ASSERT_GE(q.y, -1e-12);
+        ASSERT_LE(q.x + q.y, 1 + 1e-12);
+        ASSERT_LE(length2(p - q), length2(p - math::Vector3d(q.x * 0.5, q.y * 0.5, 0)) + 1e-12);
+    }
+}
+
+TEST(Geometry, closest_point_on_boxes) {
+    math::AABBd box{math::Vector3d(-1, -2, -3), math::Vector3d(1, 2, 3)};
+    ASSERT_TRUE(closest_point_on_aabb(math::Vector3d(0.5, 0.5, 0.5), box) == math::Vector3d(0.5, 0.5, 0.5));
+    ASSERT_TRUE(closest_point_on_aabb(math::Vector3d(5, -5, 1), box) == math::Vector3d(1, -2, 1));
+    // an OBB with identity rotation behaves as the equivalent AABB
+    math::OBBd obb = math::create_obb(math::Transform<double>(),
+                                      math::Vector3d(1, 2, 3));
+    std::mt19937 gen(2);
+    for (int i = 0; i < 100; i++) {
+        math::Vector3d p = rand_point(gen, 5.0);
+        ASSERT_TRUE(closest_point_on_obb(p, obb) == closest_point_on_aabb(p, box));
+    }
+    // rotated box: closest point in world space matches the clamped point in local space
+    math::Transform<double> pose(math::Vector3d(1, 2, 3),
+                                 math::quat_from_axis_angle(math::Vector3d(0, 0, 1), M_PI / 4));
+    obb = math::create_obb(pose, math::Vector3d(1, 2, 3));
+    for (int i = 0; i < 100; i++) {
+        math::Vector3d p = rand_point(gen, 5.0);
+        math::Vector3d expected = pose.transform(closest_point_on_aabb(pose.inverse().transform(p), box));
+        math::Vector3d q = closest_point_on_obb(p, obb);
+        ASSERT_NEAR(length(q - expected), 0.0, 1e-12);
+    }
+}
+
+TEST(Geometry, segment_segment) {
+    math::Vector3d c1, c2;
+    // crossing segments
+    double d2 = closest_points_segment_segment(math::Vector3d(-1, 0, 0), math::Vector3d(1, 0, 0),
+                                               math::Vector3d(0, -1, 1), math::Vector3d(0, 1, 1), c1, c2);
+    ASSERT_DOUBLE_EQ(d2, 1.0);
+    ASSERT_TRUE(c1 == math::Vector3d(0, 0, 0));
+    ASSERT_TRUE(c2 == math::Vector3d(0, 0, 1));
+    // parallel segments
+    d2 = closest_points_segment_segment(math::Vector3d(0, 0, 0), math::Vector3d(1, 0, 0), math::Vector3d(0, 2, 0),
+                                       math::Vector3d(1, 2, 0), c1, c2);
+    ASSERT_DOUBLE_EQ(d2, 4.0);
+    // end point regions
+    d2 = closest_points_segment_segment(math::Vector3d(0, 0, 0), math::Vector3d(1, 0, 0), math::Vector3d(3, 1, 0),
+                                        math::Vector3d(3, 5, 0), c1, c2);
+    ASSERT_DOUBLE_EQ(d2, 5.0);
+    ASSERT_TRUE(c1 == math::Vector3d(1, 0, 0));
+    ASSERT_TRUE(c2 == math::Vector3d(3, 1, 0));
+    // degenerate segments
+    ASSERT_DOUBLE_EQ(distance2_segment_segment(math::Vector3d(0, 0, 0), math::Vector3d(0, 0, 0),
+                                               math::Vector3d(0, 1, 0), math::Vector3d(0, 1, 0)),
+                     1.0);
+    ASSERT_DOUBLE_EQ(distance2_segment_segment(math::Vector3d(1, 1, 0), math::Vector3d(1, 1, 0),
+                                               math::Vector3d(0, 0, 0), math::Vector3d(2, 0, 0)),
+                     1.0);
+    // compare against brute force sampling
+    std::mt19937 gen(3);
+    for (int i = 0; i < 100; i++) {
+        math::Vector3d p1 = rand_point(gen, 2.0), q1 = rand_point(gen, 2.0);
+        math::Vector3d p2 = rand_point(gen, 2.0), q2 = rand_point(gen, 2.0);
+        double best = 1e30;
+        for (int s = 0; s <= 100; s++)
+            best = std::min(best, distance2_point_segment(p1 + (q1 - p1) * (s / 100.0), p2, q2));
+        d2 = distance2_segment_segment(p1, q1, p2, q2);
+        ASSERT_LE(d2, best + 1e-12);
+        ASSERT_GE(d2, best - 0.1);
+    }
+}
+
+TEST(Geometry, overlap) {
+    math::Sphered s1{math::Vector3d(0, 0, 0), 1.0};
+    math::Sphered s2{math::Vector3d(1.5, 0, 0), 0.6};
+    math::Sphered s3{math::Vector3d(3, 0, 0), 0.6};
+    ASSERT_TRUE(overlap(s1, s2));
+    ASSERT_FALSE(overlap(s1, s3));
+    math::Capsuled c1{math::Vector3d(-5, 2, 0), math::Vector3d(5, 2, 0), 0.5};
+    math::Capsuled c2{math::Vector3d(0, -5, 1), math::Vector3d(0, 5, 1), 0.5};
+    ASSERT_TRUE(overlap(s1, c1) == false);
+    ASSERT_TRUE(overlap(math::Sphered{math::Vector3d(0, 0, 0), 1.6}, c1));
+    ASSERT_TRUE(overlap(c1, math::Sphered{math::Vector3d(0, 0, 0), 1.6}));
+    ASSERT_TRUE(overlap(c1, c2));
+    c2.radius = 0.2;
+    ASSERT_FALSE(overlap(c1, c2));
+    math::AABBd b1{math::Vector3d(-1, -1, -1), math::Vector3d(1, 1, 1)};
+    math::AABBd b2{math::Vector3d(0.5, 0.5, 0.5), math::Vector3d(2, 2, 2)};
+    math::AABBd b3{math::Vector3d(1.5, -1, -1), math::Vector3d(2, 1, 1)};
+    ASSERT_TRUE(overlap(b1, b2));
+    ASSERT_FALSE(overlap(b1, b3));
+    ASSERT_TRUE(overlap(s2, b1));
+    ASSERT_FALSE(overlap(b1, s3));
+    // spheres against a rotated box
+    math::OBBd o1 = math::create_obb(
+        math::Transform<double>(math::quat_from_axis_angle(math::Vector3d(0, 0, 1), M_PI / 4)),
+        math::Vector3d(1, 1, 1));
+    ASSERT_TRUE(overlap(math::Sphered{math::Vector3d(1.5, 0, 0), 0.2}, o1));  // corner reaches x=sqrt(2)
+    ASSERT_FALSE(overlap(o1, math::Sphered{math::Vector3d(1.5, 1.5, 0), 0.2})); // face at distance sqrt(2)*1.5-1
+}
+
+TEST(Geometry, overlap_obb_obb) {
+    math::OBBd a = math::create_obb(math::Transform<double>(), math::Vector3d(1, 1, 1));
+    // separated along a face axis
+    math::OBBd b = math::create_obb(math::Transform<double>(math::Vector3d(2.5, 0, 0)),
+                                    math::Vector3d(1, 1, 1));
+    ASSERT_FALSE(overlap(a, b));
+    b.center.x = 1.9;
+    ASSERT_TRUE(overlap(a, b));
+    // separated only by an edge-edge axis: two boxes rotated 45 degrees around different axes, placed
+    // diagonally so that the face axes all overlap
+    math::OBBd e1 = math::create_obb(
+        math::Transform<double>(math::quat_from_axis_angle(math::Vector3d(1, 0, 0), M_PI / 4)),
+        math::Vector3d(1, 1, 1));
+    math::OBBd e2 = math::create_obb(
+        math::Transform<double>(math::Vector3d(0, 2.1, 2.1),
+                                math::quat_from_axis_angle(math::Vector3d(0, 1, 0), M_PI / 4)),
+        math::Vector3d(1, 1, 1));
+    ASSERT_FALSE(overlap(e1, e2));
+    ASSERT_FALSE(overlap(e2, e1));
+    // random boxes: if any sampled point lies inside both boxes they must overlap; symmetric results
+    std::mt19937 gen(4);
+    for (int i = 0; i < 500; i++) {
+        math::OBBd o1 = rand_obb(gen, 2.0), o2 = rand_obb(gen, 2.0);
+        ASSERT_EQ(overlap(o1, o2), overlap(o2, o1));
+        bool shared = false;
+        for (int k = 0; k < 200 && !shared; k++) {
+            math::Vector3d p = rand_point(gen, 1.0);
+            math::Vector3d local(p.x * o1.half_extents.x, p.y * o1.half_extents.y, p.z * o1.half_extents.z);
+            math::Vector3d w = o1.center + o1.rotation * local;
+            shared = length2(closest_point_on_obb(w, o2) - w) == 0.0;
+        }
+        if (shared) {
+            ASSERT_TRUE(overlap(o1, o2));
+        }
+    }
+}
+
+TEST(Geometry, batch) {
+    std::mt19937 gen(5);
+    const size_t n = 257;
+    std::vector<math::Vector3f> pts(n), out(n);
+    for (auto &p : pts)
+        p = rand_point(gen, 4.0f);
+    math::Vector3f a(0, 0, 0), b(1, 2, 3), c(-1, 1, 0);
+    closest_point_on_segment(pts.data(), n, a, b, out.data());
+    for (size_t i = 0; i < n; i++)
+        ASSERT_LT(length(out[i] - closest_point_on_segment(pts[i], a, b)), 1e-5f);
+    closest_point_on_triangle(pts.data(), n, a, b, c, out.data());
+    for (size_t i = 0; i < n; i++)
+        ASSERT_LT(length(out[i] - closest_point_on_triangle(pts[i], a, b, c)), 1e-5f);
+    math::AABBf box{math::Vector3f(-1, -1, -1), math::Vector3f(1, 2, 3)};
+    closest_point_on_aabb(pts.data(), n, box, out.data());
+    for (size_t i = 0; i < n; i++)
+        ASSERT_TRUE(out[i] == closest_point_on_aabb(pts[i], box));
+    math::OBBf obb = rand_obb(gen, 1.0f);
+    closest_point_on_obb(pts.data(), n, obb, out.data());
+    for (size_t i = 0; i < n; i++)
+        ASSERT_LT(length(out[i] - closest_point_on_obb(pts[i], obb)), 1e-5f);
+    std::vector<math::OBBf> o1(n), o2(n);
+    std::vector<math::Spheref> s(n);
+    for (size_t i = 0; i < n; i++) {
+        o1[i] = rand_obb(gen, 3.0f);
+        o2[i] = rand_obb(gen, 3.0f);
+        s[i] = math::Spheref{rand_point(gen, 3.0f), 1.0f};
+    }
+    std::unique_ptr<bool[]> res(new bool[n]);
+    overlap(o1.data(), o2.data(), n, res.get());
+    for (size_t i = 0; i < n; i++)
+        ASSERT_EQ(res[i], overlap(o1[i], o2[i]));
+    overlap(s.data(), o1.data(), n, res.get());
+    for (size_t i = 0; i < n; i++)
+        ASSERT_EQ(res[i], overlap(s[i], o1[i]));
+}
+
+TEST(Geometry, obb_fit) {
+    // points sampled inside a rotated, elongated box
+    std::mt19937 gen(6);
+    std::uniform_real_distribution<double> u(-1, 1);
+    const math::Transform<double> pose(math::Vector3d(3, -2, 1),
+                                       math::normalized(math::Quatd(0.3, -0.5, 0.7, 0.2)));
+    const math::Vector3d ext(4, 1, 0.25);
+    std::vector<math::Vector3d> pts;
+    for (int i = 0; i < 5000; i++)
+        pts.push_back(pose.transform(math::Vector3d(u(gen) * ext.x, u(gen) * ext.y, u(gen) * ext.z)));
+    math::OBBd box = fit_obb(pts.data(), pts.size());
+    // the principal axes follow the box axes (sorted by decreasing extent)
+    math::Matrix3d r = rot_matrix(pose.q);
+    for (int i = 0; i < 3; i++) {
+        double d = 0;
+        for (int k = 0; k < 3; k++)
+            d += box.rotation(k, i) * r(k, i);
+        ASSERT_NEAR(std::abs(d), 1.0, 1e-3);
+        ASSERT_NEAR(box.half_extents[i], ext[i], 0.05);
+    }
+    ASSERT_NEAR(length(box.center - pose.p), 0.0, 0.05);
+    ASSERT_NEAR(det(box.rotation), 1.0, 1e-9);
+    // every point is inside the box
+    for (const auto &p : pts)
+        ASSERT_NEAR(length(closest_point_on_obb(p, box) - p), 0.0, 1e-9);
+    // aabb
+    math::AABBd aabb = fit_aabb(pts.data(), pts.size());
+    for (const auto &p : pts)
+        ASSERT_TRUE(closest_point_on_aabb(p, aabb) == p);
+    // degenerate input: a single point
+    box = fit_obb(pts.data(), 1);
+    ASSERT_TRUE(box.center == pts[0]);
+    ASSERT_TRUE(box.half_extents == math::Vector3d(0, 0, 0));
+}
+
+TEST(Geometry, obb_transform) {
+    std::mt19937 gen(7);
+    math::OBBd box = rand_obb(gen, 2.0);
+    const math::Transform<double> t(math::Vector3d(1, 2, 3), math::normalized(math::Quatd(0.1, 0.9, -0.3, 0.2)));
+    math::OBBd moved = transformed(box, t);
+    ASSERT_TRUE(moved.half_extents == box.half_extents);
+    // rigid transform and the equivalent matrix give the same box
+    math::OBBd moved_m = transformed(box, math::create_transformation(t.p, t.q));
+    ASSERT_TRUE(moved_m.center == moved.center);
+    ASSERT_TRUE(moved_m.rotation == moved.rotation);
+    ASSERT_TRUE(moved_m.half_extents == moved.half_extents);
+    // scaling along the box axes: corners map to corners
+    const math::Matrix4d m = math::create_transformation(t.p, t.q) *
+                             math::create_scaling(math::Vector3d(2, 3, 0.5));
+    box = math::create_obb(math::Transform<double>(math::Vector3d(1, 0, 0)), math::Vector3d(1, 2, 3));
+    math::OBBd scaled = transformed(box, m);
+    ASSERT_TRUE(scaled.half_extents == math::Vector3d(2, 6, 1.5));
+    for (int c = 0; c < 8; c++) {
+        math::Vector3d corner(c & 1 ? 2 : 0, c & 2 ? 2 : -2, c & 4 ? 3 : -3);
+        math::Vector3d p = m * corner;
+        ASSERT_NEAR(length(closest_point_on_obb(p, scaled) - p), 0.0, 1e-9);
+    }
+    // overlap is invariant under rigid transforms
+    for (int i = 0; i < 100; i++) {
+        math::OBBd o1 = rand_obb(gen, 2.0), o2 = rand_obb(gen, 2.0);
+        ASSERT_EQ(overlap(o1, o2), overlap(transformed(o1, t), transformed(o2, t)));
+    }
+}
@@ -0,0 +1,193 @@
+#include "vmath.h"
+#include "vmath_half.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+uint32_t bits_of(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+float float_of(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// value of a binary16 bit pattern, straight from the definition
+double half_value(uint16_t h) {
+    const int e = (h >> 10) & 0x1f, m = h & 0x3ff;
+    const double v = e == 31 ? HUGE_VAL : e == 0 ? std::ldexp(double(m), -24) : std::ldexp(double(m | 0x400), e - 25);
+    return h & 0x8000 ? -v : v;
+}
+
+// checks that h is the correctly rounded (nearest, ties to even) encoding of the finite value f, given the value
+// of an encoding and its neighbors
+template <typename Decode> void expect_nearest(float f, uint16_t h, Decode decode) {
+    const double v = decode(h);
+    if (std::isinf(v)) {
+        // overflow: f is at least half an ulp beyond the largest finite value
+        const uint16_t max = uint16_t((h & 0x8000) | ((h & 0x7fff) - 1));
+        const uint16_t below = uint16_t((h & 0x8000) | ((h & 0x7fff) - 2));
+        EXPECT_GE(std::abs(double(f)), std::abs(decode(max)) + 0.5 * std::abs(decode(max) - decode(below))) << f;
+        return;
+    }
+    const double err = std::abs(double(f) - v);
+    for (int d = -1; d <= 1; d += 2) {
+        const uint16_t n = uint16_t((h & 0x8000) | ((h & 0x7fff) + d));
+        if ((h & 0x7fff) == 0 && d < 0)
+            continue;
+        const double nv = decode(n);
+        if (std::isinf(nv))
+            continue;
+        const double nerr = std::abs(double(f) - nv);
+        EXPECT_LE(err, nerr) << f;
+        if (err == nerr) {
+            EXPECT_EQ(h & 1, 0) << f; // tie: even mantissa
+        }
+    }
+}
+
+std::vector<float> test_floats() {
+    // special values, a sweep over all the exponents and random values around the interesting ranges
+    std::vector<float> v = {0.f, -0.f, 1.f, -1.f, 65504.f, 65519.99f, 65520.f, -65520.f, 1e30f, 5.9604645e-8f,
+                            2.9802322e-8f, 2.9802326e-8f, 6.1035156e-5f, 6.1035153e-5f, 1.0009766f, 1.0004883f,
+                            1.0014648f, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+                            std::numeric_limits<float>::denorm_min()};
+    for (uint64_t u = 0; u < (uint64_t(1) << 32); u += 65537)
+        v.push_back(float_of(uint32_t(u)));
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> mant(1.f, 2.f);
+    std::uniform_int_distribution<int> exp(-30, 18);
+    for (int i = 0; i < 200000; i++)
+        v.push_back(std::ldexp(mant(gen), exp(gen)) * (i & 1 ? -1.f : 1.f));
+    return v;
+}
+} // namespace
+
+TEST(Half, scalar) {
+    EXPECT_EQ(sizeof(math::Half), 2u);
+    EXPECT_EQ(sizeof(math::Vector3h), 6u);
+    EXPECT_EQ(sizeof(math::Quath), 8u);
+    // decoding: every bit pattern
+    for (uint32_t i = 0; i < 65536; i++) {
+        const uint16_t h = uint16_t(i);
+        const float f = float(math::Half::from_bits(h));
+        if ((h & 0x7c00) == 0x7c00 && (h & 0x3ff)) {
+            EXPECT_TRUE(std::isnan(f));
+            EXPECT_EQ(math::Half(f).bits, h | 0x200); // quiet, payload preserved
+            continue;
+        }
+        if ((h & 0x7fff) == 0x7c00)
+            EXPECT_TRUE(std::isinf(f) && (f < 0) == bool(h & 0x8000));
+        else
+            EXPECT_EQ(double(f), half_value(h)) << i;
+        EXPECT_EQ(math::Half(f).bits, h); // exact round trip
+    }
+    // encoding: correctly rounded
+    for (float f : test_floats()) {
+        const uint16_t h = math::Half(f).bits;
+        if (std::isnan(f)) {
+            EXPECT_TRUE(std::isnan(float(math::Half::from_bits(h))));
+            continue;
+        }
+        EXPECT_EQ(h >> 15, bits_of(f) >> 31);
+        if (std::isinf(f))
+            EXPECT_EQ(h & 0x7fff, 0x7c00);
+        else
+            expect_nearest(f, h, half_value);
+    }
+    // single values through the core types
+    const math::Vector3f v(0.25f, -3.f, 1000.f);
+    const math::Vector3h vh(v);
+    EXPECT_EQ(math::Vector3f(vh), v);
+    const math::Quath qh;
+    EXPECT_EQ(math::Quatf(qh), math::Quatf());
+}
+
+TEST(BFloat16, scalar) {
+    EXPECT_EQ(sizeof(math::Vector4bf), 8u);
+    auto bf_value = [](uint16_t h) { return double(float_of(uint32_t(h) << 16)); };
+    for (uint32_t i = 0; i < 65536; i++) {
+        const uint16_t h = uint16_t(i);
+        const float f = float(math::BFloat16::from_bits(h));
+        EXPECT_EQ(bits_of(f), uint32_t(h) << 16);
+        if (std::isnan(f))
+            EXPECT_EQ(math::BFloat16(f).bits, h | 0x40);
+        else
+            EXPECT_EQ(math::BFloat16(f).bits, h);
+    }
+    for (float f : test_floats()) {
+        const uint16_t h = math::BFloat16(f).bits;
+        if (std::isnan(f))
+            EXPECT_TRUE(std::isnan(float(math::BFloat16::from_bits(h))));
+        else if (std::isinf(f))
+            EXPECT_EQ(float(math::BFloat16::from_bits(h)), f);
+        else
+            expect_nearest(f, h, bf_value);
+    }
+}
+
+TEST(Half, batch) {
+    // the bulk conversions match the scalar ones bit by bit, whatever the instruction set
+    std::vector<float> f = test_floats();
+    f.push_back(std::nanf("1"));
+    f.push_back(-std::nanf("0x3ff"));
+    f.push_back(float_of(0x7f800001)); // signaling NaN
+    std::vector<math::Half> h(f.size());
+    std::vector<math::BFloat16> b(f.size());
+    for (unsigned threads : {1u, 4u}) {
+        math::convert(f.data(), h.data(), f.size(), threads);
+        math::convert(f.data(), b.data(), f.size(), threads);
+        for (size_t i = 0; i < f.size(); i++) {
+            ASSERT_EQ(h[i].bits, math::Half(f[i]).bits) << f[i];
+            ASSERT_EQ(b[i].bits, math::BFloat16(f[i]).bits) << f[i];
+        }
+    }
+    for (size_t i = 0; i < 65536; i++) {
+        h[i].bits = uint16_t(i);
+        b[i].bits = uint16_t(i);
+    }
+    std::vector<float> out(65536), out_b(65536);
+    for (size_t count : {size_t(65536), size_t(1), size_t(13), size_t(31)}) {
+        math::convert(h.data(), out.data(), count, 2);
+        math::convert(b.data(), out_b.data(), count, 2);
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(bits_of(out[i]), bits_of(float(h[i]))) << i;
+            ASSERT_EQ(bits_of(out_b[i]), bits_of(float(b[i]))) << i;
+        }
+    }
+
+    // vectors and quaternions
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<float> d(-1.f, 1.f);
+    std::vector<math::Vector3f> n(1001);
+    std::vector<math::Quatf> q(n.size());
+    for (size_t i = 0; i < n.size(); i++) {
+        n[i] = math::normalized(math::Vector3f(d(gen), d(gen), d(gen)));
+        q[i] = math::normalized(math::Quatf(d(gen), d(gen), d(gen), d(gen)));
+    }
+    std::vector<math::Vector3h> nh(n.size());
+    std::vector<math::Quatbf> qb(q.size());
+    math::convert(n.data(), nh.data(), n.size());
+    math::convert(q.data(), qb.data(), q.size());
+    std::vector<math::Vector3f> n2(n.size());
+    std::vector<math::Quatf> q2(q.size());
+    math::convert(nh.data(), n2.data(), n.size());
+    math::convert(qb.data(), q2.data(), q.size());
+    for (size_t i = 0; i < n.size(); i++) {
+        EXPECT_EQ(n2[i], math::Vector3f(nh[i]));
+        EXPECT_NEAR(n2[i].x, n[i].x, 1.f / 2048);
+        EXPECT_NEAR(n2[i].y, n[i].y, 1.f / 2048);
+        EXPECT_NEAR(n2[i].z, n[i].z, 1.f / 2048);
+        EXPECT_NEAR(q2[i].w, q[i].w, 1.f / 256);
+        EXPECT_NEAR(q2[i].z, q[i].z, 1.f / 256);
+    }
+}
@@ -0,0 +1,165 @@
+#include "vmath.h"
+#include "vmath_integrate.h"
+#include "vmath_random.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+template <typename T> T quat_distance(const math::Quaternion<T> &a, const math::Quaternion<T> &b) {
+    // q and -q are the same rotation
+    const T d = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+    return T(1) - std::abs(d);
+}
+
+template <typename T> math::Vector3<T> random_vector(math::Random &rng, T range) {
+    return math::Vector3<T>(rng.uniform(-range, range), rng.uniform(-range, range), rng.uniform(-range, range));
+}
+
+} // namespace
+
+TEST(Integrate, rotation) {
+    math::Random rng(1);
+    for (int n = 0; n < 100; n++) {
+        const math::Quatf q = math::random_quat<float>(rng);
+        const math::Vector3f axis = math::random_unit_vector<float>(rng);
+        const float speed = rng.uniform(0.f, 10.f), dt = 0.01f;
+
+        // constant angular velocity in the world frame: exact rotation about the axis, applied on the left
+        const math::Quatf expected = math::quat_from_axis_angle(axis, speed * dt) * q;
+        const math::Quatf e = math::integrate_exp(q, axis * speed, dt);
+        EXPECT_NEAR(quat_distance(e, expected), 0.f, 1e-6f);
+        EXPECT_NEAR(math::length(e), 1.f, 1e-6f);
+
+        // first order: the error of a step is O(dt^2)
+        const math::Quatf f = math::integrate_euler(q, axis * speed, dt);
+        EXPECT_NEAR(math::length(f), 1.f, 1e-6f);
+        EXPECT_LT(quat_distance(f, expected), 1e-3f);
+    }
+    // many steps of the exponential map keep following the exact rotation, large steps included
+    const math::Vector3d w(0.3, -2.0, 1.2);
+    math::Quatd q;
+    for (int n = 0; n < 1000; n++)
+        q = math::integrate_exp(q, w, 0.05);
+    EXPECT_NEAR(quat_distance(q, math::quat_from_axis_angle(math::normalized(w), math::length(w) * 50.0)), 0.0, 1e-12);
+    EXPECT_EQ(math::integrate_exp(q, math::Vector3d(0, 0, 0), 0.1), q);
+}
+
+TEST(Integrate, float_precision) {
+    // the scalar float exponential map uses the polynomial kernels instead of libm sin/cos: it must stay within a
+    // few ulp of the double path, for tiny steps, rotations of up to half a turn and the libm fallback beyond
+    math::Random rng(4);
+    for (int n = 0; n < 10000; n++) {
+        const math::Quatf q = math::random_quat<float>(rng);
+        const double range = n % 3 == 0 ? 1e-4 : n % 3 == 1 ? M_PI : 4.0 * M_PI;
+        const math::Vector3f w = math::random_unit_vector<float>(rng) * float(rng.uniform(0.0, range));
+        const math::Quatf f = math::integrate_exp(q, w, 1.f);
+        const math::Quatd d = math::integrate_exp(math::Quatd(q), math::Vector3d(w), 1.0);
+        EXPECT_NEAR(f.w, d.w, 1e-6);
+        EXPECT_NEAR(f.x, d.x, 1e-6);
+        EXPECT_NEAR(f.y, d.y, 1e-6);
+        EXPECT_NEAR(f.z, d.z, 1e-6);
+    }
+}
+
+TEST(Integrate, batch) {
+    math::Random rng(2);
+    // 1037 bodies: SIMD iterations and a scalar tail; some rotate more than half a turn per step
+    const size_t n = 1037;
+    const float dt = 1.f / 60.f;
+    std::vector<math::Transff> bodies(n);
+    std::vector<math::Vector3f> v(n), w(n), a(n), alpha(n);
+    for (size_t i = 0; i < n; i++) {
+        bodies[i] = math::random_transform<float>(rng, 10.f);
+        v[i] = random_vector(rng, 5.f);
+        w[i] = random_vector(rng, i % 10 == 0 ? 500.f : 10.f);
+        a[i] = random_vector(rng, 10.f);
+        alpha[i] = random_vector(rng, 10.f);
+    }
+    for (bool exponential : {false, true}) {
+        for (bool accelerations : {false, true}) {
+            std::vector<math::Transff> b = bodies;
+            std::vector<math::Vector3f> vb = v, wb = w;
+            const math::Vector3f *pa = accelerations ? a.data() : nullptr;
+            const math::Vector3f *palpha = accelerations ? alpha.data() : nullptr;
+            if (exponential)
+                math::integrate_exp(b.data(), vb.data(), wb.data(), pa, palpha, dt, n, 3);
+            else
+                math::integrate_euler(b.data(), vb.data(), wb.data(), pa, palpha, dt, n, 3);
+
+            for (size_t i = 0; i < n; i++) {
+                const math::Vector3f vi = accelerations ? v[i] + a[i] * dt : v[i];
+                const math::Vector3f wi = accelerations ? w[i] + alpha[i] * dt : w[i];
+                const math::Quatf qi = exponential ? math::integrate_exp(bodies[i].q, wi, dt)
+                                                         : math::integrate_euler(bodies[i].q, wi, dt);
+                ASSERT_NEAR(math::length(vb[i] - vi), 0.f, 1e-5f) << i;
+                ASSERT_NEAR(math::length(wb[i] - wi), 0.f, 1e-5f) << i;
+                ASSERT_NEAR(math::length(b[i].p - (bodies[i].p + vi * dt)), 0.f, 1e-5f) << i;
+                ASSERT_NEAR(quat_distance(b[i].q, qi), 0.f, 1e-6f) << i;
+                ASSERT_NEAR(math::length(b[i].q), 1.f, 1e-6f) << i;
+                if (exponential) {
+                    const math::Quatf exact =
+                        math::quat_from_axis_angle(math::normalized(wi), math::length(wi) * dt) * bodies[i].q;
+                    ASSERT_NEAR(quat_distance(b[i].q, exact), 0.f, 1e-6f) << i;
+                }
+            }
+        }
+    }
+}
+
+TEST(Integrate, soa) {
+    math::Random rng(3);
+    const size_t n = 523;
+    const double dt = 0.01;
+    std::vector<math::Transfd> bodies(n);
+    std::vector<math::Vector3d> v(n), w(n), a(n);
+    std::vector<double> s(13 * n), acc(3 * n);
+    for (size_t i = 0; i < n; i++) {
+        bodies[i] = math::random_transform<double>(rng, 10.0);
+        v[i] = random_vector(rng, 5.0);
+        w[i] = random_vector(rng, 10.0);
+        a[i] = random_vector(rng, 10.0);
+        const double values[13] = {bodies[i].p.x, bodies[i].p.y, bodies[i].p.z, bodies[i].q.w, bodies[i].q.x,
+                                   bodies[i].q.y, bodies[i].q.z, v[i].x,        v[i].y,        v[i].z,
+                                   w[i].x,        w[i].y,        w[i].z};
+        for (int c = 0; c < 13; c++)
+            s[c * n + i] = values[c];
+        for (int c = 0; c < 3; c++)
+            acc[c * n + i] = a[i][c];
+    }
+    math::RigidBodyArrays<double> arrays;
+    double **const columns[13] = {&arrays.px, &arrays.py, &arrays.pz, &arrays.qw, &arrays.qx,
+                                  &arrays.qy, &arrays.qz, &arrays.vx, &arrays.vy, &arrays.vz,
+                                  &arrays.wx, &arrays.wy, &arrays.wz};
+    for (int c = 0; c < 13; c++)
+        *columns[c] = s.data() + c * n;
+    arrays.ax = acc.data();
+    arrays.ay = acc.data() + n;
+    arrays.az = acc.data() + 2 * n;
+    const std::vector<double> start = s;
+    const math::Vector3d *no_alpha = nullptr;
+    for (bool exponential : {false, true}) {
+        s = start;
+        std::vector<math::Transfd> b = bodies;
+        std::vector<math::Vector3d> vb = v, wb = w;
+        if (exponential) {
+            math::integrate_exp(arrays, dt, n, 2);
+            math::integrate_exp(b.data(), vb.data(), wb.data(), a.data(), no_alpha, dt, n, 1);
+        } else {
+            math::integrate_euler(arrays, dt, n, 2);
+            math::integrate_euler(b.data(), vb.data(), wb.data(), a.data(), no_alpha, dt, n, 1);
+        }
+        for (size_t i = 0; i < n; i++) {
+            ASSERT_NEAR(math::length(math::Vector3d(s[i], s[n + i], s[2 * n + i]) - b[i].p), 0.0, 1e-14) << i;
+            ASSERT_NEAR(quat_distance(math::Quatd(s[3 * n + i], s[4 * n + i], s[5 * n + i], s[6 * n + i]),
+                                      b[i].q),
+                        0.0, 1e-14)
+                << i;
+            ASSERT_NEAR(math::length(math::Vector3d(s[7 * n + i], s[8 * n + i], s[9 * n + i]) - vb[i]), 0.0, 1e-14);
+            EXPECT_EQ(math::Vector3d(s[10 * n + i], s[11 * n + i], s[12 * n + i]), w[i]);
+        }
+    }
+}
@@ -0,0 +1,159 @@
+#include "vmath_kdtree.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+template <typename V> std::vector<V> random_points(size_t n, double range, unsigned seed);
+
+template <> std::vector<math::Vector3d> random_points<math::Vector3d>(size_t n, double range, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> d(-range, range);
+    std::vector<math::Vector3d> pts(n);
+    for (auto &p : pts)
+        p = math::Vector3d(d(gen), d(gen), d(gen));
+    return pts;
+}
+
+template <> std::vector<math::Vector2d> random_points<math::Vector2d>(size_t n, double range, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> d(-range, range);
+    std::vector<math::Vector2d> pts(n);
+    for (auto &p : pts)
+        p = math::Vector2d(d(gen), d(gen));
+    return pts;
+}
+
+template <typename V> std::vector<uint32_t> brute_radius(const std::vector<V> &pts, const V &q, double r) {
+    std::vector<uint32_t> res;
+    for (size_t i = 0; i < pts.size(); i++)
+        if ((pts[i] - q).dot(pts[i] - q) <= r * r)
+            res.push_back(uint32_t(i));
+    return res;
+}
+
+template <typename V>
+std::vector<std::pair<double, uint32_t>> brute_knn(const std::vector<V> &pts, const V &q, size_t k) {
+    std::vector<std::pair<double, uint32_t>> all;
+    for (size_t i = 0; i < pts.size(); i++)
+        all.push_back(std::make_pair((pts[i] - q).dot(pts[i] - q), uint32_t(i)));
+    std::sort(all.begin(), all.end());
+    all.resize(std::min(k, all.size()));
+    return all;
+}
+
+template <typename V> void check_queries(size_t n, size_t leaf_size) {
+    auto pts = random_points<V>(n, 10.0, 1);
+    math::KdTree<V> tree;
+    tree.build(pts.data(), pts.size(), 4, leaf_size);
+    ASSERT_EQ(tree.size(), n);
+    auto queries = random_points<V>(50, 12.0, 2);
+    for (const auto &q : queries) {
+        for (double r : {0.3, 1.0, 2.5}) {
+            std::vector<uint32_t> found;
+            tree.radius_search(q, r, found);
+            std::sort(found.begin(), found.end());
+            ASSERT_EQ(found, brute_radius(pts, q, r));
+        }
+        for (size_t k : {1, 8, 40}) {
+            std::vector<uint32_t> idx(k);
+            std::vector<double> d2(k);
+            ASSERT_EQ(tree.knn_search(q, k, idx.data(), d2.data()), std::min(k, pts.size()));
+            auto expected = brute_knn(pts, q, k);
+            for (size_t i = 0; i < expected.size(); i++) {
+                ASSERT_EQ(idx[i], expected[i].second);
+                ASSERT_DOUBLE_EQ(d2[i], expected[i].first);
+            }
+            for (size_t i = expected.size(); i < k; i++) {
+                ASSERT_EQ(idx[i], math::KdTree<V>::invalid_index);
+                ASSERT_TRUE(std::isinf(d2[i]));
+            }
+        }
+    }
+}
+} // namespace
+
+TEST(KdTree, queries) {
+    check_queries<math::Vector3d>(5000, 8);
+    check_queries<math::Vector3d>(5000, 1);
+    check_queries<math::Vector3d>(20, 8); // fewer points than k
+    check_queries<math::Vector2d>(3000, 4);
+    check_queries<math::Vector2d>(0, 8);
+
+    // duplicated points
+    std::vector<math::Vector3d> pts(100, math::Vector3d(1, 2, 3));
+    math::KdTree3d tree;
+    tree.build(pts.data(), pts.size());
+    std::vector<uint32_t> found;
+    tree.radius_search(math::Vector3d(1, 2, 3), 0.0, found);
+    ASSERT_EQ(found.size(), 100u);
+}
+
+TEST(KdTree, approximate) {
+    auto pts = random_points<math::Vector3d>(20000, 10.0, 3);
+    auto queries = random_points<math::Vector3d>(200, 10.0, 4);
+    math::KdTree3d tree;
+    tree.build(pts.data(), pts.size());
+    const size_t k = 10;
+    std::vector<uint32_t> idx(k);
+    std::vector<double> d2(k);
+    for (const auto &q : queries) {
+        auto expected = brute_knn(pts, q, k);
+        // every distance within (1 + eps) of the exact one
+        math::KdTreeSearchParams<double> params;
+        params.eps = 0.5;
+        ASSERT_EQ(tree.knn_search(q, k, idx.data(), d2.data(), params), k);
+        for (size_t i = 0; i < k; i++) {
+            ASSERT_LE(std::sqrt(d2[i]), 1.5 * std::sqrt(expected[i].first) + 1e-12);
+            ASSERT_GE(d2[i], expected[i].first);
+        }
+        // a single leaf still gives k valid, sorted candidates
+        params = math::KdTreeSearchParams<double>();
+        params.max_leaves = 1;
+        ASSERT_EQ(tree.knn_search(q, k, idx.data(), d2.data(), params), k);
+        for (size_t i = 0; i < k; i++) {
+            ASSERT_DOUBLE_EQ(d2[i], math::length2(pts[idx[i]] - q));
+            if (i > 0) {
+                ASSERT_LE(d2[i - 1], d2[i]);
+            }
+        }
+    }
+}
+
+TEST(KdTree, batch_parallel) {
+    auto ptsd = random_points<math::Vector3d>(100000, 10.0, 5);
+    auto queries = random_points<math::Vector3d>(3000, 10.0, 6);
+    const size_t k = 6;
+    std::vector<uint32_t> ref_idx, ref_offsets, ref_found;
+    for (unsigned threads : {1u, 2u, 5u}) {
+        math::KdTree3d tree;
+        tree.build(ptsd.data(), ptsd.size(), threads);
+        std::vector<uint32_t> idx(queries.size() * k), offsets, found;
+        tree.knn_search(queries.data(), queries.size(), k, idx.data(), nullptr, math::KdTreeSearchParams<double>(),
+                        threads);
+        tree.radius_search(queries.data(), queries.size(), 0.4, offsets, found, threads);
+        ASSERT_EQ(offsets.size(), queries.size() + 1);
+        for (size_t i = 0; i < queries.size(); i += 97) {
+            std::vector<uint32_t> single(k);
+            tree.knn_search(queries[i], k, single.data());
+            ASSERT_TRUE(std::equal(single.begin(), single.end(), idx.begin() + i * k));
+            std::vector<uint32_t> r(found.begin() + offsets[i], found.begin() + offsets[i + 1]);
+            std::sort(r.begin(), r.end());
+            ASSERT_EQ(r, brute_radius(ptsd, queries[i], 0.4));
+        }
+        // the tree and the results do not depend on the number of threads
+        if (threads == 1) {
+            ref_idx = idx;
+            ref_offsets = offsets;
+            ref_found = found;
+        } else {
+            ASSERT_EQ(idx, ref_idx);
+            ASSERT_EQ(offsets, ref_offsets);
+            ASSERT_EQ(found, ref_found);
+        }
+    }
+}
@@ -0,0 +1,163 @@
+#include "vmath.h"
+#include "vmath_packing.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+// rotation angle between two quaternions (degrees), accurate also for tiny angles
+double angle_deg(const math::Quatd &a, math::Quatd b) {
+    b = math::normalized(b);
+    const math::Quatd d = ~a * b;
+    return 2.0 * std::atan2(std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z), std::abs(d.w)) * 180.0 / M_PI;
+}
+
+double angle_deg(const math::Vector3d &a, const math::Vector3d &b) {
+    return std::atan2(math::length(a.cross(b)), a.dot(b)) * 180.0 / M_PI;
+}
+
+std::vector<math::Quatf> random_quats(size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> d;
+    std::vector<math::Quatf> q(n);
+    for (auto &e : q)
+        e = math::normalized(math::Quatf(d(gen), d(gen), d(gen), d(gen)));
+    // components on the boundaries of the ranges
+    q[0] = math::Quatf(1, 0, 0, 0);
+    q[1] = math::Quatf(0, 0, 0, -1);
+    q[2] = math::normalized(math::Quatf(1, 1, 0, 0));
+    q[3] = math::normalized(math::Quatf(-1, 1, -1, 1));
+    return q;
+}
+
+std::vector<math::Vector3f> random_normals(size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> d;
+    std::vector<math::Vector3f> v(n);
+    for (auto &e : v)
+        e = math::normalized(math::Vector3f(d(gen), d(gen), d(gen)));
+    const math::Vector3f axes[] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    for (int i = 0; i < 6; i++)
+        v[i] = axes[i];
+    v[6] = math::normalized(math::Vector3f(1, 1, -1e-6f));
+    v[7] = math::normalized(math::Vector3f(-1, 1, 0));
+    return v;
+}
+
+template <typename P> bool same_bits(const P &a, const P &b) { return std::memcmp(&a, &b, sizeof(P)) == 0; }
+
+// the decoded values are the same as the scalar ones, up to the last bit when the compiler fuses multiply-adds
+template <typename V> bool same_values(const std::vector<V> &a, const std::vector<V> &b) {
+    const float *x = reinterpret_cast<const float *>(a.data()), *y = reinterpret_cast<const float *>(b.data());
+    for (size_t i = 0; i < a.size() * sizeof(V) / sizeof(float); i++)
+        if (std::abs(x[i] - y[i]) > 1e-6f)
+            return false;
+    return true;
+}
+} // namespace
+
+TEST(Packing, quaternion) {
+    EXPECT_EQ(sizeof(math::PackedQuat32), 4u);
+    EXPECT_EQ(sizeof(math::PackedQuat48), 6u);
+    const auto q = random_quats(200000, 1);
+    double err32 = 0, err48 = 0;
+    for (const auto &e : q) {
+        const math::Quatd ref(e);
+        const math::Quatf d32 = math::unpack_quat<float>(math::pack_quat32(e));
+        const math::Quatf d48 = math::unpack_quat<float>(math::pack_quat48(e));
+        err32 = std::max(err32, angle_deg(ref, math::Quatd(d32)));
+        err48 = std::max(err48, angle_deg(ref, math::Quatd(d48)));
+        EXPECT_NEAR(math::length(d32), 1.f, 1e-6f);
+        EXPECT_NEAR(math::length(d48), 1.f, 1e-6f);
+        // -q encodes the same rotation
+        EXPECT_TRUE(same_bits(math::pack_quat32(-e), math::pack_quat32(e)));
+    }
+    EXPECT_LT(err32, 0.28);
+    EXPECT_LT(err48, 0.0086);
+    EXPECT_GT(err32, 0.1); // the bounds are meaningful
+    // the identity is exact
+    EXPECT_EQ(math::unpack_quat<float>(math::pack_quat48(math::Quatf())), math::Quatf());
+    // double precision
+    const math::Quatd qd = math::normalized(math::Quatd(0.1, -0.7, 0.3, 0.2));
+    EXPECT_LT(angle_deg(qd, math::unpack_quat<double>(math::pack_quat48(qd))), 0.0086);
+}
+
+TEST(Packing, normal) {
+    EXPECT_EQ(sizeof(math::PackedNormal16), 2u);
+    EXPECT_EQ(sizeof(math::PackedNormal24), 3u);
+    EXPECT_EQ(sizeof(math::PackedNormal32), 4u);
+    const auto n = random_normals(200000, 2);
+    double err16 = 0, err24 = 0, err32 = 0;
+    for (const auto &e : n) {
+        const math::Vector3d ref(e);
+        const math::Vector3f d16 = math::unpack_normal<float>(math::pack_normal16(e));
+        const math::Vector3f d24 = math::unpack_normal<float>(math::pack_normal24(e));
+        const math::Vector3f d32 = math::unpack_normal<float>(math::pack_normal32(e));
+        err16 = std::max(err16, angle_deg(ref, math::Vector3d(d16)));
+        err24 = std::max(err24, angle_deg(ref, math::Vector3d(d24)));
+        err32 = std::max(err32, angle_deg(ref, math::Vector3d(d32)));
+        EXPECT_NEAR(math::length(d16), 1.f, 1e-6f);
+    }
+    EXPECT_LT(err16, 0.64);
+    EXPECT_LT(err24, 0.040);
+    EXPECT_LT(err32, 0.0025);
+    // the axes are exact
+    for (int i = 0; i < 6; i++)
+        EXPECT_EQ(math::unpack_normal<float>(math::pack_normal24(n[i])), n[i]) << i;
+}
+
+TEST(Packing, batch) {
+    // the batch versions (SIMD decoding, any count) match the scalar functions
+    const auto q = random_quats(100003, 3);
+    const auto n = random_normals(100003, 4);
+    std::vector<math::PackedQuat32> q32(q.size());
+    std::vector<math::PackedQuat48> q48(q.size());
+    std::vector<math::PackedNormal16> n16(n.size());
+    std::vector<math::PackedNormal24> n24(n.size());
+    std::vector<math::PackedNormal32> n32(n.size());
+    math::pack(q.data(), q32.data(), q.size(), 4);
+    math::pack(q.data(), q48.data(), q.size(), 4);
+    math::pack(n.data(), n16.data(), n.size(), 4);
+    math::pack(n.data(), n24.data(), n.size(), 4);
+    math::pack(n.data(), n32.data(), n.size(), 4);
+    // with fused multiply-adds a value next to the middle of two codes may round the other way
+    size_t differ = 0;
+    for (size_t i = 0; i < q.size(); i++) {
+        differ += !same_bits(q32[i], math::pack_quat32(q[i]));
+        differ += !same_bits(q48[i], math::pack_quat48(q[i]));
+        differ += !same_bits(n16[i], math::pack_normal16(n[i]));
+        differ += !same_bits(n24[i], math::pack_normal24(n[i]));
+        differ += !same_bits(n32[i], math::pack_normal32(n[i]));
+    }
+    EXPECT_LE(differ, q.size() / 1000);
+    for (size_t count : {q.size(), size_t(1), size_t(6), size_t(11)}) {
+        std::vector<math::Quatf> dq(count), sq(count);
+        std::vector<math::Vector3f> dn(count), sn(count);
+        for (unsigned threads : {1u, 3u}) {
+            math::unpack(q32.data(), dq.data(), count, threads);
+            for (size_t i = 0; i < count; i++)
+                sq[i] = math::unpack_quat<float>(q32[i]);
+            EXPECT_TRUE(same_values(dq, sq));
+            math::unpack(q48.data(), dq.data(), count, threads);
+            for (size_t i = 0; i < count; i++)
+                sq[i] = math::unpack_quat<float>(q48[i]);
+            EXPECT_TRUE(same_values(dq, sq));
+            math::unpack(n16.data(), dn.data(), count, threads);
+            for (size_t i = 0; i < count; i++)
+                sn[i] = math::unpack_normal<float>(n16[i]);
+            EXPECT_TRUE(same_values(dn, sn));
+            math::unpack(n24.data(), dn.data(), count, threads);
+            for (size_t i = 0; i < count; i++)
+                sn[i] = math::unpack_normal<float>(n24[i]);
+            EXPECT_TRUE(same_values(dn, sn));
+            math::unpack(n32.data(), dn.data(), count, threads);
+            for (size_t i = 0; i < count; i++)
+                sn[i] = math::unpack_normal<float>(n32[i]);
+            EXPECT_TRUE(same_values(dn, sn));
+        }
+    }
+}
@@ -0,0 +1,132 @@
+#include "vmath.h"
+#include "vmath_projection.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+// OpenGL perspective projection
+math::Matrix4f perspective(float fovy, float aspect, float znear, float zfar, bool zero_to_one) {
+    const float f = 1.f / std::tan(0.5f * fovy);
+    math::Matrix4f m = math::matrix4_identity<float>();
+    m(0, 0) = f / aspect;
+    m(1, 1) = f;
+    m(2, 2) = zero_to_one ? zfar / (znear - zfar) : (zfar + znear) / (znear - zfar);
+    m(2, 3) = zero_to_one ? znear * zfar / (znear - zfar) : 2.f * zfar * znear / (znear - zfar);
+    m(3, 2) = -1.f;
+    m(3, 3) = 0.f;
+    return m;
+}
+
+struct Projected {
+    std::vector<float> x, y, depth, inv_w;
+    std::vector<uint8_t> outcode;
+    explicit Projected(size_t n)
+    : x(n, -1.f), y(n, -1.f), depth(n, -1.f), inv_w(n, -1.f), outcode(n, 0xff) {}
+    math::ScreenVertices screen() {
+        math::ScreenVertices s;
+        s.x = x.data();
+        s.y = y.data();
+        s.depth = depth.data();
+        s.inv_w = inv_w.data();
+        s.outcode = outcode.data();
+        return s;
+    }
+};
+
+// reference in double
+void check(const math::Matrix4f &mvp, const math::Vector4f &v, const math::Viewport &vp, const Projected &p,
+           size_t i, size_t &outcode_mismatches) {
+    const math::Vector4d c = math::Matrix4d(mvp) * math::Vector4d(v);
+    uint8_t code = 0;
+    code |= c.x < -c.w ? math::clip_left : 0;
+    code |= c.x > c.w ? math::clip_right : 0;
+    code |= c.y < -c.w ? math::clip_bottom : 0;
+    code |= c.y > c.w ? math::clip_top : 0;
+    code |= c.z < (vp.depth_zero_to_one ? 0.0 : -c.w) ? math::clip_near : 0;
+    code |= c.z > c.w ? math::clip_far : 0;
+    if (code != p.outcode[i])
+        outcode_mismatches++;
+    const double sx = (c.x / c.w * 0.5 + 0.5) * vp.width + vp.x;
+    const double sy = (c.y / c.w * 0.5 + 0.5) * vp.height + vp.y;
+    const double nz = c.z / c.w;
+    const double depth = vp.depth_zero_to_one ? vp.min_depth + nz * (vp.max_depth - vp.min_depth)
+                                              : vp.min_depth + (nz * 0.5 + 0.5) * (vp.max_depth - vp.min_depth);
+    if (code == 0) {
+        ASSERT_NEAR(p.x[i], sx, 1e-3) << i;
+        ASSERT_NEAR(p.y[i], sy, 1e-3) << i;
+        ASSERT_NEAR(p.depth[i], depth, 1e-4) << i;
+        ASSERT_NEAR(p.inv_w[i], 1.0 / c.w, 1e-5 / std::abs(c.w)) << i;
+    }
+}
+} // namespace
+
+TEST(Projection, vertices) {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> d(-40.f, 40.f);
+    for (bool zero_to_one : {false, true}) {
+        const math::Matrix4f view = math::inverse(math::create_lookat(math::Vector3f(0.f, -30.f, 5.f),
+                                                                      math::Vector3f(0.f, 0.f, 0.f)));
+        const math::Matrix4f mvp = perspective(1.f, 1.5f, 0.5f, 50.f, zero_to_one) * view;
+        math::Viewport vp(10.f, 600.f, 800.f, -600.f); // y down
+        vp.min_depth = 0.1f;
+        vp.max_depth = 0.9f;
+        vp.depth_zero_to_one = zero_to_one;
+
+        const size_t n = 40003;
+        std::vector<math::Vector3f> v3(n);
+        std::vector<math::Vector4f> v4(n);
+        for (size_t i = 0; i < n; i++) {
+            v3[i] = math::Vector3f(d(gen), d(gen), d(gen));
+            const float w = 0.5f + 0.5f * std::abs(d(gen));
+            v4[i] = math::Vector4f(v3[i].x * w, v3[i].y * w, v3[i].z * w, w);
+        }
+        // tails of the SIMD loop, then a large array on several threads
+        for (size_t count : {size_t(0), size_t(1), size_t(3), size_t(5), size_t(11), n}) {
+            Projected p3(n + 1), p4(n + 1);
+            const math::ClipSummary s3 = math::project_vertices(mvp, v3.data(), count, vp, p3.screen(), 4);
+            const math::ClipSummary s4 = math::project_vertices(mvp, v4.data(), count, vp, p4.screen(), 4);
+            size_t mismatches = 0;
+            uint8_t any = 0, all = count > 0 ? 0xff : 0;
+            for (size_t i = 0; i < count; i++) {
+                check(mvp, math::Vector4f(v3[i].x, v3[i].y, v3[i].z, 1.f), vp, p3, i, mismatches);
+                check(mvp, v4[i], vp, p4, i, mismatches);
+                any |= p3.outcode[i];
+                all &= p3.outcode[i];
+            }
+            EXPECT_LE(mismatches, count / 1000);
+            EXPECT_EQ(s3.any, any);
+            EXPECT_EQ(s3.all, all);
+            EXPECT_EQ(s4.any, s3.any);
+            EXPECT_EQ(p3.outcode[count], 0xff);
+            EXPECT_EQ(p3.x[count], -1.f);
+            if (count == n) {
+                // all the planes are hit, including behind the camera
+                EXPECT_EQ(any, 63);
+            }
+        }
+    }
+}
+
+TEST(Projection, summary) {
+    const math::Matrix4f identity = math::matrix4_identity<float>();
+    const math::Viewport vp(0.f, 0.f, 100.f, 50.f);
+    // all inside: no clipping
+    std::vector<math::Vector3f> inside(9, math::Vector3f(0.5f, -0.5f, 0.f));
+    std::vector<float> x(9);
+    math::ScreenVertices out;
+    out.x = x.data();
+    math::ClipSummary s = math::project_vertices(identity, inside.data(), inside.size(), vp, out);
+    EXPECT_EQ(s.any, 0);
+    EXPECT_EQ(s.all, 0);
+    EXPECT_EQ(x[8], 75.f);
+    // all to the right, some also above: culled
+    std::vector<math::Vector3f> right(9, math::Vector3f(2.f, 0.f, 0.f));
+    right[7].y = 3.f;
+    s = math::project_vertices(identity, right.data(), right.size(), vp, math::ScreenVertices());
+    EXPECT_EQ(s.any, math::clip_right | math::clip_top);
+    EXPECT_EQ(s.all, math::clip_right);
+}
@@ -0,0 +1,97 @@
+#include "vmath.h"
+#include "vmath_random.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+TEST(Random, generator) {
+    math::Random a(7), b(7), c(8);
+    for (int i = 0; i < 100; i++) {
+        const uint64_t v = a();
+        EXPECT_EQ(v, b());
+        EXPECT_NE(v, c());
+    }
+    math::Random skipped(7);
+    skipped.discard(100);
+    EXPECT_EQ(skipped(), a());
+
+    double sum = 0;
+    for (int i = 0; i < 100000; i++) {
+        const float u = a.uniform<float>();
+        const double d = a.uniform<double>();
+        ASSERT_GE(u, 0.f);
+        ASSERT_LT(u, 1.f);
+        ASSERT_GE(d, 0.0);
+        ASSERT_LT(d, 1.0);
+        sum += d;
+        const float r = a.uniform(-2.f, 3.f);
+        ASSERT_GE(r, -2.f);
+        ASSERT_LE(r, 3.f);
+    }
+    EXPECT_NEAR(sum / 100000, 0.5, 5e-3);
+
+    // usable with the standard distributions
+    std::uniform_int_distribution<int> dice(1, 6);
+    int counts[7] = {};
+    for (int i = 0; i < 60000; i++)
+        counts[dice(a)]++;
+    for (int k = 1; k <= 6; k++)
+        EXPECT_NEAR(counts[k], 10000, 500);
+}
+
+TEST(Random, rotations) {
+    const size_t n = 200000;
+    math::Random rng(42);
+    // moments of uniformly distributed rotations: E[q_i^2] = 1/4, and rotated axes uniformly distributed on the
+    // sphere (E[v] = 0, E[v_i^2] = 1/3)
+    math::Vector4d q2(0, 0, 0, 0);
+    math::Vector3d mean(0, 0, 0), mean2(0, 0, 0), unit_mean(0, 0, 0), unit_mean2(0, 0, 0);
+    for (size_t i = 0; i < n; i++) {
+        const math::Quatd q = math::random_quat<double>(rng);
+        ASSERT_NEAR(math::length(q), 1.0, 1e-12);
+        q2 += math::Vector4d(q.w * q.w, q.x * q.x, q.y * q.y, q.z * q.z);
+        const math::Vector3d v = q.rotate(math::Vector3d(0.0, 0.6, 0.8));
+        mean += v;
+        mean2 += math::Vector3d(v.x * v.x, v.y * v.y, v.z * v.z);
+        const math::Vector3d u = math::random_unit_vector<double>(rng);
+        ASSERT_NEAR(math::length(u), 1.0, 1e-12);
+        unit_mean += u;
+        unit_mean2 += math::Vector3d(u.x * u.x, u.y * u.y, u.z * u.z);
+    }
+    for (int k = 0; k < 4; k++)
+        EXPECT_NEAR(q2[k] / n, 0.25, 3e-3) << k;
+    for (int k = 0; k < 3; k++) {
+        EXPECT_NEAR(mean[k] / n, 0.0, 5e-3) << k;
+        EXPECT_NEAR(mean2[k] / n, 1.0 / 3.0, 3e-3) << k;
+        EXPECT_NEAR(unit_mean[k] / n, 0.0, 5e-3) << k;
+        EXPECT_NEAR(unit_mean2[k] / n, 1.0 / 3.0, 3e-3) << k;
+    }
+
+    const math::Transfd t = math::random_transform(rng, 5.0);
+    EXPECT_LE(std::abs(t.p.x), 5.0);
+    EXPECT_NEAR(math::length(t.q), 1.0, 1e-12);
+}
+
+TEST(Random, batch) {
+    // the batch values are the sequential ones, whatever the number of threads
+    const size_t n = 50003;
+    for (unsigned threads : {1u, 3u, 8u}) {
+        std::vector<math::Quatf> q(n);
+        std::vector<math::Vector3d> v(n);
+        std::vector<math::Transff> t(n);
+        math::random_quats(11, q.data(), n, threads);
+        math::random_unit_vectors(12, v.data(), n, threads);
+        math::random_transforms(13, t.data(), n, 10.f, threads);
+        math::Random rq(11), rv(12), rt(13);
+        for (size_t i = 0; i < n; i++) {
+            ASSERT_EQ(q[i], math::random_quat<float>(rq)) << i;
+            ASSERT_EQ(v[i], math::random_unit_vector<double>(rv)) << i;
+            const math::Transff e = math::random_transform(rt, 10.f);
+            ASSERT_EQ(t[i].p, e.p) << i;
+            ASSERT_EQ(t[i].q, e.q) << i;
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#include "vmath_registration.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace {
+template <typename T> std::vector<math::Vector3<T>> random_points(size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<T> d(T(-5), T(5));
+    std::vector<math::Vector3<T>> pts(n);
+    for (auto &p : pts)
+        p = math::Vector3<T>(d(gen) + T(100), d(gen), d(gen) * T(0.3)); // offset and anisotropic
+    return pts;
+}
+
+template <typename T> math::Transform<T> random_pose(unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<T> d(T(-1), T(1));
+    const math::Quaternion<T> q = math::normalized(math::Quaternion<T>(d(gen), d(gen), d(gen), d(gen)));
+    return math::Transform<T>(math::Vector3<T>(d(gen), d(gen), d(gen)) * T(10), q);
+}
+
+template <typename T> void expect_near(const math::Transform<T> &a, const math::Transform<T> &b, T eps) {
+    // q and -q are the same rotation
+    const T sign = a.q.w * b.q.w + a.q.x * b.q.x + a.q.y * b.q.y + a.q.z * b.q.z < 0 ? T(-1) : T(1);
+    EXPECT_NEAR(a.q.w, sign * b.q.w, eps);
+    EXPECT_NEAR(a.q.x, sign * b.q.x, eps);
+    EXPECT_NEAR(a.q.y, sign * b.q.y, eps);
+    EXPECT_NEAR(a.q.z, sign * b.q.z, eps);
+    EXPECT_NEAR(a.p.x, b.p.x, eps * 100);
+    EXPECT_NEAR(a.p.y, b.p.y, eps * 100);
+    EXPECT_NEAR(a.p.z, b.p.z, eps * 100);
+}
+} // namespace
+
+TEST(Registration, kabsch) {
+    for (unsigned seed = 0; seed < 20; seed++) {
+        const auto pose = random_pose<double>(seed);
+        const auto src = random_points<double>(200000, seed);
+        std::vector<math::Vector3d> dst(src.size());
+        for (size_t i = 0; i < src.size(); i++)
+            dst[i] = pose.transform(src[i]);
+        expect_near(math::kabsch(src.data(), dst.data(), src.size()), pose, 1e-9);
+        expect_near(math::kabsch(src.data(), dst.data(), 3), pose, 1e-9); // minimal set
+    }
+    // float data, accumulated in double
+    const auto posef = random_pose<float>(7);
+    const auto srcf = random_points<float>(300000, 7);
+    std::vector<math::Vector3f> dstf(srcf.size());
+    for (size_t i = 0; i < srcf.size(); i++)
+        dstf[i] = posef.transform(srcf[i]);
+    expect_near(math::kabsch(srcf.data(), dstf.data(), srcf.size()), posef, 1e-4f);
+
+    // planar set: the solution is still a proper rotation
+    auto planar = random_points<double>(100, 3);
+    for (auto &p : planar)
+        p.z = 0;
+    const auto pose = random_pose<double>(3);
+    std::vector<math::Vector3d> dst(planar.size());
+    for (size_t i = 0; i < planar.size(); i++)
+        dst[i] = pose.transform(planar[i]);
+    expect_near(math::kabsch(planar.data(), dst.data(), planar.size()), pose, 1e-9);
+
+    // degenerate inputs
+    EXPECT_TRUE(math::kabsch(planar.data(), dst.data(), 0) == math::Transform<double>());
+    const auto single = math::kabsch(planar.data(), dst.data(), 1);
+    EXPECT_NEAR(math::length(single.transform(planar[0]) - dst[0]), 0.0, 1e-12);
+}
+
+TEST(Registration, weights_and_noise) {
+    const auto pose = random_pose<double>(11);
+    const auto src = random_points<double>(100000, 11);
+    std::vector<math::Vector3d> dst(src.size());
+    std::vector<double> weights(src.size());
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> u(0, 1);
+    for (size_t i = 0; i < src.size(); i++) {
+        dst[i] = pose.transform(src[i]);
+        weights[i] = 0.5 + u(gen);
+        // a third of the points are outliers with zero weight
+        if (i % 3 == 0) {
+            dst[i] += math::Vector3d(u(gen), u(gen), u(gen)) * 20.0;
+            weights[i] = 0;
+        }
+    }
+    for (unsigned threads : {1u, 3u})
+        expect_near(math::kabsch(src.data(), dst.data(), src.size(), weights.data(), threads), pose, 1e-9);
+
+    // small gaussian noise: the result is close to the pose, and optimal (no perturbation improves it)
+    std::normal_distribution<double> noise(0, 0.01);
+    for (size_t i = 0; i < src.size(); i++)
+        dst[i] = pose.transform(src[i]) + math::Vector3d(noise(gen), noise(gen), noise(gen));
+    const auto fit = math::kabsch(src.data(), dst.data(), src.size(), weights.data());
+    expect_near(fit, pose, 1e-4);
+    auto cost = [&](const math::Transform<double> &t) {
+        double c = 0;
+        for (size_t i = 0; i < src.size(); i++)
+            c += weights[i] * math::length2(t.transform(src[i]) - dst[i]);
+        return c;
+    };
+    const double best = cost(fit);
+    const math::Quatd dq = math::normalized(math::Quatd(1, 1e-5, -1e-5, 1e-5));
+    EXPECT_LE(best, cost(math::Transform<double>(fit.p, fit.q * dq)));
+    EXPECT_LE(best, cost(math::Transform<double>(fit.p + math::Vector3d(1e-5, 0, 0), fit.q)));
+}
+
+TEST(Registration, umeyama) {
+    for (unsigned seed = 0; seed < 10; seed++) {
+        const auto pose = random_pose<double>(seed);
+        const double s = 0.25 + seed * 0.5;
+        const auto src = random_points<double>(1000, seed);
+        std::vector<math::Vector3d> dst(src.size());
+        for (size_t i = 0; i < src.size(); i++)
+            dst[i] = pose.p + pose.q.rotate(src[i]) * s;
+        double scale = 0;
+        const auto fit = math::umeyama(src.data(), dst.data(), src.size(), scale);
+        EXPECT_NEAR(scale, s, 1e-9);
+        expect_near(fit, pose, 1e-9);
+    }
+    // all the source points coincide: no scale
+    std::vector<math::Vector3f> src(10, math::Vector3f(1, 2, 3)), dst(10, math::Vector3f(4, 5, 6));
+    float scale = 1;
+    math::umeyama(src.data(), dst.data(), src.size(), scale);
+    EXPECT_EQ(scale, 0.0f);
+}
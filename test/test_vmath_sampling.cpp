@@ -0,0 +1,170 @@
+#include "vmath.h"
+#include "vmath_sampling.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+namespace {
+// each of the 2^m elementary intervals of all the shapes 2^a x 2^(m-a) contains one of the 2^m points
+void check_net(const std::vector<math::Vector2d> &points, unsigned m) {
+    for (unsigned a = 0; a <= m; a++) {
+        std::vector<int> cells(size_t(1) << m, 0);
+        for (const math::Vector2d &p : points) {
+            ASSERT_GE(p.x, 0.0);
+            ASSERT_LT(p.x, 1.0);
+            const size_t i = size_t(p.x * double(1u << a)), j = size_t(p.y * double(1u << (m - a)));
+            cells[(j << a) + i]++;
+        }
+        for (int c : cells)
+            ASSERT_EQ(c, 1) << a;
+    }
+}
+} // namespace
+
+TEST(Sampling, sobol) {
+    // the first points of the 2D Sobol sequence (in index order, not in Gray code order)
+    const double expected[][2] = {{0, 0}, {0.5, 0.5}, {0.25, 0.75}, {0.75, 0.25}, {0.125, 0.625}, {0.625, 0.125}};
+    for (uint32_t i = 0; i < 6; i++) {
+        const math::Vector2d p = math::sample_2d<double>(math::SampleSequence::sobol, i);
+        EXPECT_EQ(p.x, expected[i][0]) << i;
+        EXPECT_EQ(p.y, expected[i][1]) << i;
+    }
+    EXPECT_EQ(math::sobol(0x12345678u, 0), math::detail::reverse_bits(0x12345678u));
+
+    // (0, m, 2)-nets, unscrambled and scrambled, and stratification of each dimension
+    for (unsigned m = 1; m <= 10; m++) {
+        for (auto sequence : {math::SampleSequence::sobol, math::SampleSequence::owen_sobol}) {
+            std::vector<math::Vector2d> points(size_t(1) << m);
+            math::generate_samples(sequence, 0, math::pixel_seed(3, 7), points.data(), points.size(), 1);
+            check_net(points, m);
+        }
+        for (unsigned d = 0; d < math::sobol_dimensions; d++) {
+            std::vector<int> strata(size_t(1) << m, 0);
+            for (uint32_t i = 0; i < (1u << m); i++)
+                strata[math::owen_sobol(i, d, 1234) >> (32 - m)]++;
+            for (int c : strata)
+                ASSERT_EQ(c, 1) << d;
+        }
+    }
+
+    // the scrambling depends on the seed only
+    EXPECT_EQ(math::sample_2d<float>(math::SampleSequence::owen_sobol, 17, 5),
+              math::sample_2d<float>(math::SampleSequence::owen_sobol, 17, 5));
+    EXPECT_NE(math::sample_2d<float>(math::SampleSequence::owen_sobol, 17, 5),
+              math::sample_2d<float>(math::SampleSequence::owen_sobol, 17, 6));
+    EXPECT_NE(math::pixel_seed(1, 2), math::pixel_seed(2, 1));
+    EXPECT_NE(math::pixel_seed(1, 2), math::pixel_seed(1, 2, 1));
+}
+
+TEST(Sampling, halton_r2) {
+    EXPECT_EQ(math::radical_inverse<double>(2, 3), 0.75);
+    EXPECT_NEAR(math::radical_inverse<double>(3, 1), 1.0 / 3.0, 1e-15);
+    EXPECT_NEAR(math::radical_inverse<double>(3, 5), 7.0 / 9.0, 1e-15);
+    EXPECT_NEAR(math::radical_inverse<double>(5, 7), 11.0 / 25.0, 1e-15); // 12 in base 5
+    EXPECT_LT(math::radical_inverse<float>(3, 0xffffffffu), 1.f);
+    const math::Vector3d h = math::sample_3d<double>(math::SampleSequence::halton, 4);
+    EXPECT_NEAR(h.x, 0.125, 1e-15);
+    EXPECT_NEAR(h.y, 4.0 / 9.0, 1e-15);
+    EXPECT_NEAR(h.z, 4.0 / 5.0, 1e-15);
+
+    // x_n = frac(0.5 + n / g, 0.5 + n / g^2) with g the plastic number
+    const double g = 1.32471795724474602596;
+    for (uint32_t i : {0u, 1u, 2u, 1000u, 123456u}) {
+        const math::Vector2d p = math::sample_2d<double>(math::SampleSequence::r2, i);
+        EXPECT_NEAR(p.x, std::fmod(0.5 + i / g, 1.0), 1e-9 * (1 + i));
+        EXPECT_NEAR(p.y, std::fmod(0.5 + i / (g * g), 1.0), 1e-9 * (1 + i));
+    }
+    // seeded: a shift modulo 1
+    const math::Vector2d a = math::sample_2d<double>(math::SampleSequence::r2, 10, 99);
+    const math::Vector2d b = math::sample_2d<double>(math::SampleSequence::r2, 11, 99);
+    const math::Vector2d a0 = math::sample_2d<double>(math::SampleSequence::r2, 10);
+    const math::Vector2d b0 = math::sample_2d<double>(math::SampleSequence::r2, 11);
+    EXPECT_NEAR(std::fmod(b.x - a.x + 1.0, 1.0), std::fmod(b0.x - a0.x + 1.0, 1.0), 1e-9);
+    EXPECT_NE(a.x, a0.x);
+
+    // the 1D projections of the sequences are well distributed
+    for (auto sequence : {math::SampleSequence::halton, math::SampleSequence::r2}) {
+        std::vector<math::Vector3f> points(4096);
+        math::generate_samples(sequence, 0, 7, points.data(), points.size());
+        std::vector<int> strata(3 * 64, 0);
+        for (const math::Vector3f &p : points) {
+            strata[size_t(p.x * 64)]++;
+            strata[64 + size_t(p.y * 64)]++;
+            strata[128 + size_t(p.z * 64)]++;
+        }
+        for (int c : strata)
+            EXPECT_NEAR(c, 64, 6);
+    }
+}
+
+TEST(Sampling, batch) {
+    // the batch functions give the scalar results, across the SIMD tails, a wrapping index and threads
+    for (auto sequence : {math::SampleSequence::sobol, math::SampleSequence::owen_sobol, math::SampleSequence::halton,
+                          math::SampleSequence::r2}) {
+        for (uint32_t seed : {0u, 42u}) {
+            for (uint32_t first : {0u, 5u, 0xfffffff0u}) {
+                for (size_t count : {size_t(0), size_t(1), size_t(7), size_t(50001)}) {
+                    std::vector<math::Vector2f> f2(count + 1);
+                    std::vector<math::Vector3f> f3(count + 1);
+                    std::vector<math::Vector2d> d2(count);
+                    std::vector<math::Vector3d> d3(count);
+                    math::generate_samples(sequence, first, seed, f2.data(), count, 4);
+                    math::generate_samples(sequence, first, seed, f3.data(), count, 4);
+                    math::generate_samples(sequence, first, seed, d2.data(), count, 3);
+                    math::generate_samples(sequence, first, seed, d3.data(), count, 3);
+                    for (size_t i = 0; i < count; i++) {
+                        const uint32_t index = first + uint32_t(i);
+                        ASSERT_EQ(f2[i], math::sample_2d<float>(sequence, index, seed)) << i;
+                        ASSERT_EQ(f3[i], math::sample_3d<float>(sequence, index, seed)) << i;
+                        ASSERT_EQ(d2[i], math::sample_2d<double>(sequence, index, seed)) << i;
+                        ASSERT_EQ(d3[i], math::sample_3d<double>(sequence, index, seed)) << i;
+                        ASSERT_LT(f3[i].x, 1.f);
+                        ASSERT_LT(f3[i].y, 1.f);
+                        ASSERT_LT(f3[i].z, 1.f);
+                    }
+                    EXPECT_EQ(f2[count], math::Vector2f(0.f, 0.f));
+                }
+            }
+        }
+    }
+}
+
+TEST(Sampling, warps) {
+    const size_t n = 1 << 14;
+    std::vector<math::Vector2d> u(n);
+    math::generate_samples(math::SampleSequence::owen_sobol, 0, 1, u.data(), n);
+    std::vector<math::Vector2d> disk(n);
+    std::vector<math::Vector3d> hemisphere(n), sphere(n), triangle(n);
+    math::warp_disk(u.data(), disk.data(), n, 2);
+    math::warp_cosine_hemisphere(u.data(), hemisphere.data(), n, 2);
+    math::warp_uniform_sphere(u.data(), sphere.data(), n, 2);
+    math::warp_triangle(u.data(), triangle.data(), n, 2);
+    double disk_r2 = 0, hemisphere_z = 0;
+    math::Vector3d sphere_mean(0, 0, 0), triangle_mean(0, 0, 0);
+    for (size_t i = 0; i < n; i++) {
+        ASSERT_EQ(disk[i], math::warp_disk(u[i]));
+        ASSERT_LE(math::length(disk[i]), 1.0 + 1e-12);
+        ASSERT_NEAR(math::length(hemisphere[i]), 1.0, 1e-12);
+        ASSERT_GE(hemisphere[i].z, 0.0);
+        ASSERT_NEAR(math::length(sphere[i]), 1.0, 1e-12);
+        ASSERT_NEAR(triangle[i].x + triangle[i].y + triangle[i].z, 1.0, 1e-12);
+        ASSERT_GE(triangle[i].x, 0.0);
+        ASSERT_GE(triangle[i].y, 0.0);
+        ASSERT_GE(triangle[i].z, -1e-15);
+        disk_r2 += math::length2(disk[i]);
+        hemisphere_z += hemisphere[i].z;
+        sphere_mean += sphere[i];
+        triangle_mean += triangle[i];
+    }
+    // moments of the distributions: E[r^2] = 1/2 on the disk, E[cos] = 2/3 for the cosine distribution, centered
+    // sphere, centroid of the triangle
+    EXPECT_NEAR(disk_r2 / n, 0.5, 1e-3);
+    EXPECT_NEAR(hemisphere_z / n, 2.0 / 3.0, 1e-3);
+    EXPECT_NEAR(math::length(sphere_mean) / n, 0.0, 1e-3);
+    EXPECT_NEAR(triangle_mean.x / n, 1.0 / 3.0, 1e-3);
+    EXPECT_NEAR(triangle_mean.y / n, 1.0 / 3.0, 1e-3);
+    EXPECT_NEAR(math::cosine_hemisphere_pdf(0.5), 0.5 / M_PI, 1e-15);
+    EXPECT_NEAR(math::uniform_sphere_pdf<double>() * 4 * M_PI, 1.0, 1e-15);
+}
@@ -0,0 +1,162 @@
+#include "vmath.h"
+#include "vmath_random.h"
+#include "vmath_solve.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+template <typename M> M random_matrix(math::Random &rng) {
+    M m;
+    for (auto &v : m.data)
+        v = rng.uniform(typename M::value_type(-1), typename M::value_type(1));
+    return m;
+}
+
+// well conditioned symmetric positive definite matrix a * transpose(a) + identity
+template <typename M> M random_spd(math::Random &rng) {
+    const M a = random_matrix<M>(rng);
+    M at = a, id;
+    math::transpose(at);
+    math::set_identity(id);
+    return a * at + id;
+}
+
+} // namespace
+
+TEST(Solve, lu) {
+    math::Random rng(1);
+    for (int n = 0; n < 100; n++) {
+        const math::Matrix3d m3 = random_matrix<math::Matrix3d>(rng) + math::Matrix3d{2, 0, 0, 0, 2, 0, 0, 0, 2};
+        const math::Vector3d b3(rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 1.0));
+        const math::Vector3d x3 = math::solve(m3, b3);
+        EXPECT_NEAR(math::length(m3 * x3 - b3), 0.0, 1e-14);
+        EXPECT_NEAR(math::length(x3 - math::inverse(m3) * b3), 0.0, 1e-12);
+
+        const math::Matrix4f m4 = random_matrix<math::Matrix4f>(rng);
+        const math::Vector4f b4(rng.uniform(-1.f, 1.f), rng.uniform(-1.f, 1.f), rng.uniform(-1.f, 1.f), 1.f);
+        const math::Vector4f x4 = math::solve(m4, b4);
+        // relative to the size of the solution, as random matrices can be badly conditioned
+        EXPECT_NEAR(math::length(m4 * x4 - b4), 0.0, 1e-5f * (1.f + math::length(x4)));
+    }
+
+    // a zero in the top left corner needs a row exchange
+    const math::Matrix3f p = {0, 1, 0, 0, 0, 2, 3, 0, 0};
+    EXPECT_EQ(math::solve(p, math::Vector3f(1, 2, 3)), math::Vector3f(1, 1, 1));
+
+    // singular: zero vector, as inverse() returns the null matrix
+    const math::Matrix3f s = {1, 2, 3, 2, 4, 6, 0, 1, 1};
+    EXPECT_EQ(math::solve(s, math::Vector3f(1, 2, 3)), math::Vector3f(0, 0, 0));
+
+    // 4x4 Hilbert matrix: det ~1.7e-7 is below the threshold of inverse(), the solution is still accurate
+    math::Matrix4d h;
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            h(i, j) = 1.0 / (i + j + 1);
+    const math::Vector4d ones(1, 1, 1, 1);
+    EXPECT_EQ(math::inverse(h), math::Matrix4d());
+    EXPECT_NEAR(math::length(math::solve(h, h * ones) - ones), 0.0, 1e-11);
+
+    // generic sizes
+    math::Matrix6d m6;
+    for (int i = 0; i < 36; i++)
+        m6.data[i] = rng.uniform(-1.0, 1.0);
+    const math::Vector6d b6 = {1, 2, 3, 4, 5, 6};
+    EXPECT_NEAR(math::length(m6 * math::solve(m6, b6) - b6), 0.0, 1e-11);
+}
+
+TEST(Solve, cholesky) {
+    math::Random rng(2);
+    for (int n = 0; n < 100; n++) {
+        const math::Matrix3f m3 = random_spd<math::Matrix3f>(rng);
+        const math::Vector3f b3(rng.uniform(-1.f, 1.f), rng.uniform(-1.f, 1.f), rng.uniform(-1.f, 1.f));
+        const math::Vector3f x3 = math::solve_cholesky(m3, b3);
+        EXPECT_NEAR(math::length(m3 * x3 - b3), 0.f, 1e-5f);
+        EXPECT_NEAR(math::length(x3 - math::solve(m3, b3)), 0.f, 1e-5f);
+
+        const math::Matrix4d m4 = random_spd<math::Matrix4d>(rng);
+        const math::Vector4d b4(rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 1.0), 1.0);
+        EXPECT_NEAR(math::length(m4 * math::solve_cholesky(m4, b4) - b4), 0.0, 1e-13);
+    }
+    // only the lower triangle is read
+    math::Matrix3d lower = {4, 0, 0, 2, 5, 0, 0, 1, 3};
+    const math::Matrix3d full = {4, 2, 0, 2, 5, 1, 0, 1, 3};
+    const math::Vector3d b(1, 2, 3);
+    EXPECT_NEAR(math::length(math::solve_cholesky(lower, b) - math::solve(full, b)), 0.0, 1e-15);
+    // not positive definite
+    const math::Matrix3d indefinite = {1, 2, 0, 2, 1, 0, 0, 0, 1};
+    EXPECT_EQ(math::solve_cholesky(indefinite, b), math::Vector3d(0, 0, 0));
+
+    math::Matrix<5, 5, double> m5;
+    for (int i = 0; i < 5; i++)
+        for (int j = 0; j < 5; j++)
+            m5(i, j) = i == j ? 3.0 : 1.0 / (1 + i + j);
+    const math::Vector<5, double> b5 = {1, -1, 2, 0, 3};
+    EXPECT_NEAR(math::length(m5 * math::solve_cholesky(m5, b5) - b5), 0.0, 1e-14);
+}
+
+TEST(Solve, batch) {
+    math::Random rng(3);
+    // 1037 systems: SIMD iterations and a scalar tail, some singular / indefinite
+    const size_t n = 1037;
+    std::vector<math::Matrix3f> m3(n), spd3(n);
+    std::vector<math::Matrix4d> m4(n), spd4(n);
+    std::vector<math::Vector3f> b3(n), x3(n), c3(n);
+    std::vector<math::Vector4d> b4(n), x4(n), c4(n);
+    for (size_t i = 0; i < n; i++) {
+        m3[i] = random_matrix<math::Matrix3f>(rng);
+        m4[i] = random_matrix<math::Matrix4d>(rng);
+        spd3[i] = random_spd<math::Matrix3f>(rng);
+        spd4[i] = random_spd<math::Matrix4d>(rng);
+        if (i % 97 == 0) {
+            m3[i] = math::Matrix3f();
+            spd4[i] = -spd4[i];
+        }
+        b3[i] = math::Vector3f(rng.uniform(-1.f, 1.f), rng.uniform(-1.f, 1.f), rng.uniform(-1.f, 1.f));
+        b4[i] = math::Vector4d(rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 1.0), 0.5);
+    }
+    for (unsigned threads : {1u, 3u}) {
+        math::solve(m3.data(), b3.data(), x3.data(), n, threads);
+        math::solve(m4.data(), b4.data(), x4.data(), n, threads);
+        for (size_t i = 0; i < n; i++) {
+            const math::Vector3f r3 = math::solve(m3[i], b3[i]);
+            const math::Vector4d r4 = math::solve(m4[i], b4[i]);
+            ASSERT_NEAR(math::length(x3[i] - r3), 0.f, 1e-4f * (1.f + math::length(r3))) << i;
+            ASSERT_NEAR(math::length(x4[i] - r4), 0.0, 1e-10 * (1.0 + math::length(r4))) << i;
+        }
+        EXPECT_EQ(x3[0], math::Vector3f(0, 0, 0));
+        math::solve_cholesky(spd3.data(), b3.data(), x3.data(), n, threads);
+        math::solve_cholesky(spd4.data(), b4.data(), x4.data(), n, threads);
+        for (size_t i = 0; i < n; i++) {
+            ASSERT_NEAR(math::length(x3[i] - math::solve_cholesky(spd3[i], b3[i])), 0.f, 1e-5f) << i;
+            ASSERT_NEAR(math::length(x4[i] - math::solve_cholesky(spd4[i], b4[i])), 0.0, 1e-13) << i;
+        }
+        EXPECT_EQ(x4[0], math::Vector4d(0, 0, 0, 0));
+    }
+
+    // structure of arrays
+    std::vector<float> a(9 * n), b(3 * n), x(3 * n);
+    std::vector<double> ad(16 * n), bd(4 * n), xd(4 * n);
+    for (size_t i = 0; i < n; i++) {
+        for (int c = 0; c < 9; c++)
+            a[c * n + i] = m3[i].data[c];
+        for (int c = 0; c < 3; c++)
+            b[c * n + i] = b3[i][c];
+        for (int c = 0; c < 16; c++)
+            ad[c * n + i] = spd4[i].data[c];
+        for (int c = 0; c < 4; c++)
+            bd[c * n + i] = b4[i][c];
+    }
+    math::solve_soa<3>(a.data(), b.data(), x.data(), n, 2);
+    math::solve_cholesky_soa<4>(ad.data(), bd.data(), xd.data(), n, 2);
+    for (size_t i = 0; i < n; i++) {
+        const math::Vector3f r3 = math::solve(m3[i], b3[i]);
+        const math::Vector4d r4 = math::solve_cholesky(spd4[i], b4[i]);
+        ASSERT_NEAR(math::length(math::Vector3f(x[i], x[n + i], x[2 * n + i]) - r3), 0.f,
+                    1e-4f * (1.f + math::length(r3)));
+        ASSERT_NEAR(math::length(math::Vector4d(xd[i], xd[n + i], xd[2 * n + i], xd[3 * n + i]) - r4), 0.0, 1e-13);
+    }
+}
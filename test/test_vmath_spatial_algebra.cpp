@@ -0,0 +1,150 @@
+#include "vmath.h"
+#include "vmath_random.h"
+#include "vmath_spatial_algebra.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+namespace {
+
+using math::Matrix6d;
+using math::Vector6d;
+
+math::Vector3d random_vector(math::Random &rng) {
+    return math::Vector3d(rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 1.0));
+}
+math::Matrix3d random_matrix(math::Random &rng) {
+    math::Matrix3d m;
+    for (double &v : m.data)
+        v = rng.uniform(-1.0, 1.0);
+    return m;
+}
+math::Matrix3d random_symmetric(math::Random &rng) {
+    math::Matrix3d m = random_matrix(rng), mt = m;
+    math::transpose(mt);
+    return m * mt;
+}
+math::MotionVector<double> random_motion(math::Random &rng) {
+    return math::MotionVector<double>(random_vector(rng), random_vector(rng));
+}
+math::ForceVector<double> random_force(math::Random &rng) {
+    return math::ForceVector<double>(random_vector(rng), random_vector(rng));
+}
+math::SpatialTransform<double> random_spatial_transform(math::Random &rng) {
+    return math::SpatialTransform<double>(math::random_transform<double>(rng, 2.0));
+}
+
+math::Matrix<3, 3, double> skew(const math::Vector3d &v) { return {0, -v.z, v.y, v.z, 0, -v.x, -v.y, v.x, 0}; }
+
+// dense motion cross product matrix [wx 0; vx wx]
+Matrix6d dense_cross(const math::MotionVector<double> &m) {
+    Matrix6d ret;
+    math::set_block(ret, 0, 0, skew(m.angular));
+    math::set_block(ret, 3, 3, skew(m.angular));
+    math::set_block(ret, 3, 0, skew(m.linear));
+    return ret;
+}
+
+void expect_near(const Vector6d &a, const Vector6d &b, double tol = 1e-12) {
+    for (int i = 0; i < 6; i++)
+        EXPECT_NEAR(a[i], b[i], tol) << i;
+}
+void expect_near(const Matrix6d &a, const Matrix6d &b, double tol = 1e-12) {
+    for (int i = 0; i < 36; i++)
+        EXPECT_NEAR(a.data[i], b.data[i], tol) << "(" << i % 6 << "," << i / 6 << ")";
+}
+
+} // namespace
+
+TEST(SpatialAlgebra, vectors) {
+    math::Random rng(1);
+    for (int n = 0; n < 20; n++) {
+        const auto m1 = random_motion(rng), m2 = random_motion(rng);
+        const auto f = random_force(rng);
+        const Vector6d v1(m1), v2(m2), vf(f);
+        EXPECT_EQ(math::MotionVector<double>(v1), m1);
+        expect_near(Vector6d(m1 + m2 * 2.0), v1 + v2 * 2.0);
+        expect_near(Vector6d(-f), -vf);
+        EXPECT_NEAR(math::dot(m1, f), math::dot(v1, vf), 1e-14);
+        EXPECT_EQ(math::dot(m1, f), math::dot(f, m1));
+        // m x and m x* = -(m x)^T
+        const Matrix6d crm = dense_cross(m1);
+        expect_near(Vector6d(math::cross(m1, m2)), crm * v2);
+        expect_near(Vector6d(math::cross(m1, f)), -math::transpose_mul(crm, vf));
+        // the power of a force moving along with m is conserved: (m x m2) . f + m2 . (m x* f) = 0
+        EXPECT_NEAR(math::dot(math::cross(m1, m2), f) + math::dot(m2, math::cross(m1, f)), 0.0, 1e-14);
+    }
+}
+
+TEST(SpatialAlgebra, transforms) {
+    math::Random rng(2);
+    // a rotation about the z axis of A seen from a frame at (1, 0, 0): the origin of B moves along y
+    const math::SpatialTransform<double> shift(math::Transfd(math::Vector3d(1, 0, 0)));
+    const auto spin = shift * math::MotionVector<double>(math::Vector3d(0, 0, 1), math::Vector3d());
+    EXPECT_EQ(spin.angular, math::Vector3d(0, 0, 1));
+    EXPECT_EQ(spin.linear, math::Vector3d(0, 1, 0));
+
+    for (int n = 0; n < 20; n++) {
+        const math::Transfd t1 = math::random_transform<double>(rng, 2.0);
+        const math::Transfd t2 = math::random_transform<double>(rng, 2.0);
+        const math::SpatialTransform<double> X1(t1), X2(t2);
+        const auto m = random_motion(rng);
+        const auto f = random_force(rng);
+        const Matrix6d D1 = math::to_matrix(X1), D1inv = math::to_matrix(math::inverse(X1));
+        expect_near(D1 * D1inv, [] {
+            Matrix6d id;
+            math::set_identity(id);
+            return id;
+        }());
+        expect_near(Vector6d(X1 * m), D1 * Vector6d(m));
+        expect_near(Vector6d(math::inverse_mul(X1, m)), D1inv * Vector6d(m));
+        // forces transform with X* = inverse(X)^T
+        expect_near(Vector6d(X1 * f), math::transpose_mul(D1inv, Vector6d(f)));
+        expect_near(Vector6d(math::inverse_mul(X1, f)), math::transpose_mul(D1, Vector6d(f)));
+        // the power does not depend on the frame
+        EXPECT_NEAR(math::dot(X1 * m, X1 * f), math::dot(m, f), 1e-12);
+
+        // composition follows the poses: t1 * t2 is the pose of C in A, so X_AC = X_BC * X_AB
+        expect_near(math::to_matrix(X2 * X1), math::to_matrix(X2) * D1);
+        expect_near(math::to_matrix(math::SpatialTransform<double>(t1 * t2)), math::to_matrix(X2 * X1));
+        const math::Transfd back = math::pose(X1);
+        EXPECT_NEAR(math::length(back.p - t1.p), 0.0, 1e-15);
+        const double qdot = back.q.w * t1.q.w + back.q.x * t1.q.x + back.q.y * t1.q.y + back.q.z * t1.q.z;
+        EXPECT_NEAR(std::abs(qdot), 1.0, 1e-12);
+    }
+}
+
+TEST(SpatialAlgebra, inertias) {
+    math::Random rng(3);
+    for (int n = 0; n < 20; n++) {
+        const math::SpatialTransform<double> X = random_spatial_transform(rng);
+        const Matrix6d D = math::to_matrix(X), Dinv = math::to_matrix(math::inverse(X));
+        const auto m = random_motion(rng);
+        const math::Vector3d com = random_vector(rng);
+        const math::RigidInertia<double> rb(rng.uniform(0.5, 2.0), com, random_symmetric(rng));
+        EXPECT_NEAR(math::length(rb.h - com * rb.mass), 0.0, 1e-15);
+
+        // the momentum, and the dense inertia with the parallel axis theorem
+        const Matrix6d Drb = math::to_matrix(rb);
+        expect_near(Vector6d(rb * m), Drb * Vector6d(m));
+        expect_near(Vector6d(math::ArticulatedInertia<double>(rb) * m), Drb * Vector6d(m));
+
+        // rigid transforms: X* i inverse(X) and transpose(X) i X
+        expect_near(math::to_matrix(X * rb), math::transposed(Dinv) * Drb * Dinv);
+        expect_near(math::to_matrix(math::inverse_mul(X, rb)), math::transposed(D) * Drb * D);
+        expect_near(math::to_matrix(X * rb + rb), math::to_matrix(X * rb) + Drb);
+
+        // articulated inertias
+        math::ArticulatedInertia<double> ia(random_symmetric(rng), random_matrix(rng), random_symmetric(rng));
+        const Matrix6d Dia = math::to_matrix(ia);
+        expect_near(Vector6d(ia * m), Dia * Vector6d(m));
+        expect_near(math::to_matrix(math::inverse_mul(X, ia)), math::transposed(D) * Dia * D);
+        expect_near(math::to_matrix(X * ia), math::transposed(Dinv) * Dia * Dinv);
+        expect_near(math::to_matrix(math::inverse_mul(X, X * ia)), Dia);
+        const auto u = random_force(rng);
+        math::rank1_update(ia, u, -0.5);
+        expect_near(math::to_matrix(ia), Dia - 0.5 * math::outer(Vector6d(u), Vector6d(u)));
+        expect_near(math::to_matrix(ia - ia + ia), math::to_matrix(ia));
+    }
+}
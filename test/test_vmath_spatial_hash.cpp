@@ -0,0 +1,176 @@
+#include "vmath_spatial_hash.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+std::vector<math::Vector3d> random_points(size_t n, double range, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> d(-range, range);
+    std::vector<math::Vector3d> pts(n);
+    for (auto &p : pts)
+        p = math::Vector3d(d(gen), d(gen), d(gen));
+    return pts;
+}
+
+std::vector<uint32_t> brute_radius(const std::vector<math::Vector3d> &pts, const math::Vector3d &q, double r) {
+    std::vector<uint32_t> res;
+    for (size_t i = 0; i < pts.size(); i++)
+        if (length2(pts[i] - q) <= r * r)
+            res.push_back(uint32_t(i));
+    return res;
+}
+
+std::vector<std::pair<double, uint32_t>> brute_knn(const std::vector<math::Vector3d> &pts, const math::Vector3d &q,
+                                                   size_t k) {
+    std::vector<std::pair<double, uint32_t>> all;
+    for (size_t i = 0; i < pts.size(); i++)
+        all.push_back(std::make_pair(length2(pts[i] - q), uint32_t(i)));
+    std::sort(all.begin(), all.end());
+    all.resize(std::min(k, all.size()));
+    return all;
+}
+
+void check_queries(const math::SpatialHashGridd &grid, const std::vector<math::Vector3d> &pts, unsigned seed) {
+    auto queries = random_points(50, 12.0, seed);
+    for (const auto &q : queries) {
+        for (double r : {0.3, 1.0, 2.5}) {
+            std::vector<uint32_t> found;
+            grid.radius_search(q, r, found);
+            std::sort(found.begin(), found.end());
+            ASSERT_EQ(found, brute_radius(pts, q, r));
+        }
+        for (size_t k : {1, 8, 40}) {
+            std::vector<uint32_t> idx(k);
+            std::vector<double> d2(k);
+            ASSERT_EQ(grid.knn_search(q, k, idx.data(), d2.data()), std::min(k, pts.size()));
+            auto expected = brute_knn(pts, q, k);
+            for (size_t i = 0; i < expected.size(); i++) {
+                ASSERT_EQ(idx[i], expected[i].second);
+                ASSERT_DOUBLE_EQ(d2[i], expected[i].first);
+            }
+        }
+    }
+}
+} // namespace
+
+TEST(SpatialHashGrid, queries) {
+    auto pts = random_points(5000, 10.0, 1);
+    math::SpatialHashGridd grid(1.0);
+    grid.build(pts.data(), pts.size());
+    ASSERT_EQ(grid.size(), pts.size());
+    ASSERT_GE(grid.bucket_count(), pts.size());
+    check_queries(grid, pts, 2);
+    // few points spread over many cells: the rows of cells wrap around the (small) table and collide
+    std::vector<math::Vector3d> sparse(pts.begin(), pts.begin() + 50);
+    math::SpatialHashGridd sparse_grid(0.3);
+    sparse_grid.build(sparse.data(), sparse.size());
+    ASSERT_EQ(sparse_grid.bucket_count(), 64u);
+    check_queries(sparse_grid, sparse, 3);
+    // kNN with fewer points than k, and empty grid
+    math::SpatialHashGridd small(0.5);
+    small.build(pts.data(), 3);
+    uint32_t idx[5];
+    double d2[5];
+    ASSERT_EQ(small.knn_search(math::Vector3d(100, 0, 0), 5, idx, d2), 3u);
+    ASSERT_EQ(idx[3], math::SpatialHashGridd::invalid_index);
+    ASSERT_TRUE(std::isinf(d2[4]));
+    math::SpatialHashGridd empty(1.0);
+    empty.build(pts.data(), 0);
+    std::vector<uint32_t> found;
+    empty.radius_search(math::Vector3d(0, 0, 0), 1.0, found);
+    ASSERT_TRUE(found.empty());
+    ASSERT_EQ(empty.knn_search(math::Vector3d(0, 0, 0), 1, idx), 0u);
+}
+
+TEST(SpatialHashGrid, parallel) {
+    auto pts = random_points(100000, 20.0, 3);
+    math::SpatialHashGridd g1(0.7), g4(0.7);
+    g1.build(pts.data(), pts.size(), 1);
+    g4.build(pts.data(), pts.size(), 4);
+    auto queries = random_points(2000, 20.0, 4);
+    // the layout is independent of the thread count, so are the query results
+    std::vector<uint32_t> off1, idx1, off4, idx4;
+    g1.radius_search(queries.data(), queries.size(), 1.0, off1, idx1, 1);
+    g4.radius_search(queries.data(), queries.size(), 1.0, off4, idx4, 4);
+    ASSERT_EQ(off1, off4);
+    ASSERT_EQ(idx1, idx4);
+    ASSERT_EQ(off1.size(), queries.size() + 1);
+    for (size_t i = 0; i < queries.size(); i += 97) {
+        std::vector<uint32_t> single;
+        g1.radius_search(queries[i], 1.0, single);
+        ASSERT_EQ(std::vector<uint32_t>(idx1.begin() + off1[i], idx1.begin() + off1[i + 1]), single);
+    }
+    const size_t k = 6;
+    std::vector<uint32_t> knn1(queries.size() * k), knn4(queries.size() * k);
+    g1.knn_search(queries.data(), queries.size(), k, knn1.data(), nullptr, 1);
+    g4.knn_search(queries.data(), queries.size(), k, knn4.data(), nullptr, 4);
+    ASSERT_EQ(knn1, knn4);
+}
+
+TEST(ParallelFor, exceptions) {
+    // thrown by a worker and by the calling thread: rethrown once all the chunks are done
+    for (size_t throwing : {size_t(0), size_t(3)}) {
+        std::vector<int> done(4, 0);
+        EXPECT_THROW(math::parallel_for(4000, 4, 1000,
+                                        [&](size_t c, size_t, size_t) {
+                                            if (c == throwing)
+                                                throw std::runtime_error("chunk");
+                                            done[c] = 1;
+                                        }),
+                     std::runtime_error);
+        done[throwing] = 1;
+        EXPECT_EQ(done, std::vector<int>(4, 1));
+    }
+}
+
+TEST(SpatialHashGrid, update) {
+    auto pts = random_points(20000, 10.0, 5);
+    math::SpatialHashGridd grid(1.0);
+    grid.build(pts.data(), pts.size(), 2);
+    // small displacements: most points stay in their bucket, the others go to the overflow table
+    std::mt19937 gen(6);
+    std::uniform_real_distribution<double> step(-0.01, 0.01);
+    for (int frame = 0; frame < 5; frame++) {
+        for (auto &p : pts)
+            p += math::Vector3d(step(gen), step(gen), step(gen));
+        grid.update(pts.data(), 2);
+        ASSERT_GT(grid.overflow_size(), 0u);
+        ASSERT_LT(grid.overflow_size(), pts.size() / 16);
+        check_queries(grid, pts, 10 + frame);
+    }
+    // large displacements trigger a rebuild
+    for (auto &p : pts)
+        p = p * 1.5 + math::Vector3d(3, 0, 0);
+    grid.update(pts.data());
+    ASSERT_EQ(grid.overflow_size(), 0u);
+    check_queries(grid, pts, 20);
+}
+
+TEST(SpatialHashGrid, far_queries) {
+    auto pts = random_points(2000, 10.0, 7);
+    math::SpatialHashGridd grid(0.1);
+    grid.build(pts.data(), pts.size());
+    // far from the grid (the search starts at the cube that reaches the occupied cells), and so far that the cell
+    // coordinates do not fit in an int32_t
+    for (const math::Vector3d &q : {math::Vector3d(1e4, 3, -2), math::Vector3d(-5e3, 2e4, 1e3),
+                                    math::Vector3d(1e12, 0, 0), math::Vector3d(-1e30, 1e30, 5)}) {
+        const size_t k = 4;
+        uint32_t idx[k];
+        double d2[k];
+        ASSERT_EQ(grid.knn_search(q, k, idx, d2), k);
+        auto expected = brute_knn(pts, q, k);
+        for (size_t i = 0; i < k; i++)
+            ASSERT_DOUBLE_EQ(d2[i], expected[i].first); // the indices can differ for (rounded) equal distances
+        std::vector<uint32_t> found;
+        grid.radius_search(q, 1.0, found);
+        ASSERT_TRUE(found.empty());
+        // a radius that covers the whole grid
+        grid.radius_search(q, 2.0 * length(q) + 100.0, found);
+        ASSERT_EQ(found.size(), pts.size());
+    }
+}
@@ -0,0 +1,127 @@
+#include "vmath_spatial_sort.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+// reference bit-by-bit interleaving
+uint64_t naive_morton(uint32_t x, uint32_t y, uint32_t z, int bits) {
+    uint64_t code = 0;
+    for (int b = 0; b < bits; b++) {
+        code |= uint64_t((x >> b) & 1) << (3 * b);
+        code |= uint64_t((y >> b) & 1) << (3 * b + 1);
+        code |= uint64_t((z >> b) & 1) << (3 * b + 2);
+    }
+    return code;
+}
+} // namespace
+
+TEST(SpatialSort, morton) {
+    ASSERT_EQ(math::morton_encode_30(1, 0, 0), 1u);
+    ASSERT_EQ(math::morton_encode_30(0, 1, 0), 2u);
+    ASSERT_EQ(math::morton_encode_30(0, 0, 1), 4u);
+    ASSERT_EQ(math::morton_encode_30(1023, 1023, 1023), (1u << 30) - 1);
+    ASSERT_EQ(math::morton_encode_63(0x1fffff, 0x1fffff, 0x1fffff), (1ull << 63) - 1);
+    std::mt19937 gen(1);
+    for (int i = 0; i < 10000; i++) {
+        const uint32_t x = gen() & 0x1fffff, y = gen() & 0x1fffff, z = gen() & 0x1fffff;
+        ASSERT_EQ(math::morton_encode_63(x, y, z), naive_morton(x, y, z, 21));
+        uint32_t dx, dy, dz;
+        math::morton_decode_63(math::morton_encode_63(x, y, z), dx, dy, dz);
+        ASSERT_EQ(dx, x);
+        ASSERT_EQ(dy, y);
+        ASSERT_EQ(dz, z);
+        const uint32_t sx = x & 0x3ff, sy = y & 0x3ff, sz = z & 0x3ff;
+        ASSERT_EQ(math::morton_encode_30(sx, sy, sz), naive_morton(sx, sy, sz, 10));
+        math::morton_decode_30(math::morton_encode_30(sx, sy, sz), dx, dy, dz);
+        ASSERT_EQ(dx, sx);
+        ASSERT_EQ(dy, sy);
+        ASSERT_EQ(dz, sz);
+    }
+}
+
+TEST(SpatialSort, hilbert) {
+    // the 30-bit curve visits all the cells of a 1024^3 grid; check the first 2^18 steps: consecutive indices
+    // are neighboring cells and decoding inverts encoding
+    uint32_t px, py, pz;
+    math::hilbert_decode_30(0, px, py, pz);
+    ASSERT_EQ(px + py + pz, 0u);
+    for (uint32_t h = 1; h < (1u << 18); h++) {
+        uint32_t x, y, z;
+        math::hilbert_decode_30(h, x, y, z);
+        ASSERT_EQ(std::abs(int(x) - int(px)) + std::abs(int(y) - int(py)) + std::abs(int(z) - int(pz)), 1);
+        ASSERT_EQ(math::hilbert_encode_30(x, y, z), h);
+        px = x;
+        py = y;
+        pz = z;
+    }
+    std::mt19937_64 gen(2);
+    for (int i = 0; i < 10000; i++) {
+        const uint64_t h = gen() >> 1;
+        uint32_t x, y, z;
+        math::hilbert_decode_63(h, x, y, z);
+        ASSERT_EQ(math::hilbert_encode_63(x, y, z), h);
+        // steps along the 63-bit curve are unit steps too
+        uint32_t nx, ny, nz;
+        math::hilbert_decode_63(h + 1 < (1ull << 63) ? h + 1 : h - 1, nx, ny, nz);
+        ASSERT_EQ(std::abs(int(x) - int(nx)) + std::abs(int(y) - int(ny)) + std::abs(int(z) - int(nz)), 1);
+    }
+}
+
+TEST(SpatialSort, radix_sort) {
+    std::mt19937_64 gen(3);
+    for (size_t n : {0, 1, 1000, 300000}) {
+        std::vector<uint64_t> keys(n);
+        for (auto &k : keys)
+            k = gen() >> (n % 7 == 0 ? 20 : 1); // some inputs with constant high digits
+        // duplicated keys check the stability
+        for (size_t i = 0; i + 1 < n; i += 5)
+            keys[i + 1] = keys[i];
+        std::vector<uint32_t> expected(n);
+        std::iota(expected.begin(), expected.end(), 0u);
+        std::stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+        for (unsigned threads : {1u, 3u}) {
+            std::vector<uint32_t> perm(n);
+            std::vector<uint64_t> sorted(n);
+            math::radix_sort(keys.data(), n, perm.data(), sorted.data(), threads);
+            ASSERT_EQ(perm, expected);
+            for (size_t i = 0; i < n; i++)
+                ASSERT_EQ(sorted[i], keys[perm[i]]);
+        }
+    }
+}
+
+TEST(SpatialSort, spatial_sort) {
+    std::mt19937 gen(4);
+    std::uniform_real_distribution<float> u(-50.0f, 50.0f);
+    std::vector<math::Vector3f> pts(100000);
+    for (auto &p : pts)
+        p = math::Vector3f(u(gen), u(gen), u(gen));
+    for (auto curve : {math::SpaceFillingCurve::morton, math::SpaceFillingCurve::hilbert}) {
+        std::vector<uint32_t> perm(pts.size());
+        math::spatial_sort(pts.data(), pts.size(), perm.data(), curve, 2);
+        // valid permutation, keys in increasing order
+        std::vector<uint32_t> check = perm;
+        std::sort(check.begin(), check.end());
+        for (size_t i = 0; i < check.size(); i++)
+            ASSERT_EQ(check[i], i);
+        std::vector<uint64_t> keys(pts.size());
+        math::spatial_keys(pts.data(), pts.size(), math::fit_aabb(pts.data(), pts.size()), curve, keys.data(), 1);
+        for (size_t i = 1; i < perm.size(); i++)
+            ASSERT_LE(keys[perm[i - 1]], keys[perm[i]]);
+        // the sorted order is local: consecutive points are much closer than random pairs
+        std::vector<math::Vector3f> sorted(pts.size());
+        math::apply_permutation(pts.data(), perm.data(), pts.size(), sorted.data());
+        double step = 0, random_step = 0;
+        for (size_t i = 1; i < sorted.size(); i++) {
+            step += length(sorted[i] - sorted[i - 1]);
+            random_step += length(pts[i] - pts[i - 1]);
+        }
+        ASSERT_LT(step * 10, random_step);
+    }
+}
@@ -0,0 +1,208 @@
+#include "vmath.h"
+#include "vmath_stream.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+std::string temp_path(const char *name) { return testing::TempDir() + "/" + name; }
+
+template <typename T> std::vector<math::Vector3<T>> random_points(size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<T> d(-100, 100);
+    std::vector<math::Vector3<T>> v(n);
+    for (auto &e : v)
+        e = math::Vector3<T>(d(gen), d(gen), d(gen));
+    return v;
+}
+
+template <typename T> math::Transform<T> random_transform(unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<T> d;
+    return math::Transform<T>(math::Vector3<T>(d(gen), d(gen), d(gen)) * T(10),
+                              math::normalized(math::Quaternion<T>(d(gen), d(gen), d(gen), d(gen))));
+}
+
+template <typename T> void write_file(const std::string &path, const std::vector<unsigned char> &header,
+                                      const std::vector<math::Vector3<T>> &points) {
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    ASSERT_TRUE(f);
+    EXPECT_EQ(std::fwrite(header.data(), 1, header.size(), f), header.size());
+    EXPECT_EQ(std::fwrite(points.data(), sizeof(points[0]), points.size(), f), points.size());
+    std::fclose(f);
+}
+
+template <typename T>
+std::vector<math::Vector3<T>> read_file(const std::string &path, size_t offset, std::vector<unsigned char> *header) {
+    std::vector<math::Vector3<T>> points;
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return points;
+    std::fseek(f, 0, SEEK_END);
+    const size_t size = size_t(std::ftell(f));
+    std::fseek(f, 0, SEEK_SET);
+    if (header) {
+        header->resize(offset);
+        EXPECT_EQ(std::fread(header->data(), 1, offset, f), offset);
+    } else {
+        std::fseek(f, long(offset), SEEK_SET);
+    }
+    points.resize((size - offset) / sizeof(math::Vector3<T>));
+    EXPECT_EQ(std::fread(points.data(), sizeof(points[0]), points.size(), f), points.size());
+    std::fclose(f);
+    return points;
+}
+
+template <typename T> void expect_transformed(const std::vector<math::Vector3<T>> &in,
+                                              const std::vector<math::Vector3<T>> &out, const math::Transform<T> &t,
+                                              T tolerance) {
+    ASSERT_EQ(in.size(), out.size());
+    for (size_t i = 0; i < in.size(); i++)
+        ASSERT_LT(math::length(out[i] - t.transform(in[i])), tolerance) << i;
+}
+} // namespace
+
+TEST(Stream, transform_points) {
+    const auto in = random_points<float>(100003, 1);
+    const auto t = random_transform<float>(2);
+    std::vector<math::Vector3f> out(in.size());
+    math::transform_points(t, in.data(), out.data(), in.size());
+    expect_transformed(in, out, t, 1e-4f);
+    // in place, on several threads
+    out = in;
+    math::transform_points(t, out.data(), out.data(), out.size(), 4);
+    expect_transformed(in, out, t, 1e-4f);
+
+    const auto ind = random_points<double>(1000, 3);
+    const auto td = random_transform<double>(4);
+    std::vector<math::Vector3d> outd(ind.size());
+    math::transform_points(td, ind.data(), outd.data(), ind.size());
+    expect_transformed(ind, outd, td, 1e-11);
+}
+
+TEST(Stream, files) {
+    const auto points = random_points<float>(10007, 5);
+    const auto t = random_transform<float>(6);
+    const std::string input = temp_path("vmath_stream_in.bin");
+    const std::string output = temp_path("vmath_stream_out.bin");
+    write_file(input, {}, points);
+
+    // chunk sizes that do not divide the count, with and without overlap
+    for (unsigned buffers : {1u, 2u, 3u, 8u}) {
+        for (size_t chunk : {size_t(1), size_t(999), size_t(10007), size_t(1) << 20}) {
+            math::StreamOptions options;
+            options.chunk_points = chunk;
+            options.buffers = buffers;
+            options.threads = 2;
+            math::StreamStats stats;
+            ASSERT_TRUE(math::transform_points_file(input, output, t, options, &stats)) << stats.error;
+            EXPECT_EQ(stats.points, points.size());
+            EXPECT_EQ(stats.bytes, points.size() * sizeof(math::Vector3f));
+            EXPECT_LE(stats.memory, buffers * chunk * sizeof(math::Vector3f));
+            EXPECT_TRUE(stats.error.empty());
+            expect_transformed(points, read_file<float>(output, 0, nullptr), t, 1e-4f);
+        }
+    }
+
+    // in place, after a header, on a part of the points
+    const std::vector<unsigned char> header(64, 0xab);
+    const auto pointsd = random_points<double>(5000, 7);
+    const auto td = random_transform<double>(8);
+    write_file(input, header, pointsd);
+    math::StreamOptions options;
+    options.chunk_points = 333;
+    options.input_offset = header.size();
+    options.output_offset = header.size();
+    options.count = 4000;
+    ASSERT_TRUE(math::transform_points_file(input, input, td, options));
+    std::vector<unsigned char> header_out;
+    const auto outd = read_file<double>(input, header.size(), &header_out);
+    EXPECT_EQ(header_out, header);
+    ASSERT_EQ(outd.size(), pointsd.size());
+    expect_transformed(std::vector<math::Vector3d>(pointsd.begin(), pointsd.begin() + 4000),
+                       std::vector<math::Vector3d>(outd.begin(), outd.begin() + 4000), td, 1e-10);
+    for (size_t i = 4000; i < pointsd.size(); i++)
+        ASSERT_EQ(outd[i], pointsd[i]);
+
+    // any kernel
+    ASSERT_TRUE(math::stream_points<double>(input, output, [](math::Vector3d *p, size_t n) {
+        for (size_t i = 0; i < n; i++)
+            p[i] = -p[i];
+    }, options));
+    const auto negated = read_file<double>(output, header.size(), nullptr);
+    ASSERT_EQ(negated.size(), 4000u);
+    EXPECT_EQ(negated[3999], -outd[3999]);
+
+    // errors
+    math::StreamStats stats;
+    EXPECT_FALSE(math::transform_points_file(temp_path("vmath_stream_missing.bin"), output, t, {}, &stats));
+    EXPECT_FALSE(stats.error.empty());
+    options.count = 6000;
+    EXPECT_FALSE(math::transform_points_file(input, output, td, options, &stats));
+    EXPECT_EQ(stats.error, "not enough points in " + input);
+    options.input_offset = 1 << 20;
+    options.count = uint64_t(-1);
+    EXPECT_FALSE(math::transform_points_file(input, output, td, options, &stats));
+    // the failed checks leave the output untouched
+    EXPECT_EQ(read_file<double>(output, header.size(), nullptr), negated);
+
+    // a kernel that throws: the exception is passed on once the I/O threads are joined
+    const std::string thrown = temp_path("vmath_stream_throw.bin");
+    options.input_offset = header.size();
+    options.count = 4000;
+    options.threads = 1;
+    size_t calls = 0;
+    EXPECT_THROW(math::stream_points<double>(input, thrown, [&calls](math::Vector3d *, size_t) {
+        if (++calls == 3)
+            throw std::runtime_error("kernel");
+    }, options), std::runtime_error);
+    EXPECT_EQ(calls, 3u);
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+    std::remove(thrown.c_str());
+}
+
+TEST(Stream, in_place) {
+    const std::vector<unsigned char> header(48, 0x5a);
+    const auto points = random_points<double>(3000, 9);
+    const auto t = random_transform<double>(10);
+    const std::string path = temp_path("vmath_stream_in_place.bin");
+    write_file(path, header, points);
+
+    // the output is written behind the reader, on the same file
+    math::StreamOptions options;
+    options.chunk_points = 100;
+    options.input_offset = header.size();
+    math::StreamStats stats;
+    ASSERT_TRUE(math::transform_points_file(path, path, t, options, &stats)) << stats.error;
+    const auto shifted = read_file<double>(path, 0, nullptr);
+    expect_transformed(points, std::vector<math::Vector3d>(shifted.begin(), shifted.begin() + points.size()), t,
+                       1e-10);
+
+    // the writer cannot overtake the reader: rejected before anything is written
+    write_file(path, header, points);
+    options.input_offset = 0;
+    options.output_offset = header.size();
+    EXPECT_FALSE(math::transform_points_file(path, path, t, options, &stats));
+    EXPECT_FALSE(stats.error.empty());
+    std::vector<unsigned char> header_out;
+    EXPECT_EQ(read_file<double>(path, header.size(), &header_out), points);
+    EXPECT_EQ(header_out, header);
+
+#if defined(VMATH_PREAD)
+    // the same file through another path is detected, and not truncated
+    const std::string alias = testing::TempDir() + "/./vmath_stream_in_place.bin";
+    ASSERT_NE(alias, path);
+    options.input_offset = header.size();
+    ASSERT_TRUE(math::transform_points_file(path, alias, t, options, &stats)) << stats.error;
+    const auto out = read_file<double>(path, header.size(), &header_out);
+    EXPECT_EQ(header_out, header);
+    expect_transformed(points, out, t, 1e-10);
+#endif
+    std::remove(path.c_str());
+}
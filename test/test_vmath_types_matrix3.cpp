@@ -205,6 +205,22 @@ TEST(Matrix3x3, matrix_operations) {
     ASSERT_PRED2(matrix_matrix_equal<double>, m5, math::Matrix3d({102.30, 109.56, 116.82,
                                                                   244.86, 263.01, 281.16,
                                                                   387.42, 416.46, 445.50}));
+    // float (has a dedicated SIMD kernel on some architectures)
+    math::Matrix3f m6 = math::Matrix3f(m1) * math::Matrix3f(m2);
+    ASSERT_PRED2(matrix_matrix_equal<float>, m6 / 100.0f, math::Matrix3f(m5 / 100.0));
+    // the dedicated float/double kernels must give the same results of the generic implementation
+    math::Matrix3f mf1({1, 2, 3, 4, 5, 6, 7, 8, 9});
+    math::Matrix3f mf2({-2, 0, 2, -1, 1, -2, 0, 2, -1});
+    ASSERT_PRED2(matrix_matrix_equal<float>, mf1 * mf2, math::operator*<float>(mf1, mf2));
+    ASSERT_PRED2(matrix_matrix_equal<double>, m1 * m2, math::operator*<double>(m1, m2));
+    // chained products (results feeding the next product)
+    math::Matrix3f acc = mf1;
+    math::Matrix3d accd = math::Matrix3d(mf1);
+    for (int i = 0; i < 3; i++) {
+        acc = acc * mf2;
+        accd = accd * math::Matrix3d(mf2);
+    }
+    ASSERT_PRED2(matrix_matrix_equal<float>, acc, math::Matrix3f(accd));
 }
 
 
@@ -251,6 +267,10 @@ TEST(Matrix3x3, vector_operations) {
     ASSERT_NEAR(v1.x, 12.1, 1e-6);
     ASSERT_NEAR(v1.y, 31.9, 1e-6);
     ASSERT_NEAR(v1.z, 51.7, 1e-6);
+    math::Vector3f v2 = math::Matrix3f(m) * math::Vector3f(v);
+    ASSERT_NEAR(v2.x, 12.1, 1e-5);
+    ASSERT_NEAR(v2.y, 31.9, 1e-5);
+    ASSERT_NEAR(v2.z, 51.7, 1e-5);
 }
 
 TEST(Matrix3x3, other_operators) {